@@ -22,8 +22,7 @@ sptr<Box> ScaleAtom::createBox(Environment& env) {
 }
 
 sptr<Box> MathAtom::createBox(Environment& env) {
-  Environment& e = *(env.copy(env.getTeXFont()->copy()));
-  e.getTeXFont()->setRoman(false);
+  Environment& e = *(env.copy(env.getTeXFont()->withRoman(false)));
   TexStyle style = e.getStyle();
   // if parent style greater than "this style",
   // that means the parent uses smaller font size,
@@ -94,22 +93,14 @@ sptr<Box> TextRenderingAtom::createBox(Environment& env) {
   int type = tf->_isIt ? ITALIC : PLAIN;
   type = type | (tf->_isBold ? BOLD : 0);
   bool kerning = tf->_isRoman;
-  sptr<Font> font;
   const FontInfos& infos = *_infos;
+  const string* family;
   if (tf->_isSs) {
-    if (infos._sansserif.empty()) {
-      font = Font::_create(infos._serif, PLAIN, 10);
-    } else {
-      font = Font::_create(infos._sansserif, PLAIN, 10);
-    }
+    family = infos._sansserif.empty() ? &infos._serif : &infos._sansserif;
   } else {
-    if (infos._serif.empty()) {
-      font = Font::_create(infos._sansserif, PLAIN, 10);
-    } else {
-      font = Font::_create(infos._serif, PLAIN, 10);
-    }
+    family = infos._serif.empty() ? &infos._sansserif : &infos._serif;
   }
-  return sptrOf<TextRenderingBox>(_str, type, DefaultTeXFont::getSizeFactor(env.getStyle()), font, kerning);
+  return sptrOf<TextRenderingBox>(_str, type, DefaultTeXFont::getSizeFactor(env.getStyle()), *family, kerning);
 }
 
 SpaceAtom UnderScoreAtom::_w(UnitType::em, 0.7f, 0.f, 0.f);
@@ -232,8 +223,7 @@ sptr<Box> ColorAtom::createBox(Environment& env) {
 
 sptr<Box> RomanAtom::createBox(Environment& env) {
   if (_base == nullptr) return sptrOf<StrutBox>(0.f, 0.f, 0.f, 0.f);
-  Environment& c = *(env.copy(env.getTeXFont()->copy()));
-  c.getTeXFont()->setRoman(true);
+  Environment& c = *(env.copy(env.getTeXFont()->withRoman(true)));
   return _base->createBox(c);
 }
 
@@ -272,6 +272,7 @@ public:
 /** An atom representing the foreground and background color of an other atom */
 class ColorAtom : public Atom, public Row {
 private:
+  // the colors defined at runtime, the builtin colors are in a sorted constant table
   static std::map<std::string, color> _colors;
   static const color _default;
 
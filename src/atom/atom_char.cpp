@@ -30,9 +30,8 @@ sptr<Box> SymbolAtom::createBox(Environment& env) {
   sptr<Box> cb = sptrOf<CharBox>(c);
   if (env.getSmallCap() && _unicode != 0 && islower(_unicode)) {
     // find if exists in mapping
-    auto it = Formula::_symbolTextMappings.find(toupper(_unicode));
-    if (it != Formula::_symbolFormulaMappings.end()) {
-      const string& name = it->second;
+    const char* name = Formula::getSymbolTextMapping(toupper(_unicode));
+    if (name != nullptr) {
       try {
         auto cx = sptrOf<CharBox>(tf.getChar(name, style));
         cb = sptrOf<ScaleBox>(cx, 0.8f, 0.8f);
@@ -64,12 +63,6 @@ void SymbolAtom::addSymbolAtom(const sptr<SymbolAtom>& sym) {
   _symbols[sym->_name] = sym;
 }
 
-sptr<SymbolAtom> SymbolAtom::get(const string& name) {
-  auto it = _symbols.find(name);
-  if (it == _symbols.end()) throw ex_symbol_not_found(name);
-  return it->second;
-}
-
 Char CharAtom::getChar(TeXFont& tf, TexStyle style, bool smallCap) {
   wchar_t chr = _c;
   if (smallCap) {
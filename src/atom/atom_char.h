@@ -89,7 +89,8 @@ private:
   wchar_t _unicode;
 
 public:
-  // contains all defined symbols
+  // the symbols added at runtime, the builtin symbols are in a sorted constant table
+  // and never added here, see #get
   static std::map<std::string, sptr<SymbolAtom>> _symbols;
 
   SymbolAtom() = delete;
@@ -132,7 +133,8 @@ public:
 
   /**
    * Looks up the name in the table and returns the corresponding SymbolAtom
-   * representing the symbol (if it's found).
+   * representing the symbol (if it's found). The symbols added at runtime take
+   * precedence over the builtin symbols.
    *
    * @param name the name of the symbol
    * @return a SymbolAtom representing the found symbol
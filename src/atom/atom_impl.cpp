@@ -398,7 +398,7 @@ LongDivAtom::LongDivAtom(long divisor, long dividend)
     auto num = Formula(results[i])._root;
     if (i == 1) {
       wstring divisor = towstring(_divisor);
-      auto rparen = SymbolAtom::get(Formula::_symbolMappings[')']);
+      auto rparen = SymbolAtom::get(Formula::getSymbolMapping(')'));
       auto big = sptrOf<BigDelimiterAtom>(rparen, 1);
       auto ph = sptrOf<PhantomAtom>(big, false, true, true);
       auto ra = sptrOf<RowAtom>(ph);
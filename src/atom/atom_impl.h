@@ -52,8 +52,7 @@ public:
 
   sptr<Box> createBox(Environment& env) override {
     if (_base != nullptr) {
-      Environment& e = *(env.copy(env.getTeXFont()->copy()));
-      e.getTeXFont()->setBold(true);
+      Environment& e = *(env.copy(env.getTeXFont()->withBold(true)));
       return _base->createBox(e);
     }
     return sptrOf<StrutBox>(0.f, 0.f, 0.f, 0.f);
@@ -412,8 +411,7 @@ public:
   sptr<Box> createBox(Environment& env) override {
     sptr<Box> box;
     if (_base != nullptr) {
-      Environment& e = *(env.copy(env.getTeXFont()->copy()));
-      e.getTeXFont()->setIt(true);
+      Environment& e = *(env.copy(env.getTeXFont()->withIt(true)));
       box = _base->createBox(e);
     } else {
       box = sptrOf<StrutBox>(0.f, 0.f, 0.f, 0.f);
@@ -783,11 +781,8 @@ public:
   explicit SsAtom(const sptr<Atom>& base) : _base(base) {}
 
   sptr<Box> createBox(Environment& env) override {
-    bool prev = env.getTeXFont()->isSs();
-    env.getTeXFont()->setSs(true);
-    auto box = _base->createBox(env);
-    env.getTeXFont()->setSs(prev);
-    return box;
+    FontScope scope(env, env.getTeXFont()->withSs(true));
+    return _base->createBox(env);
   }
 
   __decl_clone(SsAtom)
@@ -955,11 +950,8 @@ public:
   explicit TtAtom(const sptr<Atom>& base) : _base(base) {}
 
   sptr<Box> createBox(Environment& env) override {
-    bool prev = env.getTeXFont()->isTt();
-    env.getTeXFont()->setTt(true);
-    auto box = _base->createBox(env);
-    env.getTeXFont()->setTt(prev);
-    return box;
+    FontScope scope(env, env.getTeXFont()->withTt(true));
+    return _base->createBox(env);
   }
 
   __decl_clone(TtAtom)
@@ -124,9 +124,9 @@ void MatrixAtom::parsePositions(wstring opt, vector<Alignment>& lpos) {
   if (lpos.empty()) lpos.push_back(Alignment::center);
 }
 
-float* MatrixAtom::getColumnSep(Environment& env, float width) {
+vector<float> MatrixAtom::getColumnSep(Environment& env, float width) {
   const int cols = _matrix->cols();
-  auto* arr = new float[cols + 1]();
+  vector<float> arr(cols + 1);
   sptr<Box> Align, AlignSep, Hsep;
   float h, w = env.getTextWidth();
   int i = 0;
@@ -233,14 +233,14 @@ float* MatrixAtom::getColumnSep(Environment& env, float width) {
 }
 
 void MatrixAtom::recalculateLine(
-  const int rows,
-  sptr<Box>** boxarr,
+  CellBoxes& cells,
   vector<sptr<Atom>>& multiRows,
-  float* height,
-  float* depth,
+  vector<float>& height,
+  vector<float>& depth,
   float drt,
   float vspace
 ) {
+  const int rows = cells.rows;
   const size_t s = multiRows.size();
   for (size_t i = 0; i < s; i++) {
     auto* m = (MultiRowAtom*) multiRows[i].get();
@@ -253,7 +253,7 @@ void MatrixAtom::recalculateLine(
       // Across from bottom to top
       int j = r;
       for (; j >= 0 && j > r + n; j--) {
-        if (boxarr[j][0]->_type == AtomType::hline) {
+        if (cells(j, 0)->_type == AtomType::hline) {
           if (j == 0) break;
           h += drt;
           n--;
@@ -263,13 +263,11 @@ void MatrixAtom::recalculateLine(
         }
       }
       m->_i = ++j;
-      auto tmp = boxarr[r][c];
-      boxarr[r][c] = boxarr[j][c];
-      boxarr[j][c] = tmp;
+      swap(cells(r, c), cells(j, c));
     } else {
       // Across from top to bottom
       for (int j = r; j < r + n && j < rows; j++) {
-        if (boxarr[j][0]->_type == AtomType::hline) {
+        if (cells(j, 0)->_type == AtomType::hline) {
           if (j == rows - 1) break;
           h += drt;
           n++;
@@ -280,7 +278,7 @@ void MatrixAtom::recalculateLine(
       }
     }
     m->_n = abs(n);
-    auto b = boxarr[m->_i][m->_j];
+    auto b = cells(m->_i, m->_j);
     const float bh = b->_height + b->_depth + vspace;
     if (h > bh) {
       b->_height = (h - bh + vspace) / 2.f;
@@ -288,7 +286,7 @@ void MatrixAtom::recalculateLine(
       const float ex = (bh - h) / skipped / 2.f;
       const int mr = m->_i + m->_n;
       for (int j = m->_i; j < mr; j++) {
-        if (boxarr[j][0]->_type != AtomType::hline) {
+        if (cells(j, 0)->_type != AtomType::hline) {
           height[j] += ex;
           depth[j] += ex;
         }
@@ -296,15 +294,15 @@ void MatrixAtom::recalculateLine(
       b->_height = height[m->_i];
       b->_depth = bh - b->_height - vspace;
     }
-    boxarr[m->_i][m->_j]->_type = AtomType::none;
+    cells(m->_i, m->_j)->_type = AtomType::none;
   }
 }
 
 sptr<Box> MatrixAtom::generateMulticolumn(
   Environment& env,
   const sptr<Box>& b,
-  const float* hsep,
-  const float* colWidth,
+  const vector<float>& hsep,
+  const vector<float>& colWidth,
   int i,
   int j
 ) {
@@ -390,8 +388,7 @@ void MatrixAtom::applyCell(WrapperBox& box, int i, int j) {
     for (const auto& s : row->second) s->apply(box);
   }
   // 3. cell specifier
-  const string key = tostring(i) + tostring(j);
-  auto cell = _matrix->_cellSpecifiers.find(key);
+  auto cell = _matrix->_cellSpecifiers.find(ArrayFormula::cellKey(i, j));
   if (cell != _matrix->_cellSpecifiers.end()) {
     for (const auto& s : cell->second) s->apply(box);
   }
@@ -402,11 +399,10 @@ sptr<Box> MatrixAtom::createBox(Environment& e) {
   const int rows = _matrix->rows();
   const int cols = _matrix->cols();
 
-  auto* lineDepth = new float[rows]();
-  auto* lineHeight = new float[rows]();
-  auto* colWidth = new float[cols]();
-  auto** boxarr = new sptr<Box>* [rows]();
-  for (int i = 0; i < rows; i++) boxarr[i] = new sptr<Box>[cols]();
+  vector<float> lineDepth(rows);
+  vector<float> lineHeight(rows);
+  vector<float> colWidth(cols);
+  CellBoxes cells(rows, cols);
 
   float matW = 0;
   float drt = env.getTeXFont()->getDefaultRuleThickness(env.getStyle());
@@ -423,35 +419,34 @@ sptr<Box> MatrixAtom::createBox(Environment& e) {
   vector<sptr<Atom>> listMultiCol;
   vector<sptr<Atom>> listMultiRow;
   for (int i = 0; i < rows; i++) {
-    lineDepth[i] = 0;
-    lineHeight[i] = 0;
     const int size = _matrix->_array[i].size();
     for (int j = 0; j < cols; j++) {
       if (j >= size) {
         // If current row is not full-filled, fill the row with _nullbox
-        for (int k = j; k < cols; k++) boxarr[i][k] = _nullbox;
+        for (int k = j; k < cols; k++) cells(i, k) = _nullbox;
         break;
       }
 
       sptr<Atom> atom = _matrix->_array[i][j];
-      boxarr[i][j] = (atom == nullptr) ? _nullbox : atom->createBox(env);
+      sptr<Box>& cell = cells(i, j);
+      cell = (atom == nullptr) ? _nullbox : atom->createBox(env);
       if (atom != nullptr && atom->_type == AtomType::interText) {
-        boxarr[i][j]->_type = AtomType::interText;
+        cell->_type = AtomType::interText;
       }
 
-      if (boxarr[i][j]->_type != AtomType::multiRow) {
+      if (cell->_type != AtomType::multiRow) {
         // Find the highest line (row)
-        lineDepth[i] = max(boxarr[i][j]->_depth, lineDepth[i]);
-        lineHeight[i] = max(boxarr[i][j]->_height, lineHeight[i]);
+        lineDepth[i] = max(cell->_depth, lineDepth[i]);
+        lineHeight[i] = max(cell->_height, lineHeight[i]);
       } else {
         auto* mra = (MultiRowAtom*) atom.get();
         mra->setRowColumn(i, j);
         listMultiRow.push_back(atom);
       }
 
-      if (boxarr[i][j]->_type != AtomType::multiColumn) {
+      if (cell->_type != AtomType::multiColumn) {
         // Find the widest column
-        colWidth[j] = max(boxarr[i][j]->_width, colWidth[j]);
+        colWidth[j] = max(cell->_width, colWidth[j]);
       } else {
         auto* mca = (MulticolumnAtom*) atom.get();
         mca->setRowColumn(i, j);
@@ -463,7 +458,7 @@ sptr<Box> MatrixAtom::createBox(Environment& e) {
   for (int j = 0; j < cols; j++) matW += colWidth[j];
 
   // The horizontal separator's width
-  float* Hsep = getColumnSep(env, matW);
+  const vector<float> Hsep = getColumnSep(env, matW);
 
   for (auto& i : listMultiCol) {
     auto* multi = (MulticolumnAtom*) i.get();
@@ -472,11 +467,12 @@ sptr<Box> MatrixAtom::createBox(Environment& e) {
     int j = 0;
     for (j = c; j < c + n - 1; j++) w += colWidth[j] + Hsep[j + 1];
     w += colWidth[j];
-    if (boxarr[r][c]->_width > w) {
+    const float bw = cells(r, c)->_width;
+    if (bw > w) {
       // If the multi-column's width > the total width of the acrossed columns,
       // add an extra-space to each column
-      matW += boxarr[r][c]->_width - w;
-      const float extraW = (boxarr[r][c]->_width - w) / n;
+      matW += bw - w;
+      const float extraW = (bw - w) / n;
       for (int k = c; k < c + n; k++) colWidth[k] += extraW;
     }
   }
@@ -490,7 +486,7 @@ sptr<Box> MatrixAtom::createBox(Environment& e) {
 
   auto Vsep = _vsep_in.createBox(env);
   // Recalculate the height of the row
-  recalculateLine(rows, boxarr, listMultiRow, lineHeight, lineDepth, drt, Vsep->_height);
+  recalculateLine(cells, listMultiRow, lineHeight, lineDepth, drt, Vsep->_height);
 
   auto* vb = new VBox();
   float totalHeight = 0;
@@ -499,7 +495,7 @@ sptr<Box> MatrixAtom::createBox(Environment& e) {
   for (int i = 0; i < rows; i++) {
     auto hb = sptrOf<HBox>();
     for (int j = 0; j < cols; j++) {
-      switch (boxarr[i][j]->_type) {
+      switch (cells(i, j)->_type) {
         case AtomType::none:
         case AtomType::multiColumn: {
           if (j == 0) {
@@ -518,12 +514,12 @@ sptr<Box> MatrixAtom::createBox(Environment& e) {
           WrapperBox* wb = nullptr;
           int tj = j;
           float l = j == 0 ? Hsep[j] : Hsep[j] / 2;
-          if (boxarr[i][j]->_type == AtomType::none) {
+          if (cells(i, j)->_type == AtomType::none) {
             wb = new WrapperBox(
-              boxarr[i][j], colWidth[j], lineHeight[i], lineDepth[i], _position[j]  //
+              cells(i, j), colWidth[j], lineHeight[i], lineDepth[i], _position[j]  //
             );
           } else {
-            auto b = generateMulticolumn(env, boxarr[i][j], Hsep, colWidth, i, j);
+            auto b = generateMulticolumn(env, cells(i, j), Hsep, colWidth, i, j);
             auto* matom = (MulticolumnAtom*) _matrix->_array[i][j].get();
             j += matom->skipped() - 1;
             wb = new WrapperBox(b, b->_width, lineHeight[i], lineDepth[i], Alignment::left);
@@ -533,7 +529,7 @@ sptr<Box> MatrixAtom::createBox(Environment& e) {
           wb->addInsets(l, Vspace, r, Vspace);
           applyCell(*wb, i, j);
           sptr<Box> swb(wb);
-          boxarr[i][tj] = swb;
+          cells(i, tj) = swb;
           hb->add(swb);
 
           auto it = _vlines.find(j + 1);
@@ -550,7 +546,7 @@ sptr<Box> MatrixAtom::createBox(Environment& e) {
         case AtomType::interText: {
           float f = env.getTextWidth();
           f = f == POS_INF ? colWidth[j] : f;
-          hb = sptrOf<HBox>(boxarr[i][j], f, Alignment::left);
+          hb = sptrOf<HBox>(cells(i, j), f, Alignment::left);
           j = cols;
         }
           break;
@@ -570,7 +566,7 @@ sptr<Box> MatrixAtom::createBox(Environment& e) {
       }
     }
 
-    if (boxarr[i][0]->_type != AtomType::hline) {
+    if (cells(i, 0)->_type != AtomType::hline) {
       hb->_height = lineHeight[i] + Vspace;
       hb->_depth = lineDepth[i] + Vspace;
     }
@@ -583,13 +579,6 @@ sptr<Box> MatrixAtom::createBox(Environment& e) {
   vb->_height = totalHeight / 2 + axis;
   vb->_depth = totalHeight / 2 - axis;
 
-  delete[] Hsep;
-  delete[] lineDepth;
-  delete[] lineHeight;
-  delete[] colWidth;
-  for (int i = 0; i < rows; i++) delete[] boxarr[i];
-  delete[] boxarr;
-
   return sptr<Box>(vb);
 }
 
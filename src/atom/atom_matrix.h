@@ -65,6 +65,16 @@ enum class MatrixType : i8 {
   alignedAt
 };
 
+/** Boxes of the cells of a matrix, stored row by row in a contiguous block */
+struct CellBoxes {
+  const int rows, cols;
+  std::vector<sptr<Box>> boxes;
+
+  CellBoxes(int r, int c) : rows(r), cols(c), boxes((size_t) r * c) {}
+
+  inline sptr<Box>& operator()(int i, int j) { return boxes[(size_t) i * cols + j]; }
+};
+
 /** Atom represents matrix */
 class MatrixAtom : public Atom {
 private:
@@ -86,23 +96,22 @@ private:
   sptr<Box> generateMulticolumn(
     Environment& env,
     const sptr<Box>& b,
-    const float* hsep,
-    const float* colWidth,
+    const std::vector<float>& hsep,
+    const std::vector<float>& colWidth,
     int i,
     int j
   );
 
   static void recalculateLine(
-    int rows,
-    sptr<Box>** boxarr,
+    CellBoxes& cells,
     std::vector<sptr<Atom>>& multiRows,
-    float* height,
-    float* depth,
+    std::vector<float>& height,
+    std::vector<float>& depth,
     float drt,
     float vspace
   );
 
-  float* getColumnSep(Environment& env, float width);
+  std::vector<float> getColumnSep(Environment& env, float width);
 
   void applyCell(WrapperBox& box, int i, int j);
 
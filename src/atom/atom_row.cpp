@@ -2,6 +2,7 @@
 
 #include <memory>
 #include "atom/atom_basic.h"
+#include "box/box_index.h"
 #include "core/core.h"
 
 using namespace std;
@@ -28,10 +29,10 @@ void Dummy::changeAtom(const sptr<FixedCharAtom>& atom) {
 }
 
 sptr<Box> Dummy::createBox(Environment& env) {
-  if (_textSymbol) ((CharSymbol*) _atom.get())->markAsTextSymbol();
-  auto box = _atom->createBox(env);
-  if (_textSymbol) ((CharSymbol*) _atom.get())->removeMark();
-  return box;
+  // the atom is not marked as a text symbol while it creates its box: no char
+  // symbol reads its own mark, and the symbols are shared by the formulas parsed
+  // in other threads (see SymbolAtom#get)
+  return _atom->createBox(env);
 }
 
 inline bool Dummy::isKern() const {
@@ -126,7 +127,11 @@ AtomType RowAtom::rightType() const {
 sptr<Box> RowAtom::createBox(Environment& env) {
   auto x = env.getTeXFont();
   TeXFont& tf = *x;
-  auto* hbox = new HBox();
+  // no ligatures nor kerning in draft mode
+  const bool draft = tf.isDraft();
+  // only the metrics of the row are kept if no more is wanted
+  MetricsBox* metrics = env.isMetricsOnly() ? new MetricsBox() : nullptr;
+  HBox* hbox = metrics == nullptr ? new HBox() : nullptr;
 
   // convert atoms to boxes and add to the horizontal box
   const int end = _elements.size() - 1;
@@ -153,7 +158,7 @@ sptr<Box> RowAtom::createBox(Environment& env) {
 
     // check for ligature or kerning
     float kern = 0;
-    while (i < end && atom->rightType() == AtomType::ordinary && atom->isCharSymbol()) {
+    while (!draft && i < end && atom->rightType() == AtomType::ordinary && atom->isCharSymbol()) {
       auto next = _elements[++i];
       auto* c = dynamic_cast<CharSymbol*>(next.get());
       if (c != nullptr && _ligKernSet[static_cast<i8>(next->leftType())]) {
@@ -182,12 +187,17 @@ sptr<Box> RowAtom::createBox(Environment& env) {
         && !_previousAtom->isKern()
         && !atom->isKern()
       ) {
-      hbox->add(Glue::get(_previousAtom->rightType(), atom->leftType(), env));
+      if (metrics == nullptr) {
+        hbox->add(Glue::get(_previousAtom->rightType(), atom->leftType(), env));
+      } else {
+        metrics->add(Glue::getSpace(_previousAtom->rightType(), atom->leftType(), env), 0.f, 0.f);
+      }
     }
 
     // insert atom's box
     atom->setPreviousAtom(_previousAtom);
     auto b = atom->createBox(env);
+    if (env.getAtomLinks() != nullptr) env.getAtomLinks()->add(b, at);
     auto* cb = dynamic_cast<CharBox*>(b.get());
     if (cb != nullptr
         && !atom->isCharInMathMode()
@@ -198,7 +208,7 @@ sptr<Box> RowAtom::createBox(Environment& env) {
       cb->addItalicCorrectionToWidth();
     }
 
-    if (_breakable) {
+    if (_breakable && hbox != nullptr) {
       if (_breakEveywhere) {
         hbox->addBreakPosition(hbox->_children.size());
       } else {
@@ -209,19 +219,30 @@ sptr<Box> RowAtom::createBox(Environment& env) {
       }
     }
 
-    hbox->add(b);
+    if (metrics == nullptr) {
+      hbox->add(b);
+    } else {
+      metrics->add(*b);
+    }
 
     // set last used font id (for next atom)
     env.setLastFontId(b->lastFontId());
 
     // insert kerning
-    if (abs(kern) > PREC) hbox->add(sptrOf<StrutBox>(kern, 0.f, 0.f, 0.f));
+    if (abs(kern) > PREC) {
+      if (metrics == nullptr) {
+        hbox->add(sptrOf<StrutBox>(kern, 0.f, 0.f, 0.f));
+      } else {
+        metrics->add(kern, 0.f, 0.f);
+      }
+    }
 
     // kerning do not interfere with the normal glue-rules without kerning
     if (!atom->isKern()) _previousAtom = atom;
   }
   // reset previous atom
   _previousAtom = nullptr;
+  if (metrics != nullptr) return sptr<Box>(metrics);
   return sptr<Box>(hbox);
 }
 
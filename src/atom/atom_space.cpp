@@ -16,10 +16,11 @@ inline UnitType SpaceAtom::getUnit(const std::string& unit) {
 
 sptr<Box> SpaceAtom::createBox(Environment& env) {
   if (!_blankSpace) {
-    float w = _width * getFactor(_wUnit, env);
-    float h = _height * getFactor(_hUnit, env);
-    float d = _depth * getFactor(_dUnit, env);
-    return sptrOf<StrutBox>(w, h, d, 0.f);
+    // a zero length depends on neither the unit nor the text size
+    const auto length = [&](float len, UnitType unit) {
+      return len == 0 ? 0.f : len * getFactor(unit, env);
+    };
+    return sptrOf<StrutBox>(length(_width, _wUnit), length(_height, _hUnit), length(_depth, _dUnit), 0.f);
   }
   if (_blankType == SpaceType::none) return sptrOf<StrutBox>(env.getSpace(), 0.f, 0.f, 0.f);
   return Glue::get(_blankType, env);
@@ -43,11 +43,11 @@ const function<float(const Environment&)> SpaceAtom::_unitConversions[]{
   },
   // BP
   [](const Environment& env) -> float {
-    return Formula::PIXELS_PER_POINT / env.getSize();
+    return env.getPixelsPerPoint() / env.getSize();
   },
   // PICA
   [](const Environment& env) -> float {
-    return (12 * Formula::PIXELS_PER_POINT) / env.getSize();
+    return (12 * env.getPixelsPerPoint()) / env.getSize();
   },
   // MU
   [](const Environment& env) -> float {
@@ -56,31 +56,31 @@ const function<float(const Environment&)> SpaceAtom::_unitConversions[]{
   },
   // CM
   [](const Environment& env) -> float {
-    return (28.346456693f * Formula::PIXELS_PER_POINT) / env.getSize();
+    return (28.346456693f * env.getPixelsPerPoint()) / env.getSize();
   },
   // MM
   [](const Environment& env) -> float {
-    return (2.8346456693f * Formula::PIXELS_PER_POINT) / env.getSize();
+    return (2.8346456693f * env.getPixelsPerPoint()) / env.getSize();
   },
   // IN
   [](const Environment& env) -> float {
-    return (72.f * Formula::PIXELS_PER_POINT) / env.getSize();
+    return (72.f * env.getPixelsPerPoint()) / env.getSize();
   },
   // SP
   [](const Environment& env) -> float {
-    return (65536 * Formula::PIXELS_PER_POINT) / env.getSize();
+    return (65536 * env.getPixelsPerPoint()) / env.getSize();
   },
   // PT
   [](const Environment& env) -> float {
-    return (.9962640099f * Formula::PIXELS_PER_POINT) / env.getSize();
+    return (.9962640099f * env.getPixelsPerPoint()) / env.getSize();
   },
   // DD
   [](const Environment& env) -> float {
-    return (1.0660349422f * Formula::PIXELS_PER_POINT) / env.getSize();
+    return (1.0660349422f * env.getPixelsPerPoint()) / env.getSize();
   },
   // CC
   [](const Environment& env) -> float {
-    return (12.7924193070f * Formula::PIXELS_PER_POINT) / env.getSize();
+    return (12.7924193070f * env.getPixelsPerPoint()) / env.getSize();
   },
   // X8
   [](const Environment& env) -> float {
@@ -1,4 +1,8 @@
 #include "box/box.h"
+
+#include <algorithm>
+
+#include "box/box_single.h"
 #include "fonts/fonts.h"
 
 using namespace tex;
@@ -13,6 +17,24 @@ void Box::copyMetrics(const sptr<Box>& box) {
   _shift = box->_shift;
 }
 
+void Box::drawInRun(GlyphRun& run, Graphics2D& g2, float x, float y) {
+  run.flush();
+  draw(g2, x, y);
+}
+
+void Box::drawVisible(Graphics2D& g2, float x, float y, const Rect& clip) {
+  const Rect r = bounds();
+  if (x + r.x > clip.x + clip.w || x + r.x + r.w < clip.x) return;
+  if (y + r.y > clip.y + clip.h || y + r.y + r.h < clip.y) return;
+  draw(g2, x, y);
+}
+
+Rect Box::bounds() {
+  const float l = min(0.f, _width), r = max(0.f, _width);
+  const float t = min(-_height, _depth), b = max(-_height, _depth);
+  return {l, t, r - l, b - t};
+}
+
 int Box::lastFontId() {
   return TeXFont::NO_FONT;
 }
@@ -25,6 +47,72 @@ int BoxGroup::lastFontId() {
   return id;
 }
 
+const BoxGroup::ChildIndex* BoxGroup::index() {
+  ChildIndex* cur = _index.load(std::memory_order_acquire);
+  if (cur != nullptr) return cur;
+  std::unique_ptr<ChildIndex> idx(new ChildIndex());
+  if (!childOrigins(idx->xs, idx->ys, idx->horizontal)) return nullptr;
+  const size_t n = _children.size();
+  idx->rects.resize(n);
+  idx->reach.resize(n);
+  idx->start.resize(n);
+  Rect& u = idx->bounds = Box::bounds();
+  float reach = F_MIN;
+  for (size_t i = 0; i < n; i++) {
+    Rect r = _children[i]->bounds();
+    r.x += idx->xs[i];
+    r.y += idx->ys[i];
+    idx->rects[i] = r;
+    const float l = min(u.x, r.x), t = min(u.y, r.y);
+    u.w = max(u.x + u.w, r.x + r.w) - l;
+    u.h = max(u.y + u.h, r.y + r.h) - t;
+    u.x = l;
+    u.y = t;
+    reach = max(reach, idx->horizontal ? r.x + r.w : r.y + r.h);
+    idx->reach[i] = reach;
+  }
+  float start = F_MAX;
+  for (size_t i = n; i > 0; i--) {
+    const Rect& r = idx->rects[i - 1];
+    start = min(start, idx->horizontal ? r.x : r.y);
+    idx->start[i - 1] = start;
+  }
+  // another thread may have built it meanwhile, the first published one is kept
+  // so the pointers handed out stay valid
+  if (!_index.compare_exchange_strong(cur, idx.get(), std::memory_order_acq_rel)) return cur;
+  return idx.release();
+}
+
+void BoxGroup::drawVisible(Graphics2D& g2, float x, float y, const Rect& clip) {
+  const ChildIndex* idx = index();
+  if (idx == nullptr) {
+    Box::drawVisible(g2, x, y, clip);
+    return;
+  }
+  // the clip relative to the origin of this group
+  const float l = clip.x - x, t = clip.y - y, r = l + clip.w, b = t + clip.h;
+  const Rect& u = idx->bounds;
+  if (u.x > r || u.x + u.w < l || u.y > b || u.y + u.h < t) return;
+  if (u.x >= l && u.x + u.w <= r && u.y >= t && u.y + u.h <= b) {
+    draw(g2, x, y);
+    return;
+  }
+  // skip the children end before the clip, stop at the first child all the rest start after it
+  const float near = idx->horizontal ? l : t, far = idx->horizontal ? r : b;
+  const size_t n = _children.size();
+  size_t i = lower_bound(idx->reach.begin(), idx->reach.end(), near) - idx->reach.begin();
+  for (; i < n && idx->start[i] <= far; i++) {
+    const Rect& c = idx->rects[i];
+    if (c.x > r || c.x + c.w < l || c.y > b || c.y + c.h < t) continue;
+    _children[i]->drawVisible(g2, x + idx->xs[i], y + idx->ys[i], clip);
+  }
+}
+
+Rect BoxGroup::bounds() {
+  const ChildIndex* idx = index();
+  return idx == nullptr ? Box::bounds() : idx->bounds;
+}
+
 int DecorBox::lastFontId() {
   return _base->lastFontId();
 }
@@ -1,6 +1,8 @@
 #ifndef LATEX_BOX_H
 #define LATEX_BOX_H
 
+#include <atomic>
+
 #include "common.h"
 #include "graphic/graphic.h"
 #include "utils/enums.h"
@@ -8,6 +10,10 @@
 namespace tex {
 class Environment;
 
+class DisplayCompiler;
+
+class GlyphRun;
+
 /**
  * An abstract graphical representation of a formula, that can be painted. All
  * characters, font sizes, positions are fixed. Only special Glue boxes could
@@ -77,6 +83,49 @@ public:
    */
   virtual void draw(Graphics2D& g2, float x, float y) = 0;
 
+  /**
+   * Compile this box into flat records of a display list at the given
+   * coordinates, the records must have the same effect as #draw.
+   *
+   * @param dc the compiler of the display list
+   * @param x the x-coordinate
+   * @param y the y-coordinate
+   * @return false if this box could not be flattened (e.g. it transforms the
+   * graphics), it will be drawn as it is when the list is replayed
+   */
+  virtual bool compile(DisplayCompiler& dc, float x, float y) { return false; }
+
+  /**
+   * Paints this box at the given coordinates as a part of a row whose adjacent
+   * characters are drawn as runs (see HBox#draw). The default implementation draws
+   * the pending glyphs of the run and then paints this box by #draw.
+   *
+   * @param run the run of the glyphs drawn before this box
+   * @param g2 the graphics (2D) context to use for painting
+   * @param x the x-coordinate
+   * @param y the y-coordinate
+   */
+  virtual void drawInRun(GlyphRun& run, Graphics2D& g2, float x, float y);
+
+  /**
+   * Paints the parts of this box that intersect the given clip at the given
+   * coordinates. The default implementation paints the whole box if its bounds
+   * intersect the clip.
+   *
+   * @param g2 the graphics (2D) context to use for painting
+   * @param x the x-coordinate
+   * @param y the y-coordinate
+   * @param clip the visible area, in the same coordinates as x and y
+   */
+  virtual void drawVisible(Graphics2D& g2, float x, float y, const Rect& clip);
+
+  /**
+   * Get the bounds of this box painted at (0, 0), the default is the area
+   * defined by the dimensions. The box must not be modified after its bounds
+   * are retrieved, the groups cache the bounds of their children.
+   */
+  virtual Rect bounds();
+
   /**
    * Get the id of the last font that will be used later when this box is to be
    * painted.
@@ -102,10 +151,63 @@ public:
  * (defined by it's dimensions).
  */
 class BoxGroup : public Box {
+protected:
+  /** The positions and the bounds of the children, see #drawVisible */
+  struct ChildIndex {
+    // if the children are placed along the x-axis, or along the y-axis
+    bool horizontal = true;
+    // the bounds of this group
+    Rect bounds;
+    // the origins and the bounds of the children, relative to the origin of this group
+    std::vector<float> xs, ys;
+    std::vector<Rect> rects;
+    // along the axis: the max far edge of the children [0, i], the min near edge of [i, n)
+    std::vector<float> reach, start;
+  };
+
+  // built on the first clipped painting and published atomically (the trees are
+  // drawn from several threads), owned by this group, dropped when a child is added
+  std::atomic<ChildIndex*> _index{nullptr};
+
+  /** Drop the index of the children, it is rebuilt on the next clipped painting */
+  inline void invalidateIndex() {
+    delete _index.exchange(nullptr, std::memory_order_acq_rel);
+  }
+
+  /**
+   * Get the origins of the children relative to the origin of this group, return
+   * false if the children are not placed along an axis (e.g. they are transformed)
+   */
+  virtual bool childOrigins(std::vector<float>& xs, std::vector<float>& ys, bool& horizontal) {
+    return false;
+  }
+
+  /** Get the index of the children, or nullptr if this group does not support it */
+  const ChildIndex* index();
+
+  friend class BoxIndex;
+
 public:
-  /** Children of this box */
+  /**
+   * Children of this box, add them via #add or #addOnly, the index of the
+   * children is not updated on the direct changes
+   */
   std::vector<sptr<Box>> _children{};
 
+  BoxGroup() = default;
+
+  /** Copy the children and the metrics of the given group, the index is rebuilt */
+  BoxGroup(const BoxGroup& group) : Box(group), _children(group._children) {}
+
+  BoxGroup& operator=(const BoxGroup& group) {
+    Box::operator=(group);
+    _children = group._children;
+    invalidateIndex();
+    return *this;
+  }
+
+  ~BoxGroup() override { invalidateIndex(); }
+
   /**
    * Append the given box to the end of the list of the child boxes.
    *
@@ -113,6 +215,7 @@ public:
    */
   virtual void add(const sptr<Box>& box) {
     _children.push_back(box);
+    invalidateIndex();
   }
 
   /**
@@ -123,6 +226,7 @@ public:
    */
   virtual void add(int pos, const sptr<Box>& box) {
     _children.insert(_children.begin() + pos, box);
+    invalidateIndex();
   }
 
   /**
@@ -137,6 +241,7 @@ public:
    */
   void addOnly(const sptr<Box>& box) {
     _children.push_back(box);
+    invalidateIndex();
   }
 
   /** Child count of this box */
@@ -148,6 +253,15 @@ public:
     return _children;
   }
 
+  /**
+   * Paints the children that intersect the given clip, the children out of the
+   * clip are skipped without being visited if the group supports the index of
+   * its children (see #childOrigins).
+   */
+  void drawVisible(Graphics2D& g2, float x, float y, const Rect& clip) override;
+
+  Rect bounds() override;
+
   int lastFontId() override;
 };
 
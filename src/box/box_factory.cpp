@@ -7,87 +7,168 @@
 using namespace std;
 using namespace tex;
 
-sptr<Box> DelimiterFactory::create(SymbolAtom& symbol, Environment& env, int size) {
-  if (size > 4) return symbol.createBox(env);
+/** Identifies the variants of a delimiter: the symbol and everything the metrics depend on */
+struct DelimiterFactory::Key {
+  std::string symbol;
+  TexStyle style;
+  int flags;
+  float factor, em;
+
+  bool operator<(const Key& k) const {
+    if (symbol != k.symbol) return symbol < k.symbol;
+    if (style != k.style) return style < k.style;
+    if (flags != k.flags) return flags < k.flags;
+    if (factor != k.factor) return factor < k.factor;
+    return em < k.em;
+  }
+};
+
+/** The resolved variants of a delimiter and the boxes built from them */
+struct DelimiterFactory::Variants {
+  // the next-larger chain, from the smallest to the largest
+  std::vector<Char> chars;
+  std::vector<sptr<CharBox>> boxes;
+  // the extension parts of the largest char, if it is an extension char
+  sptr<CharBox> top, middle, repeat, bottom;
+  // the total height of the assembled box with n repeats, and the boxes by n
+  std::vector<float> totals;
+  std::map<int, sptr<VBox>> assembled;
+
+  explicit Variants(const Char& c) : chars{c} {}
 
+  inline bool hasExtension() const { return repeat != nullptr; }
+
+  /** Insert the repeatable part once, the same as TeX does */
+  void addRepeat(VBox& vbox) const {
+    if (top != nullptr && bottom != nullptr) {
+      vbox.add(1, repeat);
+      if (middle != nullptr) vbox.add(vbox.size() - 1, repeat);
+    } else if (bottom != nullptr) {
+      vbox.add(0, repeat);
+    } else {
+      vbox.add(repeat);
+    }
+  }
+
+  /** Assemble the extension parts with n repeats */
+  sptr<VBox> build(int n) const {
+    auto vbox = sptrOf<VBox>();
+    if (top != nullptr) vbox->add(top);
+    if (middle != nullptr) vbox->add(middle);
+    if (bottom != nullptr) vbox->add(bottom);
+    for (int i = 0; i < n; i++) addRepeat(*vbox);
+    return vbox;
+  }
+
+  /** Get the assembled box that is taller than the given min-height */
+  const VBox& get(float minHeight) {
+    if (totals.empty()) {
+      auto vbox = build(0);
+      totals.push_back(vbox->_height + vbox->_depth);
+      assembled[0] = vbox;
+    }
+    if (totals.back() <= minHeight) {
+      // grow from the tallest known, the totals are accumulated in the same order
+      // as the box was built from the scratch
+      auto vbox = build((int) totals.size() - 1);
+      while (totals.back() <= minHeight) {
+        addRepeat(*vbox);
+        totals.push_back(vbox->_height + vbox->_depth);
+      }
+    }
+    int n = 0;
+    while (totals[n] <= minHeight) n++;
+    auto it = assembled.find(n);
+    if (it != assembled.end()) return *(it->second);
+    auto vbox = build(n);
+    assembled[n] = vbox;
+    return *vbox;
+  }
+};
+
+struct DelimiterCache::Entries {
+  map<DelimiterFactory::Key, sptr<DelimiterFactory::Variants>> variants;
+};
+
+DelimiterCache::DelimiterCache() = default;
+
+DelimiterCache::~DelimiterCache() = default;
+
+sptr<DelimiterFactory::Variants> DelimiterFactory::variants(const string& symbol, Environment& env) {
   TeXFont& tf = *(env.getTeXFont());
   const TexStyle style = env.getStyle();
-  Char c = tf.getChar(symbol.getName(), style);
-  int i = 0;
+  const int flags = (
+    (tf.isBold() ? 1 : 0) | (tf.isRoman() ? 2 : 0) | (tf.isSs() ? 4 : 0)
+    | (tf.isTt() ? 8 : 0) | (tf.isIt() ? 16 : 0) | (tf.isDraft() ? 32 : 0)
+  );
+  Key key{symbol, style, flags, tf.getScaleFactor(), tf.getEM(style)};
+  DelimiterCache* cache = env.getDelimiterCache();
+  if (cache != nullptr && cache->_entries != nullptr) {
+    auto it = cache->_entries->variants.find(key);
+    if (it != cache->_entries->variants.end()) return it->second;
+  }
 
-  for (int i = 1; i <= size && tf.hasNextLarger(c); i++) c = tf.getNextLarger(c, style);
+  // walk through the next-larger chain
+  auto v = sptrOf<Variants>(tf.getChar(symbol, style));
+  while (tf.hasNextLarger(v->chars.back())) {
+    v->chars.push_back(tf.getNextLarger(v->chars.back(), style));
+  }
+  for (const auto& c : v->chars) v->boxes.push_back(sptrOf<CharBox>(c));
+
+  // extension parts of the largest
+  const Char& largest = v->chars.back();
+  if (tf.isExtensionChar(largest)) {
+    Extension* ext = tf.getExtension(largest, style);
+    if (ext->hasTop()) v->top = sptrOf<CharBox>(ext->getTop());
+    if (ext->hasMiddle()) v->middle = sptrOf<CharBox>(ext->getMiddle());
+    if (ext->hasBottom()) v->bottom = sptrOf<CharBox>(ext->getBottom());
+    v->repeat = sptrOf<CharBox>(ext->getRepeat());
+    delete ext;
+  }
+
+  if (cache != nullptr) {
+    if (cache->_entries == nullptr) cache->_entries.reset(new DelimiterCache::Entries());
+    cache->_entries->variants[key] = v;
+  }
+  return v;
+}
+
+sptr<Box> DelimiterFactory::create(SymbolAtom& symbol, Environment& env, int size) {
+  if (size > 4) return symbol.createBox(env);
+
+  const auto& vs = variants(symbol.getName(), env);
+  const Variants& v = *vs;
+  const int last = (int) v.chars.size() - 1;
+  const int i = max(0, min(size, last));
 
-  if (i <= size && !tf.hasNextLarger(c)) {
-    CharBox A(tf.getChar(L'A', "mathnormal", style));
+  if (i == last) {
+    TeXFont& tf = *(env.getTeXFont());
+    CharBox A(tf.getChar(L'A', "mathnormal", env.getStyle()));
     auto b = create(symbol.getName(), env, size * (A._height + A._depth));
     return b;
   }
 
-  return sptrOf<CharBox>(c);
+  return sptrOf<CharBox>(*v.boxes[i]);
 }
 
 sptr<Box> DelimiterFactory::create(const string& symbol, Environment& env, float minHeight) {
-  TeXFont& tf = *(env.getTeXFont());
-  const TexStyle style = env.getStyle();
-  Char c = tf.getChar(symbol, style);
-
-  // start with smallest character
-  float total = c.getHeight() + c.getDepth();
-
-  // try larger versions of the same char until min-height has been reached
-  while (total < minHeight && tf.hasNextLarger(c)) {
-    c = tf.getNextLarger(c, style);
-    total = c.getHeight() + c.getDepth();
-  }
-  // tall enough char found
-  if (total >= minHeight) {
-    /**if (total > minHeight) {
-            auto cb = sptrOf<CharBox>(c);
-            float scale = minHeight / total;
-            return sptrOf<ScaleBox>(cb, scale);
-        }*/
-    return sptrOf<CharBox>(c);
-  } else if (tf.isExtensionChar(c)) {
-    // construct vertical box
-    auto* vBox = new VBox();
-    Extension* ext = tf.getExtension(c, style);
-
-    // insert top part
-    if (ext->hasTop()) {
-      c = ext->getTop();
-      vBox->add(sptrOf<CharBox>(c));
-    }
+  const auto vs = variants(symbol, env);
+  Variants& v = *vs;
 
-    if (ext->hasMiddle()) {
-      c = ext->getMiddle();
-      vBox->add(sptrOf<CharBox>(c));
-    }
+  // start with smallest character, try larger versions of the same char
+  // until min-height has been reached
+  const int count = (int) v.chars.size();
+  for (int i = 0; i < count; i++) {
+    const Char& c = v.chars[i];
+    // tall enough char found
+    if (c.getHeight() + c.getDepth() >= minHeight) return sptrOf<CharBox>(*v.boxes[i]);
+  }
 
-    if (ext->hasBottom()) {
-      c = ext->getBottom();
-      vBox->add(sptrOf<CharBox>(c));
-    }
+  // construct vertical box
+  if (v.hasExtension()) return sptrOf<VBox>(v.get(minHeight));
 
-    // insert repeatable part until tall enough
-    c = ext->getRepeat();
-    auto rep = sptrOf<CharBox>(c);
-    while (vBox->_height + vBox->_depth <= minHeight) {
-      if (ext->hasTop() && ext->hasBottom()) {
-        vBox->add(1, rep);
-        if (ext->hasMiddle()) {
-          vBox->add(vBox->size() - 1, rep);
-        }
-      } else if (ext->hasBottom()) {
-        vBox->add(0, rep);
-      } else {
-        vBox->add(rep);
-      }
-    }
-    delete ext;
-    return sptr<Box>(vBox);
-  }
   // no extensions, so return the tallest possible character
-  return sptrOf<CharBox>(c);
+  return sptrOf<CharBox>(*v.boxes.back());
 }
 
 sptr<Atom> XLeftRightArrowFactory::MINUS;
@@ -13,11 +13,46 @@ class TeXFont;
 
 class SymbolAtom;
 
+/**
+ * The delimiter variants resolved in one build, shared by all the environments of
+ * the build (see Environment#setDelimiterCache) and dropped with the build, so it
+ * is never shared by threads and holds the delimiters of one formula only.
+ */
+class DelimiterCache {
+private:
+  struct Entries;
+  // created on the first delimiter
+  std::unique_ptr<Entries> _entries;
+
+  friend class DelimiterFactory;
+
+public:
+  DelimiterCache();
+
+  no_copy_assign(DelimiterCache);
+
+  ~DelimiterCache();
+};
+
 /**
  * Responsible for creating a box containing a delimiter symbol that exists in
  * different sizes.
+ * <p>
+ * The resolved variants (the next-larger chain and the extension parts) of a delimiter
+ * are cached per (symbol, style, font) in the DelimiterCache of the environment, and
+ * so are the boxes built from them, thus formulas full of delimiters and radicals will
+ * not rebuild identical boxes again and again. Every call returns a new (shallow) box,
+ * so the caller is free to shift it.
  */
 class DelimiterFactory {
+private:
+  struct Key;
+  struct Variants;
+
+  friend class DelimiterCache;
+
+  static sptr<Variants> variants(const std::string& symbol, Environment& env);
+
 public:
   static sptr<Box> create(SymbolAtom& symbol, Environment& env, int size);
 
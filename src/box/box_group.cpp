@@ -5,6 +5,7 @@
 #include "common.h"
 #include "graphic/graphic.h"
 #include "box/box_single.h"
+#include "box/display_list.h"
 
 using namespace std;
 using namespace tex;
@@ -93,13 +94,40 @@ pair<sptr<HBox>, sptr<HBox>> HBox::split(int pos, int shift) {
 }
 
 void HBox::draw(Graphics2D& g2, float x, float y) {
+  // adjacent characters, including the ones of the nested horizontal boxes, are drawn as runs
+  GlyphRun run(g2);
+  drawInRun(run, g2, x, y);
+  run.flush();
+}
+
+void HBox::drawInRun(GlyphRun& run, Graphics2D& g2, float x, float y) {
   float xPos = x;
   for (const auto& box : _children) {
-    box->draw(g2, xPos, y + box->_shift);
+    box->drawInRun(run, g2, xPos, y + box->_shift);
     xPos += box->_width;
   }
 }
 
+bool HBox::childOrigins(vector<float>& xs, vector<float>& ys, bool& horizontal) {
+  float xPos = 0;
+  for (const auto& box : _children) {
+    xs.push_back(xPos);
+    ys.push_back(box->_shift);
+    xPos += box->_width;
+  }
+  horizontal = true;
+  return true;
+}
+
+bool HBox::compile(DisplayCompiler& dc, float x, float y) {
+  float xPos = x;
+  for (const auto& box : _children) {
+    dc.compile(box, xPos, y + box->_shift);
+    xPos += box->_width;
+  }
+  return true;
+}
+
 /************************************* vertical box implementation ********************************/
 
 VBox::VBox(const sptr<Box>& box, float rest, Alignment alignment)
@@ -167,6 +195,28 @@ void VBox::draw(Graphics2D& g2, float x, float y) {
   }
 }
 
+bool VBox::childOrigins(vector<float>& xs, vector<float>& ys, bool& horizontal) {
+  float yPos = -_height;
+  for (const auto& b : _children) {
+    yPos += b->_height;
+    xs.push_back(b->_shift - _leftMostPos);
+    ys.push_back(yPos);
+    yPos += b->_depth;
+  }
+  horizontal = false;
+  return true;
+}
+
+bool VBox::compile(DisplayCompiler& dc, float x, float y) {
+  float yPos = y - _height;
+  for (const auto& b : _children) {
+    yPos += b->_height;
+    dc.compile(b, x + b->_shift - _leftMostPos, yPos);
+    yPos += b->_depth;
+  }
+  return true;
+}
+
 OverBar::OverBar(const sptr<Box>& b, float kern, float thickness) : VBox() {
   add(sptrOf<StrutBox>(0.f, thickness, 0.f, 0.f));
   add(sptrOf<RuleBox>(thickness, b->_width, 0.f));
@@ -194,6 +244,18 @@ void ColorBox::draw(Graphics2D& g2, float x, float y) {
   g2.setColor(prev);
 }
 
+bool ColorBox::compile(DisplayCompiler& dc, float x, float y) {
+  const color prev = dc.getColor();
+  if (!isTransparent(_background)) {
+    dc.setColor(_background);
+    dc.fillRect(x, y - _height, _width, _height + _depth);
+  }
+  dc.setColor(isTransparent(_foreground) ? prev : _foreground);
+  dc.compile(_base, x, y);
+  dc.setColor(prev);
+  return true;
+}
+
 /*************************************** scale box implementation *********************************/
 
 void ScaleBox::init(const sptr<Box>& b, float sx, float sy) {
@@ -215,6 +277,17 @@ void ScaleBox::draw(Graphics2D& g2, float x, float y) {
   g2.translate(-x - dec, -y);
 }
 
+bool ScaleBox::compile(DisplayCompiler& dc, float x, float y) {
+  if (_sx == 0 || _sy == 0) return true;
+  float dec = _sx < 0 ? _width : 0;
+  dc.translate(x + dec, y);
+  dc.scale(_sx, _sy);
+  dc.compile(_base, 0, 0);
+  dc.scale(1.f / _sx, 1.f / _sy);
+  dc.translate(-x - dec, -y);
+  return true;
+}
+
 /************************************** reflect box implementation ********************************/
 
 ReflectBox::ReflectBox(const sptr<Box>& b) : DecorBox(b) {
@@ -229,6 +302,15 @@ void ReflectBox::draw(Graphics2D& g2, float x, float y) {
   g2.translate(-x, -y);
 }
 
+bool ReflectBox::compile(DisplayCompiler& dc, float x, float y) {
+  dc.translate(x, y);
+  dc.scale(-1, 1);
+  dc.compile(_base, -_width, 0);
+  dc.scale(-1, 1);
+  dc.translate(-x, -y);
+  return true;
+}
+
 /************************************** rotate box implementation *********************************/
 
 void RotateBox::init(const sptr<Box>& b, float angle, float x, float y) {
@@ -361,6 +443,15 @@ void RotateBox::draw(Graphics2D& g2, float x, float y) {
   g2.rotate(_angle, x, y);
 }
 
+bool RotateBox::compile(DisplayCompiler& dc, float x, float y) {
+  y -= _shiftY;
+  x += _shiftX - _xmin;
+  dc.rotate(-_angle, x, y);
+  dc.compile(_base, x, y);
+  dc.rotate(_angle, x, y);
+  return true;
+}
+
 /************************************* framed box implementation **********************************/
 
 void FramedBox::init(const sptr<Box>& box, float thickness, float space) {
@@ -397,6 +488,24 @@ void FramedBox::draw(Graphics2D& g2, float x, float y) {
   _base->draw(g2, x + _space + _thickness, y);
 }
 
+bool FramedBox::compile(DisplayCompiler& dc, float x, float y) {
+  const DisplayStroke st = dc.getStroke();
+  dc.setStroke(Stroke(_thickness, CAP_BUTT, JOIN_MITER));
+  float th = _thickness / 2.f;
+  const color prev = dc.getColor();
+  if (!isTransparent(_bg)) {
+    dc.setColor(_bg);
+    dc.fillRect(x + th, y - _height + th, _width - _thickness, _height + _depth - _thickness);
+    dc.setColor(prev);
+  }
+  if (!isTransparent(_line)) dc.setColor(_line);
+  dc.drawRect(x + th, y - _height + th, _width - _thickness, _height + _depth - _thickness);
+  dc.setColor(prev);
+  dc.setStroke(st);
+  dc.compile(_base, x + _space + _thickness, y);
+  return true;
+}
+
 void OvalBox::draw(Graphics2D& g2, float x, float y) {
   const Stroke& st = g2.getStroke();
   g2.setStroke(Stroke(_thickness, CAP_BUTT, JOIN_MITER));
@@ -418,6 +527,28 @@ void OvalBox::draw(Graphics2D& g2, float x, float y) {
   _base->draw(g2, x + _space + _thickness, y);
 }
 
+bool OvalBox::compile(DisplayCompiler& dc, float x, float y) {
+  const DisplayStroke st = dc.getStroke();
+  dc.setStroke(Stroke(_thickness, CAP_BUTT, JOIN_MITER));
+  float th = _thickness / 2.f;
+  float r = 0.f;
+  if (_diameter != 0) {
+    r = _diameter;
+  } else {
+    r = _multiplier * min(_width - _thickness, _height + _depth - _thickness);
+  }
+  dc.drawRoundRect(
+    x + th,
+    y - _height + th,
+    _width - _thickness,
+    _height + _depth - _thickness,
+    r, r
+  );
+  dc.setStroke(st);
+  dc.compile(_base, x + _space + _thickness, y);
+  return true;
+}
+
 void ShadowBox::draw(Graphics2D& g2, float x, float y) {
   const float th = _thickness / 2.f;
   const Stroke& st = g2.getStroke();
@@ -446,6 +577,35 @@ void ShadowBox::draw(Graphics2D& g2, float x, float y) {
   _base->draw(g2, x + _space + _thickness, y);
 }
 
+bool ShadowBox::compile(DisplayCompiler& dc, float x, float y) {
+  const float th = _thickness / 2.f;
+  const DisplayStroke st = dc.getStroke();
+  dc.setStroke(Stroke(_thickness, CAP_BUTT, JOIN_MITER));
+  dc.drawRect(
+    x + th,
+    y - _height + th,
+    _width - _shadowRule - _thickness,
+    _height + _depth - _shadowRule - _thickness
+  );
+  float penth = abs(1.f / dc.sx());
+  dc.setStroke(Stroke(penth, CAP_BUTT, JOIN_MITER));
+  dc.fillRect(
+    x + _shadowRule - penth,
+    y + _depth - _shadowRule - penth,
+    _width - _shadowRule,
+    _shadowRule
+  );
+  dc.fillRect(
+    x + _width - _shadowRule - penth,
+    y - _height + th + _shadowRule,
+    _shadowRule,
+    _depth + _height - 2 * _shadowRule - th
+  );
+  dc.setStroke(st);
+  dc.compile(_base, x + _space + _thickness, y);
+  return true;
+}
+
 /************************************** wrapper box implementation **********************************/
 
 void WrapperBox::addInsets(float l, float t, float r, float b) {
@@ -465,3 +625,15 @@ void WrapperBox::draw(Graphics2D& g2, float x, float y) {
   _base->draw(g2, x + _l, y + _base->_shift);
   g2.setColor(prev);
 }
+
+bool WrapperBox::compile(DisplayCompiler& dc, float x, float y) {
+  const color prev = dc.getColor();
+  if (!isTransparent(_bg)) {
+    dc.setColor(_bg);
+    dc.fillRect(x, y - _height, _width, _height + _depth);
+  }
+  dc.setColor(isTransparent(_fg) ? prev : _fg);
+  dc.compile(_base, x + _l, y + _base->_shift);
+  dc.setColor(prev);
+  return true;
+}
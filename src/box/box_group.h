@@ -16,6 +16,9 @@ private:
 
   std::pair<sptr<HBox>, sptr<HBox>> split(int pos, int shift);
 
+protected:
+  bool childOrigins(std::vector<float>& xs, std::vector<float>& ys, bool& horizontal) override;
+
 public:
   std::vector<int> _breakPositions;
 
@@ -44,6 +47,10 @@ public:
   }
 
   void draw(Graphics2D& g2, float x, float y) override;
+
+  void drawInRun(GlyphRun& run, Graphics2D& g2, float x, float y) override;
+
+  bool compile(DisplayCompiler& dc, float x, float y) override;
 };
 
 /** A box composed of other boxes, put one above the other */
@@ -53,6 +60,9 @@ private:
 
   void recalculateWidth(const Box& box);
 
+protected:
+  bool childOrigins(std::vector<float>& xs, std::vector<float>& ys, bool& horizontal) override;
+
 public:
   VBox() : _leftMostPos(F_MAX), _rightMostPos(F_MIN) {}
 
@@ -65,6 +75,8 @@ public:
   void add(int pos, const sptr<Box>& box) override;
 
   void draw(Graphics2D& g2, float x, float y) override;
+
+  bool compile(DisplayCompiler& dc, float x, float y) override;
 };
 
 /**
@@ -93,6 +105,8 @@ public:
   explicit ColorBox(const sptr<Box>& box, color fg = transparent, color bg = transparent);
 
   void draw(Graphics2D& g2, float x, float y) override;
+
+  bool compile(DisplayCompiler& dc, float x, float y) override;
 };
 
 /** A box representing a scale operation */
@@ -114,6 +128,8 @@ public:
   }
 
   void draw(Graphics2D& g2, float x, float y) override;
+
+  bool compile(DisplayCompiler& dc, float x, float y) override;
 };
 
 /** A box representing a reflected box */
@@ -124,6 +140,8 @@ public:
   explicit ReflectBox(const sptr<Box>& b);
 
   void draw(Graphics2D& g2, float x, float y) override;
+
+  bool compile(DisplayCompiler& dc, float x, float y) override;
 };
 
 /** Enumeration representing rotation origin */
@@ -187,6 +205,8 @@ public:
 
   void draw(Graphics2D& g2, float x, float y) override;
 
+  bool compile(DisplayCompiler& dc, float x, float y) override;
+
   static Rotation getOrigin(std::string option);
 };
 
@@ -220,6 +240,8 @@ public:
   }
 
   void draw(Graphics2D& g2, float x, float y) override;
+
+  bool compile(DisplayCompiler& dc, float x, float y) override;
 };
 
 /** A box representing a wrapped box by oval frame */
@@ -239,6 +261,8 @@ public:
       _diameter(diameter) {}
 
   void draw(Graphics2D& g2, float x, float y) override;
+
+  bool compile(DisplayCompiler& dc, float x, float y) override;
 };
 
 /** A box representing a wrapped box by shadowed frame */
@@ -257,6 +281,8 @@ public:
   }
 
   void draw(Graphics2D& g2, float x, float y) override;
+
+  bool compile(DisplayCompiler& dc, float x, float y) override;
 };
 
 /** A box representing 'wrapper' that with insets in left, top, right and bottom */
@@ -288,6 +314,8 @@ public:
   void addInsets(float l, float t, float r, float b);
 
   void draw(Graphics2D& g2, float x, float y) override;
+
+  bool compile(DisplayCompiler& dc, float x, float y) override;
 };
 
 }  // namespace tex
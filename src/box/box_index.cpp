@@ -0,0 +1,157 @@
+#include "box/box_index.h"
+
+#include <algorithm>
+
+#include "box/box_group.h"
+
+using namespace std;
+using namespace tex;
+
+namespace {
+
+inline Rect unite(const Rect& a, const Rect& b) {
+  const float l = min(a.x, b.x), t = min(a.y, b.y);
+  return {l, t, max(a.x + a.w, b.x + b.w) - l, max(a.y + a.h, b.y + b.h) - t};
+}
+
+inline bool contains(const Rect& r, float x, float y) {
+  return x >= r.x && x <= r.x + r.w && y >= r.y && y <= r.y + r.h;
+}
+
+inline bool intersects(const Rect& a, const Rect& b) {
+  return a.x <= b.x + b.w && b.x <= a.x + a.w && a.y <= b.y + b.h && b.y <= a.y + a.h;
+}
+
+}  // namespace
+
+sptr<BoxIndex> BoxIndex::build(
+  const sptr<Box>& box, float x, float y, float scale, const AtomLinks* links
+) {
+  unordered_map<const Box*, sptr<Atom>> map;
+  if (links != nullptr) {
+    // the later links win, the boxes created again replace the earlier ones
+    for (const auto& [b, a] : links->links()) map[b.get()] = a;
+  }
+  auto index = sptrOf<BoxIndex>();
+  index->collect(box, x, y, scale, nullptr, map);
+  const u32 n = index->_entries.size();
+  index->_order.resize(n);
+  for (u32 i = 0; i < n; i++) index->_order[i] = i;
+  if (n > 0) index->build(0, n);
+  return index;
+}
+
+void BoxIndex::collect(
+  const sptr<Box>& box, float x, float y, float scale, const sptr<Atom>& atom,
+  const unordered_map<const Box*, sptr<Atom>>& links
+) {
+  const auto it = links.find(box.get());
+  const sptr<Atom>& a = it == links.end() ? atom : it->second;
+  auto* group = dynamic_cast<BoxGroup*>(box.get());
+  const BoxGroup::ChildIndex* idx = group == nullptr ? nullptr : group->index();
+  if (idx != nullptr) {
+    for (size_t i = 0; i < group->_children.size(); i++) {
+      collect(group->_children[i], x + idx->xs[i], y + idx->ys[i], scale, a, links);
+    }
+    return;
+  }
+  auto* cb = dynamic_cast<ColorBox*>(box.get());
+  if (cb != nullptr) {
+    collect(cb->_base, x, y, scale, a, links);
+    return;
+  }
+  if (box->isSpace()) return;
+  const Rect r = box->bounds();
+  if (r.w == 0 && r.h == 0) return;
+  _entries.push_back({{(x + r.x) * scale, (y + r.y) * scale, r.w * scale, r.h * scale}, box, a});
+}
+
+u32 BoxIndex::build(u32 begin, u32 end) {
+  const u32 id = _nodes.size();
+  _nodes.emplace_back();
+  Rect bounds = _entries[_order[begin]].rect;
+  for (u32 i = begin + 1; i < end; i++) bounds = unite(bounds, _entries[_order[i]].rect);
+  if (end - begin <= LEAF_SIZE) {
+    _nodes[id] = {bounds, begin, end, 0, 0};
+    return id;
+  }
+  // split at the median of the centers along the longer side
+  const bool horizontal = bounds.w >= bounds.h;
+  const u32 mid = begin + (end - begin) / 2;
+  nth_element(
+    _order.begin() + begin, _order.begin() + mid, _order.begin() + end,
+    [&](u32 i, u32 j) {
+      const Rect& a = _entries[i].rect;
+      const Rect& b = _entries[j].rect;
+      return horizontal ? a.x * 2 + a.w < b.x * 2 + b.w : a.y * 2 + a.h < b.y * 2 + b.h;
+    }
+  );
+  const u32 left = build(begin, mid);
+  const u32 right = build(mid, end);
+  _nodes[id] = {bounds, begin, end, left, right};
+  return id;
+}
+
+template <typename Test, typename Visit>
+void BoxIndex::visit(Test&& test, Visit&& fn) const {
+  if (_nodes.empty()) return;
+  vector<u32> stack{0};
+  while (!stack.empty()) {
+    const Node& node = _nodes[stack.back()];
+    stack.pop_back();
+    if (!test(node.bounds)) continue;
+    if (node.left == 0) {
+      for (u32 i = node.begin; i < node.end; i++) {
+        if (test(_entries[_order[i]].rect)) fn(_order[i]);
+      }
+    } else {
+      stack.push_back(node.left);
+      stack.push_back(node.right);
+    }
+  }
+}
+
+int BoxIndex::hitTest(float x, float y) const {
+  int hit = -1;
+  float area = 0;
+  visit(
+    [&](const Rect& r) { return contains(r, x, y); },
+    [&](u32 i) {
+      const Rect& r = _entries[i].rect;
+      const float a = r.w * r.h;
+      if (hit < 0 || a < area || (a == area && (int) i > hit)) {
+        hit = (int) i;
+        area = a;
+      }
+    }
+  );
+  return hit;
+}
+
+vector<u32> BoxIndex::query(const Rect& area) const {
+  vector<u32> found;
+  visit(
+    [&](const Rect& r) { return intersects(r, area); },
+    [&](u32 i) { found.push_back(i); }
+  );
+  sort(found.begin(), found.end());
+  return found;
+}
+
+vector<Rect> BoxIndex::rects(u32 from, u32 to) const {
+  vector<Rect> rects;
+  to = min<u32>(to, _entries.size());
+  for (u32 i = from; i < to; i++) {
+    const Rect& r = _entries[i].rect;
+    if (!rects.empty()) {
+      Rect& last = rects.back();
+      // on the same line if they overlap vertically
+      if (r.y < last.y + last.h && last.y < r.y + r.h) {
+        last = unite(last, r);
+        continue;
+      }
+    }
+    rects.push_back(r);
+  }
+  return rects;
+}
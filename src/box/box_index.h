@@ -0,0 +1,107 @@
+#ifndef LATEX_BOX_INDEX_H
+#define LATEX_BOX_INDEX_H
+
+#include <unordered_map>
+#include <vector>
+#include "box/box.h"
+
+namespace tex {
+
+class Atom;
+
+/**
+ * The atoms the boxes were created from, recorded while creating the boxes if
+ * the environment has links (see Environment#setAtomLinks). The boxes are held,
+ * so the addresses of the boxes created and dropped while laying out are never
+ * reused by the boxes of the final tree.
+ */
+class AtomLinks {
+private:
+  std::vector<std::pair<sptr<Box>, sptr<Atom>>> _links;
+
+public:
+  /** Link the given box to the atom it was created from */
+  inline void add(const sptr<Box>& box, const sptr<Atom>& atom) { _links.emplace_back(box, atom); }
+
+  inline const std::vector<std::pair<sptr<Box>, sptr<Atom>>>& links() const { return _links; }
+};
+
+/**
+ * A spatial index over the laid-out boxes for hit-testing and selections, e.g.
+ * in an editor. The entries are the boxes that draw something, in the order they
+ * are drawn, the groups placing their children along an axis (HBox, VBox) are
+ * descended, the other boxes are entries as a whole. The entries are kept in a
+ * bounding volume hierarchy, so a point or an area is looked up in logarithmic
+ * time plus the count of the entries found.
+ */
+class BoxIndex {
+public:
+  struct Entry {
+    /** The bounds of the box */
+    Rect rect;
+    /** The box */
+    sptr<Box> box;
+    /** The innermost atom the box was created from, nullptr if not linked */
+    sptr<Atom> atom;
+  };
+
+private:
+  struct Node {
+    Rect bounds;
+    // a leaf (left = 0) holds the entries _order[begin, end), the others hold 2 child nodes
+    u32 begin, end, left, right;
+  };
+
+  static constexpr u32 LEAF_SIZE = 4;
+
+  std::vector<Entry> _entries;
+  std::vector<Node> _nodes;
+  std::vector<u32> _order;
+
+  void collect(
+    const sptr<Box>& box, float x, float y, float scale, const sptr<Atom>& atom,
+    const std::unordered_map<const Box*, sptr<Atom>>& links
+  );
+
+  u32 build(u32 begin, u32 end);
+
+  template <typename Test, typename Visit>
+  void visit(Test&& test, Visit&& visit) const;
+
+public:
+  /**
+   * Build the index of the given box drawn at (x, y) in box units, the rects of
+   * the entries are scaled by the given scale (e.g. the text size to get the rects
+   * in pixels).
+   *
+   * @param links the atoms the boxes were created from, could be nullptr
+   */
+  static sptr<BoxIndex> build(
+    const sptr<Box>& box, float x, float y, float scale, const AtomLinks* links
+  );
+
+  /** The entries in the order they are drawn */
+  inline const std::vector<Entry>& entries() const { return _entries; }
+
+  /**
+   * Find the entry at the given point, the smallest one if the point is in several
+   * entries (e.g. a script over its base).
+   *
+   * @return the index of the entry, or -1 if no entry contains the point
+   */
+  int hitTest(float x, float y) const;
+
+  /** Find the entries intersect the given area, in the order they are drawn */
+  std::vector<u32> query(const Rect& area) const;
+
+  /**
+   * Get the rectangles covering the entries [from, to) in the order they are drawn,
+   * the entries on the same line are merged into one rectangle, e.g. to highlight
+   * a selection.
+   */
+  std::vector<Rect> rects(u32 from, u32 to) const;
+};
+
+}  // namespace tex
+
+#endif  // LATEX_BOX_INDEX_H
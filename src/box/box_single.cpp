@@ -1,9 +1,29 @@
 #include "box_single.h"
 #include "fonts/fonts.h"
+#include "box/display_list.h"
+#include "utils/concurrent_cache.h"
+
+#include <atomic>
+#include <list>
 
 using namespace std;
 using namespace tex;
 
+MetricsBox::MetricsBox() : _lastFontId(TeXFont::NO_FONT) {}
+
+void MetricsBox::add(Box& box) {
+  add(box._width, box._height - box._shift, box._depth + box._shift);
+  const int id = box.lastFontId();
+  if (id != TeXFont::NO_FONT) _lastFontId = id;
+}
+
+void MetricsBox::add(float width, float height, float depth) {
+  _width += width;
+  _height = _empty ? height : max(_height, height);
+  _depth = _empty ? depth : max(_depth, depth);
+  _empty = false;
+}
+
 CharBox::CharBox(const Char& c) {
   _cf = c.getCharFont();
   _size = c.getSize();
@@ -29,33 +49,164 @@ void CharBox::draw(Graphics2D& g2, float x, float y) {
   g2.translate(-x, -y);
 }
 
+void CharBox::drawInRun(GlyphRun& run, Graphics2D& g2, float x, float y) {
+  run.add(*this, x, y);
+}
+
+bool CharBox::compile(DisplayCompiler& dc, float x, float y) {
+  dc.drawGlyph(_cf->fontId, _cf->chr, _size, x, y, _width, _height, _depth);
+  return true;
+}
+
 int CharBox::lastFontId() {
   return _cf->fontId;
 }
 
-sptr<Font> TextRenderingBox::_font(nullptr);
+void GlyphRun::add(i32 fontId, float size, wchar_t chr, float x, float y) {
+  if (_count == CAPACITY || fontId != _fontId || size != _size) {
+    flush();
+    _fontId = fontId;
+    _size = size;
+  }
+  _glyphs[_count++] = {chr, x, y};
+}
+
+void GlyphRun::add(const CharBox& box, float x, float y) {
+  add(box._cf->fontId, box._size, box._cf->chr, x / box._size, y / box._size);
+}
+
+void GlyphRun::flush() {
+  if (_count == 0) return;
+  const Font* font = FontInfo::getFont(_fontId);
+  if (_size != 1) _g2.scale(_size, _size);
+  _g2.drawGlyphs(font, _glyphs, _count);
+  if (_size != 1) _g2.scale(1.f / _size, 1.f / _size);
+  _count = 0;
+}
+
+string TextRenderingBox::_family("Serif");
+
+namespace {
+
+/** The fonts of the text rendering boxes by (family, style), shared by the threads */
+ConcurrentCache<pair<string, int>, sptr<Font>> derivedFonts;
+
+const sptr<Font>& deriveFont(const string& family, int style) {
+  return derivedFonts.getOrCreate({family, style}, [&]() {
+    return Font::_create(family, PLAIN, 10)->deriveFont(style);
+  });
+}
+
+atomic<size_t> layoutCacheCapacity(512);
+
+/**
+ * The least recently used cache of the bounds of the text layouts, shared by the
+ * threads, see TextRenderingBox. Only the bounds are kept, a layout of the platform
+ * must not be drawn by several threads at once, so each box has its own.
+ */
+class LayoutCache {
+private:
+  struct Key {
+    wstring text;
+    string family;
+    int style;
+
+    bool operator<(const Key& k) const {
+      if (style != k.style) return style < k.style;
+      const int c = family.compare(k.family);
+      if (c != 0) return c < 0;
+      return text < k.text;
+    }
+  };
+
+  typedef list<pair<Key, Rect>> Entries;
+
+  mutex _mutex;
+  // the entries from the most to the least recently used
+  Entries _entries;
+  map<Key, Entries::iterator> _index;
+  TextLayoutCacheStats _stats;
+
+public:
+  /** Get the bounds of the layout of the given text, lay it out if not cached */
+  Rect get(const wstring& text, const string& family, int style) {
+    Key key{text, family, style};
+    {
+      lock_guard<mutex> lock(_mutex);
+      const auto it = _index.find(key);
+      if (it != _index.end()) {
+        _stats.hits++;
+        _entries.splice(_entries.begin(), _entries, it->second);
+        return it->second->second;
+      }
+      _stats.misses++;
+    }
+    // lay out without the lock, the threads may lay out the same text at once
+    Rect bounds;
+    TextLayout::create(text, deriveFont(family, style))->getBounds(bounds);
+    const size_t capacity = layoutCacheCapacity.load(memory_order_relaxed);
+    lock_guard<mutex> lock(_mutex);
+    if (capacity == 0 || _index.find(key) != _index.end()) return bounds;
+    while (!_entries.empty() && _entries.size() >= capacity) {
+      _index.erase(_entries.back().first);
+      _entries.pop_back();
+      _stats.evictions++;
+    }
+    _entries.emplace_front(std::move(key), bounds);
+    _index[_entries.front().first] = _entries.begin();
+    return bounds;
+  }
+
+  TextLayoutCacheStats stats() {
+    lock_guard<mutex> lock(_mutex);
+    TextLayoutCacheStats stats = _stats;
+    stats.size = _entries.size();
+    return stats;
+  }
+
+  void clear() {
+    lock_guard<mutex> lock(_mutex);
+    _entries.clear();
+    _index.clear();
+    _stats = TextLayoutCacheStats();
+  }
+};
+
+LayoutCache layoutCache;
+
+}  // namespace
 
 void TextRenderingBox::_init_() {
-  _font = Font::_create("Serif", PLAIN, 10);
+  _family = "Serif";
 }
 
 void TextRenderingBox::_free_() {
   // For memory check purpose
   // to check if has memory leak
-  _font = nullptr;
+  layoutCache.clear();
+  derivedFonts.clear();
 }
 
 void TextRenderingBox::setFont(const string& name) {
-  _font = Font::_create(name, PLAIN, 10);
+  _family = name;
+}
+
+void TextRenderingBox::setLayoutCacheCapacity(size_t capacity) {
+  layoutCacheCapacity = capacity;
+}
+
+TextLayoutCacheStats TextRenderingBox::layoutCacheStats() {
+  return layoutCache.stats();
 }
 
 void TextRenderingBox::init(
-  const wstring& str, int type, float size, const sptr<Font>& f, bool kerning
+  const wstring& str, int type, float size, const string& family, bool kerning
 ) {
+  _str = str;
+  _type = type;
+  _textFamily = family;
   _size = size;
-  _layout = TextLayout::create(str, f->deriveFont(type));
-  Rect rect;
-  _layout->getBounds(rect);
+  const Rect rect = layoutCache.get(str, family, type);
   _height = -rect.y * size / 10;
   _depth = rect.h * size / 10 - _height;
   _width = (rect.w + rect.x + 0.4f) * size / 10;
@@ -64,7 +215,12 @@ void TextRenderingBox::init(
 void TextRenderingBox::draw(Graphics2D& g2, float x, float y) {
   g2.translate(x, y);
   g2.scale(0.1f * _size, 0.1f * _size);
-  _layout->draw(g2, 0, 0);
+  // laid out when drawn first, the boxes only measured never lay out
+  call_once(_layoutOnce, [this]() {
+    _layout = TextLayout::create(_str, deriveFont(_textFamily, _type));
+  });
+  // the layouts of the platforms expect the graphics of the backend, not a wrapper
+  _layout->draw(g2.unwrap(), 0, 0);
   g2.scale(10 / _size, 10 / _size);
   g2.translate(-x, -y);
 }
@@ -90,6 +246,20 @@ void LineBox::draw(Graphics2D& g2, float x, float y) {
   g2.setStrokeWidth(oldThickness);
 }
 
+bool LineBox::compile(DisplayCompiler& dc, float x, float y) {
+  const DisplayStroke st = dc.getStroke();
+  dc.setStrokeWidth(_thickness);
+  int count = _lines.size() / 4;
+  for (int i = 0; i < count; i++) {
+    int j = i * 4;
+    float x1 = _lines[j] + x, y1 = _lines[j + 1] + y - _height;
+    float x2 = _lines[j + 2] + x, y2 = _lines[j + 3] + y - _height;
+    dc.drawLine(x1, y1, x2, y2);
+  }
+  dc.setStroke(st);
+  return true;
+}
+
 RuleBox::RuleBox(float thickness, float width, float shift, color c, bool trueshift)
   : _color(c), _speShift(0) {
   _height = thickness;
@@ -113,6 +283,18 @@ void RuleBox::draw(Graphics2D& g2, float x, float y) {
   g2.setColor(oldColor);
 }
 
+bool RuleBox::compile(DisplayCompiler& dc, float x, float y) {
+  const color oldColor = dc.getColor();
+  if (!isTransparent(_color)) dc.setColor(_color);
+  const DisplayStroke oldStroke = dc.getStroke();
+  dc.setStroke(Stroke(_height, CAP_BUTT, JOIN_BEVEL));
+  y = y - _height / 2.f - _speShift;
+  dc.drawLine(x, y, x + _width, y);
+  dc.setStroke(oldStroke);
+  dc.setColor(oldColor);
+  return true;
+}
+
 DebugBox::DebugBox(const sptr<Box>& base) {
   copyMetrics(base);
 }
@@ -126,3 +308,14 @@ void DebugBox::draw(Graphics2D& g2, float x, float y) {
   g2.setColor(prevColor);
   g2.setStroke(prevStroke);
 }
+
+bool DebugBox::compile(DisplayCompiler& dc, float x, float y) {
+  const color prevColor = dc.getColor();
+  const DisplayStroke prevStroke = dc.getStroke();
+  dc.setColor(red);
+  dc.setStrokeWidth(std::abs(1.f / dc.sx()));
+  dc.drawRect(x, y - _height, _width, _height + _depth);
+  dc.setColor(prevColor);
+  dc.setStroke(prevStroke);
+  return true;
+}
@@ -1,6 +1,8 @@
 #ifndef LATEX_BOX_SINGLE_H
 #define LATEX_BOX_SINGLE_H
 
+#include <mutex>
+
 #include "atom/atom.h"
 
 namespace tex {
@@ -30,6 +32,12 @@ public:
     // no visual effect
   }
 
+  void drawInRun(GlyphRun& run, Graphics2D& g2, float x, float y) override {
+    // no visual effect, the run goes on
+  }
+
+  bool compile(DisplayCompiler& dc, float x, float y) override { return true; }
+
   bool isSpace() const override { return true; }
 };
 
@@ -50,9 +58,43 @@ public:
     // no visual effect
   }
 
+  void drawInRun(GlyphRun& run, Graphics2D& g2, float x, float y) override {
+    // no visual effect, the run goes on
+  }
+
+  bool compile(DisplayCompiler& dc, float x, float y) override { return true; }
+
   bool isSpace() const override { return true; }
 };
 
+/**
+ * A box keeping only the metrics of a row, created instead of the horizontal box
+ * when only the metrics are wanted (see Environment#setMetricsOnly). It has no
+ * visual effect.
+ */
+class MetricsBox : public Box {
+private:
+  int _lastFontId;
+  bool _empty = true;
+
+public:
+  MetricsBox();
+
+  /** Add the metrics of the given box as HBox#add does */
+  void add(Box& box);
+
+  /** Add the metrics of a box (e.g. a glue or a kern) without creating it */
+  void add(float width, float height, float depth);
+
+  void draw(Graphics2D& g2, float x, float y) override {
+    // no visual effect
+  }
+
+  bool compile(DisplayCompiler& dc, float x, float y) override { return true; }
+
+  int lastFontId() override { return _lastFontId; }
+};
+
 /** A box representing a single character */
 class CharBox : public Box {
 private:
@@ -75,38 +117,102 @@ public:
 
   void draw(Graphics2D& g2, float x, float y) override;
 
+  void drawInRun(GlyphRun& run, Graphics2D& g2, float x, float y) override;
+
+  bool compile(DisplayCompiler& dc, float x, float y) override;
+
   int lastFontId() override;
+
+  friend class GlyphRun;
+};
+
+/**
+ * Coalesces the glyphs drawn with the same font and size into a run, and draws
+ * the run by a single Graphics2D#drawGlyphs call instead of a call per glyph.
+ */
+class GlyphRun {
+private:
+  static constexpr size_t CAPACITY = 64;
+
+  Graphics2D& _g2;
+  i32 _fontId = -1;
+  float _size = 1;
+  size_t _count = 0;
+  GlyphPos _glyphs[CAPACITY];
+
+public:
+  explicit GlyphRun(Graphics2D& g2) : _g2(g2) {}
+
+  /** Add a glyph positioned in the space scaled by the given size */
+  void add(i32 fontId, float size, wchar_t chr, float x, float y);
+
+  /** Add the glyph of the given CharBox drawn at (x, y) */
+  void add(const CharBox& box, float x, float y);
+
+  /** Draw the pending glyphs, must be called before drawing anything else */
+  void flush();
+};
+
+/** Counters of the cache of the text bounds, see TextRenderingBox#layoutCacheStats */
+struct TextLayoutCacheStats {
+  u64 hits = 0, misses = 0, evictions = 0;
+  // the count of the cached bounds
+  size_t size = 0;
 };
 
-/** A box representing a text rendering box */
+/**
+ * A box representing a text rendering box, the text is laid out by the platform
+ * (e.g. \text or the chars of the scripts no font is registered for).
+ * <p>
+ * The bounds of the layouts are cached by (text, font family, style) for all the
+ * threads, the same labels (e.g. "if", "otherwise") recur in many formulas, and
+ * laying out costs much on the platforms (a Pango layout on cairo). The cache keeps
+ * the most recently used bounds up to a capacity (see #setLayoutCacheCapacity).
+ * The layout to draw is created by each box when it is drawn first, thus never for
+ * the boxes only measured, and is not shared by the boxes. The fonts derived from a
+ * family are cached too, and shared by the threads.
+ */
 class TextRenderingBox : public Box {
 private:
-  static sptr<Font> _font;
-  sptr<TextLayout> _layout;
+  // the family of the text, see #setFont
+  static std::string _family;
+  std::wstring _str;
+  std::string _textFamily;
+  int _type{};
   float _size{};
+  // the layout created by the first draw
+  std::once_flag _layoutOnce;
+  sptr<TextLayout> _layout;
 
-  void init(const std::wstring& str, int type, float size, const sptr<Font>& font, bool kerning);
+  void init(const std::wstring& str, int type, float size, const std::string& family, bool kerning);
 
 public:
   TextRenderingBox() = delete;
 
   TextRenderingBox(
     const std::wstring& str, int type, float size,
-    const sptr<Font>& font, bool kerning
+    const std::string& family, bool kerning
   ) {
-    init(str, type, size, font, kerning);
+    init(str, type, size, family, kerning);
   }
 
   TextRenderingBox(const std::wstring& str, int type, float size) {
-    init(str, type, size, sptr<Font>(_font), true);
+    init(str, type, size, _family, true);
   }
 
   void draw(Graphics2D& g2, float x, float y) override;
 
   static void setFont(const std::string& name);
 
+  /** Set the max count of the cached bounds, 0 disables the cache, default is 512 */
+  static void setLayoutCacheCapacity(size_t capacity);
+
+  /** The counters of the cache of the bounds, shared by the threads */
+  static TextLayoutCacheStats layoutCacheStats();
+
   static void _init_();
 
+  /** Clear the cached fonts and bounds, must not be called while rendering */
   static void _free_();
 };
 
@@ -123,6 +229,8 @@ public:
   LineBox(const std::vector<float>& lines, float thickness);
 
   void draw(Graphics2D& g2, float x, float y) override;
+
+  bool compile(DisplayCompiler& dc, float x, float y) override;
 };
 
 /** A box representing a line. */
@@ -140,6 +248,8 @@ public:
   );
 
   void draw(Graphics2D& g2, float x, float y) override;
+
+  bool compile(DisplayCompiler& dc, float x, float y) override;
 };
 
 class DebugBox : public Box {
@@ -147,6 +257,8 @@ public:
   explicit DebugBox(const sptr<Box>& base);
 
   void draw(Graphics2D& g2, float x, float y) override;
+
+  bool compile(DisplayCompiler& dc, float x, float y) override;
 };
 
 }
@@ -0,0 +1,646 @@
+#include "box/display_list.h"
+#include "box/box_single.h"
+#include "fonts/fonts.h"
+
+#include <array>
+
+using namespace std;
+using namespace tex;
+
+bool DisplayStroke::operator==(const DisplayStroke& o) const {
+  if (flags != o.flags) return false;
+  if ((flags & HAS_WIDTH) != 0 && stroke.lineWidth != o.stroke.lineWidth) return false;
+  return (flags & HAS_STYLE) == 0 || (
+    stroke.cap == o.stroke.cap &&
+    stroke.join == o.stroke.join &&
+    stroke.miterLimit == o.stroke.miterLimit
+  );
+}
+
+/************************************* display list implementation ********************************/
+
+sptr<DisplayList> DisplayList::compile(const sptr<Box>& box, float x, float y, float scale) {
+  auto list = sptrOf<DisplayList>();
+  DisplayCompiler dc(*list, scale);
+  dc.compile(box, x, y);
+  dc.finish();
+  list->_items.shrink_to_fit();
+  return list;
+}
+
+namespace {
+
+/** The state of the graphics while replaying a display list */
+class Replayer {
+private:
+  Graphics2D& _g2;
+  const color _baseColor;
+  const Stroke _baseStroke;
+  // consecutive glyphs are drawn as runs, the glyph records are in the scaled space already
+  GlyphRun _run;
+
+public:
+  explicit Replayer(Graphics2D& g2)
+    : _g2(g2), _baseColor(g2.getColor()), _baseStroke(g2.getStroke()), _run(g2) {}
+
+  /** Draw the pending glyphs, must be called after the last record */
+  inline void flush() { _run.flush(); }
+
+  inline void run(const DisplayItem& it, const vector<sptr<Box>>& boxes) {
+    Graphics2D& g2 = _g2;
+    if (it.op == DisplayOp::glyph) {
+      _run.add(it.id, 1, (wchar_t) it.arg, it.v[0], it.v[1]);
+      return;
+    }
+    _run.flush();
+    switch (it.op) {
+      case DisplayOp::glyph:
+        break;
+      case DisplayOp::line:
+        g2.drawLine(it.v[0], it.v[1], it.v[2], it.v[3]);
+        break;
+      case DisplayOp::rect:
+        g2.drawRect(it.v[0], it.v[1], it.v[2], it.v[3]);
+        break;
+      case DisplayOp::fillRect:
+        g2.fillRect(it.v[0], it.v[1], it.v[2], it.v[3]);
+        break;
+      case DisplayOp::roundRect:
+        g2.drawRoundRect(it.v[0], it.v[1], it.v[2], it.v[3], it.v[4], it.v[5]);
+        break;
+      case DisplayOp::fillRoundRect:
+        g2.fillRoundRect(it.v[0], it.v[1], it.v[2], it.v[3], it.v[4], it.v[5]);
+        break;
+      case DisplayOp::color:
+        g2.setColor(isTransparent(it.arg) ? _baseColor : it.arg);
+        break;
+      case DisplayOp::stroke: {
+        Stroke s = _baseStroke;
+        if ((it.arg & DisplayStroke::HAS_STYLE) != 0) {
+          // valid, the serialized ones are checked by DisplayListView#parse
+          s.cap = (Cap) (it.arg & 0xff);
+          s.join = (Join) ((it.arg >> 8) & 0xff);
+          s.miterLimit = it.v[1];
+        }
+        if ((it.arg & DisplayStroke::HAS_WIDTH) != 0) s.lineWidth = it.v[0];
+        g2.setStroke(s);
+        break;
+      }
+      case DisplayOp::scale:
+        g2.scale(it.v[0], it.v[1]);
+        break;
+      case DisplayOp::translate:
+        g2.translate(it.v[0], it.v[1]);
+        break;
+      case DisplayOp::rotate:
+        g2.rotate(it.v[0], it.v[1], it.v[2]);
+        break;
+      case DisplayOp::box:
+        boxes[it.id]->draw(g2, it.v[0], it.v[1]);
+        break;
+    }
+  }
+};
+
+// the count of floats of the records, in the order of DisplayOp
+const u8 FLOAT_COUNTS[] = {2, 4, 4, 4, 6, 6, 0, 2, 2, 2, 3, 2};
+
+const vector<sptr<Box>> NO_BOXES;
+
+inline void put(vector<u8>& out, u32 v, int bytes) {
+  for (int i = 0; i < bytes; i++) out.push_back((u8) (v >> (i * 8)));
+}
+
+inline void putf(vector<u8>& out, float f) {
+  u32 v;
+  memcpy(&v, &f, sizeof(v));
+  put(out, v, 4);
+}
+
+inline u32 get(const u8* p, int bytes) {
+  u32 v = 0;
+  for (int i = 0; i < bytes; i++) v |= (u32) p[i] << (i * 8);
+  return v;
+}
+
+inline float getf(const u8* p) {
+  const u32 v = get(p, 4);
+  float f;
+  memcpy(&f, &v, sizeof(f));
+  return f;
+}
+
+/** The count of bytes of the record of the given op, excluding the op */
+inline int payloadSize(DisplayOp op) {
+  const int head = op == DisplayOp::glyph ? 6 : (op == DisplayOp::color || op == DisplayOp::stroke ? 4 : 0);
+  return head + FLOAT_COUNTS[static_cast<u8>(op)] * 4;
+}
+
+}  // namespace
+
+void DisplayList::draw(Graphics2D& g2, float x, float y) const {
+  Replayer r(g2);
+  g2.translate(x, y);
+  for (const auto& it : _items) r.run(it, _boxes);
+  r.flush();
+  g2.translate(-x, -y);
+}
+
+void DisplayList::serialize(vector<u8>& out) const {
+  if (!_boxes.empty()) {
+    throw ex_invalid_state("The display list contains boxes that could not be serialized!");
+  }
+  // the fonts used by the glyphs, referenced by the index in this table
+  vector<i32> fonts;
+  map<i32, u16> indices;
+  for (const auto& it : _items) {
+    if (it.op == DisplayOp::glyph && indices.find(it.id) == indices.end()) {
+      indices[it.id] = (u16) fonts.size();
+      fonts.push_back(it.id);
+    }
+  }
+  put(out, fonts.size(), 2);
+  for (i32 id : fonts) {
+    const string& name = FontInfo::__name(id);
+    const size_t len = min<size_t>(name.size(), 0xff);
+    put(out, id, 2);
+    put(out, len, 1);
+    out.insert(out.end(), name.begin(), name.begin() + len);
+  }
+
+  put(out, _items.size(), 4);
+  for (const auto& it : _items) {
+    out.push_back(static_cast<u8>(it.op));
+    if (it.op == DisplayOp::glyph) {
+      put(out, indices[it.id], 2);
+      put(out, it.arg, 4);
+    } else if (it.op == DisplayOp::color || it.op == DisplayOp::stroke) {
+      put(out, it.arg, 4);
+    }
+    for (int i = 0; i < FLOAT_COUNTS[static_cast<u8>(it.op)]; i++) putf(out, it.v[i]);
+  }
+}
+
+namespace {
+
+/** An affine transformation maps (x, y) to (a * x + c * y + e, b * x + d * y + f) */
+struct Affine {
+  float a = 1, b = 0, c = 0, d = 1, e = 0, f = 0;
+
+  inline void translate(float dx, float dy) {
+    e += a * dx + c * dy;
+    f += b * dx + d * dy;
+  }
+
+  inline void scale(float sx, float sy) {
+    a *= sx;
+    b *= sx;
+    c *= sy;
+    d *= sy;
+  }
+
+  inline void rotate(float angle) {
+    const float cs = cos(angle), sn = sin(angle);
+    const float na = a * cs + c * sn, nb = b * cs + d * sn;
+    c = c * cs - a * sn;
+    d = d * cs - b * sn;
+    a = na;
+    b = nb;
+  }
+
+  /** The bounds of the given rect after the transformation, as (left, top, right, bottom) */
+  void map(float x, float y, float w, float h, float (&out)[4]) const {
+    const float xs[] = {x, x + w}, ys[] = {y, y + h};
+    out[0] = out[1] = F_MAX;
+    out[2] = out[3] = -F_MAX;
+    for (float px : xs) {
+      for (float py : ys) {
+        const float tx = a * px + c * py + e, ty = b * px + d * py + f;
+        out[0] = min(out[0], tx);
+        out[1] = min(out[1], ty);
+        out[2] = max(out[2], tx);
+        out[3] = max(out[3], ty);
+      }
+    }
+  }
+};
+
+/** A drawing record placed on the graphics, the records are matched by the key */
+struct Placed {
+  // the key: the primitive, the state and the quantized geometry
+  DisplayOp op;
+  i32 id;
+  u32 arg;
+  color c;
+  u32 strokeArg;
+  float strokeWidth;
+  const Box* box;
+  i32 q[10];
+  // the bounds as (left, top, right, bottom)
+  float bounds[4];
+
+  bool operator<(const Placed& o) const {
+    if (op != o.op) return op < o.op;
+    if (id != o.id) return id < o.id;
+    if (arg != o.arg) return arg < o.arg;
+    if (c != o.c) return c < o.c;
+    if (strokeArg != o.strokeArg) return strokeArg < o.strokeArg;
+    if (strokeWidth != o.strokeWidth) return strokeWidth < o.strokeWidth;
+    if (box != o.box) return box < o.box;
+    return memcmp(q, o.q, sizeof(q)) < 0;
+  }
+};
+
+// the positions are matched with the precision of 1/16 pixel
+inline i32 quantize(float v) {
+  return (i32) lround(v * 16);
+}
+
+void place(const DisplayList::Placement& p, vector<Placed>& out) {
+  Affine m;
+  m.scale(p.scale, p.scale);
+  m.translate(p.x, p.y);
+  color c = p.fg;
+  u32 strokeArg = 0;
+  float strokeWidth = 0;
+  for (const auto& it : p.list.items()) {
+    Placed r{it.op, it.id, 0, c, 0, 0, nullptr, {}, {}};
+    // the geometry is the origin of the record and the linear part of the transformation
+    r.q[0] = quantize(m.a);
+    r.q[1] = quantize(m.b);
+    r.q[2] = quantize(m.c);
+    r.q[3] = quantize(m.d);
+    float pad = 0;
+    switch (it.op) {
+      case DisplayOp::color:
+        c = isTransparent(it.arg) ? p.fg : it.arg;
+        continue;
+      case DisplayOp::stroke:
+        strokeArg = it.arg;
+        strokeWidth = (it.arg & DisplayStroke::HAS_WIDTH) != 0 ? it.v[0] : 0;
+        continue;
+      case DisplayOp::scale:
+        m.scale(it.v[0], it.v[1]);
+        continue;
+      case DisplayOp::translate:
+        m.translate(it.v[0], it.v[1]);
+        continue;
+      case DisplayOp::rotate:
+        m.translate(it.v[1], it.v[2]);
+        m.rotate(it.v[0]);
+        m.translate(-it.v[1], -it.v[2]);
+        continue;
+      case DisplayOp::glyph: {
+        r.arg = it.arg;
+        // the glyphs may overhang their boxes (e.g. italic), in the space scaled by the size
+        const float h = it.v[3] + it.v[4];
+        const float over = 0.15f * max(h, it.v[2]);
+        m.map(it.v[0] - over, it.v[1] - it.v[3] - over, it.v[2] + 2 * over, h + 2 * over, r.bounds);
+        break;
+      }
+      case DisplayOp::box: {
+        r.id = 0;
+        r.box = p.list.boxes()[it.id].get();
+        const Rect b = p.list.boxes()[it.id]->bounds();
+        m.map(it.v[0] + b.x, it.v[1] + b.y, b.w, b.h, r.bounds);
+        break;
+      }
+      case DisplayOp::line:
+        m.map(it.v[0], it.v[1], it.v[2] - it.v[0], it.v[3] - it.v[1], r.bounds);
+        pad = max(strokeWidth, 1.f / p.scale) / 2;
+        break;
+      default:
+        m.map(it.v[0], it.v[1], it.v[2], it.v[3], r.bounds);
+        if (it.op == DisplayOp::rect || it.op == DisplayOp::roundRect) {
+          pad = max(strokeWidth, 1.f / p.scale) / 2;
+        }
+        break;
+    }
+    if (pad != 0) {
+      const float dx = pad * (abs(m.a) + abs(m.c)), dy = pad * (abs(m.b) + abs(m.d));
+      r.bounds[0] -= dx;
+      r.bounds[1] -= dy;
+      r.bounds[2] += dx;
+      r.bounds[3] += dy;
+    }
+    if (it.op == DisplayOp::line || it.op == DisplayOp::rect || it.op == DisplayOp::roundRect) {
+      r.strokeArg = strokeArg;
+      r.strokeWidth = strokeWidth;
+    }
+    // the origin, and the end of a line or the size (and the radii) of a rect
+    const int n = it.op == DisplayOp::glyph || it.op == DisplayOp::box ? 2 : FLOAT_COUNTS[static_cast<u8>(it.op)];
+    for (int i = 0; i < n; i += 2) {
+      const bool point = i == 0 || it.op == DisplayOp::line;
+      r.q[4 + i] = quantize(m.a * it.v[i] + m.c * it.v[i + 1] + (point ? m.e : 0));
+      r.q[5 + i] = quantize(m.b * it.v[i] + m.d * it.v[i + 1] + (point ? m.f : 0));
+    }
+    out.push_back(r);
+  }
+}
+
+}  // namespace
+
+vector<Rect> DisplayList::diff(const Placement& a, const Placement& b) {
+  vector<Placed> pa, pb;
+  place(a, pa);
+  place(b, pb);
+  sort(pa.begin(), pa.end());
+  sort(pb.begin(), pb.end());
+
+  // the bounds of the records in only one of the lists, rounded outward and grown
+  // by 1 pixel for the antialiasing
+  vector<array<float, 4>> dirty;
+  const auto mark = [&](const Placed& r) {
+    dirty.push_back({
+      floor(r.bounds[0]) - 1, floor(r.bounds[1]) - 1, ceil(r.bounds[2]) + 1, ceil(r.bounds[3]) + 1
+    });
+  };
+  size_t i = 0, j = 0;
+  while (i < pa.size() && j < pb.size()) {
+    if (pa[i] < pb[j]) {
+      mark(pa[i++]);
+    } else if (pb[j] < pa[i]) {
+      mark(pb[j++]);
+    } else {
+      i++;
+      j++;
+    }
+  }
+  for (; i < pa.size(); i++) mark(pa[i]);
+  for (; j < pb.size(); j++) mark(pb[j]);
+
+  // merge the overlapped areas, an area grown by a merge may overlap the areas
+  // merged before, so merge it again until it overlaps nothing
+  sort(dirty.begin(), dirty.end(), [](const auto& x, const auto& y) { return x[1] < y[1]; });
+  vector<array<float, 4>> merged;
+  for (auto r : dirty) {
+    bool grown = true;
+    while (grown) {
+      grown = false;
+      for (size_t k = 0; k < merged.size(); k++) {
+        const auto& o = merged[k];
+        if (o[0] > r[2] || o[2] < r[0] || o[1] > r[3] || o[3] < r[1]) continue;
+        r = {min(r[0], o[0]), min(r[1], o[1]), max(r[2], o[2]), max(r[3], o[3])};
+        merged[k] = merged.back();
+        merged.pop_back();
+        grown = true;
+        break;
+      }
+    }
+    merged.push_back(r);
+  }
+
+  vector<Rect> rects;
+  rects.reserve(merged.size());
+  for (const auto& r : merged) rects.emplace_back(r[0], r[1], r[2] - r[0], r[3] - r[1]);
+  return rects;
+}
+
+/********************************** display list view implementation ******************************/
+
+const u8* DisplayListView::parse(const u8* data, const u8* end) {
+  const u8* p = data;
+  const auto require = [&](size_t n) {
+    if ((size_t) (end - p) < n) throw ex_invalid_param("The serialized display list is truncated!");
+  };
+
+  require(2);
+  const int fontCount = get(p, 2);
+  p += 2;
+  _fonts.clear();
+  for (int i = 0; i < fontCount; i++) {
+    require(3);
+    i32 id = get(p, 2);
+    const int len = p[2];
+    p += 3;
+    require(len);
+    // map the font name to the font id of this process, the id of another process
+    // could be another font here, so a named font must be registered
+    if (len > 0) {
+      const string name((const char*) p, len);
+      id = FontInfo::__id(name);
+      if (id < 0) {
+        throw ex_invalid_param("The serialized display list refers to the unknown font '" + name + "'!");
+      }
+    }
+    // the fonts left out of the build have no info
+    if (FontInfo::__get(id) == nullptr) {
+      throw ex_invalid_param("The serialized display list refers to an unknown font!");
+    }
+    _fonts.push_back(id);
+    p += len;
+  }
+
+  require(4);
+  _count = get(p, 4);
+  p += 4;
+  _items = p;
+  for (u32 i = 0; i < _count; i++) {
+    require(1);
+    const u8 op = *p;
+    if (op >= static_cast<u8>(DisplayOp::box)) {
+      throw ex_invalid_param("Invalid record in the serialized display list!");
+    }
+    const int n = payloadSize(static_cast<DisplayOp>(op));
+    require(1 + n);
+    if (op == static_cast<u8>(DisplayOp::glyph) && get(p + 1, 2) >= _fonts.size()) {
+      throw ex_invalid_param("The serialized display list refers to an unknown font!");
+    }
+    if (op == static_cast<u8>(DisplayOp::stroke)) {
+      const u32 arg = get(p + 1, 4);
+      if ((arg & DisplayStroke::HAS_STYLE) != 0
+          && ((arg & 0xff) > CAP_SQUARE || ((arg >> 8) & 0xff) > JOIN_ROUND)) {
+        throw ex_invalid_param("Invalid stroke in the serialized display list!");
+      }
+    }
+    p += 1 + n;
+  }
+  _end = p;
+  return p;
+}
+
+void DisplayListView::draw(Graphics2D& g2, float x, float y) const {
+  Replayer r(g2);
+  g2.translate(x, y);
+  DisplayItem it{};
+  for (const u8* p = _items; p < _end;) {
+    it.op = static_cast<DisplayOp>(*p++);
+    if (it.op == DisplayOp::glyph) {
+      it.id = _fonts[get(p, 2)];
+      it.arg = get(p + 2, 4);
+      p += 6;
+    } else if (it.op == DisplayOp::color || it.op == DisplayOp::stroke) {
+      it.arg = get(p, 4);
+      p += 4;
+    }
+    for (int i = 0; i < FLOAT_COUNTS[static_cast<u8>(it.op)]; i++, p += 4) it.v[i] = getf(p);
+    r.run(it, NO_BOXES);
+  }
+  r.flush();
+  g2.translate(-x, -y);
+}
+
+/*********************************** display compiler implementation ******************************/
+
+DisplayItem& DisplayCompiler::add(DisplayOp op) {
+  auto& it = _list._items.emplace_back();
+  it.op = op;
+  it.id = 0;
+  it.arg = 0;
+  return it;
+}
+
+void DisplayCompiler::syncColor() {
+  if (_listColor == _color) return;
+  add(DisplayOp::color).arg = _color;
+  _listColor = _color;
+}
+
+void DisplayCompiler::syncStroke() {
+  if (_listStroke == _stroke) return;
+  auto& it = add(DisplayOp::stroke);
+  it.arg = _stroke.stroke.cap | (_stroke.stroke.join << 8) | _stroke.flags;
+  it.v[0] = _stroke.stroke.lineWidth;
+  it.v[1] = _stroke.stroke.miterLimit;
+  _listStroke = _stroke;
+}
+
+void DisplayCompiler::syncScale(float scale) {
+  if (_listScale == scale) return;
+  // scale back to the unscaled space first to avoid accumulating errors
+  if (_listScale != 1) {
+    auto& it = add(DisplayOp::scale);
+    it.v[0] = it.v[1] = 1.f / _listScale;
+  }
+  if (scale != 1) {
+    auto& it = add(DisplayOp::scale);
+    it.v[0] = it.v[1] = scale;
+  }
+  _listScale = scale;
+}
+
+void DisplayCompiler::compile(const sptr<Box>& box, float x, float y) {
+  if (box->compile(*this, x, y)) return;
+  syncColor();
+  syncStroke();
+  syncScale(1);
+  auto& it = add(DisplayOp::box);
+  it.id = (i32) _list._boxes.size();
+  it.v[0] = x;
+  it.v[1] = y;
+  _list._boxes.push_back(box);
+}
+
+void DisplayCompiler::finish() {
+  _color = transparent;
+  _stroke = DisplayStroke();
+  syncColor();
+  syncStroke();
+  syncScale(1);
+}
+
+void DisplayCompiler::setStroke(const Stroke& s) {
+  _stroke.stroke = s;
+  _stroke.flags = DisplayStroke::HAS_WIDTH | DisplayStroke::HAS_STYLE;
+}
+
+void DisplayCompiler::setStrokeWidth(float w) {
+  _stroke.stroke.lineWidth = w;
+  _stroke.flags |= DisplayStroke::HAS_WIDTH;
+}
+
+void DisplayCompiler::translate(float dx, float dy) {
+  syncScale(1);
+  auto& it = add(DisplayOp::translate);
+  it.v[0] = dx;
+  it.v[1] = dy;
+}
+
+void DisplayCompiler::scale(float sx, float sy) {
+  syncScale(1);
+  auto& it = add(DisplayOp::scale);
+  it.v[0] = sx;
+  it.v[1] = sy;
+  _sx *= sx;
+}
+
+void DisplayCompiler::rotate(float angle, float px, float py) {
+  syncScale(1);
+  auto& it = add(DisplayOp::rotate);
+  it.v[0] = angle;
+  it.v[1] = px;
+  it.v[2] = py;
+}
+
+void DisplayCompiler::drawGlyph(
+  i32 fontId, wchar_t chr, float size, float x, float y,
+  float width, float height, float depth
+) {
+  syncColor();
+  syncScale(size);
+  auto& it = add(DisplayOp::glyph);
+  it.id = fontId;
+  it.arg = (u32) chr;
+  it.v[0] = x / size;
+  it.v[1] = y / size;
+  it.v[2] = width / size;
+  it.v[3] = height / size;
+  it.v[4] = depth / size;
+}
+
+void DisplayCompiler::drawLine(float x1, float y1, float x2, float y2) {
+  syncColor();
+  syncStroke();
+  syncScale(1);
+  auto& it = add(DisplayOp::line);
+  it.v[0] = x1;
+  it.v[1] = y1;
+  it.v[2] = x2;
+  it.v[3] = y2;
+}
+
+void DisplayCompiler::drawRect(float x, float y, float w, float h) {
+  syncColor();
+  syncStroke();
+  syncScale(1);
+  auto& it = add(DisplayOp::rect);
+  it.v[0] = x;
+  it.v[1] = y;
+  it.v[2] = w;
+  it.v[3] = h;
+}
+
+void DisplayCompiler::fillRect(float x, float y, float w, float h) {
+  syncColor();
+  syncScale(1);
+  auto& it = add(DisplayOp::fillRect);
+  it.v[0] = x;
+  it.v[1] = y;
+  it.v[2] = w;
+  it.v[3] = h;
+}
+
+void DisplayCompiler::drawRoundRect(float x, float y, float w, float h, float rx, float ry) {
+  syncColor();
+  syncStroke();
+  syncScale(1);
+  auto& it = add(DisplayOp::roundRect);
+  it.v[0] = x;
+  it.v[1] = y;
+  it.v[2] = w;
+  it.v[3] = h;
+  it.v[4] = rx;
+  it.v[5] = ry;
+}
+
+void DisplayCompiler::fillRoundRect(float x, float y, float w, float h, float rx, float ry) {
+  syncColor();
+  syncScale(1);
+  auto& it = add(DisplayOp::fillRoundRect);
+  it.v[0] = x;
+  it.v[1] = y;
+  it.v[2] = w;
+  it.v[3] = h;
+  it.v[4] = rx;
+  it.v[5] = ry;
+}
@@ -0,0 +1,263 @@
+#ifndef LATEX_DISPLAY_LIST_H
+#define LATEX_DISPLAY_LIST_H
+
+#include "box/box.h"
+
+namespace tex {
+
+/** Operations of the records in a display list */
+enum class DisplayOp : u8 {
+  /**
+   * Draw a glyph: id = font id, arg = char code, v = (x, y, width, height, depth)
+   * in the scaled space, the extents are used to find the changed areas only (see
+   * DisplayList#diff) and are not serialized
+   */
+  glyph,
+  /** Draw a line: v = (x1, y1, x2, y2) */
+  line,
+  /** Draw a rectangle: v = (x, y, w, h) */
+  rect,
+  /** Fill a rectangle: v = (x, y, w, h) */
+  fillRect,
+  /** Draw a round rectangle: v = (x, y, w, h, rx, ry) */
+  roundRect,
+  /** Fill a round rectangle: v = (x, y, w, h, rx, ry) */
+  fillRoundRect,
+  /** Set the color: arg = color, a transparent color means the color before replay */
+  color,
+  /** Set the stroke: arg = cap | join << 8 | flags, v = (width, miter limit) */
+  stroke,
+  /** Scale the graphics: v = (sx, sy) */
+  scale,
+  /** Translate the graphics: v = (dx, dy) */
+  translate,
+  /** Rotate the graphics around a point: v = (angle, px, py) */
+  rotate,
+  /** Draw a box that could not be flattened: id = index of the box, v = (x, y) */
+  box
+};
+
+/**
+ * A record of the display list. All the coordinates are absolute (from the
+ * origin of the list), glyphs are positioned in the space scaled by their
+ * size, the other records are in the unscaled space.
+ */
+struct DisplayItem {
+  DisplayOp op;
+  i32 id;
+  u32 arg;
+  float v[6];
+};
+
+/** A stroke of the display list, the parts not set are taken from the graphics before replay */
+struct DisplayStroke {
+  static constexpr u32 HAS_WIDTH = 1 << 16;
+  static constexpr u32 HAS_STYLE = 1 << 17;
+
+  Stroke stroke;
+  u32 flags = 0;
+
+  bool operator==(const DisplayStroke& o) const;
+
+  bool operator!=(const DisplayStroke& o) const { return !(*this == o); }
+};
+
+/**
+ * A flat list of drawing records compiled from a box tree, drawing the list is
+ * a tight loop over the records, instead of walking the tree with virtual calls
+ * and saving and restoring the graphics state for every box.
+ */
+class DisplayList {
+private:
+  std::vector<DisplayItem> _items;
+  // the boxes that could not be flattened, drawn as they are
+  std::vector<sptr<Box>> _boxes;
+
+  friend class DisplayCompiler;
+
+public:
+  /**
+   * Compile the given box drawn at the given coordinates into a display list.
+   * The list holds no reference to the box except the sub-boxes that could not
+   * be flattened, so the box tree could be released after. The scale is the
+   * scale of the graphics the list will be replayed with, see DisplayCompiler#sx.
+   */
+  static sptr<DisplayList> compile(const sptr<Box>& box, float x, float y, float scale = 1);
+
+  /** Replay the list with the given graphics translated by (x, y) */
+  void draw(Graphics2D& g2, float x, float y) const;
+
+  /**
+   * Append the serialized form of this list to the given buffer, see
+   * DisplayListView. The glyphs refer to the fonts by name, so the list can be
+   * drawn in another process. Throws ex_invalid_state if the list contains
+   * boxes that could not be flattened.
+   */
+  void serialize(std::vector<u8>& out) const;
+
+  /** A list drawn at a position, see #diff */
+  struct Placement {
+    const DisplayList& list;
+    /** The position the list is drawn at */
+    float x, y;
+    /** The scale of the graphics the list is drawn with */
+    float scale;
+    /** The color of the graphics before the list is drawn */
+    color fg;
+  };
+
+  /**
+   * Find the areas the given lists draw differently, e.g. to repaint only the
+   * changed parts of a view after a formula is edited. The drawing records of a
+   * list are placed with the transformations of the list and matched to the same
+   * records (the same primitive at the same position with the same color and
+   * stroke) of the other list, the bounds of the records not matched are the
+   * changed areas. The boxes could not be flattened match only themselves.
+   *
+   * @param a the list before the change
+   * @param b the list after the change
+   * @return the changed areas in the space of the graphics before scaling, the
+   * rects are rounded outward to integers and the overlapped ones are merged
+   */
+  static std::vector<Rect> diff(const Placement& a, const Placement& b);
+
+  inline const std::vector<DisplayItem>& items() const { return _items; }
+
+  inline const std::vector<sptr<Box>>& boxes() const { return _boxes; }
+};
+
+/**
+ * A read-only view of a serialized display list. The records are decoded from
+ * the buffer while drawing, the buffer (e.g. a memory-mapped file) is not
+ * copied and must outlive the view.
+ * <p>
+ * All the values are in little-endian, the layout is:
+ * <pre>
+ * u16 font count, for each font: u16 font id, u8 name length, name
+ * u32 record count, for each record: u8 op, then
+ *     glyph: u16 font index, u32 char code, 2 x f32
+ *     color: u32 color
+ *     stroke: u32 cap | join << 8 | flags, 2 x f32
+ *     others: f32 x the count of values of the op, see DisplayOp
+ * </pre>
+ */
+class DisplayListView {
+private:
+  // the font ids of this process, indexed by the font index in the buffer
+  std::vector<i32> _fonts;
+  const u8* _items = nullptr;
+  const u8* _end = nullptr;
+  u32 _count = 0;
+
+public:
+  /**
+   * Parse the serialized display list starts at data and validate it, throws
+   * ex_invalid_param if the data is malformed or refers to a font that is not
+   * registered in this process.
+   *
+   * @return the end of the display list in the buffer
+   */
+  const u8* parse(const u8* data, const u8* end);
+
+  /** Replay the list with the given graphics translated by (x, y) */
+  void draw(Graphics2D& g2, float x, float y) const;
+
+  /** The count of records */
+  inline u32 size() const { return _count; }
+};
+
+/**
+ * Compiles boxes into a display list, see Box#compile. It tracks the state a
+ * box expects to draw with (color, stroke), and emits a state record only
+ * before a drawing record that requires a state different from the current one.
+ */
+class DisplayCompiler {
+private:
+  DisplayList& _list;
+  // the state the boxes expect, transparent means the color before replay
+  color _color = transparent;
+  DisplayStroke _stroke;
+  // the state of the graphics while replaying
+  color _listColor = transparent;
+  DisplayStroke _listStroke;
+  float _listScale = 1;
+  // the horizontal scale of the graphics the boxes will be drawn with
+  float _sx;
+
+  void syncColor();
+
+  void syncStroke();
+
+  void syncScale(float scale);
+
+  DisplayItem& add(DisplayOp op);
+
+public:
+  explicit DisplayCompiler(DisplayList& list, float sx = 1) : _list(list), _sx(sx) {}
+
+  /** Compile the given box at the given coordinates */
+  void compile(const sptr<Box>& box, float x, float y);
+
+  /** Restore the state of the graphics to the one before replay */
+  void finish();
+
+  /** The horizontal scale of the graphics, the same as Graphics2D#sx */
+  inline float sx() const { return _sx; }
+
+  inline color getColor() const { return _color; }
+
+  inline void setColor(color c) { _color = c; }
+
+  inline const DisplayStroke& getStroke() const { return _stroke; }
+
+  inline void setStroke(const DisplayStroke& s) { _stroke = s; }
+
+  void setStroke(const Stroke& s);
+
+  void setStrokeWidth(float w);
+
+  void translate(float dx, float dy);
+
+  void scale(float sx, float sy);
+
+  void rotate(float angle, float px, float py);
+
+  /** Draw a glyph, the extents are the metrics of the glyph in box units */
+  void drawGlyph(
+    i32 fontId, wchar_t chr, float size, float x, float y,
+    float width = 0, float height = 0, float depth = 0
+  );
+
+  void drawLine(float x1, float y1, float x2, float y2);
+
+  void drawRect(float x, float y, float w, float h);
+
+  void fillRect(float x, float y, float w, float h);
+
+  void drawRoundRect(float x, float y, float w, float h, float rx, float ry);
+
+  void fillRoundRect(float x, float y, float w, float h, float rx, float ry);
+};
+
+/** A box replays a compiled display list, see TeXRender#compile */
+class DisplayListBox : public Box {
+private:
+  sptr<DisplayList> _list;
+
+public:
+  DisplayListBox() = delete;
+
+  DisplayListBox(const sptr<DisplayList>& list, const sptr<Box>& box) : _list(list) {
+    copyMetrics(box);
+  }
+
+  inline const sptr<DisplayList>& list() const { return _list; }
+
+  void draw(Graphics2D& g2, float x, float y) override {
+    _list->draw(g2, x, y);
+  }
+};
+
+}  // namespace tex
+
+#endif  // LATEX_DISPLAY_LIST_H
@@ -0,0 +1,46 @@
+#include "core/char_routing.h"
+
+#include "core/formula.h"
+#include "fonts/fonts.h"
+
+using namespace std;
+using namespace tex;
+
+atomic<const CharRouting::Tables*> CharRouting::_tables(nullptr);
+vector<const CharRouting::Tables*> CharRouting::_retired;
+mutex CharRouting::_mutex;
+CharRouting::Tables* CharRouting::_building = nullptr;
+
+const CharRouting::Tables* CharRouting::rebuild(bool missingOnly) {
+  lock_guard<mutex> lock(_mutex);
+  const Tables* old = _tables.load(memory_order_acquire);
+  if (missingOnly && old != nullptr) return old;
+
+  auto* t = new Tables();
+  _building = t;
+  Formula::__markSymbolMappings();
+  Formula::__markFormulaMappings();
+  _building = nullptr;
+
+  for (const auto& i : DefaultTeXFont::_registeredAlphabets) {
+    if (indexOf(DefaultTeXFont::_loadedAlphabets, i.first) >= 0) continue;
+    const int id = UnicodeBlock::idOf(i.first);
+    if (id < 0) {
+      t->unknownAlphabet = true;
+    } else {
+      if (id >= (int) t->alphabets.size()) t->alphabets.resize(id + 1, false);
+      t->alphabets[id] = true;
+    }
+  }
+
+  _tables.store(t, memory_order_release);
+  if (old != nullptr) _retired.push_back(old);
+  return t;
+}
+
+void CharRouting::_free_() {
+  lock_guard<mutex> lock(_mutex);
+  delete _tables.exchange(nullptr, memory_order_acq_rel);
+  for (auto t : _retired) delete t;
+  _retired.clear();
+}
@@ -0,0 +1,86 @@
+#ifndef CHAR_ROUTING_H_INCLUDED
+#define CHAR_ROUTING_H_INCLUDED
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include "utils/code_point_table.h"
+#include "utils/utils.h"
+
+namespace tex {
+
+/**
+ * The routing of the chars TeXParser#convertCharacter looks up for every char
+ * that is not alphanumeric: which mappings (see Formula#getSymbolMapping) the
+ * char has, and if the alphabet registered for its block (see
+ * DefaultTeXFont#registerAlphabet) needs to be loaded. The chars without a
+ * mapping go to the text rendering (see TextRenderingAtom) or to a CharAtom.
+ * <p>
+ * The routes are precomputed in a two-level table by the code point, so a
+ * script-heavy input (e.g. CJK or Cyrillic) costs a table lookup per char
+ * instead of several map lookups. The tables are rebuilt under a lock when the
+ * mappings or the alphabets change (see #update) and published as an immutable
+ * snapshot by an atomic pointer, so the parsers in other threads never see a
+ * table half built. The replaced snapshots are kept until #_free_ since a lookup
+ * may still read them, there are as many as the changes of the mappings and the
+ * alphabets (a few per process).
+ */
+class CharRouting {
+private:
+  struct Tables {
+    CodePointTable<u8> routes;
+    // by the id of the block (see UnicodeBlock#idOf), if its alphabet is registered but not loaded
+    std::vector<bool> alphabets;
+    bool unknownAlphabet = false;
+  };
+
+  static std::atomic<const Tables*> _tables;
+  static std::vector<const Tables*> _retired;
+  static std::mutex _mutex;
+  // the tables being built, see #__mark
+  static Tables* _building;
+
+  /** Build the tables and publish them, if missing only, return the published tables */
+  static const Tables* rebuild(bool missingOnly);
+
+  static inline const Tables& tables() {
+    const Tables* t = _tables.load(std::memory_order_acquire);
+    return t != nullptr ? *t : *rebuild(true);
+  }
+
+public:
+  /** The char maps to a symbol in math mode */
+  static constexpr u8 SYMBOL = 1;
+  /** The char maps to a formula */
+  static constexpr u8 FORMULA = 2;
+  /** The char maps to a symbol in text mode */
+  static constexpr u8 TEXT = 4;
+
+  /** Get the mappings (a combination of SYMBOL, FORMULA and TEXT) of the given char */
+  static inline u8 routeOf(wchar_t c) {
+    return tables().routes.get((u32) c);
+  }
+
+  /** Test if the alphabet registered for the block of the given id needs to be loaded */
+  static inline bool needsAlphabet(int blockId) {
+    const Tables& t = tables();
+    if (blockId < 0) return t.unknownAlphabet;
+    return blockId < (int) t.alphabets.size() && t.alphabets[blockId];
+  }
+
+  /** Add the given mappings to the route of the given char, used while rebuilding */
+  static inline void __mark(int c, u8 mappings) {
+    _building->routes.set((u32) c, (u8) (_building->routes.get((u32) c) | mappings));
+  }
+
+  /** Rebuild the routes now, called when the mappings or the alphabets change */
+  static inline void update() { rebuild(false); }
+
+  /** Release the tables, no thread may look up meanwhile */
+  static void _free_();
+};
+
+}  // namespace tex
+
+#endif  // CHAR_ROUTING_H_INCLUDED
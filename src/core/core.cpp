@@ -58,11 +58,23 @@ void tex::print_box(const sptr<Box>& b) {
 
 #endif  // HAVE_LOG
 
-sptr<Box> BoxSplitter::split(const sptr<Box>& b, float width, float lineSpace) {
+vector<float> BoxSplitter::breakPositions(const sptr<Box>& box) {
+  vector<float> xs;
+  auto hb = dynamic_pointer_cast<HBox>(box);
+  if (hb == nullptr) return xs;
+  vector<Break> breaks;
+  vector<int> path;
+  collectBreaks(*hb, 0.f, path, breaks);
+  xs.reserve(breaks.size());
+  for (const auto& b : breaks) xs.push_back(b._x);
+  return xs;
+}
+
+sptr<Box> BoxSplitter::split(const sptr<Box>& b, float width, float lineSpace, BreakMode mode) {
   auto h = dynamic_pointer_cast<HBox>(b);
   sptr<Box> box;
   if (h != nullptr) {
-    auto box = split(h, width, lineSpace);
+    auto box = split(h, width, lineSpace, mode);
 #ifdef HAVE_LOG
     if (box != b) {
       __print("[BEFORE SPLIT]:\n");
@@ -83,107 +95,178 @@ sptr<Box> BoxSplitter::split(const sptr<Box>& b, float width, float lineSpace) {
   return b;
 }
 
-sptr<Box> BoxSplitter::split(const sptr<HBox>& hb, float width, float lineSpace) {
+sptr<Box> BoxSplitter::split(const sptr<HBox>& hb, float width, float lineSpace, BreakMode mode) {
   if (width == 0 || hb->_width <= width) return hb;
 
-  auto* vbox = new VBox();
-  sptr<HBox> first, second;
-  stack<Position> positions;
-  sptr<HBox> hbox = hb;
-
-  while (hbox->_width > width && canBreak(positions, hbox, width) != hbox->_width) {
-    Position pos = positions.top();
-    positions.pop();
-    auto hboxes = pos._box->split(pos._index - 1);
-    first = hboxes.first;
-    second = hboxes.second;
-    while (!positions.empty()) {
-      pos = positions.top();
-      positions.pop();
-      hboxes = pos._box->splitRemove(pos._index);
-      hboxes.first->add(first);
-      hboxes.second->add(0, second);
-      first = hboxes.first;
-      second = hboxes.second;
-    }
-    vbox->add(first, lineSpace);
-    hbox = second;
-  }
-
-  if (second != nullptr) {
-    vbox->add(second, lineSpace);
-    return sptr<Box>(vbox);
+  // the start and the end of the box are treated as breaks too
+  vector<Break> breaks;
+  vector<int> path;
+  breaks.emplace_back(0.f, vector<int>());
+  collectBreaks(*hb, 0.f, path, breaks);
+  breaks.emplace_back(hb->_width, vector<int>());
+
+  const vector<int> ends = (
+    mode == BreakMode::greedy
+    ? greedyBreaks(breaks, width)
+    : optimalBreaks(breaks, width)
+  );
+  if (ends.size() <= 1) return hb;
+
+  auto vbox = sptrOf<VBox>();
+  int start = 0;
+  for (int end : ends) {
+    const auto& from = breaks[start]._path;
+    const auto& to = breaks[end]._path;
+    vbox->add(slice(*hb, from.data(), from.size(), to.data(), to.size()), lineSpace);
+    start = end;
   }
-
-  return hbox;
+  return vbox;
 }
 
-float BoxSplitter::canBreak(stack<Position>& s, const sptr<HBox>& hbox, const float width) {
-  const vector<sptr<Box>>& children = hbox->_children;
+void BoxSplitter::collectBreaks(
+  const HBox& hb,
+  float x,
+  vector<int>& path,
+  vector<Break>& breaks
+) {
+  const auto& children = hb._children;
+  const auto& positions = hb._breakPositions;
   const int count = children.size();
-  // Cumulative width
-  auto* cumWidth = new float[count + 1]();
-  cumWidth[0] = 0;
+  size_t k = 0;
   for (int i = 0; i < count; i++) {
-    auto box = children[i];
-    cumWidth[i + 1] = cumWidth[i] + box->_width;
-    if (cumWidth[i + 1] <= width) continue;
-    int pos = getBreakPosition(hbox, i);
-    auto h = dynamic_pointer_cast<HBox>(box);
+    // the break positions are in ascending order
+    while (k < positions.size() && positions[k] < i) k++;
+    if (k < positions.size() && positions[k] == i) {
+      path.push_back(i);
+      breaks.emplace_back(x, path);
+      path.pop_back();
+    }
+    const Box* box = children[i].get();
+    const auto* h = dynamic_cast<const HBox*>(box);
     if (h != nullptr) {
-      stack<Position> sub;
-      float w = canBreak(sub, h, width - cumWidth[i]);
-      if (w != box->_width && (cumWidth[i] + w <= width || pos == -1)) {
-        s.push(Position(i - 1, hbox));
-        // add to stack
-        vector<Position> p;
-        while (!sub.empty()) {
-          p.push_back(sub.top());
-          sub.pop();
-        }
-        for (auto it = p.rbegin(); it != p.rend(); it++) s.push(*it);
-        // release cum-width
-        float x = cumWidth[i] + w;
-        delete[] cumWidth;
-        return x;
-      }
+      path.push_back(i);
+      collectBreaks(*h, x, path, breaks);
+      path.pop_back();
     }
+    x += box->_width;
+  }
+}
 
-    if (pos != -1) {
-      s.push(Position(pos, hbox));
-      float x = cumWidth[pos];
-      delete[] cumWidth;
-      return x;
+vector<int> BoxSplitter::greedyBreaks(const vector<Break>& breaks, float width) {
+  vector<int> ends;
+  const int n = breaks.size();
+  int start = 0;
+  while (breaks[n - 1]._x - breaks[start]._x > width) {
+    // the farthest break that fits, or the first one if none fits
+    int end = -1;
+    for (int j = start + 1; j < n - 1; j++) {
+      const float w = breaks[j]._x - breaks[start]._x;
+      if (w <= 0) continue;
+      if (w > width) {
+        if (end == -1) end = j;
+        break;
+      }
+      end = j;
     }
+    if (end == -1) break;
+    ends.push_back(end);
+    start = end;
   }
+  ends.push_back(n - 1);
+  return ends;
+}
 
-  delete[] cumWidth;
-  return hbox->_width;
+/** The demerits of a line with the given width */
+static double lineDemerits(float w, float width, bool last) {
+  // the penalty of each line, so fewer lines are preferred
+  static constexpr double LINE_PENALTY = 10;
+  // the base demerits of a line that exceeds the width
+  static constexpr double OVERFULL = 1e8;
+  if (w > width) {
+    const double over = (w - width) / width;
+    return OVERFULL * (1 + over * over);
+  }
+  // the last line could be as short as it wants
+  if (last) return LINE_PENALTY * LINE_PENALTY;
+  const double ratio = (width - w) / width;
+  const double badness = 100 * ratio * ratio * ratio;
+  return (LINE_PENALTY + badness) * (LINE_PENALTY + badness);
 }
 
-int BoxSplitter::getBreakPosition(const sptr<HBox>& hb, int i) {
-  if (hb->_breakPositions.empty()) return -1;
+vector<int> BoxSplitter::optimalBreaks(const vector<Break>& breaks, float width) {
+  const int n = breaks.size();
+  // the minimal total demerits to break at i, and the previous break of that way
+  vector<double> total(n, numeric_limits<double>::infinity());
+  vector<int> prev(n, -1);
+  total[0] = 0;
+  for (int j = 1; j < n; j++) {
+    const bool last = j == n - 1;
+    const float x = breaks[j]._x;
+    // only the breaks within the width before j could start a line that ends at j,
+    // so the scan is linear in the count of breaks per line
+    int i = j - 1;
+    for (; i >= 0; i--) {
+      const float w = x - breaks[i]._x;
+      if (w > width) break;
+      if (w <= 0 || (prev[i] == -1 && i != 0)) continue;
+      const double d = total[i] + lineDemerits(w, width, last);
+      if (d < total[j]) {
+        total[j] = d;
+        prev[j] = i;
+      }
+    }
+    if (prev[j] != -1) continue;
+    // no line fits, start an overfull line from the nearest reachable break
+    for (; i >= 0; i--) {
+      if (prev[i] == -1 && i != 0) continue;
+      total[j] = total[i] + lineDemerits(x - breaks[i]._x, width, last);
+      prev[j] = i;
+      break;
+    }
+  }
 
-  if (hb->_breakPositions.size() == 1 && hb->_breakPositions[0] <= i)
-    return hb->_breakPositions[0];
+  vector<int> ends;
+  for (int j = n - 1; j > 0 && prev[j] != -1; j = prev[j]) ends.push_back(j);
+  reverse(ends.begin(), ends.end());
+  return ends;
+}
 
-  size_t pos = 0;
-  for (; pos < hb->_breakPositions.size(); pos++) {
-    if (hb->_breakPositions[pos] > i) {
-      if (pos == 0) return -1;
-      return hb->_breakPositions[pos - 1];
+sptr<HBox> BoxSplitter::slice(
+  HBox& hb,
+  const int* from, size_t fromLen,
+  const int* to, size_t toLen
+) {
+  // a path with only one index is a break position of this box, otherwise the
+  // break is inside the child at the first index
+  const auto& children = hb._children;
+  auto line = hb.cloneBox();
+  const int start = fromLen == 0 ? 0 : from[0];
+  const int end = toLen == 0 ? children.size() : (toLen == 1 ? to[0] : to[0] + 1);
+  for (int i = start; i < end; i++) {
+    const bool head = fromLen > 1 && i == from[0];
+    const bool tail = toLen > 1 && i == to[0];
+    if (head || tail) {
+      auto& h = static_cast<HBox&>(*children[i]);
+      line->add(slice(
+        h,
+        head ? from + 1 : nullptr, head ? fromLen - 1 : 0,
+        tail ? to + 1 : nullptr, tail ? toLen - 1 : 0
+      ));
+    } else {
+      line->add(children[i]);
     }
   }
-
-  return hb->_breakPositions[pos - 1];
+  return line;
 }
 
 /************************************* Environment implementation ******************************/
 
-Environment::Environment(TexStyle style, const sptr<TeXFont>& tf, UnitType wu, float tw) {
+Environment::Environment(
+  TexStyle style, const sptr<TeXFont>& tf, float ppp, UnitType wu, float tw) {
   init();
   _style = style;
   _tf = tf;
+  _ppp = ppp;
   setInterline(UnitType::ex, 1.f);
   _textWidth = tw * SpaceAtom::getFactor(wu, *this);
 }
@@ -197,62 +280,94 @@ void Environment::setTextWidth(UnitType wu, float w) {
 }
 
 sptr<Environment>& Environment::copy() {
-  Environment* t = new Environment(_style, _scaleFactor, _tf, _textStyle, _smallCap);
+  Environment* t = new Environment(_style, _scaleFactor, _tf, _ppp, _textStyle, _smallCap);
   _copy = sptr<Environment>(t);
+  _copy->_links = _links;
+  _copy->_deps = _deps;
+  _copy->_delimiters = _delimiters;
+  _copy->_metricsOnly = _metricsOnly;
   return _copy;
 }
 
 sptr<Environment>& Environment::copy(const sptr<TeXFont>& tf) {
-  Environment* te = new Environment(_style, _scaleFactor, tf, _textStyle, _smallCap);
+  Environment* te = new Environment(_style, _scaleFactor, tf, _ppp, _textStyle, _smallCap);
   te->_textWidth = _textWidth;
   te->_interline = _interline;
   te->_interlineUnit = _interlineUnit;
   _copytf = sptr<Environment>(te);
+  _copytf->_links = _links;
+  _copytf->_deps = _deps;
+  _copytf->_delimiters = _delimiters;
+  _copytf->_metricsOnly = _metricsOnly;
   return _copytf;
 }
 
 sptr<Environment>& Environment::crampStyle() {
-  Environment* t = new Environment(_style, _scaleFactor, _tf, _textStyle, _smallCap);
+  Environment* t = new Environment(_style, _scaleFactor, _tf, _ppp, _textStyle, _smallCap);
   _cramp = sptr<Environment>(t);
+  _cramp->_links = _links;
+  _cramp->_deps = _deps;
+  _cramp->_delimiters = _delimiters;
+  _cramp->_metricsOnly = _metricsOnly;
   const i8 style = static_cast<i8>(_style);
   _cramp->_style = static_cast<TexStyle>(style % 2 == 1 ? style : style + 1);
   return _cramp;
 }
 
 sptr<Environment>& Environment::dnomStyle() {
-  Environment* t = new Environment(_style, _scaleFactor, _tf, _textStyle, _smallCap);
+  Environment* t = new Environment(_style, _scaleFactor, _tf, _ppp, _textStyle, _smallCap);
   _dnom = sptr<Environment>(t);
+  _dnom->_links = _links;
+  _dnom->_deps = _deps;
+  _dnom->_delimiters = _delimiters;
+  _dnom->_metricsOnly = _metricsOnly;
   const i8 style = static_cast<i8>(_style);
   _dnom->_style = static_cast<TexStyle>(2 * (style / 2) + 1 + 2 - 2 * (style / 6));
   return _dnom;
 }
 
 sptr<Environment>& Environment::numStyle() {
-  Environment* t = new Environment(_style, _scaleFactor, _tf, _textStyle, _smallCap);
+  Environment* t = new Environment(_style, _scaleFactor, _tf, _ppp, _textStyle, _smallCap);
   _num = sptr<Environment>(t);
+  _num->_links = _links;
+  _num->_deps = _deps;
+  _num->_delimiters = _delimiters;
+  _num->_metricsOnly = _metricsOnly;
   const i8 style = static_cast<i8>(_style);
   _num->_style = static_cast<TexStyle>(style + 2 - 2 * (style / 6));
   return _num;
 }
 
 sptr<Environment>& Environment::rootStyle() {
-  Environment* t = new Environment(_style, _scaleFactor, _tf, _textStyle, _smallCap);
+  Environment* t = new Environment(_style, _scaleFactor, _tf, _ppp, _textStyle, _smallCap);
   _root = sptr<Environment>(t);
+  _root->_links = _links;
+  _root->_deps = _deps;
+  _root->_delimiters = _delimiters;
+  _root->_metricsOnly = _metricsOnly;
   _root->_style = TexStyle::scriptScript;
   return _root;
 }
 
 sptr<Environment>& Environment::subStyle() {
-  Environment* t = new Environment(_style, _scaleFactor, _tf, _textStyle, _smallCap);
+  Environment* t = new Environment(_style, _scaleFactor, _tf, _ppp, _textStyle, _smallCap);
   _sub = sptr<Environment>(t);
+  _sub->_links = _links;
+  _sub->_deps = _deps;
+  _sub->_delimiters = _delimiters;
+  _sub->_metricsOnly = _metricsOnly;
   const i8 style = static_cast<i8>(_style);
   _sub->_style = static_cast<TexStyle>(2 * (style / 4) + 4 + 1);
   return _sub;
 }
 
 sptr<Environment>& Environment::supStyle() {
-  Environment* t = new Environment(_style, _scaleFactor, _tf, _textStyle, _smallCap);
+  Environment* t = new Environment(_style, _scaleFactor, _tf, _ppp, _textStyle, _smallCap);
   _sup = sptr<Environment>(t);
+  _sup->_links = _links;
+  _sup->_deps = _deps;
+  _sup->_delimiters = _delimiters;
+  _sup->_metricsOnly = _metricsOnly;
   const i8 style = static_cast<i8>(_style);
   _sup->_style = static_cast<TexStyle>(2 * (style / 4) + 4 + (style % 2));
   return _sup;
@@ -2,7 +2,7 @@
 #define CORE_H_INCLUDED
 
 #include <cstring>
-#include <stack>
+#include <vector>
 
 #include "common.h"
 #include "fonts/fonts.h"
@@ -12,31 +12,85 @@ namespace tex {
 
 class Box;
 
+class HBox;
+
+class AtomLinks;
+
+class DelimiterCache;
+
 #ifdef HAVE_LOG
 
 void print_box(const sptr<Box>& box);
 
 #endif  // HAVE_LOG
 
+/**
+ * Break a horizontal box into lines that fit the given width. The break
+ * opportunities (including those in nested horizontal boxes) are collected in
+ * one pass, then the breaks are chosen by the given BreakMode, and finally the
+ * lines are sliced out of the box at once.
+ */
 class BoxSplitter {
-public:
-  struct Position {
-    int _index;
-    sptr<HBox> _box;
-
-    Position(int index, const sptr<HBox>& box)
-      : _index(index), _box(box) {}
+private:
+  /** A break opportunity */
+  struct Break {
+    // the x position of the break from the left of the box
+    float _x;
+    // the child indices from the box to the break, the last one is the break position
+    std::vector<int> _path;
+
+    Break(float x, std::vector<int> path) : _x(x), _path(std::move(path)) {}
   };
 
-private:
-  static float canBreak(std::stack<Position>& stack, const sptr<HBox>& hbox, float width);
+  static void collectBreaks(
+    const HBox& hb,
+    float x,
+    std::vector<int>& path,
+    std::vector<Break>& breaks
+  );
+
+  static std::vector<int> greedyBreaks(const std::vector<Break>& breaks, float width);
+
+  static std::vector<int> optimalBreaks(const std::vector<Break>& breaks, float width);
 
-  static int getBreakPosition(const sptr<HBox>& hb, int index);
+  static sptr<HBox> slice(
+    HBox& hb,
+    const int* from, size_t fromLen,
+    const int* to, size_t toLen
+  );
 
 public:
-  static sptr<Box> split(const sptr<Box>& box, float width, float lineSpace);
+  /**
+   * The x-coordinates (from the left of the box, in box units) of the break
+   * opportunities of the given box, empty if the box could not be broken
+   */
+  static std::vector<float> breakPositions(const sptr<Box>& box);
+
+  static sptr<Box> split(
+    const sptr<Box>& box,
+    float width,
+    float lineSpace,
+    BreakMode mode = BreakMode::optimal
+  );
+
+  static sptr<Box> split(
+    const sptr<HBox>& hb,
+    float width,
+    float lineSpace,
+    BreakMode mode = BreakMode::optimal
+  );
+};
 
-  static sptr<Box> split(const sptr<HBox>& hb, float width, float lineSpace);
+/**
+ * What a layout depends on besides the formula, the style and the font, recorded
+ * while creating the boxes if the environment has one (see Environment#setLayoutDeps).
+ * A layout depends on neither could be drawn at any text size, see TeXLayout.
+ */
+struct LayoutDeps {
+  /** If the text size is queried, e.g. to convert a length in pt or pixels */
+  bool size = false;
+  /** If the text width is queried, e.g. by an array spans the whole width */
+  bool width = false;
 };
 
 /**
@@ -54,6 +108,8 @@ private:
   int _lastFontId{};
   // Environment width
   float _textWidth{};
+  // the pixels per point, see Formula#setDPITarget
+  float _ppp{};
 
   // The text style to use
   std::string _textStyle;
@@ -65,6 +121,15 @@ private:
   // The inter line space
   float _interline{};
 
+  // The atoms the boxes were created from, recorded only if not null
+  AtomLinks* _links = nullptr;
+  // What the layout depends on, recorded only if not null
+  LayoutDeps* _deps = nullptr;
+  // The delimiters resolved by the build, cached only if not null
+  DelimiterCache* _delimiters = nullptr;
+  // If only the metrics of the boxes are wanted, see TeXRenderBuilder#measure
+  bool _metricsOnly = false;
+
   // Member to store copies to prevent destruct
   sptr<Environment> _copy, _copytf, _cramp, _dnom;
   sptr<Environment> _num, _root, _sub, _sup;
@@ -81,27 +146,34 @@ private:
 
   Environment(
     TexStyle style, float scaleFactor,
-    const sptr<TeXFont>& tf,
+    const sptr<TeXFont>& tf, float ppp,
     const std::string& textstyle, bool smallCap  //
   ) {
     init();
     _style = style;
     _scaleFactor = scaleFactor;
     _tf = tf;
+    _ppp = ppp;
     _textStyle = textstyle;
     _smallCap = smallCap;
     setInterline(UnitType::ex, 1.f);
   }
 
 public:
-  Environment(TexStyle style, const sptr<TeXFont>& tf) {
+  /**
+   * Create an environment of the given style and font, the pixels per point (see
+   * Formula#setDPITarget) must be the one the font is created with.
+   */
+  Environment(TexStyle style, const sptr<TeXFont>& tf, float ppp) {
     init();
     _style = style;
     _tf = tf;
+    _ppp = ppp;
     setInterline(UnitType::ex, 1.f);
   }
 
-  Environment(TexStyle style, const sptr<TeXFont>& tf, UnitType widthUnit, float textWidth);
+  Environment(
+    TexStyle style, const sptr<TeXFont>& tf, float ppp, UnitType widthUnit, float textWidth);
 
   inline void setInterline(UnitType unit, float len) {
     _interline = len;
@@ -112,7 +184,10 @@ public:
 
   void setTextWidth(UnitType widthUnit, float width);
 
-  inline float getTextWidth() const { return _textWidth; }
+  inline float getTextWidth() const {
+    if (_deps != nullptr) _deps->width = true;
+    return _textWidth;
+  }
 
   inline void setScaleFactor(float f) { _scaleFactor = f; }
 
@@ -152,10 +227,16 @@ public:
    */
   sptr<Environment>& supStyle();
 
-  inline float getSize() const { return _tf->getSize(); }
+  inline float getSize() const {
+    if (_deps != nullptr) _deps->size = true;
+    return _tf->getSize();
+  }
 
   inline TexStyle getStyle() const { return _style; }
 
+  /** The pixels per point the formula is laid out with, see Formula#setDPITarget */
+  inline float getPixelsPerPoint() const { return _ppp; }
+
   inline void setStyle(TexStyle style) { _style = style; }
 
   inline const std::string& getTextStyle() const { return _textStyle; }
@@ -168,8 +249,33 @@ public:
 
   inline const sptr<TeXFont>& getTeXFont() const { return _tf; }
 
+  /** Change the font of this environment, e.g. to lay out a group in other styles without copying */
+  inline void setTeXFont(const sptr<TeXFont>& tf) { _tf = tf; }
+
   inline float getSpace() const { return _tf->getSpace(_style) * _tf->getScaleFactor(); }
 
+  /** Set the links to record the atoms the boxes are created from, see BoxIndex */
+  inline void setAtomLinks(AtomLinks* links) { _links = links; }
+
+  inline AtomLinks* getAtomLinks() const { return _links; }
+
+  /** Set the dependencies to record what the layout depends on, see TeXLayout */
+  inline void setLayoutDeps(LayoutDeps* deps) { _deps = deps; }
+
+  /** Set the cache of the delimiters resolved by the build, see DelimiterFactory */
+  inline void setDelimiterCache(DelimiterCache* cache) { _delimiters = cache; }
+
+  inline DelimiterCache* getDelimiterCache() const { return _delimiters; }
+
+  /**
+   * Set if only the metrics of the boxes are wanted. The rows are then reduced to
+   * their dimensions instead of keeping their children, the boxes created in this
+   * mode can not be drawn nor split.
+   */
+  inline void setMetricsOnly(bool metricsOnly) { _metricsOnly = metricsOnly; }
+
+  inline bool isMetricsOnly() const { return _metricsOnly; }
+
   inline void setLastFontId(int id) { _lastFontId = id; }
 
   inline int getLastFontId() const {
@@ -177,6 +283,25 @@ public:
   }
 };
 
+/**
+ * Change the font of an environment in a scope, the previous font is restored when
+ * the scope exits, even if the box creation in the scope throws.
+ */
+class FontScope {
+private:
+  Environment& _env;
+  const sptr<TeXFont> _prev;
+
+public:
+  FontScope(Environment& env, const sptr<TeXFont>& tf) : _env(env), _prev(env.getTeXFont()) {
+    env.setTeXFont(tf);
+  }
+
+  no_copy_assign(FontScope);
+
+  ~FontScope() { _env.setTeXFont(_prev); }
+};
+
 }  // namespace tex
 
 #endif  // CORE_H_INCLUDED
@@ -1,11 +1,13 @@
 #include "core/formula.h"
 
 #include "common.h"
+#include "core/char_routing.h"
 #include "core/core.h"
 #include "core/parser.h"
 #include "fonts/alphabet.h"
 #include "fonts/fonts.h"
 #include "res/parser/formula_parser.h"
+#include "res/reg/bundles.h"
 
 using namespace std;
 using namespace tex;
@@ -21,8 +23,12 @@ void Formula::_init_() {
   __dbg("%s\n", "init formula");
 #endif  // HAVE_LOG
   // Register external alphabet
+#if CLM_BUNDLE_CYRILLIC
   DefaultTeXFont::registerAlphabet(new CyrillicRegistration());
+#endif
+#if CLM_BUNDLE_GREEK
   DefaultTeXFont::registerAlphabet(new GreekRegistration());
+#endif
 #ifdef HAVE_LOG
   __log << "elements in _symbolMappings:" << endl;
   for (auto i : _symbolMappings)
@@ -171,12 +177,26 @@ FontInfos* Formula::getExternalFont(const UnicodeBlock& block) {
 
 void Formula::addSymbolMappings(const string& file) {
   TeXFormulaSettingParser parser(file);
-  parser.parseSymbol(_symbolMappings, _symbolTextMappings);
-  parser.parseSymbol2Formula(_symbolFormulaMappings, _symbolTextMappings);
+  vector<pair<int, string>> symbols, formulas, text;
+  parser.parseSymbol(symbols, text);
+  parser.parseSymbol2Formula(formulas, text);
+  addSymbolMappings(symbols, formulas, text);
+}
+
+void Formula::addSymbolMappings(
+  const vector<pair<int, string>>& symbols,
+  const vector<pair<int, string>>& formulas,
+  const vector<pair<int, string>>& text
+) {
+  for (const auto& m : symbols) _symbolMappings[m.first] = m.second;
+  for (const auto& m : formulas) _symbolFormulaMappings[m.first] = m.second;
+  for (const auto& m : text) _symbolTextMappings[m.first] = m.second;
+  CharRouting::update();
 }
 
 void Formula::_free_() {
   for (auto i : _externalFontMap) delete i.second;
+  CharRouting::_free_();
 }
 
 /*************************************** ArrayFormula implementation ******************************/
@@ -224,12 +244,7 @@ void ArrayFormula::addRowSpecifier(const sptr<CellSpecifier>& spe) {
 }
 
 void ArrayFormula::addCellSpecifier(const sptr<CellSpecifier>& spe) {
-  string str = tostring(_row) + tostring(_col);
-  auto it = _cellSpecifiers.find(str);
-  if (it == _cellSpecifiers.end()) {
-    _cellSpecifiers[str] = vector<sptr<CellSpecifier>>();
-  }
-  _cellSpecifiers[str].push_back(spe);
+  _cellSpecifiers[cellKey(_row, _col)].push_back(spe);
 }
 
 int ArrayFormula::rows() const {
@@ -59,7 +59,8 @@ public:
   static std::map<std::wstring, sptr<Formula>> _predefinedTeXFormulas;
   static std::map<std::wstring, std::wstring> _predefinedTeXFormulasAsString;
 
-  // character-to-symbol and character-to-delimiter mappings
+  // character-to-symbol and character-to-delimiter mappings added at runtime, the
+  // builtin mappings are in sorted constant tables, see #getSymbolMapping
   static std::map<int, std::string> _symbolMappings;
   static std::map<int, std::string> _symbolTextMappings;
   static std::map<int, std::string> _symbolFormulaMappings;
@@ -133,7 +134,9 @@ public:
   static sptr<Formula> get(const std::wstring& name);
 
   /**
-   * Set the DPI of target
+   * Set the DPI of target, the default of the builders without a DPI target of
+   * their own (see TeXRenderBuilder#setDPITarget). It must not be called while
+   * formulas are built on other threads.
    *
    * @param dpi the target DPI
    */
@@ -144,8 +147,35 @@ public:
 
   static FontInfos* getExternalFont(const UnicodeBlock& block);
 
+  /**
+   * Get the name of the symbol the given char maps to in math mode, the mappings
+   * added at runtime take precedence over the builtin mappings.
+   *
+   * @return the name of the symbol, or nullptr if the char is not mapped
+   */
+  static const char* getSymbolMapping(int c);
+
+  /** Get the name of the symbol the given char maps to in text mode, see #getSymbolMapping */
+  static const char* getSymbolTextMapping(int c);
+
+  /** Get the formula the given char maps to, see #getSymbolMapping */
+  static const char* getSymbolFormulaMapping(int c);
+
   static void addSymbolMappings(const std::string& file);
 
+  /** Add the mappings of the chars to the symbols, the formulas and the text, see __FontDescription */
+  static void addSymbolMappings(
+    const std::vector<std::pair<int, std::string>>& symbols,
+    const std::vector<std::pair<int, std::string>>& formulas,
+    const std::vector<std::pair<int, std::string>>& text
+  );
+
+  /** Mark the chars mapped to the symbols in math and text mode in CharRouting */
+  static void __markSymbolMappings();
+
+  /** Mark the chars mapped to the formulas in CharRouting */
+  static void __markFormulaMappings();
+
   /** Enable or disable debug mode. */
   static void setDEBUG(bool b);
 
@@ -163,7 +193,13 @@ private:
 public:
   std::vector<std::vector<sptr<Atom>>> _array;
   std::map<int, std::vector<sptr<CellSpecifier>>> _rowSpecifiers;
-  std::map<std::string, std::vector<sptr<CellSpecifier>>> _cellSpecifiers;
+  // cell specifiers keyed by #cellKey(row, col)
+  std::map<u64, std::vector<sptr<CellSpecifier>>> _cellSpecifiers;
+
+  /** Pack the given row and column into the key of a cell */
+  static inline u64 cellKey(u32 row, u32 col) {
+    return ((u64) row << 32) | col;
+  }
 
   ArrayFormula();
 
@@ -92,12 +92,17 @@ public:
 
 class MacroInfo {
 public:
+  // the macros added at runtime, the builtin macros are in a sorted constant table
+  // and never added here, see #get
   static std::map<std::wstring, MacroInfo*> _commands;
 
   /** Add a macro, replace it if the macro is exists. */
   static void add(const std::wstring& name, MacroInfo* mac);
 
-  /** Get the macro info from given name, return nullptr if not found. */
+  /**
+   * Get the macro info from given name, return nullptr if not found. The macros
+   * added at runtime take precedence over the builtin macros.
+   */
   static MacroInfo* get(const std::wstring& name);
 
   // Number of arguments
@@ -1,331 +1,348 @@
 #include "common.h"
 #include "core/macro.h"
 #include "macro_impl.h"
+#include "utils/sorted_table.h"
 
 using namespace std;
 using namespace tex;
 
 #define mac3(argc, name, code) \
-  { L##code, m(argc, name) }
+  { L##code, argc, 0, name }
 
 #define mac4(argc, posOpts, name, code) \
-  { L##code, m(argc, posOpts, name) }
+  { L##code, argc, posOpts, name }
 
-inline static PreDefMacro* m(int argc, int posOpts, MacroDelegate del) {
-  return new PreDefMacro(argc, posOpts, del);
-}
+namespace {
 
-inline static PreDefMacro* m(int argc, MacroDelegate del) {
-  return new PreDefMacro(argc, del);
-}
+struct BuiltinMacro {
+  const wchar_t* key;
+  int argc;
+  int posOpts;
+  MacroDelegate delegate;
+};
 
-map<wstring, MacroInfo*> MacroInfo::_commands{
-#define mac mac4
-    mac(2, 2, macro_newcommand, "newcommand"),
-    mac(2, 2, macro_renewcommand, "renewcommand"),
-    mac(2, 1, macro_rule, "rule"),
-    mac(1, 1, macro_includegraphics, "includegraphics"),
-    mac(2, 1, macro_cfrac, "cfrac"),
-    mac(1, 1, macro_xleftarrow, "xleftarrow"),
-    mac(1, 1, macro_xrightarrow, "xrightarrow"),
-    mac(1, 1, macro_sqrt, "sqrt"),
-    mac(1, 1, macro_smash, "smash"),
-    mac(1, 1, macro_hdotsfor, "hdotsfor"),
-    mac(2, 1, macro_stackrel, "stackrel"),
-    mac(2, 1, macro_stackbin, "stackbin"),
-    mac(2, 1, macro_rotatebox, "rotatebox"),
-    mac(2, 2, macro_scalebox, "scalebox"),
-    mac(2, 2, macro_raisebox, "raisebox"),
-    mac(1, 1, macro_dynamic, "dynamic"),
-#undef mac
-#define mac mac3
-    mac(1, macro_fatalIfCmdConflict, "fatalIfCmdConflict"),
-    mac(1, macro_breakEverywhere, "breakEverywhere"),
-    mac(3, macro_newenvironment, "newenvironment"),
-    mac(3, macro_renewenvironment, "renewenvironment"),
-    mac(0, macro_makeatletter, "makeatletter"),
-    mac(0, macro_makeatother, "makeatother"),
-    mac(1, macro_smallmatrixATATenv, "smallmatrix@@env"),
-    mac(1, macro_matrixATATenv, "matrix@@env"),
-    mac(2, macro_arrayATATenv, "array@@env"),
-    mac(2, macro_alignATATenv, "align@@env"),
-    mac(2, macro_alignedATATenv, "aligned@@env"),
-    mac(2, macro_flalignATATenv, "flalign@@env"),
-    mac(2, macro_alignatATATenv, "alignat@@env"),
-    mac(2, macro_alignedatATATenv, "alignedat@@env"),
-    mac(2, macro_multlineATATenv, "multline@@env"),
-    mac(2, macro_gatherATATenv, "gather@@env"),
-    mac(2, macro_gatheredATATenv, "gathered@@env"),
-    mac(1, macro_hvspace, "hspace"),
-    mac(1, macro_hvspace, "vspace"),
-    mac(1, macro_clrlap, "llap"),
-    mac(1, macro_clrlap, "rlap"),
-    mac(1, macro_clrlap, "clap"),
-    mac(1, macro_mathclrlap, "mathllap"),
-    mac(1, macro_mathclrlap, "mathrlap"),
-    mac(1, macro_mathclrlap, "mathclap"),
-    mac(2, macro_frac, "frac"),
-    mac(2, macro_sfrac, "sfrac"),
-    mac(6, macro_genfrac, "genfrac"),
-    mac(0, macro_over, "over"),
-    mac(0, macro_atop, "atop"),
-    mac(2, macro_overwithdelims, "overwithdelims"),
-    mac(2, macro_atopwithdelims, "atopwithdelims"),
-    mac(2, macro_abovewithdelims, "abovewithdelims"),
-    mac(0, macro_choose, "choose"),
-    mac(0, macro_brace, "brace"),
-    mac(0, macro_brack, "brack"),
-    mac(0, macro_bangle, "bangle"),
-    mac(0, macro_underscore, "underscore"),
-    mac(1, macro_mbox, "mbox"),
-    mac(1, macro_text, "text"),
-    mac(1, macro_intertext, "intertext"),
-    mac(2, macro_binom, "binom"),
-    // math text styles
-    mac(1, macro_mathbf, "mathbf"),
-    mac(0, macro_bf, "bf"),
-    mac(1, macro_mathit, "mathit"),
-    mac(0, macro_it, "it"),
-    mac(1, macro_mathrm, "mathrm"),
-    mac(0, macro_rm, "rm"),
-    mac(1, macro_mathsf, "mathsf"),
-    mac(0, macro_sf, "sf"),
-    mac(1, macro_mathtt, "mathtt"),
-    mac(0, macro_tt, "tt"),
-    // text styles
-    mac(1, macro_textstyles, "mathscr"),
-    mac(1, macro_textstyles, "mathbb"),
-    mac(1, macro_textstyles, "mathcal"),
-    mac(1, macro_textstyles, "cal"),
-    mac(1, macro_textstyles, "mathfrak"),
-    mac(1, macro_textstyles, "mathds"),
-    mac(1, macro_textstyles, "frak"),
-    mac(1, macro_textstyles, "Bbb"),
-    mac(1, macro_textstyles, "oldstylenums"),
-    mac(1, macro_textstyles, "bold"),
-    // accents
-    mac(1, macro_accentbiss, "^"),
-    mac(1, macro_accentbiss, "\'"),
-    mac(1, macro_accentbiss, "\""),
-    mac(1, macro_accentbiss, "`"),
-    mac(1, macro_accentbiss, "="),
-    mac(1, macro_accentbiss, "."),
-    mac(1, macro_accentbiss, "~"),
-    mac(1, macro_accentbiss, "u"),
-    mac(1, macro_accentbiss, "v"),
-    mac(1, macro_accentbiss, "H"),
-    mac(1, macro_accentbiss, "r"),
-    mac(1, macro_accentbiss, "U"),
-    mac(1, macro_T, "T"),
-    mac(1, macro_accentbiss, "t"),
-    mac(2, macro_accent, "accent"),
-    mac(2, macro_grkaccent, "grkaccent"),
-    mac(1, macro_accents, "hat"),
-    mac(1, macro_accents, "widehat"),
-    mac(1, macro_accents, "tilde"),
-    mac(1, macro_accents, "acute"),
-    mac(1, macro_accents, "grave"),
-    mac(1, macro_accents, "ddot"),
-    mac(1, macro_accents, "cyrddot"),
-    mac(1, macro_accents, "mathring"),
-    mac(1, macro_accents, "bar"),
-    mac(1, macro_accents, "breve"),
-    mac(1, macro_accents, "check"),
-    mac(1, macro_accents, "vec"),
-    mac(1, macro_accents, "dot"),
-    mac(1, macro_accents, "widetilde"),
-    mac(0, macro_nbsp, "nbsp"),
-    mac(1, macro_overrightarrow, "overrightarrow"),
-    mac(1, macro_overleftarrow, "overleftarrow"),
-    mac(1, macro_overleftrightarrow, "overleftrightarrow"),
-    mac(1, macro_underrightarrow, "underrightarrow"),
-    mac(1, macro_underleftarrow, "underleftarrow"),
-    mac(1, macro_underleftrightarrow, "underleftrightarrow"),
-    mac(1, macro_underbrace, "underbrace"),
-    mac(1, macro_overbrace, "overbrace"),
-    mac(1, macro_underbrack, "underbrack"),
-    mac(1, macro_overbrack, "overbrack"),
-    mac(1, macro_underparen, "underparen"),
-    mac(1, macro_overparen, "overparen"),
-    mac(1, macro_sqrt, "sqrtsign"),
-    mac(1, macro_overline, "overline"),
-    mac(1, macro_underline, "underline"),
-    mac(1, macro_mathop, "mathop"),
-    mac(1, macro_mathpunct, "mathpunct"),
-    mac(1, macro_mathord, "mathord"),
-    mac(1, macro_mathrel, "mathrel"),
-    mac(1, macro_mathinner, "mathinner"),
-    mac(1, macro_mathbin, "mathbin"),
-    mac(1, macro_mathopen, "mathopen"),
-    mac(1, macro_mathclose, "mathclose"),
-    mac(0, macro_joinrel, "joinrel"),
-    mac(0, macro_vdots, "vdots"),
-    mac(0, macro_ddots, "ddots"),
-    mac(0, macro_iddots, "iddots"),
-    mac(0, macro_nolimits, "nolimits"),
-    mac(0, macro_limits, "limits"),
-    mac(0, macro_normal, "normal"),
-    mac(0, macro_leftparenthesis, "("),
-    mac(0, macro_leftbracket, "["),
-    mac(1, macro_left, "left"),
-    mac(1, macro_middle, "middle"),
-    mac(0, macro_cr, "cr"),
-    mac(3, macro_multicolumn, "multicolumn"),
-    mac(1, macro_shoveright, "shoveright"),
-    mac(1, macro_shoveleft, "shoveleft"),
-    mac(0, macro_backslashcr, "\\"),
-    mac(1, macro_fbox, "fbox"),
-    mac(1, macro_fbox, "boxed"),
-    mac(0, macro_questeq, "questeq"),
-    mac(2, macro_accentset, "accentset"),
-    mac(2, macro_underaccent, "underaccent"),
-    mac(1, macro_undertilde, "undertilde"),
-    mac(2, macro_overset, "overset"),
-    mac(1, macro_Braket, "Braket"),
-    mac(1, macro_Set, "Set"),
-    mac(2, macro_underset, "underset"),
-    mac(1, macro_boldsymbol, "boldsymbol"),
-    mac(0, macro_GeoGebra, "GeoGebra"),
-    mac(1, macro_big, "big"),
-    mac(1, macro_Big, "Big"),
-    mac(1, macro_bigg, "bigg"),
-    mac(1, macro_Bigg, "Bigg"),
-    mac(1, macro_bigl, "bigl"),
-    mac(1, macro_Bigl, "Bigl"),
-    mac(1, macro_biggl, "biggl"),
-    mac(1, macro_Biggl, "Biggl"),
-    mac(1, macro_bigr, "bigr"),
-    mac(1, macro_Bigr, "Bigr"),
-    mac(1, macro_biggr, "biggr"),
-    mac(1, macro_Biggr, "Biggr"),
-    mac(0, macro_displaystyle, "displaystyle"),
-    mac(0, macro_textstyle, "textstyle"),
-    mac(0, macro_scriptstyle, "scriptstyle"),
-    mac(0, macro_scriptscriptstyle, "scriptscriptstyle"),
-    mac(3, macro_sideset, "sideset"),
-    mac(3, macro_prescript, "prescript"),
-    mac(1, macro_reflectbox, "reflectbox"),
-    mac(3, macro_resizebox, "resizebox"),
-    mac(1, macro_shadowbox, "shadowbox"),
-    mac(1, macro_ovalbox, "ovalbox"),
-    mac(1, macro_cornersize, "cornersize"),
-    mac(1, macro_doublebox, "doublebox"),
-    mac(1, macro_phantom, "phantom"),
-    mac(1, macro_hphantom, "hphantom"),
-    mac(1, macro_vphantom, "vphantom"),
-    mac(0, macro_spATbreve, "sp@breve"),
-    mac(0, macro_spAThat, "sp@hat"),
-    mac(3, macro_definecolor, "definecolor"),
-    mac(2, macro_textcolor, "textcolor"),
-    mac(2, macro_fgcolor, "fgcolor"),
-    mac(2, macro_bgcolor, "bgcolor"),
-    mac(2, macro_colorbox, "colorbox"),
-    mac(3, macro_fcolorbox, "fcolorbox"),
-    mac(1, macro_cedilla, "c"),
-    mac(0, macro_IJ, "IJ"),
-    mac(0, macro_IJ, "ij"),
-    mac(0, macro_TStroke, "TStroke"),
-    mac(0, macro_TStroke, "tStroke"),
-    mac(0, macro_LCaron, "Lcaron"),
-    mac(0, macro_tcaron, "tcaron"),
-    mac(0, macro_LCaron, "lcaron"),
-    mac(1, macro_ogonek, "k"),
-    mac(0, macro_cong, "cong"),
-    mac(0, macro_doteq, "doteq"),
-    mac(1, macro_externalfont, "externalFont"),
-    mac(1, macro_text, "Text"),
-    mac(1, macro_textit, "Textit"),
-    mac(1, macro_textbf, "Textbf"),
-    mac(1, macro_textitbf, "Textitbf"),
-    mac(4, macro_declaremathsizes, "DeclareMathSizes"),
-    mac(1, macro_magnification, "magnification"),
-    mac(0, macro_hline, "hline"),
-    mac(0, macro_sizes, "tiny"),
-    mac(0, macro_sizes, "scriptsize"),
-    mac(0, macro_sizes, "footnotesize"),
-    mac(0, macro_sizes, "small"),
-    mac(0, macro_sizes, "normalsize"),
-    mac(0, macro_sizes, "large"),
-    mac(0, macro_sizes, "Large"),
-    mac(0, macro_sizes, "LARGE"),
-    mac(0, macro_sizes, "huge"),
-    mac(0, macro_sizes, "Huge"),
-    mac(1, macro_mathcumsup, "mathcumsup"),
-    mac(1, macro_mathcumsub, "mathcumsub"),
-    mac(0, macro_hstrok, "hstrok"),
-    mac(0, macro_Hstrok, "Hstrok"),
-    mac(0, macro_dstrok, "dstrok"),
-    mac(0, macro_Dstrok, "Dstrok"),
-    mac(0, macro_dotminus, "dotminus"),
-    mac(0, macro_ratio, "ratio"),
-    mac(0, macro_smallfrowneq, "smallfrowneq"),
-    mac(0, macro_geoprop, "geoprop"),
-    mac(0, macro_minuscolon, "minuscolon"),
-    mac(0, macro_minuscoloncolon, "minuscoloncolon"),
-    mac(0, macro_simcolon, "simcolon"),
-    mac(0, macro_simcoloncolon, "simcoloncolon"),
-    mac(0, macro_approxcolon, "approxcolon"),
-    mac(0, macro_approxcoloncolon, "approxcoloncolon"),
-    mac(0, macro_coloncolon, "coloncolon"),
-    mac(0, macro_equalscolon, "equalscolon"),
-    mac(0, macro_equalscoloncolon, "equalscoloncolon"),
-    mac(0, macro_colonminus, "colonminus"),
-    mac(0, macro_coloncolonminus, "coloncolonminus"),
-    mac(0, macro_colonequals, "colonequals"),
-    mac(0, macro_coloncolonequals, "coloncolonequals"),
-    mac(0, macro_colonsim, "colonsim"),
-    mac(0, macro_coloncolonsim, "coloncolonsim"),
-    mac(0, macro_colonapprox, "colonapprox"),
-    mac(0, macro_coloncolonapprox, "coloncolonapprox"),
-    mac(0, macro_kern, "kern"),
-    mac(1, macro_char, "char"),
-    mac(1, macro_romannumeral, "roman"),
-    mac(1, macro_romannumeral, "Roman"),
-    mac(1, macro_textcircled, "textcircled"),
-    mac(1, macro_textsc, "textsc"),
-    mac(0, macro_sc, "sc"),
-    mac(0, macro_muskips, ","),
-    mac(0, macro_muskips, ":"),
-    mac(0, macro_muskips, ";"),
-    mac(0, macro_muskips, "thinspace"),
-    mac(0, macro_muskips, "medspace"),
-    mac(0, macro_muskips, "thickspace"),
-    mac(0, macro_muskips, "!"),
-    mac(0, macro_muskips, "negthinspace"),
-    mac(0, macro_muskips, "negmedspace"),
-    mac(0, macro_muskips, "negthickspace"),
-    mac(0, macro_quad, "quad"),
-    mac(0, macro_surd, "surd"),
-    mac(0, macro_iint, "iint"),
-    mac(0, macro_iiint, "iiint"),
-    mac(0, macro_iiiint, "iiiint"),
-    mac(0, macro_idotsint, "idotsint"),
-    mac(0, macro_int, "int"),
-    mac(0, macro_oint, "oint"),
-    mac(0, macro_lmoustache, "lmoustache"),
-    mac(0, macro_rmoustache, "rmoustache"),
-    mac(0, macro_insertBreakMark, "-"),
-    mac(1, macro_xml, "XML"),
-    mac(0, macro_above, "above"),
-    mac(1, macro_st, "st"),
-    mac(1, macro_fcscore, "fcscore"),
-    mac(1, macro_rowcolor, "rowcolor"),
-    mac(1, macro_columnbg, "columncolor"),
-    mac(1, macro_arrayrulecolor, "arrayrulecolor"),
-    mac(2, macro_newcolumntype, "newcolumntype"),
-    mac(1, macro_color, "color"),
-    mac(1, macro_cellcolor, "cellcolor"),
-    mac(3, macro_multirow, "multirow"),
-    mac(2, macro_longdiv, "longdiv"),
-    mac(1, macro_cancel, "cancel"),
-    mac(1, macro_bcancel, "bcancel"),
-    mac(1, macro_xcancel, "xcancel"),
+/** Sorted by the name, the macros are created on the first use */
+constexpr BuiltinMacro BUILTIN_MACROS[]{
+    mac3(0, macro_muskips, "!"),
+    mac3(1, macro_accentbiss, "\""),
+    mac3(1, macro_accentbiss, "\'"),
+    mac3(0, macro_leftparenthesis, "("),
+    mac3(0, macro_muskips, ","),
+    mac3(0, macro_insertBreakMark, "-"),
+    mac3(1, macro_accentbiss, "."),
+    mac3(0, macro_muskips, ":"),
+    mac3(0, macro_muskips, ";"),
+    mac3(1, macro_accentbiss, "="),
+    mac3(1, macro_textstyles, "Bbb"),
+    mac3(1, macro_Big, "Big"),
+    mac3(1, macro_Bigg, "Bigg"),
+    mac3(1, macro_Biggl, "Biggl"),
+    mac3(1, macro_Biggr, "Biggr"),
+    mac3(1, macro_Bigl, "Bigl"),
+    mac3(1, macro_Bigr, "Bigr"),
+    mac3(1, macro_Braket, "Braket"),
+    mac3(4, macro_declaremathsizes, "DeclareMathSizes"),
+    mac3(0, macro_Dstrok, "Dstrok"),
+    mac3(0, macro_GeoGebra, "GeoGebra"),
+    mac3(1, macro_accentbiss, "H"),
+    mac3(0, macro_Hstrok, "Hstrok"),
+    mac3(0, macro_sizes, "Huge"),
+    mac3(0, macro_IJ, "IJ"),
+    mac3(0, macro_sizes, "LARGE"),
+    mac3(0, macro_sizes, "Large"),
+    mac3(0, macro_LCaron, "Lcaron"),
+    mac3(1, macro_romannumeral, "Roman"),
+    mac3(1, macro_Set, "Set"),
+    mac3(1, macro_T, "T"),
+    mac3(0, macro_TStroke, "TStroke"),
+    mac3(1, macro_text, "Text"),
+    mac3(1, macro_textbf, "Textbf"),
+    mac3(1, macro_textit, "Textit"),
+    mac3(1, macro_textitbf, "Textitbf"),
+    mac3(1, macro_accentbiss, "U"),
+    mac3(1, macro_xml, "XML"),
+    mac3(0, macro_leftbracket, "["),
+    mac3(0, macro_backslashcr, "\\"),
+    mac3(1, macro_accentbiss, "^"),
+    mac3(1, macro_accentbiss, "`"),
+    mac3(0, macro_above, "above"),
+    mac3(2, macro_abovewithdelims, "abovewithdelims"),
+    mac3(2, macro_accent, "accent"),
+    mac3(2, macro_accentset, "accentset"),
+    mac3(1, macro_accents, "acute"),
+    mac3(2, macro_alignATATenv, "align@@env"),
+    mac3(2, macro_alignatATATenv, "alignat@@env"),
+    mac3(2, macro_alignedATATenv, "aligned@@env"),
+    mac3(2, macro_alignedatATATenv, "alignedat@@env"),
+    mac3(0, macro_approxcolon, "approxcolon"),
+    mac3(0, macro_approxcoloncolon, "approxcoloncolon"),
+    mac3(2, macro_arrayATATenv, "array@@env"),
+    mac3(1, macro_arrayrulecolor, "arrayrulecolor"),
+    mac3(0, macro_atop, "atop"),
+    mac3(2, macro_atopwithdelims, "atopwithdelims"),
+    mac3(0, macro_bangle, "bangle"),
+    mac3(1, macro_accents, "bar"),
+    mac3(1, macro_bcancel, "bcancel"),
+    mac3(0, macro_bf, "bf"),
+    mac3(2, macro_bgcolor, "bgcolor"),
+    mac3(1, macro_big, "big"),
+    mac3(1, macro_bigg, "bigg"),
+    mac3(1, macro_biggl, "biggl"),
+    mac3(1, macro_biggr, "biggr"),
+    mac3(1, macro_bigl, "bigl"),
+    mac3(1, macro_bigr, "bigr"),
+    mac3(2, macro_binom, "binom"),
+    mac3(1, macro_textstyles, "bold"),
+    mac3(1, macro_boldsymbol, "boldsymbol"),
+    mac3(1, macro_fbox, "boxed"),
+    mac3(0, macro_brace, "brace"),
+    mac3(0, macro_brack, "brack"),
+    mac3(1, macro_breakEverywhere, "breakEverywhere"),
+    mac3(1, macro_accents, "breve"),
+    mac3(1, macro_cedilla, "c"),
+    mac3(1, macro_textstyles, "cal"),
+    mac3(1, macro_cancel, "cancel"),
+    mac3(1, macro_cellcolor, "cellcolor"),
+    mac4(2, 1, macro_cfrac, "cfrac"),
+    mac3(1, macro_char, "char"),
+    mac3(1, macro_accents, "check"),
+    mac3(0, macro_choose, "choose"),
+    mac3(1, macro_clrlap, "clap"),
+    mac3(0, macro_colonapprox, "colonapprox"),
+    mac3(0, macro_coloncolon, "coloncolon"),
+    mac3(0, macro_coloncolonapprox, "coloncolonapprox"),
+    mac3(0, macro_coloncolonequals, "coloncolonequals"),
+    mac3(0, macro_coloncolonminus, "coloncolonminus"),
+    mac3(0, macro_coloncolonsim, "coloncolonsim"),
+    mac3(0, macro_colonequals, "colonequals"),
+    mac3(0, macro_colonminus, "colonminus"),
+    mac3(0, macro_colonsim, "colonsim"),
+    mac3(1, macro_color, "color"),
+    mac3(2, macro_colorbox, "colorbox"),
+    mac3(1, macro_columnbg, "columncolor"),
+    mac3(0, macro_cong, "cong"),
+    mac3(1, macro_cornersize, "cornersize"),
+    mac3(0, macro_cr, "cr"),
+    mac3(1, macro_accents, "cyrddot"),
+    mac3(1, macro_accents, "ddot"),
+    mac3(0, macro_ddots, "ddots"),
 #ifdef GRAPHICS_DEBUG
-    mac(0, macro_debug, "debug"),
-    mac(0, macro_undebug, "undebug"),
+    mac3(0, macro_debug, "debug"),
 #endif  // GRAPHICS_DEBUG
+    mac3(3, macro_definecolor, "definecolor"),
+    mac3(0, macro_displaystyle, "displaystyle"),
+    mac3(1, macro_accents, "dot"),
+    mac3(0, macro_doteq, "doteq"),
+    mac3(0, macro_dotminus, "dotminus"),
+    mac3(1, macro_doublebox, "doublebox"),
+    mac3(0, macro_dstrok, "dstrok"),
+    mac4(1, 1, macro_dynamic, "dynamic"),
+    mac3(0, macro_equalscolon, "equalscolon"),
+    mac3(0, macro_equalscoloncolon, "equalscoloncolon"),
+    mac3(1, macro_externalfont, "externalFont"),
+    mac3(1, macro_fatalIfCmdConflict, "fatalIfCmdConflict"),
+    mac3(1, macro_fbox, "fbox"),
+    mac3(3, macro_fcolorbox, "fcolorbox"),
+    mac3(1, macro_fcscore, "fcscore"),
+    mac3(2, macro_fgcolor, "fgcolor"),
+    mac3(2, macro_flalignATATenv, "flalign@@env"),
+    mac3(0, macro_sizes, "footnotesize"),
+    mac3(2, macro_frac, "frac"),
+    mac3(1, macro_textstyles, "frak"),
+    mac3(2, macro_gatherATATenv, "gather@@env"),
+    mac3(2, macro_gatheredATATenv, "gathered@@env"),
+    mac3(6, macro_genfrac, "genfrac"),
+    mac3(0, macro_geoprop, "geoprop"),
+    mac3(1, macro_accents, "grave"),
+    mac3(2, macro_grkaccent, "grkaccent"),
+    mac3(1, macro_accents, "hat"),
+    mac4(1, 1, macro_hdotsfor, "hdotsfor"),
+    mac3(0, macro_hline, "hline"),
+    mac3(1, macro_hphantom, "hphantom"),
+    mac3(1, macro_hvspace, "hspace"),
+    mac3(0, macro_hstrok, "hstrok"),
+    mac3(0, macro_sizes, "huge"),
+    mac3(0, macro_iddots, "iddots"),
+    mac3(0, macro_idotsint, "idotsint"),
+    mac3(0, macro_iiiint, "iiiint"),
+    mac3(0, macro_iiint, "iiint"),
+    mac3(0, macro_iint, "iint"),
+    mac3(0, macro_IJ, "ij"),
+    mac4(1, 1, macro_includegraphics, "includegraphics"),
+    mac3(0, macro_int, "int"),
+    mac3(1, macro_intertext, "intertext"),
+    mac3(0, macro_it, "it"),
+    mac3(0, macro_joinrel, "joinrel"),
+    mac3(1, macro_ogonek, "k"),
+    mac3(0, macro_kern, "kern"),
+    mac3(0, macro_sizes, "large"),
+    mac3(0, macro_LCaron, "lcaron"),
+    mac3(1, macro_left, "left"),
+    mac3(0, macro_limits, "limits"),
+    mac3(1, macro_clrlap, "llap"),
+    mac3(0, macro_lmoustache, "lmoustache"),
+    mac3(2, macro_longdiv, "longdiv"),
+    mac3(1, macro_magnification, "magnification"),
+    mac3(0, macro_makeatletter, "makeatletter"),
+    mac3(0, macro_makeatother, "makeatother"),
+    mac3(1, macro_textstyles, "mathbb"),
+    mac3(1, macro_mathbf, "mathbf"),
+    mac3(1, macro_mathbin, "mathbin"),
+    mac3(1, macro_textstyles, "mathcal"),
+    mac3(1, macro_mathclrlap, "mathclap"),
+    mac3(1, macro_mathclose, "mathclose"),
+    mac3(1, macro_mathcumsub, "mathcumsub"),
+    mac3(1, macro_mathcumsup, "mathcumsup"),
+    mac3(1, macro_textstyles, "mathds"),
+    mac3(1, macro_textstyles, "mathfrak"),
+    mac3(1, macro_mathinner, "mathinner"),
+    mac3(1, macro_mathit, "mathit"),
+    mac3(1, macro_mathclrlap, "mathllap"),
+    mac3(1, macro_mathop, "mathop"),
+    mac3(1, macro_mathopen, "mathopen"),
+    mac3(1, macro_mathord, "mathord"),
+    mac3(1, macro_mathpunct, "mathpunct"),
+    mac3(1, macro_mathrel, "mathrel"),
+    mac3(1, macro_accents, "mathring"),
+    mac3(1, macro_mathclrlap, "mathrlap"),
+    mac3(1, macro_mathrm, "mathrm"),
+    mac3(1, macro_textstyles, "mathscr"),
+    mac3(1, macro_mathsf, "mathsf"),
+    mac3(1, macro_mathtt, "mathtt"),
+    mac3(1, macro_matrixATATenv, "matrix@@env"),
+    mac3(1, macro_mbox, "mbox"),
+    mac3(0, macro_muskips, "medspace"),
+    mac3(1, macro_middle, "middle"),
+    mac3(0, macro_minuscolon, "minuscolon"),
+    mac3(0, macro_minuscoloncolon, "minuscoloncolon"),
+    mac3(3, macro_multicolumn, "multicolumn"),
+    mac3(3, macro_multirow, "multirow"),
+    mac3(2, macro_multlineATATenv, "multline@@env"),
+    mac3(0, macro_nbsp, "nbsp"),
+    mac3(0, macro_muskips, "negmedspace"),
+    mac3(0, macro_muskips, "negthickspace"),
+    mac3(0, macro_muskips, "negthinspace"),
+    mac3(2, macro_newcolumntype, "newcolumntype"),
+    mac4(2, 2, macro_newcommand, "newcommand"),
+    mac3(3, macro_newenvironment, "newenvironment"),
+    mac3(0, macro_nolimits, "nolimits"),
+    mac3(0, macro_normal, "normal"),
+    mac3(0, macro_sizes, "normalsize"),
+    mac3(0, macro_oint, "oint"),
+    mac3(1, macro_textstyles, "oldstylenums"),
+    mac3(1, macro_ovalbox, "ovalbox"),
+    mac3(0, macro_over, "over"),
+    mac3(1, macro_overbrace, "overbrace"),
+    mac3(1, macro_overbrack, "overbrack"),
+    mac3(1, macro_overleftarrow, "overleftarrow"),
+    mac3(1, macro_overleftrightarrow, "overleftrightarrow"),
+    mac3(1, macro_overline, "overline"),
+    mac3(1, macro_overparen, "overparen"),
+    mac3(1, macro_overrightarrow, "overrightarrow"),
+    mac3(2, macro_overset, "overset"),
+    mac3(2, macro_overwithdelims, "overwithdelims"),
+    mac3(1, macro_phantom, "phantom"),
+    mac3(3, macro_prescript, "prescript"),
+    mac3(0, macro_quad, "quad"),
+    mac3(0, macro_questeq, "questeq"),
+    mac3(1, macro_accentbiss, "r"),
+    mac4(2, 2, macro_raisebox, "raisebox"),
+    mac3(0, macro_ratio, "ratio"),
+    mac3(1, macro_reflectbox, "reflectbox"),
+    mac4(2, 2, macro_renewcommand, "renewcommand"),
+    mac3(3, macro_renewenvironment, "renewenvironment"),
+    mac3(3, macro_resizebox, "resizebox"),
+    mac3(1, macro_clrlap, "rlap"),
+    mac3(0, macro_rm, "rm"),
+    mac3(0, macro_rmoustache, "rmoustache"),
+    mac3(1, macro_romannumeral, "roman"),
+    mac4(2, 1, macro_rotatebox, "rotatebox"),
+    mac3(1, macro_rowcolor, "rowcolor"),
+    mac4(2, 1, macro_rule, "rule"),
+    mac3(0, macro_sc, "sc"),
+    mac4(2, 2, macro_scalebox, "scalebox"),
+    mac3(0, macro_scriptscriptstyle, "scriptscriptstyle"),
+    mac3(0, macro_sizes, "scriptsize"),
+    mac3(0, macro_scriptstyle, "scriptstyle"),
+    mac3(0, macro_sf, "sf"),
+    mac3(2, macro_sfrac, "sfrac"),
+    mac3(1, macro_shadowbox, "shadowbox"),
+    mac3(1, macro_shoveleft, "shoveleft"),
+    mac3(1, macro_shoveright, "shoveright"),
+    mac3(3, macro_sideset, "sideset"),
+    mac3(0, macro_simcolon, "simcolon"),
+    mac3(0, macro_simcoloncolon, "simcoloncolon"),
+    mac3(0, macro_sizes, "small"),
+    mac3(0, macro_smallfrowneq, "smallfrowneq"),
+    mac3(1, macro_smallmatrixATATenv, "smallmatrix@@env"),
+    mac4(1, 1, macro_smash, "smash"),
+    mac3(0, macro_spATbreve, "sp@breve"),
+    mac3(0, macro_spAThat, "sp@hat"),
+    mac4(1, 1, macro_sqrt, "sqrt"),
+    mac3(1, macro_sqrt, "sqrtsign"),
+    mac3(1, macro_st, "st"),
+    mac4(2, 1, macro_stackbin, "stackbin"),
+    mac4(2, 1, macro_stackrel, "stackrel"),
+    mac3(0, macro_surd, "surd"),
+    mac3(1, macro_accentbiss, "t"),
+    mac3(0, macro_TStroke, "tStroke"),
+    mac3(0, macro_tcaron, "tcaron"),
+    mac3(1, macro_text, "text"),
+    mac3(1, macro_textcircled, "textcircled"),
+    mac3(2, macro_textcolor, "textcolor"),
+    mac3(1, macro_textsc, "textsc"),
+    mac3(0, macro_textstyle, "textstyle"),
+    mac3(0, macro_muskips, "thickspace"),
+    mac3(0, macro_muskips, "thinspace"),
+    mac3(1, macro_accents, "tilde"),
+    mac3(0, macro_sizes, "tiny"),
+    mac3(0, macro_tt, "tt"),
+    mac3(1, macro_accentbiss, "u"),
+#ifdef GRAPHICS_DEBUG
+    mac3(0, macro_undebug, "undebug"),
+#endif  // GRAPHICS_DEBUG
+    mac3(2, macro_underaccent, "underaccent"),
+    mac3(1, macro_underbrace, "underbrace"),
+    mac3(1, macro_underbrack, "underbrack"),
+    mac3(1, macro_underleftarrow, "underleftarrow"),
+    mac3(1, macro_underleftrightarrow, "underleftrightarrow"),
+    mac3(1, macro_underline, "underline"),
+    mac3(1, macro_underparen, "underparen"),
+    mac3(1, macro_underrightarrow, "underrightarrow"),
+    mac3(0, macro_underscore, "underscore"),
+    mac3(2, macro_underset, "underset"),
+    mac3(1, macro_undertilde, "undertilde"),
+    mac3(1, macro_accentbiss, "v"),
+    mac3(0, macro_vdots, "vdots"),
+    mac3(1, macro_accents, "vec"),
+    mac3(1, macro_vphantom, "vphantom"),
+    mac3(1, macro_hvspace, "vspace"),
+    mac3(1, macro_accents, "widehat"),
+    mac3(1, macro_accents, "widetilde"),
+    mac3(1, macro_xcancel, "xcancel"),
+    mac4(1, 1, macro_xleftarrow, "xleftarrow"),
+    mac4(1, 1, macro_xrightarrow, "xrightarrow"),
+    mac3(1, macro_accentbiss, "~"),
 };
 
+static_assert(isSortedTable(BUILTIN_MACROS), "The builtin macros must be sorted by the name");
+
+TableObjects<std::unique_ptr<MacroInfo>, std::size(BUILTIN_MACROS)> builtinMacros;
+
+}  // namespace
+
+map<wstring, MacroInfo*> MacroInfo::_commands;
+
+MacroInfo* MacroInfo::get(const wstring& name) {
+  auto it = _commands.find(name);
+  if (it != _commands.end()) return it->second;
+  const auto* m = findInTable(BUILTIN_MACROS, name.c_str());
+  if (m == nullptr) return nullptr;
+  return builtinMacros.get(BUILTIN_MACROS, m, [](const BuiltinMacro& e) {
+    return std::unique_ptr<MacroInfo>(new PreDefMacro(e.argc, e.posOpts, e.delegate));
+  }).get();
+}
+
 map<wstring, wstring> NewCommandMacro::_codes;
 map<wstring, wstring> NewCommandMacro::_replacements;
 Macro* NewCommandMacro::_instance = new NewCommandMacro();
@@ -694,8 +694,8 @@ inline macro(fbox) {
 }
 
 inline macro(questeq) {
-  auto eq = SymbolAtom::get(Formula::_symbolMappings['=']);
-  auto quest = SymbolAtom::get(Formula::_symbolMappings['?']);
+  auto eq = SymbolAtom::get(Formula::getSymbolMapping('='));
+  auto quest = SymbolAtom::get(Formula::getSymbolMapping('?'));
   auto sq = sptrOf<ScaleAtom>(quest, 0.75f);
   auto at = sptrOf<UnderOverAtom>(eq, sq, UnitType::mu, 2.5f, true, true);
   return sptrOf<TypedAtom>(AtomType::relation, AtomType::relation, at);
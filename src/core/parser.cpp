@@ -3,6 +3,7 @@
 #include "atom/atom.h"
 #include "atom/atom_basic.h"
 #include "common.h"
+#include "core/char_routing.h"
 #include "core/formula.h"
 #include "core/macro.h"
 #include "fonts/alphabet.h"
@@ -932,11 +933,12 @@ sptr<Atom> TeXParser::convertCharacter(wchar_t c, bool oneChar) {
     // the unicode Greek Letters in math mode are not drawn with the Greek font
     if (c >= 945 && c <= 969) {
       // Greek small letter
-      return SymbolAtom::get(Formula::_symbolMappings[c]);
+      const char* name = Formula::getSymbolMapping(c);
+      return SymbolAtom::get(name == nullptr ? "" : name);
     } else if (c >= 913 && c <= 937) {
       // Greek capital letter
-      wstring ltx = utf82wide(Formula::_symbolFormulaMappings[c]);
-      return Formula(ltx)._root;
+      const char* formula = Formula::getSymbolFormulaMapping(c);
+      return Formula(utf82wide(formula == nullptr ? "" : formula))._root;
     }
   }
 
@@ -949,27 +951,26 @@ sptr<Atom> TeXParser::convertCharacter(wchar_t c, bool oneChar) {
     /*
        * Find from registered UNICODE-table
        */
-    const UnicodeBlock& block = UnicodeBlock::of(c);
+    const int blockId = UnicodeBlock::idOf(c);
+    const UnicodeBlock& block = UnicodeBlock::get(blockId);
 #ifdef HAVE_LOG
     int idx = indexOf(DefaultTeXFont::_loadedAlphabets, block);
     __log << "block of char: " << std::to_string(c) << " is " << idx << endl;
 #endif  // HAVE_LOG
-    bool exist = (indexOf(DefaultTeXFont::_loadedAlphabets, block) != -1);
-    if (!_isLoading && !exist) {
-      auto it = DefaultTeXFont::_registeredAlphabets.find(block);
-      if (it != DefaultTeXFont::_registeredAlphabets.end())
-        DefaultTeXFont::addAlphabet(DefaultTeXFont::_registeredAlphabets[block]);
+    if (!_isLoading && CharRouting::needsAlphabet(blockId)) {
+      DefaultTeXFont::addAlphabet(DefaultTeXFont::_registeredAlphabets[block]);
     }
 
-    auto sit = Formula::_symbolMappings.find(c);
-    auto fit = Formula::_symbolFormulaMappings.find(c);
+    // the routes tell which mappings the char has, the maps are looked up only if it has
+    const u8 route = CharRouting::routeOf(c);
+    const char* symbol = (route & CharRouting::SYMBOL) ? Formula::getSymbolMapping(c) : nullptr;
+    const char* formula = (route & CharRouting::FORMULA) ? Formula::getSymbolFormulaMapping(c) : nullptr;
 
     /*
        * Character not in the symbol-mapping and not in the formula-mapping, find from
        * external font-mapping
        */
-    if (sit == Formula::_symbolMappings.end() &&
-        fit == Formula::_symbolFormulaMappings.end()) {
+    if (symbol == nullptr && formula == nullptr) {
       FontInfos* fontInfos = nullptr;
       bool isLatin = UnicodeBlock::BASIC_LATIN == block;
       if ((isLatin && Formula::isRegisteredBlock(UnicodeBlock::BASIC_LATIN)) || !isLatin) {
@@ -1003,22 +1004,21 @@ sptr<Atom> TeXParser::convertCharacter(wchar_t c, bool oneChar) {
       /*
            * In text mode (with command \text{})
            */
-      if (!_isMathMode) {
-        auto it = Formula::_symbolTextMappings.find(c);
-        if (it != Formula::_symbolTextMappings.end()) {
-          auto atom = SymbolAtom::get(it->second);
+      if (!_isMathMode && (route & CharRouting::TEXT)) {
+        const char* text = Formula::getSymbolTextMapping(c);
+        if (text != nullptr) {
+          auto atom = SymbolAtom::get(text);
           atom->setUnicode(c);
           return atom;
         }
       }
-      auto it = Formula::_symbolFormulaMappings.find(c);
-      if (it != Formula::_symbolFormulaMappings.end()) {
-        wstring wstr = utf82wide(it->second);
+      if (formula != nullptr) {
+        wstring wstr = utf82wide(formula);
         return Formula(wstr)._root;
       }
 
-      if (sit != Formula::_symbolMappings.end()) {
-        string symbolName = sit->second;
+      if (symbol != nullptr) {
+        string symbolName = symbol;
         try {
           return SymbolAtom::get(symbolName);
         } catch (ex_symbol_not_found& e) {
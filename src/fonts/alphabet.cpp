@@ -1,8 +1,11 @@
 #include "fonts/alphabet.h"
 #include "common.h"
+#include "utils/code_point_table.h"
 
 using namespace tex;
 
+static const u16 NO_BLOCK = 0xffff;
+
 const UnicodeBlock UnicodeBlock::BASIC_LATIN      (0x0020, 0x007f);
 const UnicodeBlock UnicodeBlock::LATIN1_SUPPLEMENT(0x0080, 0x00ff);
 const UnicodeBlock UnicodeBlock::CYRILLIC         (0x0400, 0x04ff);
@@ -18,13 +21,26 @@ std::vector<const UnicodeBlock*> UnicodeBlock::_defined = {
     &GREEK_EXTENDED,
 };
 
-bool UnicodeBlock::contains(wchar_t c) const {
-  // if this block is UNKNOWN, check others first
-  if (*this == UNKNOWN) {
-    for (auto b : _defined)
-      if (b->contains(c)) return false;
-    return true;
+CodePointTable<u16>& UnicodeBlock::table() {
+  static CodePointTable<u16> blocks = []() {
+    CodePointTable<u16> t(NO_BLOCK);
+    index(t);
+    return t;
+  }();
+  return blocks;
+}
+
+void UnicodeBlock::index(CodePointTable<u16>& table) {
+  table.reset(NO_BLOCK);
+  // the first defined block wins if the blocks overlap
+  for (size_t i = _defined.size(); i-- > 0;) {
+    table.set((u32) _defined[i]->_start, (u32) _defined[i]->_end, (u16) i);
   }
+}
+
+bool UnicodeBlock::contains(wchar_t c) const {
+  // if this block is UNKNOWN, no others contain the char
+  if (*this == UNKNOWN) return idOf(c) < 0;
   return (c >= _start && c <= _end);
 }
 
@@ -43,14 +59,28 @@ bool UnicodeBlock::operator==(const UnicodeBlock& ub) const {
 const UnicodeBlock& UnicodeBlock::define(wchar_t codePointStart, wchar_t codePointEnd) {
   auto ub = new UnicodeBlock(codePointStart, codePointEnd);
   _defined.push_back(ub);
+  index(table());
   return *ub;
 }
 
 const UnicodeBlock& UnicodeBlock::of(wchar_t c) {
-  for (auto x : _defined) {
-    if (x->contains(c)) return *x;
+  return get(idOf(c));
+}
+
+int UnicodeBlock::idOf(wchar_t c) {
+  const u16 id = table().get((u32) c);
+  return id == NO_BLOCK ? -1 : id;
+}
+
+int UnicodeBlock::idOf(const UnicodeBlock& block) {
+  for (size_t i = 0; i < _defined.size(); i++) {
+    if (*_defined[i] == block) return (int) i;
   }
-  return UNKNOWN;
+  return -1;
+}
+
+const UnicodeBlock& UnicodeBlock::get(int id) {
+  return id < 0 ? UNKNOWN : *_defined[id];
 }
 
 /*********************************** alphabet implementation **************************/
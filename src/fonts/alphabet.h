@@ -6,10 +6,19 @@
 
 namespace tex {
 
+template <typename T>
+class CodePointTable;
+
 class UnicodeBlock {
 private:
   static std::vector<const UnicodeBlock*> _defined;
 
+  // the ids of the blocks by the code points, built on the first use and rebuilt
+  // by #define, so #of takes constant time instead of scanning the blocks
+  static CodePointTable<unsigned short>& table();
+
+  static void index(CodePointTable<unsigned short>& table);
+
 public:
   // predefined unicode-blocks
   static const UnicodeBlock BASIC_LATIN;
@@ -35,6 +44,18 @@ public:
   static const UnicodeBlock& define(wchar_t codePointStart, wchar_t codePointEnd);
 
   static const UnicodeBlock& of(wchar_t c);
+
+  /**
+   * Get the id of the block the given char belongs to, that is the index of the
+   * first defined block contains it, or -1 if the block is UNKNOWN.
+   */
+  static int idOf(wchar_t c);
+
+  /** Get the id of the given block, see #idOf(wchar_t) */
+  static int idOf(const UnicodeBlock& block);
+
+  /** Get the block of the given id, see #idOf(wchar_t) */
+  static const UnicodeBlock& get(int id);
 };
 
 class AlphabetRegistration {
@@ -0,0 +1,119 @@
+#ifndef FONT_DESC_H_INCLUDED
+#define FONT_DESC_H_INCLUDED
+
+#include <array>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "utils/enums.h"
+#include "utils/utils.h"
+
+namespace tex {
+
+/**
+ * A table of a font (e.g. the metrics), the rows are sorted by the first key(s),
+ * see FontInfo. The data is either allocated with new[] and owned by the table,
+ * or borrowed from a buffer that outlives the font (e.g. a memory-mapped bundle).
+ */
+template <typename T>
+struct __FontTable {
+  const T* data = nullptr;
+  // count of the elements (not the rows)
+  int len = 0;
+  bool owned = false;
+
+  __FontTable() = default;
+
+  __FontTable(const T* d, int l, bool o) : data(d), len(l), owned(o) {}
+
+  __FontTable(__FontTable&& t) noexcept : data(t.data), len(t.len), owned(t.owned) {
+    t.owned = false;
+  }
+
+  __FontTable& operator=(__FontTable&& t) noexcept {
+    if (this == &t) return *this;
+    if (owned) delete[] data;
+    data = t.data;
+    len = t.len;
+    owned = t.owned;
+    t.owned = false;
+    return *this;
+  }
+
+  no_copy_assign(__FontTable);
+
+  /** Give up the ownership of the data, return if the data was owned */
+  inline bool release() {
+    const bool o = owned;
+    owned = false;
+    return o;
+  }
+
+  ~__FontTable() {
+    if (owned) delete[] data;
+  }
+};
+
+/** A char in a font referred to by the name of the font */
+struct __NamedCharFont {
+  wchar_t ch = 0;
+  std::string font;
+  // the bold version of the font, empty if no bold version
+  std::string bold;
+};
+
+/** A larger version of a char in a font referred to by name */
+struct __NamedLarger {
+  wchar_t code, larger;
+  std::string font;
+};
+
+/** A font of a description, the fonts refer to each other by name */
+struct __FontDesc {
+  std::string id;
+  // path of the font file
+  std::string file;
+  float xHeight = 0, space = 0, quad = 0;
+  int skewChar = -1;
+  // the names of the various versions, empty for the font itself
+  std::string bold, roman, ss, tt, it;
+  // rows of (code, width, height, depth, italic)
+  __FontTable<float> metrics;
+  // rows of (code, top, mid, rep, bot)
+  __FontTable<int> extensions;
+  // rows of (left, right, kern)
+  __FontTable<float> kerns;
+  // rows of (left, right, ligature)
+  __FontTable<wchar_t> ligs;
+  std::vector<__NamedLarger> largers;
+};
+
+/** A TeX symbol of a description, see SymbolAtom */
+struct __SymbolDesc {
+  std::string name;
+  AtomType type;
+  bool del;
+};
+
+/**
+ * The contents of a TeX font description (e.g. an alphabet) with the files it
+ * includes, read from XML (see DefaultTeXFontParser#parse) or from a bundle (see
+ * FontBundle), and registered by DefaultTeXFont#addTeXFontDescription.
+ */
+struct __FontDescription {
+  std::vector<__FontDesc> fonts;
+  // text style name => (numbers, capitals, small, unicode) ranges, empty font if the range is absent
+  std::vector<std::pair<std::string, std::array<__NamedCharFont, 4>>> textStyles;
+  // symbol name => char
+  std::vector<std::pair<std::string, __NamedCharFont>> symbolMappings;
+  std::vector<__SymbolDesc> symbols;
+  // code => symbol name, code => formula, in math mode
+  std::vector<std::pair<int, std::string>> charToSymbol, charToFormula;
+  // code => symbol name or formula in text mode, the later ones win
+  std::vector<std::pair<int, std::string>> charToText;
+};
+
+}  // namespace tex
+
+#endif  // FONT_DESC_H_INCLUDED
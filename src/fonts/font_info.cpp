@@ -1,42 +1,117 @@
 #include "fonts/font_info.h"
 
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
 #include "core/formula.h"
 #include "fonts/font_reg.h"
 
 using namespace std;
 using namespace tex;
 
+namespace tex {
+
+/** The font of an info, created once by the first of the renders and the preloading that need it */
+struct __FontSlot {
+  once_flag once;
+  // the registration of a lazy font, see FontInfo#__register_lazy
+  once_flag registered;
+  const Font* font = nullptr;
+
+  void create(const string& path, float size) {
+    // the platforms cache the loaded font files in thread-safe caches, so the
+    // fonts could be created on several threads at the same time
+    call_once(once, [&] { font = Font::create(path, size); });
+  }
+};
+
+}  // namespace tex
+
+namespace {
+
+/** The threads preloading the fonts, see FontInfo#__preload */
+struct Loaders {
+  vector<thread> threads;
+
+  void join() {
+    for (auto& t : threads) t.join();
+    threads.clear();
+  }
+
+  // the threads must be joined even if LaTeX is not released before exit
+  ~Loaders() { join(); }
+} loaders;
+
+}  // namespace
+
 vector<FontInfo*> FontInfo::_infos;
 vector<string>    FontInfo::_names;
+vector<__FontSlot*> FontInfo::_fonts;
+vector<void (*)()> FontInfo::_lazyRegs;
+mutex FontInfo::_lazyMutex;
 
 void FontInfo::__register(const FontSet& set) {
   const vector<FontReg>& regs = set.regs();
+  // the names of the fonts left out are predefined too, the ids are positional
+  const size_t first = _names.size();
   for (auto r : regs) __predefine_name(r.name);
-  for (auto r : regs) r.reg();
+  if (_infos.size() < _names.size()) _infos.resize(_names.size(), nullptr);
+  for (size_t i = 0; i < regs.size(); i++) {
+    const FontReg& r = regs[i];
+    if (r.reg == nullptr) continue;
+    if (!r.lazy) {
+      r.reg();
+      continue;
+    }
+    const size_t id = first + i;
+    if (id >= _lazyRegs.size()) _lazyRegs.resize(id + 1, nullptr);
+    _lazyRegs[id] = r.reg;
+    // the slot is allocated here, so the table of the slots is never resized by the renders
+    __slot((int) id);
+  }
+}
+
+FontInfo* FontInfo::__register_lazy(int id) {
+  // once per font, the renders needing it on other threads wait until it is registered
+  call_once(_fonts[id]->registered, [id]() {
+    lock_guard<mutex> lock(_lazyMutex);
+    _lazyRegs[id]();
+  });
+  return _infos[id];
+}
+
+void FontInfo::__register_lazy() {
+  for (size_t i = 0; i < _lazyRegs.size(); i++) {
+    if (_lazyRegs[i] != nullptr) __register_lazy((int) i);
+  }
 }
 
 const float* const FontInfo::getMetrics(wchar_t ch) const {
-  return _metrics.isEmpty() ? nullptr : _metrics((float)ch) + 1;
+  const float* const item = _metrics.find(ch);
+  return item == nullptr ? nullptr : item + 1;
 }
 
 const int* const FontInfo::getExtension(wchar_t ch) const {
-  return _extensions.isEmpty() ? nullptr : _extensions((int)ch) + 1;
+  const int* const item = _extensions.find(ch);
+  return item == nullptr ? nullptr : item + 1;
 }
 
 //sptr<CharFont> FontInfo::getNextLarger(wchar_t ch) const {
-//  const int* const item = _nextLargers((int)ch);
+//  const int* const item = _nextLargers.find(ch);
 //  if (item == nullptr) return nullptr;
 //  return sptrOf<CharFont>(item[1], item[2]);
 //}
 
 //sptr<CharFont> FontInfo::getLigture(wchar_t left, wchar_t right) const {
-//  const wchar_t* const item = _lig(left, right);
+//  const wchar_t* const item = _lig.find(left, right);
 //  if (item == nullptr) return nullptr;
 //  return sptrOf<CharFont>(item[2], _id);
 //}
 
 float FontInfo::getKern(wchar_t left, wchar_t right, float factor) const {
-  const float* const item = _kern((float)left, (float)right);
+  const float* const item = _kern.find(left, right);
   if (item == nullptr) return 0;
   return item[2] * factor;
 }
@@ -54,19 +129,63 @@ void FontInfo::setVariousId(
   _itId    = __idOf(it);
 }
 
-const Font* FontInfo::getFont() {
-  if (_font == nullptr) _font = Font::create(_path, Formula::PIXELS_PER_POINT);
-  return _font;
+__FontSlot* FontInfo::__slot(int id) {
+  if ((size_t) id >= _fonts.size()) _fonts.resize(id + 1, nullptr);
+  if (_fonts[id] == nullptr) _fonts[id] = new __FontSlot();
+  return _fonts[id];
+}
+
+const Font* FontInfo::getFont() const {
+  __FontSlot* slot = _fonts[_id];
+  slot->create(_path, Formula::PIXELS_PER_POINT);
+  return slot->font;
+}
+
+void FontInfo::__preload(FontPreload policy) {
+  __join_preload();
+  // the loaders never touch the table of the slots
+  auto tasks = sptrOf<vector<pair<__FontSlot*, string>>>();
+  for (auto info : _infos) {
+    if (info != nullptr) tasks->emplace_back(_fonts[info->_id], info->_path);
+  }
+  const float size = Formula::PIXELS_PER_POINT;
+  auto next = sptrOf<atomic<size_t>>(0);
+  const auto load = [tasks, next, size]() {
+    for (size_t i = (*next)++; i < tasks->size(); i = (*next)++) {
+      try {
+        (*tasks)[i].first->create((*tasks)[i].second, size);
+      } catch (...) {
+        // leave it to the render that needs it, which reports the failure
+      }
+    }
+  };
+  if (policy == FontPreload::blocking) {
+    load();
+    return;
+  }
+  size_t count = 1;
+  if (policy == FontPreload::parallel) {
+    count = max(1u, thread::hardware_concurrency());
+    count = min(count, max((size_t) 1, tasks->size()));
+  }
+  for (size_t i = 0; i < count; i++) loaders.threads.emplace_back(load);
 }
 
-FontInfo::~FontInfo() {
-  if (_font != nullptr) delete _font;
+void FontInfo::__join_preload() {
+  loaders.join();
 }
 
 void FontInfo::__free() {
-  for (auto f : _infos) {
+  __join_preload();
+  for (auto f : _fonts) {
+    if (f != nullptr) delete f->font;
     delete f;
   }
+  for (auto f : _infos) Arena::state().destroy(f);
+  _fonts.clear();
+  _infos.clear();
+  _names.clear();
+  _lazyRegs.clear();
 }
 
 #ifdef HAVE_LOG
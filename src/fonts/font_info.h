@@ -1,22 +1,39 @@
 #ifndef FONT_INFO_H_INCLUDED
 #define FONT_INFO_H_INCLUDED
 
+#include <mutex>
+
 #include "common.h"
 #include "fonts/font_basic.h"
 #include "graphic/graphic.h"
+#include "utils/arena.h"
+#include "utils/enums.h"
 #include "utils/indexed_arr.h"
 
 namespace tex {
 
 class FontSet;
 
+struct __FontSlot;
+
 class FontInfo {
 private:
   static std::vector<FontInfo*> _infos;
   static std::vector<std::string> _names;
+  // the fonts created on demand, by the id of the info, they are kept apart from
+  // the infos so the infos are never written after init, see Arena#state
+  static std::vector<__FontSlot*> _fonts;
+  // the registrations of the fonts registered on the first use, by the id of the
+  // info, see res/reg/bundles.h, never written after init
+  static std::vector<void (*)()> _lazyRegs;
+  // serializes the lazy registrations, they write the arena and the tables
+  static std::mutex _lazyMutex;
+
+  static __FontSlot* __slot(int id);
+
+  static FontInfo* __register_lazy(int id);
 
   const int _id;    // id of this font info
-  const Font* _font;  // font of this info
   const std::string _path;  // font file path
 
   IndexedArray<int, 5, 1> _extensions;   // extensions for big delimiter
@@ -42,12 +59,13 @@ private:
     _boldId = _romanId = _ssId = _ttId = _itId = _id;
     // the skew char
     _skewChar = (wchar_t) -1;
-    _font = nullptr;
   }
 
   static void __add(FontInfo* info) {
     if (info->_id >= _infos.size()) _infos.resize(info->_id + 1);
     _infos[info->_id] = info;
+    // the slot is allocated here, so the renders on several threads only read the table
+    __slot(info->_id);
   }
 
   inline int __idOf(const std::string& name) {
@@ -60,7 +78,7 @@ public:
   static FontInfo* __create(
     int id, const std::string& path,
     float xHeight = 0, float space = 0, float quad = 0) {
-    auto i = new FontInfo(id, path, xHeight, space, quad);
+    auto i = Arena::state().create<FontInfo>(id, path, xHeight, space, quad);
     __add(i);
     return i;
   }
@@ -69,12 +87,52 @@ public:
 
   static inline int __id(const std::string& name) { return indexOf(_names, name); }
 
+  static inline const std::string& __name(int id) {
+    static const std::string empty;
+    return id >= 0 && id < (int) _names.size() ? _names[id] : empty;
+  }
+
   static inline const std::vector<FontInfo*>& __infos() { return _infos; }
 
-  static inline FontInfo* __get(int id) { return _infos[id]; }
+  /**
+   * Get the info of the given id, the font of a lazy bundle is registered on the
+   * first call, return nullptr if the font is left out of the build.
+   */
+  static inline FontInfo* __get(int id) {
+    if (id < 0 || id >= (int) _infos.size()) return nullptr;
+    // the info of a lazy font is written by its registration, read it after
+    if (id < (int) _lazyRegs.size() && _lazyRegs[id] != nullptr) return __register_lazy(id);
+    return _infos[id];
+  }
+
+  /**
+   * The mutex the lazy registrations hold, the symbols of the lazy bundles are
+   * registered and read under it too, see DefaultTeXFont#__register_lazy.
+   */
+  static inline std::mutex& __lazy_mutex() { return _lazyMutex; }
 
+  /**
+   * Register the fonts of the given set, the ones of the lazy bundles are
+   * registered on their first use, see #__get.
+   */
   static void __register(const FontSet& set);
 
+  /**
+   * Register the fonts of the lazy bundles, it is required before the state is
+   * protected, see LaTeX#protectState.
+   */
+  static void __register_lazy();
+
+  /**
+   * Create the fonts of all the registered infos ahead of their first use by the
+   * given policy, see LaTeX#preloadFonts. A font is created once, a render that
+   * needs a font while it is being created waits for that font only.
+   */
+  static void __preload(FontPreload policy);
+
+  /** Wait until the fonts being preloaded are created */
+  static void __join_preload();
+
   static void __free();
 
   inline void __metrics(const float* arr, int len, bool autoDelete = false) {
@@ -125,8 +183,9 @@ public:
   // workaround for the MSVC's LNK2019 error
   // it should be implemented in the font_info.cpp file
   sptr<CharFont> getNextLarger(wchar_t ch) const {
-    const int* const item = _nextLargers((int) ch);
-    if (item == nullptr) return nullptr;
+    const int* const item = _nextLargers.find(ch);
+    // the larger one may be in a font left out of the build
+    if (item == nullptr || __get(item[2]) == nullptr) return nullptr;
     return sptrOf<CharFont>(item[1], item[2]);
   }
 
@@ -134,7 +193,7 @@ public:
   // workaround for the MSVS's LNK2019 error
   // it should be implemented in the font_info.cpp file
   sptr<CharFont> getLigture(wchar_t left, wchar_t right) const {
-    const wchar_t* const item = _lig(left, right);
+    const wchar_t* const item = _lig.find(left, right);
     if (item == nullptr) return nullptr;
     return sptrOf<CharFont>(item[2], _id);
   }
@@ -148,7 +207,8 @@ public:
     const std::string& tt,
     const std::string& it);
 
-  const Font* getFont();
+  /** Get the font of this info, it is created on the first use if not preloaded */
+  const Font* getFont() const;
 
   inline float getQuad(float factor) const { return _quad * factor; }
 
@@ -174,10 +234,8 @@ public:
 
   inline const std::string& getPath() const { return _path; }
 
-  ~FontInfo();
-
   inline static const Font* getFont(int id) {
-    return _infos[id]->getFont();
+    return __get(id)->getFont();
   }
 
 #ifdef HAVE_LOG
@@ -185,6 +243,8 @@ public:
   friend std::ostream& operator<<(std::ostream& os, const FontInfo& info);
 
 #endif
+
+  friend class Arena;
 };
 
 }  // namespace tex
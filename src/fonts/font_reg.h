@@ -14,7 +14,10 @@ typedef void (*__reg_font_func)(void);
 /** Represents a font description registration */
 typedef struct {
   std::string name;
+  // nullptr if the font is left out of the build, see res/reg/bundles.h
   __reg_font_func reg;
+  // register on the first use instead of by LaTeX#init
+  bool lazy;
 } FontReg;
 
 /** Represents a set of font descriptions */
@@ -38,7 +41,24 @@ public:
   };
 
 #define REG_FONT(name) \
-  {#name, __font_reg(name)},
+  {#name, __font_reg(name), false},
+
+#define REG_FONT_LAZY(name) \
+  {#name, __font_reg(name), true},
+
+/** A font left out of the build, the name is kept so the ids of the fonts do not change */
+#define NO_FONT(name) \
+  {#name, nullptr, false},
+
+#define __font_reg_0(name) NO_FONT(name)
+#define __font_reg_1(name) REG_FONT_LAZY(name)
+#define __font_reg_2(name) REG_FONT(name)
+#define __font_reg_cat(a, b) __font_reg_cat2(a, b)
+#define __font_reg_cat2(a, b) a##b
+
+/** Register a font of the given bundle by its build option, see res/reg/bundles.h */
+#define REG_FONT_IN(bundle, name) \
+  __font_reg_cat(__font_reg_, bundle)(name)
 
 #define DEF_FONT_SET(name)                                \
   std::vector<tex::FontReg> FontSet##name::regs() const { \
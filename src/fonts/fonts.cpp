@@ -1,12 +1,20 @@
 #include "fonts/fonts.h"
 
 #include <cmath>
+#include <cstdio>
+#include <fstream>
 
 #include "common.h"
+#include "core/char_routing.h"
 #include "fonts/symbol_reg.h"
 #include "graphic/graphic.h"
 #include "render.h"
+#include "res/parser/font_bundle.h"
 #include "res/parser/font_parser.h"
+#include "res/parser/otf_parser.h"
+#if CLATEX_CXX17
+#include <filesystem>
+#endif
 
 using namespace std;
 using namespace tex;
@@ -14,9 +22,13 @@ using namespace tex;
 const int TeXFont::NO_FONT = -1;
 
 string* DefaultTeXFont::_defaultTextStyleMappings;
-map<string, vector<CharFont*>> DefaultTeXFont::_textStyleMappings;
-map<string, CharFont*> DefaultTeXFont::_symbolMappings;
+StateMap<string, StateVector<CharFont*>> DefaultTeXFont::_textStyleMappings;
+StateMap<string, CharFont*> DefaultTeXFont::_symbolMappings;
+vector<void (*)()> DefaultTeXFont::_lazySymbols;
+StateMap<string, CharFont*> DefaultTeXFont::_lazySymbolMappings;
+bool DefaultTeXFont::_pushingLazy = false;
 map<string, float> DefaultTeXFont::_generalSettings;
+float DefaultTeXFont::_sizeFactors[3];
 vector<UnicodeBlock> DefaultTeXFont::_loadedAlphabets;
 map<UnicodeBlock, AlphabetRegistration*> DefaultTeXFont::_registeredAlphabets;
 
@@ -40,8 +52,147 @@ const int DefaultTeXFont::BOT = 3;
 
 bool DefaultTeXFont::_magnificationEnable = true;
 
+vector<sptr<FontBundle>> DefaultTeXFont::_bundles;
+
+AtomicSharedPtr<const vector<sptr<DefaultTeXFont::Family>>> DefaultTeXFont::_families;
+mutex DefaultTeXFont::_familiesMutex;
+atomic<u64> DefaultTeXFont::_familyTicks(0);
+
+namespace {
+
+/** The fonts are registered in Arena#state, which is read-only once protected */
+void checkUnprotected(const string& what) {
+  if (Arena::state().isSealed()) {
+    throw ex_invalid_state("Can not add " + what + " after the state is protected, see LaTeX::protectState!");
+  }
+}
+
+[[noreturn]] void immutable() {
+  throw ex_invalid_state("The font is immutable, derive a font by TeXFont#withBold and friends!");
+}
+
+}  // namespace
+
+sptr<TeXFont> TeXFont::withBold(bool bold) {
+  const auto f = copy();
+  f->setBold(bold);
+  return f;
+}
+
+sptr<TeXFont> TeXFont::withRoman(bool rm) {
+  const auto f = copy();
+  f->setRoman(rm);
+  return f;
+}
+
+sptr<TeXFont> TeXFont::withTt(bool tt) {
+  const auto f = copy();
+  f->setTt(tt);
+  return f;
+}
+
+sptr<TeXFont> TeXFont::withIt(bool it) {
+  const auto f = copy();
+  f->setIt(it);
+  return f;
+}
+
+sptr<TeXFont> TeXFont::withSs(bool ss) {
+  const auto f = copy();
+  f->setSs(ss);
+  return f;
+}
+
+void TeXFont::setBold(bool bold) { immutable(); }
+
+void TeXFont::setRoman(bool rm) { immutable(); }
+
+void TeXFont::setTt(bool tt) { immutable(); }
+
+void TeXFont::setIt(bool it) { immutable(); }
+
+void TeXFont::setSs(bool ss) { immutable(); }
+
+sptr<TeXFont> TeXFont::copy() {
+  throw ex_invalid_state("The font can not be copied, override TeXFont#copy or TeXFont#withBold and friends!");
+}
+
 TeXFont::~TeXFont() {}
 
+DefaultTeXFont::DefaultTeXFont(
+  Family* family, float size, float factor, float ppp, u8 flags, sptr<Family> owner)
+  : _size(size),
+    _factor(factor),
+    _ppp(ppp),
+    _flags(flags),
+    _owner(std::move(owner)),
+    _family(family != nullptr ? family : _owner.get()),
+    _isBold((flags & FLAG_BOLD) != 0),
+    _isRoman((flags & FLAG_ROMAN) != 0),
+    _isSs((flags & FLAG_SS) != 0),
+    _isTt((flags & FLAG_TT) != 0),
+    _isIt((flags & FLAG_IT) != 0),
+    _isDraft((flags & FLAG_DRAFT) != 0) {}
+
+sptr<TeXFont> DefaultTeXFont::Family::font(u8 flags) {
+  call_once(once[flags], [&]() { fonts[flags].reset(new DefaultTeXFont(this, size, factor, ppp, flags)); });
+  // share the ownership of the family
+  return sptr<TeXFont>(shared_from_this(), fonts[flags].get());
+}
+
+sptr<DefaultTeXFont::Family> DefaultTeXFont::family(float size, float factor, float ppp) {
+  const u64 tick = _familyTicks.fetch_add(1, memory_order_relaxed);
+  const auto find = [size, factor, ppp, tick](const shared_ptr<const vector<sptr<Family>>>& families) {
+    if (families != nullptr) {
+      for (const auto& f : *families) {
+        if (f->size == size && f->factor == factor && f->ppp == ppp) {
+          f->used.store(tick, memory_order_relaxed);
+          return f;
+        }
+      }
+    }
+    return sptr<Family>();
+  };
+  auto family = find(_families.load());
+  if (family != nullptr) return family;
+
+  lock_guard<mutex> lock(_familiesMutex);
+  const auto old = _families.load();
+  family = find(old);
+  if (family != nullptr) return family;
+  auto families = old == nullptr ? make_shared<vector<sptr<Family>>>()
+                                 : make_shared<vector<sptr<Family>>>(*old);
+  if (families->size() >= MAX_FAMILIES) {
+    const auto lru = min_element(
+      families->begin(),
+      families->end(),
+      [](const sptr<Family>& a, const sptr<Family>& b) {
+        return a->used.load(memory_order_relaxed) < b->used.load(memory_order_relaxed);
+      });
+    families->erase(lru);
+  }
+  family = sptrOf<Family>(size, factor, ppp, tick);
+  families->push_back(family);
+  _families.store(shared_ptr<const vector<sptr<Family>>>(std::move(families)));
+  return family;
+}
+
+DefaultTeXFont::DefaultTeXFont(float size, float f, bool b, bool rm, bool ss, bool tt, bool it)
+  : DefaultTeXFont(
+      nullptr, size, f, Formula::PIXELS_PER_POINT, flagsOf(b, rm, ss, tt, it, false),
+      family(size, f, Formula::PIXELS_PER_POINT)) {}
+
+u8 DefaultTeXFont::flagsOf(bool b, bool rm, bool ss, bool tt, bool it, bool draft) {
+  return (b ? FLAG_BOLD : 0) | (rm ? FLAG_ROMAN : 0) | (ss ? FLAG_SS : 0)
+         | (tt ? FLAG_TT : 0) | (it ? FLAG_IT : 0) | (draft ? FLAG_DRAFT : 0);
+}
+
+sptr<TeXFont> DefaultTeXFont::get(
+  float size, float f, bool b, bool rm, bool ss, bool tt, bool it, bool draft, float ppp) {
+  const u8 flags = flagsOf(b, rm, ss, tt, it, draft);
+  return family(size, f, ppp > 0 ? ppp : Formula::PIXELS_PER_POINT)->font(flags);
+}
+
 DefaultTeXFont::~DefaultTeXFont() {
 #ifdef HAVE_LOG
   __dbg("DefaultTeXFont destruct\n");
@@ -49,24 +200,162 @@ DefaultTeXFont::~DefaultTeXFont() {
 }
 
 void DefaultTeXFont::__register_symbols_set(const SymbolsSet& set) {
-  for (auto reg : set.regs()) reg();
+  for (auto r : set.regs()) {
+    if (r.lazy) {
+      _lazySymbols.push_back(r.reg);
+    } else {
+      r.reg();
+    }
+  }
+}
+
+bool DefaultTeXFont::__register_lazy() {
+  FontInfo::__register_lazy();
+  lock_guard<mutex> lock(FontInfo::__lazy_mutex());
+  if (_lazySymbols.empty()) return false;
+  const auto regs = move(_lazySymbols);
+  _lazySymbols.clear();
+  // the later sets win as if registered by init, the ones registered before win
+  // over all since they are looked up first, see #getChar
+  _pushingLazy = true;
+  for (auto it = regs.rbegin(); it != regs.rend(); ++it) (*it)();
+  _pushingLazy = false;
+  return true;
 }
 
 void DefaultTeXFont::__push_symbols(const __symbol_component* symbols, const int len) {
   for (int i = 0; i < len; i++) {
     const __symbol_component& c = symbols[i];
-    _symbolMappings[c.name] = new CharFont(c.code, c.font);
+    if (!_pushingLazy) {
+      _symbolMappings[c.name] = Arena::state().create<CharFont>(c.code, c.font);
+    } else if (_lazySymbolMappings.find(c.name) == _lazySymbolMappings.end()) {
+      _lazySymbolMappings[c.name] = Arena::state().create<CharFont>(c.code, c.font);
+    }
   }
 }
 
 void DefaultTeXFont::addTeXFontDescription(
   const string& base, const string& file) {
-  DefaultTeXFontParser parser(base, file);
-  parser.parseFontDescriptions();
-  parser.parseExtraPath();
-  const auto x = parser.parseTextStyleMappings();
-  _textStyleMappings.insert(x.begin(), x.end());
-  parser.parseSymbolMappings(_symbolMappings);
+  checkUnprotected("the fonts of " + file);
+  __FontDescription desc;
+  DefaultTeXFontParser(base, file).parse(desc);
+  addTeXFontDescription(desc);
+}
+
+void DefaultTeXFont::addTeXFontDescription(__FontDescription& desc) {
+  checkUnprotected("a font description");
+  for (size_t i = 0; i < desc.fonts.size(); i++) {
+    const string& id = desc.fonts[i].id;
+    bool loaded = FontInfo::__id(id) >= 0;
+    for (size_t j = 0; !loaded && j < i; j++) loaded = desc.fonts[j].id == id;
+    if (loaded) throw ex_font_loaded("Font " + id + " is already loaded!");
+  }
+  // predefine all the names first, so the fonts could refer to each other
+  for (const auto& f : desc.fonts) FontInfo::__predefine_name(f.id);
+  for (auto& f : desc.fonts) {
+    auto info = FontInfo::__create(FontInfo::__id(f.id), f.file, f.xHeight, f.space, f.quad);
+    if (f.skewChar != -1) info->__skewChar((wchar_t) f.skewChar);
+    info->__metrics(f.metrics.data, f.metrics.len, f.metrics.release());
+    info->__extensions(f.extensions.data, f.extensions.len, f.extensions.release());
+    info->__kerns(f.kerns.data, f.kerns.len, f.kerns.release());
+    info->__ligtures(f.ligs.data, f.ligs.len, f.ligs.release());
+    int* const largers = new int[f.largers.size() * 3];
+    for (size_t i = 0; i < f.largers.size(); i++) {
+      largers[i * 3 + 0] = f.largers[i].code;
+      largers[i * 3 + 1] = f.largers[i].larger;
+      largers[i * 3 + 2] = FontInfo::__id(f.largers[i].font);
+    }
+    info->__largers(largers, f.largers.size() * 3, true);
+    info->setVariousId(f.bold, f.roman, f.ss, f.tt, f.it);
+  }
+
+  const auto charFont = [](const __NamedCharFont& f) -> CharFont* {
+    if (f.font.empty()) return nullptr;
+    const int id = FontInfo::__id(f.font);
+    const int boldId = f.bold.empty() ? id : FontInfo::__id(f.bold);
+    return Arena::state().create<CharFont>(f.ch, id, boldId);
+  };
+  for (const auto& s : desc.textStyles) {
+    // the styles already defined are kept
+    if (_textStyleMappings.find(s.first) != _textStyleMappings.end()) continue;
+    StateVector<CharFont*> charFonts(4);
+    for (size_t i = 0; i < 4; i++) charFonts[i] = charFont(s.second[i]);
+    _textStyleMappings[s.first] = charFonts;
+  }
+  for (const auto& m : desc.symbolMappings) {
+    auto it = _symbolMappings.find(m.first);
+    if (it != _symbolMappings.end()) Arena::state().destroy(it->second);
+    _symbolMappings[m.first] = charFont(m.second);
+  }
+  for (const auto& s : desc.symbols) {
+    SymbolAtom::addSymbolAtom(sptrOf<SymbolAtom>(s.name, s.type, s.del));
+  }
+  Formula::addSymbolMappings(desc.charToSymbol, desc.charToFormula, desc.charToText);
+}
+
+void DefaultTeXFont::addTeXFontBundle(const string& file) {
+  checkUnprotected("the fonts of " + file);
+  auto bundle = sptrOf<FontBundle>(file);
+  __FontDescription desc;
+  bundle->read(desc);
+  addTeXFontDescription(desc);
+  _bundles.push_back(bundle);
+}
+
+void DefaultTeXFont::addOpenTypeFont(const string& id, const string& file, const string& cacheDir) {
+  checkUnprotected("the font " + file);
+  const OpenTypeParser parser(file);
+  __FontDescription desc;
+  if (cacheDir.empty()) {
+    parser.parse(id, desc);
+    addTeXFontDescription(desc);
+    return;
+  }
+  // the bundle is named by the version of the font, so an updated font is read again
+  const string bundle = cacheDir + "/" + id + "-" + parser.stamp() + FontBundle::EXTENSION;
+  if (MappedFile::exists(bundle)) {
+    try {
+      addTeXFontBundle(bundle);
+      return;
+    } catch (ex_res_parse& e) {
+      // e.g. compiled by an older version, read the font again
+#ifdef HAVE_LOG
+      __dbg("%s\n", e.what());
+#endif  // HAVE_LOG
+    }
+  }
+  parser.parse(id, desc);
+#if CLATEX_CXX17
+  // the bundle is not beside the font, refer to the font by the absolute path
+  desc.fonts[0].file = filesystem::absolute(file).string();
+#endif
+  vector<u8> data;
+  FontBundle::compile(cacheDir, desc, data);
+  // write a temporary file of this writer first, so the processes never map a
+  // partial bundle and the writers never write the same file
+  const string tmp = MappedFile::tempPathOf(bundle);
+  bool written;
+  {
+    ofstream os(tmp, ios::binary);
+    os.write((const char*) data.data(), data.size());
+    written = (bool) os;
+  }
+  if (written && rename(tmp.c_str(), bundle.c_str()) == 0) {
+    try {
+      addTeXFontBundle(bundle);
+      return;
+    } catch (ex_res_parse& e) {
+      // e.g. replaced by a broken bundle meanwhile, register the tables read
+#ifdef HAVE_LOG
+      __dbg("%s\n", e.what());
+#endif  // HAVE_LOG
+      addTeXFontDescription(desc);
+      return;
+    }
+  }
+  // the cache is not writable, register the tables read
+  remove(tmp.c_str());
+  addTeXFontDescription(desc);
 }
 
 void DefaultTeXFont::addAlphabet(
@@ -78,12 +367,27 @@ void DefaultTeXFont::addAlphabet(
     b = (indexOf(_loadedAlphabets, alphabet[i]) != -1) || b;
   }
   if (!b) {
+    checkUnprotected("the alphabet " + lang);
     TeXParser::_isLoading = true;
-    string file = lang;
-    addTeXFontDescription(base, file);
+    // prefer the precompiled bundle if there is one, nothing is registered if
+    // the bundle is invalid (e.g. outdated), fall back to the XML then
+    const string bundle = FontBundle::pathOf(lang);
+    bool loaded = false;
+    if (MappedFile::exists(bundle)) {
+      try {
+        addTeXFontBundle(bundle);
+        loaded = true;
+      } catch (ex_res_parse& e) {
+#ifdef HAVE_LOG
+        __dbg("%s\n", e.what());
+#endif  // HAVE_LOG
+      }
+    }
+    if (!loaded) addTeXFontDescription(base, lang);
     for (size_t i = 0; i < alphabet.size(); i++) {
       _loadedAlphabets.push_back(alphabet[i]);
     }
+    CharRouting::update();
     TeXParser::_isLoading = false;
   }
 }
@@ -104,14 +408,14 @@ void DefaultTeXFont::registerAlphabet(AlphabetRegistration* reg) {
   for (size_t i = 0; i < blocks.size(); i++) {
     _registeredAlphabets[blocks[i]] = reg;
   }
+  CharRouting::update();
 }
 
-sptr<TeXFont> DefaultTeXFont::copy() {
-  return sptrOf<DefaultTeXFont>(
-    _size, _factor, _isBold, _isRoman, _isSs, _isTt, _isIt);
+void DefaultTeXFont::preloadAlphabets() {
+  for (const auto& i : _registeredAlphabets) addAlphabet(i.second);
 }
 
-Char DefaultTeXFont::getChar(wchar_t c, const vector<CharFont*>& cf, TexStyle style) {
+Char DefaultTeXFont::getChar(wchar_t c, const StateVector<CharFont*>& cf, TexStyle style) {
   int kind, offset;
   if (c >= '0' && c <= '9') {
     kind = NUMBERS;
@@ -198,17 +502,28 @@ Char DefaultTeXFont::getChar(const CharFont& c, TexStyle style) {
 Char DefaultTeXFont::getChar(
   const string& symbolName, TexStyle style) {
   // find first
-  auto i = _symbolMappings.find(symbolName);
+  const auto i = _symbolMappings.find(symbolName);
+  if (i != _symbolMappings.end()) return getChar(*(i->second), style);
+  // the symbol may be in a lazy bundle
+  __register_lazy();
+  const CharFont* cf = nullptr;
+  {
+    lock_guard<mutex> lock(FontInfo::__lazy_mutex());
+    const auto j = _lazySymbolMappings.find(symbolName);
+    if (j != _lazySymbolMappings.end()) cf = j->second;
+  }
   // no symbol mapping found
-  if (i == _symbolMappings.end()) throw ex_symbol_mapping_not_found(symbolName);
-  return getChar(*(i->second), style);
+  if (cf == nullptr) throw ex_symbol_mapping_not_found(symbolName);
+  // out of the lock, the font of the char may be registered lazily
+  return getChar(*cf, style);
 }
 
 sptr<Metrics> DefaultTeXFont::getMetrics(const CharFont& cf, float size) {
   auto info = getInfo(cf.fontId);
   const float* m = info->getMetrics(cf.chr);
+  // no italic corrections in draft mode
   Metrics* met = new Metrics(
-    m[WIDTH], m[HEIGHT], m[DEPTH], m[IT], size * Formula::PIXELS_PER_POINT, size);
+    m[WIDTH], m[HEIGHT], m[DEPTH], _isDraft ? 0 : m[IT], size * _ppp, size);
   return sptr<Metrics>(met);
 }
 
@@ -233,15 +548,15 @@ Extension* DefaultTeXFont::getExtension(const Char& c, TexStyle style) {
 }
 
 float DefaultTeXFont::getKern(const CharFont& left, const CharFont& right, TexStyle style) {
-  if (left.fontId == right.fontId) {
+  if (!_isDraft && left.fontId == right.fontId) {
     auto info = getInfo(left.fontId);
-    return info->getKern(left.chr, right.chr, getSizeFactor(style) * Formula::PIXELS_PER_POINT);
+    return info->getKern(left.chr, right.chr, getSizeFactor(style) * _ppp);
   }
   return 0;
 }
 
 sptr<CharFont> DefaultTeXFont::getLigature(const CharFont& left, const CharFont& right) {
-  if (left.fontId == right.fontId) {
+  if (!_isDraft && left.fontId == right.fontId) {
     auto info = getInfo(left.fontId);
     return info->getLigture(left.chr, right.chr);
   }
@@ -262,7 +577,7 @@ Char DefaultTeXFont::getNextLarger(const Char& c, TexStyle style) {
 float DefaultTeXFont::getSpace(TexStyle style) {
   int spaceFontId = _generalSettings[DefaultTeXFontParser::SPACEFONTID_ATTR];
   auto info = getInfo(spaceFontId);
-  return info->getSpace(getSizeFactor(style) * Formula::PIXELS_PER_POINT);
+  return info->getSpace(getSizeFactor(style) * _ppp);
 }
 
 void DefaultTeXFont::setMathSizes(float ds, float ts, float ss, float sss) {
@@ -270,9 +585,16 @@ void DefaultTeXFont::setMathSizes(float ds, float ts, float ss, float sss) {
   _generalSettings["scriptfactor"] = abs(ss / ds);
   _generalSettings["scriptscriptfactor"] = abs(sss / ds);
   _generalSettings["textfactor"] = abs(ts / ds);
+  __update_size_factors();
   TeXRender::_defaultSize = abs(ds);
 }
 
+void DefaultTeXFont::__update_size_factors() {
+  _sizeFactors[0] = _generalSettings["textfactor"];
+  _sizeFactors[1] = _generalSettings["scriptfactor"];
+  _sizeFactors[2] = _generalSettings["scriptscriptfactor"];
+}
+
 void DefaultTeXFont::setMagnification(float mag) {
   if (!_magnificationEnable) return;
   TeXRender::_magFactor = mag / 1000.f;
@@ -287,8 +609,10 @@ void DefaultTeXFont::enableMagnification(bool b) {
 
 void DefaultTeXFont::_init_() {
   _loadedAlphabets.push_back(UnicodeBlock::of('a'));
+  CharRouting::update();
   FontInfo::__register(FontSetBuiltin());
   __default_general_settings();
+  __update_size_factors();
   __default_text_style_mapping();
   __register_symbols_set(SymbolsSetBuiltin());
 
@@ -299,14 +623,19 @@ void DefaultTeXFont::_init_() {
 
 void DefaultTeXFont::_free_() {
   delete[] _defaultTextStyleMappings;
-  for (auto f : _textStyleMappings) {
-    vector<CharFont*> x = f.second;
-    for (auto i : x) {
-      if (i != nullptr) delete i;
-    }
+  for (const auto& f : _textStyleMappings) {
+    for (auto i : f.second) Arena::state().destroy(i);
   }
-  for (auto f : _symbolMappings) delete f.second;
+  for (const auto& f : _symbolMappings) Arena::state().destroy(f.second);
+  for (const auto& f : _lazySymbolMappings) Arena::state().destroy(f.second);
+  _lazySymbolMappings.clear();
+  _textStyleMappings.clear();
+  _symbolMappings.clear();
+  _lazySymbols.clear();
   FontInfo::__free();
+  _families.store(nullptr);
+  // the fonts point to the bundles
+  _bundles.clear();
   // _registeredAlphabets :=> map<UnicodeBlock, AlphabetRegistration>
   // multi => one
   vector<AlphabetRegistration*> cleaned;
@@ -351,10 +680,13 @@ void DefaultTeXFont::log() {
   __log << "SYMBOL MAPPINGS:" << endl
         << "\t";
   for (auto i : _symbolMappings) __log << i.first << "; ";
+  for (auto i : _lazySymbolMappings) __log << i.first << "; ";
   __log << "\n\n";
   // font information
   __log << "FONTINFOS:" << endl;
-  for (auto i : FontInfo::__infos()) __log << *i;
+  for (auto i : FontInfo::__infos()) {
+    if (i != nullptr) __log << *i;
+  }
   __log << endl;
 }
 #endif
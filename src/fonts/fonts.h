@@ -1,8 +1,11 @@
 #ifndef FONTS_H_INCLUDED
 #define FONTS_H_INCLUDED
 
+#include <atomic>
 #include <cstring>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -13,6 +16,7 @@
 #include "fonts/font_info.h"
 #include "fonts/tex_font.h"
 #include "graphic/graphic.h"
+#include "utils/concurrent_cache.h"
 
 namespace tex {
 
@@ -23,23 +27,99 @@ typedef struct {
 } __symbol_component;
 
 class SymbolsSet;
+class FontBundle;
+struct __FontDescription;
 
 /**
  * The default implementation of the TeXFont-interface.
+ * <p>
+ * A font is a small immutable handle of the size, the scale factor, the pixels
+ * per point and the styles (bold, roman, sans-serif, type-writer, italic and
+ * draft), the tables are static. The fonts are interned: the fonts of a (size,
+ * factor, pixels per point) make a family, a font of the family is created the first time it is requested (see
+ * #get and #withBold) and shared by all the builds afterwards, so a build or a
+ * switch of the styles rarely allocates a font.
+ * <p>
+ * At most MAX_FAMILIES families are kept, the least recently used one is dropped
+ * for a new one. A font shares the ownership of its family, so a dropped family
+ * lives on until its last font is released, and it is created again on the next
+ * request of its (size, factor, pixels per point).
  */
 class DefaultTeXFont : public TeXFont {
 private:
+  // the flags of the styles
+  static constexpr u8 FLAG_BOLD = 1, FLAG_ROMAN = 2, FLAG_SS = 4, FLAG_TT = 8;
+  static constexpr u8 FLAG_IT = 16, FLAG_DRAFT = 32, FLAGS_COUNT = 64;
+
+  // the families kept, the text sizes used by an application are few
+  static constexpr size_t MAX_FAMILIES = 16;
+
+  // the fonts of a (size, factor, pixels per point) indexed by the flags, created on demand
+  struct Family : public std::enable_shared_from_this<Family> {
+    const float size, factor, ppp;
+    // the tick of the last lookup, to drop the least recently used family
+    std::atomic<u64> used;
+    std::once_flag once[FLAGS_COUNT];
+    std::unique_ptr<DefaultTeXFont> fonts[FLAGS_COUNT];
+
+    Family(float size, float factor, float ppp, u64 tick)
+      : size(size), factor(factor), ppp(ppp), used(tick) {}
+
+    /** Get the font of the given flags, the font keeps this family alive */
+    sptr<TeXFont> font(u8 flags);
+  };
+  // the families kept, the readers never lock, the writers copy the list under
+  // the mutex
+  static AtomicSharedPtr<const std::vector<sptr<Family>>> _families;
+  static std::mutex _familiesMutex;
+  static std::atomic<u64> _familyTicks;
+
+  /** Get the family of the given size, factor and pixels per point, create it if not kept */
+  static sptr<Family> family(float size, float factor, float ppp);
+
   // font related
   static std::string* _defaultTextStyleMappings;
-  static std::map<std::string, std::vector<CharFont*>> _textStyleMappings;
-  static std::map<std::string, CharFont*> _symbolMappings;
+  // the mappings and their char fonts are in Arena#state
+  static StateMap<std::string, StateVector<CharFont*>> _textStyleMappings;
+  static StateMap<std::string, CharFont*> _symbolMappings;
+  // the symbols of the lazy bundles, registered on the first miss of a symbol,
+  // see res/reg/bundles.h
+  static std::vector<void (*)()> _lazySymbols;
+  // the mappings of the lazy symbols, kept apart so the renders never see
+  // #_symbolMappings written, written and read under FontInfo#__lazy_mutex, and
+  // never replace the ones of #_symbolMappings
+  static StateMap<std::string, CharFont*> _lazySymbolMappings;
+  // if the lazy symbols are being pushed, see #__push_symbols
+  static bool _pushingLazy;
   static std::map<std::string, float> _parameters;
   static std::map<std::string, float> _generalSettings;
   static bool _magnificationEnable;
+  // the bundles the registered fonts point to, see #addTeXFontBundle
+  static std::vector<sptr<FontBundle>> _bundles;
+  // the size factors of the text, script and scriptscript styles, cached from the
+  // general settings since they are queried for every char while laying out
+  static float _sizeFactors[3];
+
+  const float _size, _factor;
+  // the pixels per point the metrics are scaled with, see Formula#setDPITarget
+  const float _ppp;
+  const u8 _flags;
+  // the family of a font created by the public constructor, which is not owned by it
+  const sptr<Family> _owner;
+  // the family this font belongs to, kept alive by the handles of this font
+  Family* const _family;
+
+  DefaultTeXFont(
+    Family* family, float size, float factor, float ppp, u8 flags,
+    sptr<Family> owner = nullptr);
 
-  float _factor, _size;
+  static u8 flagsOf(bool b, bool rm, bool ss, bool tt, bool it, bool draft);
+
+  inline sptr<TeXFont> with(u8 flag, bool on) const {
+    return _family->font((u8) (on ? _flags | flag : _flags & ~flag));
+  }
 
-  Char getChar(wchar_t c, const std::vector<CharFont*>& cf, TexStyle style);
+  Char getChar(wchar_t c, const StateVector<CharFont*>& cf, TexStyle style);
 
   sptr<Metrics> getMetrics(const CharFont& cf, float size);
 
@@ -47,6 +127,8 @@ private:
 
   static void __default_general_settings();
 
+  static void __update_size_factors();
+
   static void __default_text_style_mapping();
 
 public:
@@ -62,8 +144,13 @@ public:
   // extensions
   static const int TOP, MID, REP, BOT;
 
-  bool _isBold, _isRoman, _isSs, _isTt, _isIt;
+  const bool _isBold, _isRoman, _isSs, _isTt, _isIt, _isDraft;
 
+  /**
+   * Create a font of the given point size, scale factor and styles with the
+   * current pixels per point. Prefer #get, which shares the fonts, the fonts
+   * derived from this one by #withBold and friends are shared too.
+   */
   DefaultTeXFont(
     float pointSize,
     float f = 1,
@@ -71,21 +158,67 @@ public:
     bool rm = false,
     bool ss = false,
     bool tt = false,
-    bool it = false)
-      : _size(pointSize),
-        _factor(f),
-        _isBold(b),
-        _isRoman(rm),
-        _isSs(ss),
-        _isTt(tt),
-        _isIt(it) {}
+    bool it = false);
+
+  /**
+   * Get the font of the given point size, scale factor and styles, the font is
+   * created on the first request and shared afterwards, see DefaultTeXFont. The
+   * pixels per point (see Formula#setDPITarget) 0 means the current one.
+   */
+  static sptr<TeXFont> get(
+    float pointSize,
+    float f = 1,
+    bool b = false,
+    bool rm = false,
+    bool ss = false,
+    bool tt = false,
+    bool it = false,
+    bool draft = false,
+    float ppp = 0);
 
   static void __register_symbols_set(const SymbolsSet& set);
 
+  /**
+   * Register the fonts and the symbols of the lazy bundles, return true if any
+   * symbols are registered. It is required before the state is protected, see
+   * LaTeX#protectState. It is safe to call while rendering on other threads.
+   */
+  static bool __register_lazy();
+
   static void __push_symbols(const __symbol_component* symbols, const int len);
 
   static void addTeXFontDescription(const std::string& base, const std::string& file);
 
+  /**
+   * Register the fonts, the mappings and the symbols of the given description,
+   * the tables of the fonts are taken from the description. Throws
+   * ex_font_loaded without registering anything if a font of the description is
+   * already loaded. All the ways to add fonts throw ex_invalid_state once the state
+   * is protected, see LaTeX#protectState.
+   */
+  static void addTeXFontDescription(__FontDescription& desc);
+
+  /**
+   * Register the TeX font description of the given bundle (see FontBundle), the
+   * bundle is kept mapped until the fonts are released.
+   */
+  static void addTeXFontBundle(const std::string& file);
+
+  /**
+   * Register the OpenType font of the given file (e.g. a math font) as the TeX font of
+   * the given id, see OpenTypeParser, the mappings of the TeX font descriptions could
+   * refer to it by the id. Throws ex_font_loaded if the id is already loaded, and
+   * ex_file_not_found or ex_res_parse if the font could not be read.
+   *
+   * @param id the id of the TeX font
+   * @param file the path of the font file
+   * @param cacheDir the directory to cache the tables of the font in, as a bundle named
+   * by the id and the version of the font (see FontBundle), so the font is read once and
+   * the bundle is mapped instead later; empty to read the font every time
+   */
+  static void addOpenTypeFont(
+    const std::string& id, const std::string& file, const std::string& cacheDir = "");
+
   static void addAlphabet(AlphabetRegistration* reg);
 
   static void addAlphabet(
@@ -95,6 +228,12 @@ public:
 
   static void registerAlphabet(AlphabetRegistration* reg);
 
+  /**
+   * Load all the registered alphabets now, instead of the first time a char of
+   * the alphabet is parsed, see LaTeX#init.
+   */
+  static void preloadAlphabets();
+
   inline static float getParameter(const std::string& name) {
     auto it = _parameters.find(name);
     if (it == _parameters.end()) return 0;
@@ -106,13 +245,13 @@ public:
    */
   inline static float getSizeFactor(TexStyle style) {
     if (style < TexStyle::text) return 1;
-    if (style < TexStyle::script) return _generalSettings["textfactor"];
-    if (style < TexStyle::scriptScript) return _generalSettings["scriptfactor"];
-    return _generalSettings["scriptscriptfactor"];
+    if (style < TexStyle::script) return _sizeFactors[0];
+    if (style < TexStyle::scriptScript) return _sizeFactors[1];
+    return _sizeFactors[2];
   }
 
   inline float styleParam(const std::string& name, TexStyle style) {
-    return getParameter(name) * getSizeFactor(style) * Formula::PIXELS_PER_POINT;
+    return getParameter(name) * getSizeFactor(style) * _ppp;
   }
 
   /************************************ get char ************************************************/
@@ -138,8 +277,6 @@ public:
 
   Char getNextLarger(const Char& c, TexStyle style) override;
 
-  sptr<TeXFont> copy() override;
-
   inline float getScaleFactor() override { return _factor; }
 
   inline float getAxisHeight(TexStyle style) override { return styleParam("axisheight", style); }
@@ -183,7 +320,7 @@ public:
   }
 
   inline float getQuad(TexStyle style, int fontCode) override {
-    return getInfo(fontCode)->getQuad(getSizeFactor(style) * Formula::PIXELS_PER_POINT);
+    return getInfo(fontCode)->getQuad(getSizeFactor(style) * _ppp);
   }
 
   int getMuFontId() override;
@@ -201,35 +338,36 @@ public:
 
   inline float getXHeight(TexStyle style, int fontCode) override {
     FontInfo* info = getInfo(fontCode);
-    return info->getXHeight(getSizeFactor(style) * Formula::PIXELS_PER_POINT);
+    return info->getXHeight(getSizeFactor(style) * _ppp);
   }
 
   inline float getEM(TexStyle style) override {
-    return getSizeFactor(style) * Formula::PIXELS_PER_POINT;
+    return getSizeFactor(style) * _ppp;
   }
 
   inline bool hasNextLarger(const Char& c) override {
+    if (_isDraft) return false;
     FontInfo* info = getInfo(c.getFontCode());
     return info->getNextLarger(c.getChar()) != nullptr;
   }
 
-  inline void setBold(bool bold) override { _isBold = bold; }
+  inline sptr<TeXFont> withBold(bool bold) override { return with(FLAG_BOLD, bold); }
 
   inline bool isBold() override { return _isBold; }
 
-  inline void setRoman(bool rm) override { _isRoman = rm; }
+  inline sptr<TeXFont> withRoman(bool rm) override { return with(FLAG_ROMAN, rm); }
 
   inline bool isRoman() override { return _isRoman; }
 
-  inline void setTt(bool tt) override { _isTt = tt; }
+  inline sptr<TeXFont> withTt(bool tt) override { return with(FLAG_TT, tt); }
 
   inline bool isTt() override { return _isTt; }
 
-  inline void setSs(bool ss) override { _isSs = ss; }
+  inline sptr<TeXFont> withSs(bool ss) override { return with(FLAG_SS, ss); }
 
   inline bool isSs() override { return _isSs; }
 
-  inline void setIt(bool it) override { _isIt = it; }
+  inline sptr<TeXFont> withIt(bool it) override { return with(FLAG_IT, it); }
 
   inline bool isIt() override { return _isIt; }
 
@@ -239,10 +377,24 @@ public:
   }
 
   inline bool isExtensionChar(const Char& c) override {
+    if (_isDraft) return false;
     FontInfo* info = getInfo(c.getFontCode());
     return info->getExtension(c.getChar()) != nullptr;
   }
 
+  /**
+   * Get the font that is the same as this font but lays out in draft mode or
+   * not: no kerning, no ligatures, no italic corrections and no larger versions
+   * nor extensions of the characters (e.g. the delimiters stay in the base
+   * size), see TeXRenderBuilder#setDraft
+   */
+  inline sptr<TeXFont> withDraft(bool draft) { return with(FLAG_DRAFT, draft); }
+
+  inline bool isDraft() override { return _isDraft; }
+
+  /** The fonts are immutable, return the same font */
+  inline sptr<TeXFont> copy() override { return _family->font(_flags); }
+
   /**
    * Set the various sizes of the envrionment
    */
@@ -8,10 +8,17 @@ namespace tex {
 /** Symbols registration function */
 typedef void (*__reg_symbols_func)(void);
 
+/** Represents a symbols registration */
+typedef struct {
+  __reg_symbols_func reg;
+  // register on the first use instead of by LaTeX#init
+  bool lazy;
+} SymbolsReg;
+
 /** Represents a set of symbols registration */
 class SymbolsSet {
 public:
-  virtual std::vector<__reg_symbols_func> regs() const = 0;
+  virtual std::vector<SymbolsReg> regs() const = 0;
 };
 
 }  // namespace tex
@@ -25,14 +32,27 @@ public:
 #define DECL_SYMBOLS_SET(name)                                          \
   class SymbolsSet##name : public tex::SymbolsSet {                     \
   public:                                                               \
-    virtual std::vector<tex::__reg_symbols_func> regs() const override; \
+    virtual std::vector<tex::SymbolsReg> regs() const override;         \
   };
 
 #define REG_SYMBOLS(name) \
-  __symbols_reg(name),
+  {__symbols_reg(name), false},
+
+#define REG_SYMBOLS_LAZY(name) \
+  {__symbols_reg(name), true},
+
+#define __symbols_reg_0(name)
+#define __symbols_reg_1(name) REG_SYMBOLS_LAZY(name)
+#define __symbols_reg_2(name) REG_SYMBOLS(name)
+#define __symbols_reg_cat(a, b) __symbols_reg_cat2(a, b)
+#define __symbols_reg_cat2(a, b) a##b
+
+/** Register the symbols of the given bundle by its build option, see res/reg/bundles.h */
+#define REG_SYMBOLS_IN(bundle, name) \
+  __symbols_reg_cat(__symbols_reg_, bundle)(name)
 
 #define DEF_SYMBOLS_SET(name)                                           \
-  std::vector<tex::__reg_symbols_func> SymbolsSet##name::regs() const { \
+  std::vector<tex::SymbolsReg> SymbolsSet##name::regs() const {         \
     return {
 #define END_DEF_SYMBOLS_SET \
   }                         \
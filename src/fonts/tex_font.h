@@ -9,6 +9,14 @@ namespace tex {
 /**
  * An interface representing a "TeXFont", which is responsible for all the
  * necessary fonts and font information.
+ * <p>
+ * The fonts are immutable, a font of other styles (e.g. bold or type-writer) is
+ * derived by #withBold and friends instead of changing the font, so a font could
+ * be shared by the layouts on any threads.
+ * <p>
+ * The fonts written against the former interface, which override #copy and the
+ * setters (e.g. #setBold), still work: #withBold and friends derive a font by a
+ * copy and a setter by default.
  */
 class TeXFont {
 public:
@@ -193,31 +201,74 @@ public:
 
   virtual bool hasSpace(int font) = 0;
 
-  virtual void setBold(bool bold) = 0;
+  /**
+   * Get the font that is the same as this font but bold or not, by default a
+   * #copy of this font set by #setBold
+   */
+  virtual sptr<TeXFont> withBold(bool bold);
 
   /** Test if this font is bold */
   virtual bool isBold() = 0;
 
-  virtual void setRoman(bool rm) = 0;
+  /**
+   * Get the font that is the same as this font but roman or not, by default a
+   * #copy of this font set by #setRoman
+   */
+  virtual sptr<TeXFont> withRoman(bool rm);
 
   /** Test if this font is roman */
   virtual bool isRoman() = 0;
 
-  virtual void setTt(bool tt) = 0;
+  /**
+   * Get the font that is the same as this font but type-writer or not, by
+   * default a #copy of this font set by #setTt
+   */
+  virtual sptr<TeXFont> withTt(bool tt);
 
   /** Test if this font is type-writer */
   virtual bool isTt() = 0;
 
-  virtual void setIt(bool it) = 0;
+  /**
+   * Get the font that is the same as this font but italic or not, by default a
+   * #copy of this font set by #setIt
+   */
+  virtual sptr<TeXFont> withIt(bool it);
 
   /** Test if this font is italic */
   virtual bool isIt() = 0;
 
-  virtual void setSs(bool ss) = 0;
+  /**
+   * Get the font that is the same as this font but sans-serif or not, by default
+   * a #copy of this font set by #setSs
+   */
+  virtual sptr<TeXFont> withSs(bool ss);
 
   /** Test if this font is sans-serif */
   virtual bool isSs() = 0;
 
+  /**
+   * Deprecated, use #withBold and friends. Set the styles of this font, only
+   * called on a #copy by the default #withBold and friends. Throws
+   * ex_invalid_state by default since the fonts are immutable (e.g.
+   * DefaultTeXFont).
+   */
+  virtual void setBold(bool bold);
+
+  virtual void setRoman(bool rm);
+
+  virtual void setTt(bool tt);
+
+  virtual void setIt(bool it);
+
+  virtual void setSs(bool ss);
+
+  /**
+   * Deprecated, the fonts are immutable. Get a copy of this font, DefaultTeXFont
+   * returns the same font. Throws ex_invalid_state by default, override it with
+   * the setters or #withBold and friends.
+   */
+  virtual sptr<TeXFont> copy();
+
   /**
    * Test if the given character is an extension character.
    * 
@@ -228,7 +279,11 @@ public:
    */
   virtual bool isExtensionChar(const Char& c) = 0;
 
-  virtual sptr<TeXFont> copy() = 0;
+  /**
+   * Test if this font lays out in draft mode (see DefaultTeXFont#withDraft), the
+   * fonts not support it return false
+   */
+  virtual bool isDraft() { return false; }
 
   virtual ~TeXFont();
 };
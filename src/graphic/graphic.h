@@ -84,6 +84,16 @@ public:
   static sptr<TextLayout> create(const std::wstring& src, const sptr<Font>& font);
 };
 
+/** A glyph of a run to draw, see Graphics2D#drawGlyphs */
+struct GlyphPos {
+  /** the character to draw */
+  wchar_t chr;
+  /** x-coordinate of the glyph */
+  float x;
+  /** y-coordinate of the glyph, is baseline aligned */
+  float y;
+};
+
 /**
  * Abstract class to represents a graphics (2D) context, all the TeX drawing operations will on it.
  * It must have scale, translation, and rotation support. You should notice that the scaling on
@@ -93,6 +103,13 @@ public:
  */
 class Graphics2D {
 public:
+  /**
+   * Get the graphics that performs the drawing. A graphics wraps another one (e.g.
+   * ElidingGraphics2D) must apply its pending state to the wrapped graphics before
+   * returning it. The backends access their native context through it.
+   */
+  virtual Graphics2D& unwrap() { return *this; }
+
   /**
    * Set the color of the context
    * 
@@ -185,6 +202,20 @@ public:
    */
   virtual void drawText(const std::wstring& c, float x, float y) = 0;
 
+  /**
+   * Draw a run of glyphs with the given font, each of them is baseline aligned. The given
+   * font becomes the font of the context. The default implementation draws the glyphs one
+   * by one, the backends should override it to submit the whole run at once.
+   *
+   * @param font the font to draw the glyphs with
+   * @param glyphs the glyphs to draw
+   * @param n the count of the glyphs
+   */
+  virtual void drawGlyphs(const Font* font, const GlyphPos* glyphs, size_t n) {
+    if (getFont() != font) setFont(font);
+    for (size_t i = 0; i < n; i++) drawChar(glyphs[i].chr, glyphs[i].x, glyphs[i].y);
+  }
+
   /**
    * Draw line
    * 
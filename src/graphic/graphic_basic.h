@@ -29,19 +29,19 @@ static const color magenta = 0xffff00ff;
 #define CYAN (cyan)
 #define MAGENTA (magenta)
 
-inline color argb(int a, int r, int g, int b) {
-  return (a << 24) | (r << 16) | (g << 8) | b;
+constexpr color argb(int a, int r, int g, int b) {
+  return ((color) a << 24) | ((color) r << 16) | ((color) g << 8) | (color) b;
 }
 
-inline color rgb(int r, int g, int b) {
+constexpr color rgb(int r, int g, int b) {
   return argb(0xff, r, g, b);
 }
 
-inline color argb(float a, float r, float g, float b) {
+constexpr color argb(float a, float r, float g, float b) {
   return argb((int) (a * 255), (int) (r * 255), (int) (g * 255), (int) (b * 255));
 }
 
-inline color rgb(float r, float g, float b) {
+constexpr color rgb(float r, float g, float b) {
   return argb(1.f, r, g, b);
 }
 
@@ -61,7 +61,7 @@ inline color color_b(color c) {
   return c & 0x000000ff;
 }
 
-inline color cmyk(float c, float m, float y, float k) {
+constexpr color cmyk(float c, float m, float y, float k) {
   float kk = 1.f - k;
   return rgb(kk * (1 - c), kk * (1 - m), kk * (1 - y));
 }
@@ -0,0 +1,206 @@
+#include "graphic/graphic_eliding.h"
+
+using namespace std;
+using namespace tex;
+
+namespace {
+
+inline bool sameStroke(const Stroke& a, const Stroke& b) {
+  return a.lineWidth == b.lineWidth
+         && a.miterLimit == b.miterLimit
+         && a.cap == b.cap
+         && a.join == b.join;
+}
+
+}  // namespace
+
+ElidingGraphics2D::ElidingGraphics2D(Graphics2D& g2)
+  : _g2(g2),
+    _color(g2.getColor()),
+    _stroke(g2.getStroke()),
+    _font(g2.getFont()),
+    _emittedColor(_color),
+    _emittedStroke(_stroke),
+    _emittedFont(_font) {}
+
+ElidingGraphics2D::~ElidingGraphics2D() {
+  target();
+}
+
+void ElidingGraphics2D::adopt() {
+  _emittedColor = _g2.getColor();
+  _emittedStroke = _g2.getStroke();
+  _emittedFont = _g2.getFont();
+  _lent = false;
+}
+
+void ElidingGraphics2D::syncColor() {
+  if (_lent) adopt();
+  if (_color == _emittedColor) return;
+  _emittedColor = _color;
+  _stats.emitted.colors++;
+  _g2.setColor(_color);
+}
+
+void ElidingGraphics2D::syncStroke() {
+  if (_lent) adopt();
+  if (sameStroke(_stroke, _emittedStroke)) return;
+  _emittedStroke = _stroke;
+  _stats.emitted.strokes++;
+  _g2.setStroke(_stroke);
+}
+
+void ElidingGraphics2D::syncFont() {
+  if (_lent) adopt();
+  if (_font == _emittedFont) return;
+  _emittedFont = _font;
+  _stats.emitted.fonts++;
+  _g2.setFont(_font);
+}
+
+void ElidingGraphics2D::syncTranslation() {
+  if (_dx == 0 && _dy == 0) return;
+  _stats.emitted.translates++;
+  _g2.translate(_dx, _dy);
+  _dx = _dy = 0;
+}
+
+Graphics2D& ElidingGraphics2D::target() {
+  syncColor();
+  syncStroke();
+  syncFont();
+  syncTranslation();
+  _lent = true;
+  return _g2;
+}
+
+Graphics2D& ElidingGraphics2D::unwrap() {
+  return target().unwrap();
+}
+
+void ElidingGraphics2D::setColor(color c) {
+  _stats.received.colors++;
+  _color = c;
+}
+
+color ElidingGraphics2D::getColor() const {
+  return _color;
+}
+
+void ElidingGraphics2D::setStroke(const Stroke& s) {
+  _stats.received.strokes++;
+  _stroke = s;
+}
+
+const Stroke& ElidingGraphics2D::getStroke() const {
+  return _stroke;
+}
+
+void ElidingGraphics2D::setStrokeWidth(float w) {
+  _stats.received.strokes++;
+  _stroke.lineWidth = w;
+}
+
+const Font* ElidingGraphics2D::getFont() const {
+  return _font;
+}
+
+void ElidingGraphics2D::setFont(const Font* font) {
+  _stats.received.fonts++;
+  _font = font;
+}
+
+void ElidingGraphics2D::translate(float dx, float dy) {
+  _stats.received.translates++;
+  _dx += dx;
+  _dy += dy;
+}
+
+void ElidingGraphics2D::scale(float sx, float sy) {
+  if (sx == 0 || sy == 0) {
+    syncTranslation();
+  } else {
+    // translate(d) then scale(s) is the same as scale(s) then translate(d / s)
+    _dx /= sx;
+    _dy /= sy;
+  }
+  _g2.scale(sx, sy);
+}
+
+void ElidingGraphics2D::rotate(float angle) {
+  syncTranslation();
+  _g2.rotate(angle);
+}
+
+void ElidingGraphics2D::rotate(float angle, float px, float py) {
+  syncTranslation();
+  _g2.rotate(angle, px, py);
+}
+
+void ElidingGraphics2D::reset() {
+  _dx = _dy = 0;
+  _g2.reset();
+}
+
+float ElidingGraphics2D::sx() const {
+  return _g2.sx();
+}
+
+float ElidingGraphics2D::sy() const {
+  return _g2.sy();
+}
+
+void ElidingGraphics2D::drawChar(wchar_t c, float x, float y) {
+  syncColor();
+  syncFont();
+  _g2.drawChar(c, x + _dx, y + _dy);
+}
+
+void ElidingGraphics2D::drawText(const wstring& c, float x, float y) {
+  syncColor();
+  syncFont();
+  _g2.drawText(c, x + _dx, y + _dy);
+}
+
+void ElidingGraphics2D::drawGlyphs(const Font* font, const GlyphPos* glyphs, size_t n) {
+  syncColor();
+  _font = _emittedFont = font;
+  if (_dx == 0 && _dy == 0) {
+    _g2.drawGlyphs(font, glyphs, n);
+    return;
+  }
+  _glyphs.assign(glyphs, glyphs + n);
+  for (auto& g : _glyphs) {
+    g.x += _dx;
+    g.y += _dy;
+  }
+  _g2.drawGlyphs(font, _glyphs.data(), n);
+}
+
+void ElidingGraphics2D::drawLine(float x1, float y1, float x2, float y2) {
+  syncColor();
+  syncStroke();
+  _g2.drawLine(x1 + _dx, y1 + _dy, x2 + _dx, y2 + _dy);
+}
+
+void ElidingGraphics2D::drawRect(float x, float y, float w, float h) {
+  syncColor();
+  syncStroke();
+  _g2.drawRect(x + _dx, y + _dy, w, h);
+}
+
+void ElidingGraphics2D::fillRect(float x, float y, float w, float h) {
+  syncColor();
+  _g2.fillRect(x + _dx, y + _dy, w, h);
+}
+
+void ElidingGraphics2D::drawRoundRect(float x, float y, float w, float h, float rx, float ry) {
+  syncColor();
+  syncStroke();
+  _g2.drawRoundRect(x + _dx, y + _dy, w, h, rx, ry);
+}
+
+void ElidingGraphics2D::fillRoundRect(float x, float y, float w, float h, float rx, float ry) {
+  syncColor();
+  _g2.fillRoundRect(x + _dx, y + _dy, w, h, rx, ry);
+}
@@ -0,0 +1,136 @@
+#ifndef GRAPHIC_ELIDING_H_INCLUDED
+#define GRAPHIC_ELIDING_H_INCLUDED
+
+#include <vector>
+#include "graphic/graphic.h"
+
+namespace tex {
+
+/** Counters of the state changes, see ElisionStats */
+struct StateCounters {
+  u64 colors = 0, strokes = 0, fonts = 0, translates = 0;
+
+  inline u64 total() const { return colors + strokes + fonts + translates; }
+};
+
+/**
+ * Counters of the state changes an ElidingGraphics2D received from the callers
+ * and emitted to the wrapped graphics, the difference is the count of the elided
+ * ones.
+ */
+struct ElisionStats {
+  StateCounters received;
+  StateCounters emitted;
+
+  inline u64 elided() const { return received.total() - emitted.total(); }
+};
+
+/**
+ * A graphics wraps another one and drops the redundant state changes before they
+ * reach the wrapped graphics. The boxes save, set and restore the color, the
+ * stroke, the font and the transformation around every primitive even if nothing
+ * changes, which is not free on the backends (e.g. pen rebuilding on Qt, state
+ * saving on cairo).
+ * <p>
+ * The color, the stroke and the font are applied lazily, right before a primitive
+ * that uses them. The translations are accumulated and folded into the coordinates
+ * of the primitives, so a translation and its inverse around a primitive never
+ * reach the wrapped graphics. A rotation or a direct access to the wrapped
+ * graphics (see #target) applies the pending translation.
+ */
+class ElidingGraphics2D : public Graphics2D {
+private:
+  Graphics2D& _g2;
+  // the state the callers see
+  color _color;
+  Stroke _stroke;
+  const Font* _font;
+  // the state of the wrapped graphics
+  color _emittedColor;
+  Stroke _emittedStroke;
+  const Font* _emittedFont;
+  // the translation not applied to the wrapped graphics yet
+  float _dx = 0, _dy = 0;
+  // if the wrapped graphics was handed out by #target, its state could be changed
+  bool _lent = false;
+  std::vector<GlyphPos> _glyphs;
+  ElisionStats _stats;
+
+  void syncColor();
+
+  void syncStroke();
+
+  void syncFont();
+
+  void syncTranslation();
+
+  /** Read the state of the wrapped graphics back after it was handed out */
+  void adopt();
+
+public:
+  explicit ElidingGraphics2D(Graphics2D& g2);
+
+  /** Apply the pending state to the wrapped graphics */
+  ~ElidingGraphics2D();
+
+  /** The counters of the state changes since the creation */
+  inline const ElisionStats& stats() const { return _stats; }
+
+  /**
+   * Get the wrapped graphics with the pending state applied, for the callbacks
+   * that expect the graphics of the backend (e.g. TextLayout#draw, see
+   * TextRenderingBox). The callbacks may change the state of the wrapped graphics
+   * directly, the state is read back before the next primitive.
+   */
+  Graphics2D& target();
+
+  Graphics2D& unwrap() override;
+
+  void setColor(color c) override;
+
+  color getColor() const override;
+
+  void setStroke(const Stroke& s) override;
+
+  const Stroke& getStroke() const override;
+
+  void setStrokeWidth(float w) override;
+
+  const Font* getFont() const override;
+
+  void setFont(const Font* font) override;
+
+  void translate(float dx, float dy) override;
+
+  void scale(float sx, float sy) override;
+
+  void rotate(float angle) override;
+
+  void rotate(float angle, float px, float py) override;
+
+  void reset() override;
+
+  float sx() const override;
+
+  float sy() const override;
+
+  void drawChar(wchar_t c, float x, float y) override;
+
+  void drawText(const std::wstring& c, float x, float y) override;
+
+  void drawGlyphs(const Font* font, const GlyphPos* glyphs, size_t n) override;
+
+  void drawLine(float x1, float y1, float x2, float y2) override;
+
+  void drawRect(float x, float y, float w, float h) override;
+
+  void fillRect(float x, float y, float w, float h) override;
+
+  void drawRoundRect(float x, float y, float w, float h, float rx, float ry) override;
+
+  void fillRoundRect(float x, float y, float w, float h, float rx, float ry) override;
+};
+
+}  // namespace tex
+
+#endif  // GRAPHIC_ELIDING_H_INCLUDED
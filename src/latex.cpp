@@ -1,9 +1,11 @@
 #include "latex.h"
 
+#include "box/box_factory.h"
 #include "core/core.h"
 #include "core/formula.h"
 #include "core/macro.h"
 #include "fonts/fonts.h"
+#include "utils/arena.h"
 #if CLATEX_CXX17
 #include <filesystem>
 #endif
@@ -94,7 +96,7 @@ string LaTeX::queryResourceLocation(string& custom_path) {
   return "";
 }
 
-void LaTeX::init(string res_root_path) {
+void LaTeX::init(string res_root_path, bool preloadAlphabets) {
   try {
     auto path = queryResourceLocation(res_root_path);
     if (!path.empty()) {
@@ -108,12 +110,24 @@ void LaTeX::init(string res_root_path) {
   DefaultTeXFont::_init_();
   Formula::_init_();
   TextRenderingBox::_init_();
+  if (preloadAlphabets) DefaultTeXFont::preloadAlphabets();
 
   _formula = new Formula();
   _builder = new TeXRenderBuilder();
 }
 
+void LaTeX::preloadFonts(FontPreload policy) {
+  FontInfo::__preload(policy);
+}
+
+void LaTeX::protectState() {
+  DefaultTeXFont::preloadAlphabets();
+  DefaultTeXFont::__register_lazy();
+  Arena::state().seal();
+}
+
 void LaTeX::release() {
+  Arena::state().unseal();
   DefaultTeXFont::_free_();
   Formula::_free_();
   MacroInfo::_free_();
@@ -122,6 +136,8 @@ void LaTeX::release() {
 
   if (_formula != nullptr) delete _formula;
   if (_builder != nullptr) delete _builder;
+  // all the objects in the arena have been destroyed
+  Arena::state().clear();
 }
 
 const string& LaTeX::getResRootPath() {
@@ -132,20 +148,25 @@ void LaTeX::setDebug(bool debug) {
   Formula::setDEBUG(debug);
 }
 
-TeXRender* LaTeX::parse(const wstring& latex, int width, float textSize, float lineSpace, color fg) {
+TeXRenderBuilder& LaTeX::builder(const wstring& latex, int width, float textSize, float lineSpace, color fg) {
   bool lined = true;
   if (startswith(latex, L"$$") || startswith(latex, L"\\[")) {
     lined = false;
   }
   Alignment align = lined ? Alignment::left : Alignment::center;
   _formula->setLaTeX(latex);
-  TeXRender* render =
-    _builder->setStyle(TexStyle::display)
-      .setTextSize(textSize)
-      .setWidth(UnitType::pixel, width, align)
-      .setIsMaxWidth(lined)
-      .setLineSpace(UnitType::pixel, lineSpace)
-      .setForeground(fg)
-      .build(*_formula);
-  return render;
+  return _builder->setStyle(TexStyle::display)
+    .setTextSize(textSize)
+    .setWidth(UnitType::pixel, width, align)
+    .setIsMaxWidth(lined)
+    .setLineSpace(UnitType::pixel, lineSpace)
+    .setForeground(fg);
+}
+
+TeXRender* LaTeX::parse(const wstring& latex, int width, float textSize, float lineSpace, color fg) {
+  return builder(latex, width, textSize, lineSpace, fg).build(*_formula);
+}
+
+sptr<TeXLayout> LaTeX::layout(const wstring& latex, int width, float textSize, float lineSpace, color fg) {
+  return builder(latex, width, textSize, lineSpace, fg).layout(*_formula);
 }
@@ -19,6 +19,8 @@ private:
   static Formula* _formula;
   static TeXRenderBuilder* _builder;
 
+  static TeXRenderBuilder& builder(const std::wstring& tex, int width, float textSize, float lineSpace, color fg);
+
 protected:
   static std::string queryResourceLocation(std::string& custom_path);
 
@@ -27,8 +29,37 @@ public:
    * Initialize TeX context with given root path of the TeX resources
    *
    * @param res_root_path root path of the resources, default is 'res'
+   * @param preloadAlphabets if load the external alphabets (e.g. Greek, Cyrillic)
+   * now, instead of the first time a char of the alphabet is parsed, which stalls
+   * that parse; the alphabets are loaded from the precompiled bundles if there
+   * are (see FontBundle), default is false
+   */
+  static void init(std::string res_root_path = "res", bool preloadAlphabets = false);
+
+  /**
+   * Create the fonts of all the registered TeX fonts (about 35 builtin ones and
+   * the loaded alphabets) ahead of their first use, which otherwise stalls the
+   * first render that draws a char of the font. A render that needs a font
+   * being preloaded waits for that font only. Call it after #init, the fonts
+   * are created in the current point-to-pixel conversion (see
+   * Formula#setDPITarget).
+   *
+   * @param policy how to create the fonts, default is on a pool of background
+   * threads, see FontPreload
    */
-  static void init(std::string res_root_path = "res");
+  static void preloadFonts(FontPreload policy = FontPreload::parallel);
+
+  /**
+   * Make the state built by #init read-only, for the servers that fork workers
+   * after init. The fonts and the mappings of the chars to the fonts are built
+   * in one arena (see Arena#state) that is never written after init, so its
+   * pages stay shared between the workers; protecting it makes a write to the
+   * state fault instead of copying a page silently. The external alphabets and
+   * the lazy bundles (see res/reg/bundles.h) are loaded first, adding fonts or
+   * alphabets afterwards throws ex_invalid_state. It takes effect where
+   * mprotect or VirtualProtect is supported.
+   */
+  static void protectState();
 
   /**
    * Get the root path of the "TeX resources"
@@ -51,6 +82,13 @@ public:
    */
   static TeXRender* parse(const std::wstring& tex, int width, float textSize, float lineSpace, color fg);
 
+  /**
+   * Parse TeX formatted string and lay it out once, to render it at several text
+   * sizes and DPIs later (see TeXLayout#render), the parameters are the same as
+   * #parse, the width and the text size are the defaults of the renders.
+   */
+  static sptr<TeXLayout> layout(const std::wstring& tex, int width, float textSize, float lineSpace, color fg);
+
   /**
    * Release the LaTeX context
    */
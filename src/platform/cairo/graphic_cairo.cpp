@@ -11,8 +11,7 @@
 using namespace tex;
 using namespace std;
 
-map<string, string> Font_cairo::_families;
-map<string, Cairo::RefPtr<Cairo::FtFontFace>> Font_cairo::_cairoFtFaces;
+ConcurrentCache<string, Font_cairo::FtFace> Font_cairo::_ftFaces;
 
 Font_cairo::Font_cairo(string family, int style, float size)
   : _family(std::move(family)), _style(style), _size((double) size) {}
@@ -22,12 +21,11 @@ Font_cairo::Font_cairo(const string& file, float size) : Font_cairo("", PLAIN, s
 }
 
 void Font_cairo::loadFont(const string& file) {
-  auto ffaceEntry = _cairoFtFaces.find(file);
-  auto familyEntry = _families.find(file);
-  if (ffaceEntry != _cairoFtFaces.end() && familyEntry != _families.end()) {
+  const FtFace* loaded = _ftFaces.find(file);
+  if (loaded != nullptr) {
     // already loaded
-    _family = familyEntry->second;
-    _fface = ffaceEntry->second;
+    _family = loaded->family;
+    _fface = &loaded->face;
 #ifdef HAVE_LOG
     __log << file << " already loaded, skip\n";
 #endif
@@ -54,11 +52,10 @@ void Font_cairo::loadFont(const string& file) {
   if (!status) __dbg(ANSI_COLOR_RED "Load %s failed\n" ANSI_RESET, file.c_str());
 #endif
 
-  _family = (const char*) family;
-  _families[file] = _family;
-
-  _fface = Cairo::FtFontFace::create(p);
-  _cairoFtFaces[file] = _fface;
+  // another thread may have loaded the same file meanwhile, the face cached first is used
+  const FtFace& face = _ftFaces.put(file, {(const char*) family, Cairo::FtFontFace::create(p)});
+  _family = face.family;
+  _fface = &face.face;
 
   // release
   FcPatternDestroy(p);
@@ -68,8 +65,9 @@ string Font_cairo::getFamily() const {
   return _family;
 }
 
-Cairo::RefPtr<Cairo::FtFontFace> Font_cairo::getCairoFontFace() const {
-  return _fface;
+const Cairo::RefPtr<Cairo::FtFontFace>& Font_cairo::getCairoFontFace() const {
+  static const Cairo::RefPtr<Cairo::FtFontFace> none;
+  return _fface == nullptr ? none : *_fface;
 }
 
 int Font_cairo::getStyle() const {
@@ -103,15 +101,16 @@ sptr<Font> Font::_create(const string& name, int style, float size) {
 
 /**************************************************************************************************/
 
-Cairo::RefPtr<Cairo::Context> TextLayout_cairo::_img_context;
-
 TextLayout_cairo::TextLayout_cairo(const wstring& src, const sptr<Font_cairo>& f) {
-  if (!_img_context) {
+  // the context to measure the layouts, one per thread since a cairo context
+  // must not be used by several threads at the same time
+  static thread_local Cairo::RefPtr<Cairo::Context> context;
+  if (!context) {
     auto surface = Cairo::ImageSurface::create(Cairo::FORMAT_ARGB32, 1, 1);
-    _img_context = Cairo::Context::create(surface);
+    context = Cairo::Context::create(surface);
   }
 
-  _layout = Pango::Layout::create(_img_context);
+  _layout = Pango::Layout::create(context);
 
   Pango::FontDescription fd;
   fd.set_family(f->getFamily());
@@ -157,7 +156,7 @@ void TextLayout_cairo::draw(Graphics2D& g2, float x, float y) {
   // draw layout
   g2.setColor(old);
   g2.translate(x, y - _ascent);
-  auto& g = static_cast<Graphics2D_cairo&>(g2);
+  auto& g = static_cast<Graphics2D_cairo&>(g2.unwrap());
   _layout->show_in_cairo_context(g.getCairoContext());
   g2.translate(-x, -y + _ascent);
 }
@@ -295,6 +294,29 @@ void Graphics2D_cairo::drawText(const wstring& t, float x, float y) {
   _context->show_text(wide2utf8(t));
 }
 
+void Graphics2D_cairo::drawGlyphs(const Font* font, const GlyphPos* glyphs, size_t n) {
+  setFont(font);
+  _context->set_font_face(_font->getCairoFontFace());
+  _context->set_font_size(_font->getSize());
+  // map the characters to the glyph indices in one pass, then place the glyphs
+  wstring str(n, L'\0');
+  for (size_t i = 0; i < n; i++) str[i] = glyphs[i].chr;
+  vector<Cairo::Glyph> run;
+  vector<Cairo::TextCluster> clusters;
+  Cairo::TextClusterFlags flags;
+  _context->get_scaled_font()->text_to_glyphs(0, 0, wide2utf8(str), run, clusters, flags);
+  if (run.size() != n) {
+    // ligatures or missing characters, could not map them one to one
+    Graphics2D::drawGlyphs(font, glyphs, n);
+    return;
+  }
+  for (size_t i = 0; i < n; i++) {
+    run[i].x = glyphs[i].x;
+    run[i].y = glyphs[i].y;
+  }
+  _context->show_glyphs(run);
+}
+
 void Graphics2D_cairo::drawLine(float x1, float y1, float x2, float y2) {
   _context->move_to(x1, y1);
   _context->line_to(x2, y2);
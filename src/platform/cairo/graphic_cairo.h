@@ -6,6 +6,7 @@
 #define GRAPHIC_CAIRO_H_INCLUDED
 
 #include "graphic/graphic.h"
+#include "utils/concurrent_cache.h"
 
 #include <cairomm/context.h>
 #include <pangomm/fontdescription.h>
@@ -17,13 +18,20 @@ namespace tex {
 
 class Font_cairo : public Font {
 private:
-  static map<string, Cairo::RefPtr<Cairo::FtFontFace>> _cairoFtFaces;
-  static map<string, string> _families;
+  struct FtFace {
+    string family;
+    Cairo::RefPtr<Cairo::FtFontFace> face;
+  };
+
+  // the faces loaded from the font files, by the file path, shared by the threads
+  static ConcurrentCache<string, FtFace> _ftFaces;
 
   int _style;
   double _size;
   string _family;
-  Cairo::RefPtr<Cairo::FtFontFace> _fface;
+  // the cached face of the font file, the RefPtr of cairomm is never copied
+  // since its reference count is not thread-safe
+  const Cairo::RefPtr<Cairo::FtFontFace>* _fface = nullptr;
 
   void loadFont(const string& file);
 
@@ -36,7 +44,7 @@ public:
 
   int getStyle() const;
 
-  Cairo::RefPtr<Cairo::FtFontFace> getCairoFontFace() const;
+  const Cairo::RefPtr<Cairo::FtFontFace>& getCairoFontFace() const;
 
   float getSize() const override;
 
@@ -53,7 +61,6 @@ public:
 
 class TextLayout_cairo : public TextLayout {
 private:
-  static Cairo::RefPtr<Cairo::Context> _img_context;
   Glib::RefPtr<Pango::Layout> _layout;
   float _ascent;
 
@@ -116,6 +123,8 @@ public:
 
   void drawText(const wstring& t, float x, float y) override;
 
+  void drawGlyphs(const Font* font, const GlyphPos* glyphs, size_t n) override;
+
   void drawLine(float x, float y1, float x2, float y2) override;
 
   void drawRect(float x, float y, float w, float h) override;
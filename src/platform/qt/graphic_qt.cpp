@@ -12,6 +12,7 @@
 #include <QColor>
 #include <QFont>
 #include <QFontDatabase>
+#include <QGlyphRun>
 #include <QPainter>
 #include <QPen>
 #include <QPointF>
@@ -25,7 +26,7 @@
 using namespace tex;
 using namespace std;
 
-QMap<QString, QString> Font_qt::_loaded_families;
+ConcurrentCache<QString, QString> Font_qt::_loaded_families;
 
 namespace tex {
 // Some wstrings arrive with a \0 at end, so we remove when converting
@@ -63,9 +64,9 @@ Font_qt::Font_qt(const string& file, float size)
 //      qInfo() << "new filename" << filename;
   }
 
-  if(_loaded_families.contains(filename)) {
+  if(auto family = _loaded_families.find(filename); family != nullptr) {
     // file already loaded
-    _font.setFamily(_loaded_families.value(filename));
+    _font.setFamily(*family);
 #ifdef HAVE_LOG
     __log << file << " already loaded, skip\n";
 #endif
@@ -81,8 +82,8 @@ Font_qt::Font_qt(const string& file, float size)
   } else {
     QStringList families = db.applicationFontFamilies(id);
     if( families.size() > 0 ) {
-      _loaded_families[filename] = families.first();
-      _font.setFamily(families.first());
+      // another thread may have loaded the same file meanwhile, the family cached first is used
+      _font.setFamily(_loaded_families.put(filename, QString(families.first())));
     } else {
 #ifdef HAVE_LOG
     __log << file << " no font families found\n";
@@ -106,6 +107,11 @@ QFont Font_qt::getQFont() const {
   return _font;
 }
 
+QRawFont Font_qt::getQRawFont() const {
+  std::call_once(_rawFontOnce, [this]() { _rawFont = QRawFont::fromFont(_font); });
+  return _rawFont;
+}
+
 float Font_qt::getSize() const {
   return _font.pointSizeF();
 }
@@ -152,7 +158,7 @@ void TextLayout_qt::getBounds(Rect& r) {
 }
 
 void TextLayout_qt::draw(Graphics2D& g2, float x, float y) {
-  Graphics2D_qt& g = static_cast<Graphics2D_qt&>(g2);
+  Graphics2D_qt& g = static_cast<Graphics2D_qt&>(g2.unwrap());
   g.getQPainter()->setFont(_font);
   g.getQPainter()->drawText(QPointF(x, y), _text);
 }
@@ -306,6 +312,34 @@ void Graphics2D_qt::drawText(const std::wstring& t, float x, float y) {
   _painter->drawText(QPointF(x, y), text);
 }
 
+void Graphics2D_qt::drawGlyphs(const Font* font, const GlyphPos* glyphs, size_t n) {
+  setFont(font);
+  const QRawFont raw = _font->getQRawFont();
+  QVector<QChar> chars((int) n);
+  for (size_t i = 0; i < n; i++) {
+    // characters out of the BMP take 2 glyph slots, draw them one by one
+    if (glyphs[i].chr > 0xffff || !raw.isValid()) {
+      Graphics2D::drawGlyphs(font, glyphs, n);
+      return;
+    }
+    chars[(int) i] = QChar((ushort) glyphs[i].chr);
+  }
+  QVector<quint32> indexes((int) n);
+  int count = (int) n;
+  if (!raw.glyphIndexesForChars(chars.constData(), (int) n, indexes.data(), &count) || count != (int) n) {
+    Graphics2D::drawGlyphs(font, glyphs, n);
+    return;
+  }
+  QVector<QPointF> positions((int) n);
+  for (size_t i = 0; i < n; i++) positions[(int) i] = QPointF(glyphs[i].x, glyphs[i].y);
+
+  QGlyphRun run;
+  run.setRawFont(raw);
+  run.setGlyphIndexes(indexes);
+  run.setPositions(positions);
+  _painter->drawGlyphRun(QPointF(0, 0), run);
+}
+
 void Graphics2D_qt::drawLine(float x1, float y1, float x2, float y2) {
   _painter->drawLine(QPointF(x1, y1), QPointF(x2, y2));
 }
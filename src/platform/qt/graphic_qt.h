@@ -5,13 +5,16 @@
 #ifndef GRAPHIC_QT_H_INCLUDED
 #define GRAPHIC_QT_H_INCLUDED
 
+#include <mutex>
 #include <string>
 #include "graphic/graphic.h"
+#include "utils/concurrent_cache.h"
 
 #include <QBrush>
 #include <QFont>
 #include <QMap>
 #include <QPainter>
+#include <QRawFont>
 #include <QString>
 
 namespace tex {
@@ -23,8 +26,13 @@ class Font_qt : public Font {
 
 private:
   QFont _font;
+  // the physical font to draw glyph runs with, created on demand once, the
+  // fonts are shared by the threads
+  mutable QRawFont _rawFont;
+  mutable std::once_flag _rawFontOnce;
 
-  static QMap<QString, QString> _loaded_families;
+  // the families of the loaded font files, by the file name, shared by the threads
+  static ConcurrentCache<QString, QString> _loaded_families;
 
 public:
 
@@ -32,12 +40,17 @@ public:
 
   Font_qt(const std::string& file, float size);
 
+  /** Copy the given font, the physical font is created again on demand */
+  Font_qt(const Font_qt& f) : Font(), _font(f._font) {}
+
   std::string getFamily() const;
 
   int getStyle() const;
 
   QFont getQFont() const;
 
+  QRawFont getQRawFont() const;
+
   virtual float getSize() const override;
 
   virtual sptr<Font> deriveFont(int style) const override;
@@ -119,6 +132,8 @@ public:
 
   virtual void drawText(const std::wstring& t, float x, float y) override;
 
+  virtual void drawGlyphs(const Font* font, const GlyphPos* glyphs, size_t n) override;
+
   virtual void drawLine(float x, float y1, float x2, float y2) override;
 
   virtual void drawRect(float x, float y, float w, float h) override;
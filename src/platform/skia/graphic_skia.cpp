@@ -4,14 +4,15 @@
 
 #include "platform/skia/graphic_skia.h"
 
+#include <core/SkTextBlob.h>
 #include <utility>
 
 using namespace tex;
 using namespace std;
 
 std::map<std::pair<std::string, int>, int> Font_skia::_test;
-std::map<std::pair<std::string, int>, sk_sp<SkTypeface>> Font_skia::_named_typefaces;
-std::map<std::string, sk_sp<SkTypeface>> Font_skia::_file_typefaces;
+ConcurrentCache<std::pair<std::string, int>, sk_sp<SkTypeface>> Font_skia::_named_typefaces;
+ConcurrentCache<std::string, sk_sp<SkTypeface>> Font_skia::_file_typefaces;
 
 SkFont::Edging Font_skia::Edging {SkFont::Edging::kAntiAlias};
 SkFontHinting Font_skia::Hinting {SkFontHinting::kNone};
@@ -25,25 +26,20 @@ Font_skia::Font_skia(sk_sp<SkTypeface> typeface, float size) {
 }
 
 sk_sp<SkTypeface> Font_skia::loadTypefaceFromName(const string &family, int style) {
-  auto key = std::make_pair(family, style);
-  if (auto it = _named_typefaces.find(key); it != _named_typefaces.end()) {
-    return it->second;
-  } else {
+  return _named_typefaces.getOrCreate(std::make_pair(family, style), [&]() {
     SkFontStyle fontStyle(style & BOLD ? SkFontStyle::kBold_Weight : SkFontStyle::kNormal_Weight,
                           SkFontStyle::kNormal_Width,
                           style & ITALIC ? SkFontStyle::kItalic_Slant : SkFontStyle::kUpright_Slant);
-    auto typeface = SkTypeface::MakeFromName(family.c_str(), fontStyle);
-    _named_typefaces[key] = typeface;
-    return typeface;
-  }
+    return SkTypeface::MakeFromName(family.c_str(), fontStyle);
+  });
 }
 
 sk_sp<SkTypeface> Font_skia::loadTypefaceFromFile(const string &file) {
-  if (auto it = _file_typefaces.find(file); it != _file_typefaces.end()) {
+  if (auto typeface = _file_typefaces.find(file); typeface != nullptr) {
 #ifdef HAVE_LOG
     __log << file << " already loaded, skip\n";
 #endif
-    return it->second;
+    return *typeface;
   }
 
   auto typeface = SkTypeface::MakeFromFile(file.c_str());
@@ -52,10 +48,9 @@ sk_sp<SkTypeface> Font_skia::loadTypefaceFromFile(const string &file) {
     __log << file << " failed to load\n";
 #endif
     throw std::runtime_error("Failed to load font file: " + file);
-  } else {
-    _file_typefaces[file] = typeface;
   }
-  return typeface;
+  // another thread may have loaded the same file meanwhile, the typeface cached first is used
+  return _file_typefaces.put(file, std::move(typeface));
 }
 
 Font_skia::Font_skia(const string &family, int style, float size)
@@ -125,7 +120,7 @@ void TextLayout_skia::getBounds(_out_ Rect &r) {
 }
 
 void TextLayout_skia::draw(Graphics2D &g2, float x, float y) {
-  Graphics2D_skia &g = static_cast<Graphics2D_skia &>(g2);
+  Graphics2D_skia &g = static_cast<Graphics2D_skia &>(g2.unwrap());
   g.getSkCanvas()->drawString(_text.c_str(), x, y, _font, g.getSkPaint());
 }
 
@@ -258,6 +253,20 @@ void Graphics2D_skia::drawText(const wstring &t, float x, float y) {
   _canvas->drawString(str.c_str(), x, y, _font->getSkFont(), _paint);
 }
 
+void Graphics2D_skia::drawGlyphs(const Font *font, const GlyphPos *glyphs, size_t n) {
+  setFont(font);
+  const SkFont f = _font->getSkFont();
+  SkTextBlobBuilder builder;
+  const auto &run = builder.allocRunPos(f, (int) n);
+  for (size_t i = 0; i < n; i++) {
+    run.glyphs[i] = f.unicharToGlyph((SkUnichar) glyphs[i].chr);
+    run.pos[i * 2] = glyphs[i].x;
+    run.pos[i * 2 + 1] = glyphs[i].y;
+  }
+  _paint.setStyle(SkPaint::kFill_Style);
+  _canvas->drawTextBlob(builder.make(), 0, 0, _paint);
+}
+
 void Graphics2D_skia::drawLine(float x1, float y1, float x2, float y2) {
   _paint.setStyle(SkPaint::kStroke_Style);
   _canvas->drawLine(x1, y1, x2, y2, _paint);
@@ -7,6 +7,7 @@
 
 #include <string>
 #include "graphic/graphic.h"
+#include "utils/concurrent_cache.h"
 #include <core/SkFont.h>
 #include <core/SkCanvas.h>
 #include <map>
@@ -20,8 +21,9 @@ private:
   SkFont _font{};
 
   static std::map<std::pair<std::string, int>, int> _test;
-  static std::map<std::pair<std::string, int>, sk_sp<SkTypeface>> _named_typefaces;
-  static std::map<std::string, sk_sp<SkTypeface>> _file_typefaces;
+  // the loaded typefaces, shared by the threads
+  static ConcurrentCache<std::pair<std::string, int>, sk_sp<SkTypeface>> _named_typefaces;
+  static ConcurrentCache<std::string, sk_sp<SkTypeface>> _file_typefaces;
 
   static sk_sp<SkTypeface> loadTypefaceFromName(const std::string &family, int style = PLAIN);
 
@@ -125,6 +127,8 @@ public:
 
   virtual void drawText(const std::wstring &t, float x, float y) override;
 
+  virtual void drawGlyphs(const Font *font, const GlyphPos *glyphs, size_t n) override;
+
   virtual void drawLine(float x, float y1, float x2, float y2) override;
 
   virtual void drawRect(float x, float y, float w, float h) override;
@@ -1,8 +1,10 @@
 #include "render.h"
 
 #include "atom/atom.h"
+#include "box/box_factory.h"
 #include "core/core.h"
 #include "core/formula.h"
+#include "graphic/graphic_eliding.h"
 
 using namespace std;
 using namespace tex;
@@ -10,6 +12,7 @@ using namespace tex;
 const color TeXRender::_defaultcolor = black;
 float TeXRender::_defaultSize = -1;
 float TeXRender::_magFactor = 0;
+bool TeXRender::_elideState = true;
 
 TeXRender::TeXRender(const sptr<Box>& box, float textSize, bool trueValues) {
   _box = box;
@@ -99,6 +102,7 @@ float TeXRender::getBaseline() const {
 
 void TeXRender::setTextSize(float textSize) {
   _textSize = textSize;
+  _boxIndex = nullptr;
 }
 
 void TeXRender::setForeground(color fg) {
@@ -112,6 +116,7 @@ Insets TeXRender::getInsets() {
 void TeXRender::setInsets(const Insets& insets, bool trueval) {
   _insets = insets;
   if (!trueval) _insets += (int) (0.18f * _textSize);
+  _boxIndex = nullptr;
 }
 
 void TeXRender::setWidth(int width, Alignment align) {
@@ -120,19 +125,120 @@ void TeXRender::setWidth(int width, Alignment align) {
   // only care if new width larger than old
   if (diff > 0) {
     _box = sptrOf<HBox>(_box, (float) width, align);
+    _compiled = nullptr;
+    _boxIndex = nullptr;
   }
 }
 
+sptr<Box> TeXRender::Layout::lines(float textWidth) const {
+  auto box = _box;
+  if (_lineSpace != 0) box = BoxSplitter::split(box, textWidth, _lineSpace, _breakMode);
+  return sptrOf<HBox>(box, _isMaxWidth ? box->_width : textWidth, _align);
+}
+
+bool TeXRender::relayout(int width) {
+  if (_layout._box == nullptr) return false;
+  // the same conversion as UnitType::pixel
+  _box = _layout.lines(width * (1.f / _layout._fontSize));
+  _compiled = nullptr;
+  _boxIndex = nullptr;
+  return true;
+}
+
+void TeXRender::compile(bool release) {
+  auto box = sptrOf<DisplayListBox>(DisplayList::compile(_box, 0, 0, _textSize), _box);
+  if (release) {
+    _box = box;
+    _compiled = nullptr;
+    _layout = Layout();
+  } else {
+    _compiled = box;
+  }
+}
+
+sptr<DisplayList> TeXRender::displayList() const {
+  const auto& box = _compiled != nullptr ? _compiled : _box;
+  auto* lb = dynamic_cast<DisplayListBox*>(box.get());
+  return lb != nullptr ? lb->list() : DisplayList::compile(box, 0, 0, _textSize);
+}
+
+vector<u8> TeXRender::serialize() {
+  const auto list = displayList();
+
+  vector<u8> out;
+  const auto put = [&](u32 v) {
+    for (int i = 0; i < 4; i++) out.push_back((u8) (v >> (i * 8)));
+  };
+  const auto putf = [&](float f) {
+    u32 v;
+    memcpy(&v, &f, sizeof(v));
+    put(v);
+  };
+  out.insert(out.end(), {'C', 'L', 'T', 'R'});
+  put(TeXRenderView::VERSION);
+  putf(_textSize);
+  putf(_box->_width);
+  putf(_box->_height);
+  putf(_box->_depth);
+  put(_insets.top);
+  put(_insets.left);
+  put(_insets.bottom);
+  put(_insets.right);
+  put(_fg);
+  list->serialize(out);
+  return out;
+}
+
 void TeXRender::setHeight(int height, Alignment align) {
   float diff = height - getHeight();
   // FIXME
   // only care if new height larger than old
   if (diff > 0) {
     _box = sptrOf<VBox>(_box, diff, align);
+    _compiled = nullptr;
+    _boxIndex = nullptr;
+  }
+}
+
+const BoxIndex& TeXRender::getBoxIndex() {
+  if (_boxIndex == nullptr) {
+    // the same position as drawn at (0, 0)
+    const float x = _insets.left / _textSize;
+    const float y = _insets.top / _textSize + _box->_height;
+    _boxIndex = BoxIndex::build(_box, x, y, _textSize, _links.get());
   }
+  return *_boxIndex;
+}
+
+vector<Rect> TeXRender::diff(const TeXRender& a, const TeXRender& b) {
+  const auto la = a.displayList(), lb = b.displayList();
+  // the same position as drawn at (0, 0)
+  const auto placement = [](const TeXRender& r, const DisplayList& list) {
+    return DisplayList::Placement{
+      list,
+      r._insets.left / r._textSize,
+      r._insets.top / r._textSize + r._box->_height,
+      r._textSize,
+      isTransparent(r._fg) ? _defaultcolor : r._fg
+    };
+  };
+  return DisplayList::diff(placement(a, *la), placement(b, *lb));
 }
 
 void TeXRender::draw(Graphics2D& g2, int x, int y) {
+  draw(g2, x, y, nullptr);
+}
+
+void TeXRender::draw(Graphics2D& g2, int x, int y, const Rect& clip) {
+  draw(g2, x, y, &clip);
+}
+
+void TeXRender::draw(Graphics2D& g2, int x, int y, const Rect* clip) {
+  if (_elideState && dynamic_cast<ElidingGraphics2D*>(&g2) == nullptr) {
+    ElidingGraphics2D g(g2);
+    draw(g, x, y, clip);
+    return;
+  }
   color old = g2.getColor();
   g2.scale(_textSize, _textSize);
   if (!isTransparent(_fg)) {
@@ -142,69 +248,299 @@ void TeXRender::draw(Graphics2D& g2, int x, int y) {
   }
 
   // draw formula box
-  _box->draw(g2, (x + _insets.left) / _textSize, (y + _insets.top) / _textSize + _box->_height);
+  const float bx = (x + _insets.left) / _textSize;
+  const float by = (y + _insets.top) / _textSize + _box->_height;
+  if (clip == nullptr) {
+    const auto& box = _compiled != nullptr ? _compiled : _box;
+    box->draw(g2, bx, by);
+  } else {
+    // the clip in box units, grow it by 1em since the glyphs may overhang their boxes
+    const float s = 1.f / _textSize;
+    const Rect r(clip->x * s - 1, clip->y * s - 1, clip->w * s + 2, clip->h * s + 2);
+    _box->drawVisible(g2, bx, by, r);
+  }
+
+  // restore
+  g2.reset();
+  g2.setColor(old);
+}
 
+const u16 TeXRenderView::VERSION = 1;
+
+TeXRenderView::TeXRenderView(const void* data, size_t len) {
+  const auto* p = static_cast<const u8*>(data);
+  const u8* end = p + len;
+  // magic, version, text size, 3 dimensions, 4 insets and foreground
+  if (len < 44 || memcmp(p, "CLTR", 4) != 0) {
+    throw ex_invalid_param("The data is not a serialized TeXRender!");
+  }
+  const auto get = [&](int offset) {
+    u32 v = 0;
+    for (int i = 0; i < 4; i++) v |= (u32) p[offset + i] << (i * 8);
+    return v;
+  };
+  const auto getf = [&](int offset) {
+    const u32 v = get(offset);
+    float f;
+    memcpy(&f, &v, sizeof(f));
+    return f;
+  };
+  if ((get(4) & 0xffff) != VERSION) {
+    throw ex_invalid_param("Unsupported version of the serialized TeXRender!");
+  }
+  _textSize = getf(8);
+  _width = getf(12);
+  _height = getf(16);
+  _depth = getf(20);
+  _insets.top = (i32) get(24);
+  _insets.left = (i32) get(28);
+  _insets.bottom = (i32) get(32);
+  _insets.right = (i32) get(36);
+  _fg = get(40);
+  _list.parse(p + 44, end);
+}
+
+float TeXRenderView::getTextSize() const {
+  return _textSize;
+}
+
+int TeXRenderView::getHeight() const {
+  return (int) (_height * _textSize + _depth * _textSize + _insets.top + _insets.bottom);
+}
+
+int TeXRenderView::getDepth() const {
+  return (int) (_depth * _textSize + _insets.bottom);
+}
+
+int TeXRenderView::getWidth() const {
+  return (int) (_width * _textSize + _insets.left + _insets.right);
+}
+
+float TeXRenderView::getBaseline() const {
+  return (
+    (_height * _textSize + _insets.top) /
+    ((_height + _depth) * _textSize + _insets.top + _insets.bottom)
+  );
+}
+
+Insets TeXRenderView::getInsets() const {
+  return _insets;
+}
+
+void TeXRenderView::draw(Graphics2D& g2, int x, int y) const {
+  color old = g2.getColor();
+  g2.scale(_textSize, _textSize);
+  g2.setColor(isTransparent(_fg) ? black : _fg);
+  _list.draw(g2, (x + _insets.left) / _textSize, (y + _insets.top) / _textSize + _height);
   // restore
   g2.reset();
   g2.setColor(old);
 }
 
-DefaultTeXFont* TeXRenderBuilder::createFont(float size, int type) {
-  DefaultTeXFont* tf = new DefaultTeXFont(size);
-  if (type == 0) tf->setSs(false);
-  if ((type & ROMAN) != 0) tf->setRoman(true);
-  if ((type & TYPEWRITER) != 0) tf->setTt(true);
-  if ((type & SANSSERIF) != 0) tf->setSs(true);
-  if ((type & ITALIC) != 0) tf->setIt(true);
-  if ((type & BOLD) != 0) tf->setBold(true);
-  return tf;
+sptr<TeXFont> TeXRenderBuilder::createFont(float size, int type, bool draft, float ppp) {
+  return DefaultTeXFont::get(
+    size,
+    1,
+    (type & BOLD) != 0,
+    (type & ROMAN) != 0,
+    (type & SANSSERIF) != 0,
+    (type & TYPEWRITER) != 0,
+    (type & ITALIC) != 0,
+    draft,
+    ppp);
 }
 
 TeXRender* TeXRenderBuilder::build(Formula& f) {
   return build(f._root);
 }
 
-TeXRender* TeXRenderBuilder::build(const sptr<Atom>& fc) {
-  sptr<Atom> f = fc;
-  if (f == nullptr) f = sptrOf<EmptyAtom>();
-  if (_textSize == -1) {
-    throw ex_invalid_state("A size is required, call function setSize before build.");
-  }
+float TeXRenderBuilder::pixelsPerPoint() const {
+  return _ppp > 0 ? _ppp : Formula::PIXELS_PER_POINT;
+}
 
-  DefaultTeXFont* font = (
-    _type == -1
-    ? new DefaultTeXFont(_textSize)
-    : createFont(_textSize, _type)
-  );
-  sptr<TeXFont> tf(font);
+sptr<TeXFont> TeXRenderBuilder::sharedFont() const {
+  const float ppp = pixelsPerPoint();
+  return _type == -1 ? DefaultTeXFont::get(_textSize, 1, false, false, false, false, false, _draft, ppp)
+                     : createFont(_textSize, _type, _draft, ppp);
+}
+
+Environment* TeXRenderBuilder::createEnv(const sptr<TeXFont>& tf) const {
   Environment* env;
   if (_widthUnit != UnitType::none && _textWidth != 0) {
-    env = new Environment(_style, tf, _widthUnit, _textWidth);
+    env = new Environment(_style, tf, pixelsPerPoint(), _widthUnit, _textWidth);
   } else {
-    env = new Environment(_style, tf);
+    env = new Environment(_style, tf, pixelsPerPoint());
   }
-
   if (_lineSpaceUnit != UnitType::none) {
     env->setInterline(_lineSpaceUnit, _lineSpace);
   }
+  return env;
+}
+
+TeXRender::Layout TeXRenderBuilder::createLayout(const sptr<Box>& box, const Environment& env) const {
+  TeXRender::Layout layout;
+  layout._box = box;
+  layout._fontSize = _textSize;
+  if (_lineSpaceUnit != UnitType::none && _lineSpace != 0) {
+    layout._lineSpace = _lineSpace * SpaceAtom::getFactor(_lineSpaceUnit, env);
+  }
+  layout._align = _align;
+  layout._isMaxWidth = _isMaxWidth;
+  layout._breakMode = _draft ? BreakMode::greedy : _breakMode;
+  return layout;
+}
+
+TeXRender* TeXRenderBuilder::build(const sptr<Atom>& fc) {
+  sptr<Atom> f = fc;
+  if (f == nullptr) f = sptrOf<EmptyAtom>();
+  if (_textSize == -1) {
+    throw ex_invalid_state("A size is required, call function setSize before build.");
+  }
+
+  Environment* env = createEnv(sharedFont());
+  const auto links = _linkAtoms ? sptrOf<AtomLinks>() : nullptr;
+  env->setAtomLinks(links.get());
+  DelimiterCache delimiters;
+  env->setDelimiterCache(&delimiters);
 
   auto box = f->createBox(*env);
+  if (links != nullptr) links->add(box, f);
   TeXRender* render;
   if (_widthUnit != UnitType::none && _textWidth != 0) {
-    HBox* hb;
-    if (_lineSpaceUnit != UnitType::none && _lineSpace != 0) {
-      float space = _lineSpace * SpaceAtom::getFactor(_lineSpaceUnit, *env);
-      auto split = BoxSplitter::split(box, env->getTextWidth(), space);
-      hb = new HBox(split, _isMaxWidth ? split->_width : env->getTextWidth(), _align);
-    } else {
-      hb = new HBox(box, _isMaxWidth ? box->_width : env->getTextWidth(), _align);
-    }
-    render = new TeXRender(sptr<Box>(hb), _textSize, _trueValues);
+    auto layout = createLayout(box, *env);
+    render = new TeXRender(layout.lines(env->getTextWidth()), _textSize, _trueValues);
+    // the debug boxes are built into the box tree, it can not be split again
+    if (!Box::DEBUG) render->_layout = std::move(layout);
   } else {
     render = new TeXRender(box, _textSize, _trueValues);
   }
 
   if (!isTransparent(_fg)) render->setForeground(_fg);
+  render->_links = links;
+
+  delete env;
+  return render;
+}
+
+TeXMetrics TeXRenderBuilder::measure(Formula& f, bool breaks) {
+  return measure(f._root, breaks);
+}
+
+TeXMetrics TeXRenderBuilder::measure(const sptr<Atom>& f, bool breaks) {
+  DelimiterCache delimiters;
+  return measure(f, breaks, delimiters);
+}
+
+TeXMetrics TeXRenderBuilder::measure(const sptr<Atom>& fc, bool breaks, DelimiterCache& delimiters) {
+  sptr<Atom> f = fc;
+  if (f == nullptr) f = sptrOf<EmptyAtom>();
+  if (_textSize == -1) {
+    throw ex_invalid_state("A size is required, call function setSize before build.");
+  }
+  Environment* env = createEnv(sharedFont());
+  env->setDelimiterCache(&delimiters);
+  const bool lines = _widthUnit != UnitType::none && _textWidth != 0;
+  // the rows are kept only to find the breaks or to split the lines
+  env->setMetricsOnly(!breaks && !lines);
+
+  auto box = f->createBox(*env);
+  // the same as the constructor of TeXRender
+  const float size = TeXRender::_magFactor != 0 ? _textSize * std::abs(TeXRender::_magFactor) : _textSize;
+  const int insets = _trueValues ? 0 : (int) (0.18f * _textSize);
+
+  TeXMetrics m;
+  if (breaks) {
+    for (float x : BoxSplitter::breakPositions(box)) m.breaks.push_back(x * size + insets);
+  }
+  if (lines) box = createLayout(box, *env).lines(env->getTextWidth());
+  m.width = box->_width * size + 2 * insets;
+  m.height = box->_height * size + insets;
+  m.depth = box->_depth * size + insets;
+
+  delete env;
+  return m;
+}
+
+vector<TeXMetrics> TeXRenderBuilder::measureBatch(const vector<sptr<Atom>>& formulas, bool breaks) {
+  vector<TeXMetrics> metrics;
+  metrics.reserve(formulas.size());
+  // the delimiters built for a formula are reused by the others
+  DelimiterCache delimiters;
+  for (const auto& f : formulas) metrics.push_back(measure(f, breaks, delimiters));
+  return metrics;
+}
+
+sptr<TeXLayout> TeXRenderBuilder::layout(Formula& f) {
+  return layout(f._root);
+}
+
+sptr<TeXLayout> TeXRenderBuilder::layout(const sptr<Atom>& fc) {
+  sptr<Atom> f = fc;
+  if (f == nullptr) f = sptrOf<EmptyAtom>();
+  if (_textSize == -1) {
+    throw ex_invalid_state("A size is required, call function setSize before build.");
+  }
+
+  sptr<TeXLayout> layout(new TeXLayout());
+  Environment* env = createEnv(sharedFont());
+  LayoutDeps deps;
+  env->setLayoutDeps(&deps);
+  const auto links = _linkAtoms ? sptrOf<AtomLinks>() : nullptr;
+  env->setAtomLinks(links.get());
+  DelimiterCache delimiters;
+  env->setDelimiterCache(&delimiters);
+
+  layout->_box = f->createBox(*env);
+  if (links != nullptr) links->add(layout->_box, f);
+  env->setLayoutDeps(nullptr);
+
+  layout->_formula = f;
+  layout->_builder = *this;
+  layout->_links = links;
+  layout->_sizeDependent = deps.size;
+  layout->_widthDependent = deps.width;
+  layout->_textSize = _textSize;
+  layout->_ppp = pixelsPerPoint();
+  layout->_textWidth = env->getTextWidth();
+
+  delete env;
+  return layout;
+}
+
+TeXRender* TeXLayout::render(float textSize, int width, float dpi) {
+  TeXRenderBuilder b = _builder;
+  b.setTextSize(textSize);
+  if (dpi > 0) b.setDPITarget(dpi);
+  if (width > 0) b.setWidth(UnitType::pixel, (float) width, b._align);
+  // the debug boxes are built into the box tree, it can not be shared
+  if (Box::DEBUG) return b.build(_formula);
+
+  // the boxes laid out with the pixels per point of this layout are r times smaller
+  const float r = b.pixelsPerPoint() / _ppp;
+  Environment* env = b.createEnv(b.sharedFont());
+  const float textWidth = env->getTextWidth() / r;
+  if (
+    (_exactSize && _sizeDependent && (textSize != _textSize || r != 1))
+    || (_widthDependent && textWidth != _textWidth)
+  ) {
+    delete env;
+    return b.build(_formula);
+  }
+
+  TeXRender* render;
+  if (b._widthUnit != UnitType::none && b._textWidth != 0) {
+    auto layout = b.createLayout(_box, *env);
+    layout._fontSize = textSize * r;
+    layout._lineSpace /= r;
+    render = new TeXRender(layout.lines(textWidth), textSize * r, true);
+    render->_layout = std::move(layout);
+  } else {
+    render = new TeXRender(_box, textSize * r, true);
+  }
+  // the insets are relative to the text size, not scaled with the boxes
+  if (!b._trueValues) render->_insets += (int) (0.18f * textSize);
+  if (!isTransparent(b._fg)) render->setForeground(b._fg);
+  render->_links = _links;
 
   delete env;
   return render;
@@ -5,11 +5,17 @@
 
 #include "utils/enums.h"
 #include "box/box.h"
+#include "box/box_index.h"
+#include "box/display_list.h"
 #include "graphic/graphic.h"
 
 namespace tex {
 
-class DefaultTeXFont;
+class TeXFont;
+
+class Environment;
+
+class TeXLayout;
 
 class Formula;
 
@@ -17,16 +23,40 @@ class Box;
 
 class Atom;
 
+class DelimiterCache;
+
 using BoxFilter = std::function<bool(const sptr<Box>&)>;
 
 class TeXRender {
 private:
   static const color _defaultcolor;
 
+  /** The unsplit box and the parameters to break it into lines again */
+  struct Layout {
+    sptr<Box> _box;
+    // the size of the font the box was created with
+    float _fontSize = 0;
+    // the line space in box units, 0 means the box is not split
+    float _lineSpace = 0;
+    Alignment _align = Alignment::none;
+    bool _isMaxWidth = false;
+    BreakMode _breakMode = BreakMode::optimal;
+
+    /** Break the box into lines with the given text width (in box units) and align them */
+    sptr<Box> lines(float textWidth) const;
+  };
+
   sptr<Box> _box;
+  // the box replays the display list compiled from _box, see #compile
+  sptr<Box> _compiled;
   float _textSize;
   color _fg = black;
   Insets _insets;
+  Layout _layout;
+  // the atoms the boxes were created from, see TeXRenderBuilder#setLinkAtoms
+  sptr<AtomLinks> _links;
+  // built on demand, see #getBoxIndex
+  sptr<BoxIndex> _boxIndex;
 
   void buildDebug(
     const sptr<BoxGroup>& parent,
@@ -36,9 +66,21 @@ private:
 
   static sptr<BoxGroup> wrap(const sptr<Box>& box);
 
+  void draw(Graphics2D& g2, int x, int y, const Rect* clip);
+
+  /** The display list of this render drawn at (0, 0) in box units, compiled if not yet */
+  sptr<DisplayList> displayList() const;
+
 public:
   static float _defaultSize;
   static float _magFactor;
+  /**
+   * If drop the redundant state changes while drawing, see ElidingGraphics2D,
+   * default is true. The boxes draw to a wrapper of the given graphics, but the
+   * callbacks of the platforms (e.g. TextLayout#draw) still receive the given
+   * graphics, see ElidingGraphics2D#target.
+   */
+  static bool _elideState;
 
   TeXRender(const sptr<Box>& box, float textSize, bool trueValues = false);
 
@@ -64,7 +106,131 @@ public:
 
   void setHeight(int height, Alignment align);
 
+  /**
+   * Break the formula into lines again with the given width (in pixels), the
+   * formula is not parsed nor laid out again, only the line breaking and the
+   * alignment are done. The effects of #setWidth and #setHeight are dropped.
+   *
+   * @return false if this render does not keep the unsplit box (it was built
+   * without a width, or in debug mode), nothing is changed in this case
+   */
+  bool relayout(int width);
+
+  /**
+   * Compile the box tree into a flat display list, the following draws replay
+   * the list instead of walking the tree. The list is dropped if the layout is
+   * changed (by #setWidth, #setHeight or #relayout).
+   *
+   * @param release if to release the box tree (and the unsplit box kept for
+   * #relayout) to free memory, #relayout does nothing after that
+   */
+  void compile(bool release = false);
+
+  /**
+   * Serialize this render (dimensions, insets, foreground and the drawing
+   * records) into a compact binary form, it could be drawn by TeXRenderView in
+   * another process. Throws ex_invalid_state if the render contains boxes that
+   * could not be flattened (e.g. text drawn with the platform fonts).
+   */
+  std::vector<u8> serialize();
+
   void draw(Graphics2D& g2, int x, int y);
+
+  /**
+   * Draw only the parts of this render that intersect the given clip (e.g. the
+   * visible area of a scrollable view). The subtrees out of the clip are skipped,
+   * so the cost is proportional to the visible part. The bounds of the subtrees
+   * are cached on the first call. A render compiled with release (see #compile)
+   * is drawn entirely if it intersects the clip.
+   *
+   * @param g2 the graphics to draw with
+   * @param x the x-coordinate of this render
+   * @param y the y-coordinate of this render
+   * @param clip the visible area, in the same coordinates as x and y
+   */
+  void draw(Graphics2D& g2, int x, int y, const Rect& clip);
+
+  /**
+   * Get the spatial index of the boxes of this render drawn at (0, 0), the rects
+   * are in pixels. It is built on the first call and rebuilt after the layout or
+   * the size changes. The entries link to the atoms the boxes were created from
+   * if the render is built with TeXRenderBuilder#setLinkAtoms. Get the index
+   * before compile the render with release (see #compile), the box tree is
+   * dropped after.
+   */
+  const BoxIndex& getBoxIndex();
+
+  /**
+   * Find the areas to repaint when the render a drawn at a position is replaced
+   * by the render b drawn at the same position (e.g. after the formula is edited
+   * in an editor), the parts of the formulas not changed are not repainted. The
+   * renders not compiled (see #compile) are compiled on each call.
+   *
+   * @return the areas in pixels, relative to the position the renders are drawn at
+   */
+  static std::vector<Rect> diff(const TeXRender& a, const TeXRender& b);
+
+  friend class TeXRenderBuilder;
+  friend class TeXLayout;
+};
+
+/**
+ * A read-only view of a serialized TeXRender (see TeXRender#serialize) over a
+ * buffer, e.g. a memory-mapped file. The buffer is not copied and must outlive
+ * the view.
+ * <p>
+ * All the values are in little-endian, the layout is:
+ * <pre>
+ * u8[4] magic "CLTR", u16 version, u16 reserved
+ * f32 text size, f32 width, f32 height, f32 depth (box units)
+ * i32 insets (top, left, bottom, right), u32 foreground
+ * the display list, see DisplayListView
+ * </pre>
+ */
+class TeXRenderView {
+private:
+  float _textSize, _width, _height, _depth;
+  Insets _insets;
+  color _fg;
+  DisplayListView _list;
+
+public:
+  static const u16 VERSION;
+
+  /** Parse the serialized render, throws ex_invalid_param if the data is malformed */
+  TeXRenderView(const void* data, size_t len);
+
+  float getTextSize() const;
+
+  int getHeight() const;
+
+  int getDepth() const;
+
+  int getWidth() const;
+
+  float getBaseline() const;
+
+  Insets getInsets() const;
+
+  void draw(Graphics2D& g2, int x, int y) const;
+};
+
+/** The dimensions of a formula, see TeXRenderBuilder#measure */
+struct TeXMetrics {
+  /** The width in pixels including the insets, see TeXRender#getWidth */
+  float width = 0;
+  /** The height above the baseline in pixels including the insets */
+  float height = 0;
+  /** The depth below the baseline in pixels including the insets, see TeXRender#getDepth */
+  float depth = 0;
+  /**
+   * The x-coordinates (in pixels, from the left of the formula) where the formula
+   * could be broken into lines, only filled if requested
+   */
+  std::vector<float> breaks;
+
+  /** The baseline as a fraction of the total height, the same as TeXRender#getBaseline */
+  inline float baseline() const { return height + depth == 0 ? 0 : height / (height + depth); }
 };
 
 class TeXRenderBuilder {
@@ -77,6 +243,26 @@ private:
   bool _trueValues = false, _isMaxWidth = false;
   color _fg = black;
   Alignment _align = Alignment::none;
+  BreakMode _breakMode = BreakMode::optimal;
+  bool _linkAtoms = false;
+  bool _draft = false;
+  // the pixels per point, 0 means the one of Formula#setDPITarget
+  float _ppp = 0;
+
+  /** The pixels per point the formulas are laid out with */
+  float pixelsPerPoint() const;
+
+  /**
+   * The font of the size, the type and the draft mode of this builder, the fonts are
+   * interned (see DefaultTeXFont#get), so all the builds with the same settings share it
+   */
+  sptr<TeXFont> sharedFont() const;
+
+  Environment* createEnv(const sptr<TeXFont>& tf) const;
+
+  TeXRender::Layout createLayout(const sptr<Box>& box, const Environment& env) const;
+
+  TeXMetrics measure(const sptr<Atom>& f, bool breaks, DelimiterCache& delimiters);
 
 public:
   // TODO declaration conflict with TypefaceStyle defined in graphic/graphic.h
@@ -167,11 +353,138 @@ public:
     return *this;
   }
 
+  /**
+   * Set the strategy to break the formula into lines, only works if the line
+   * space is specified. The default is BreakMode::optimal.
+   */
+  inline TeXRenderBuilder& setBreakMode(BreakMode mode) {
+    _breakMode = mode;
+    return *this;
+  }
+
+  /**
+   * Set if lay out in draft mode, default is false. A draft trades the fidelity
+   * for the latency, e.g. to preview on every keystroke while typing and build the
+   * final render once the typing pauses: no kerning, no ligatures, no italic
+   * corrections, the delimiters and the big operators stay in their base size
+   * (no larger versions nor extensions), and the lines are broken greedily (see
+   * BreakMode).
+   */
+  inline TeXRenderBuilder& setDraft(bool draft) {
+    _draft = draft;
+    return *this;
+  }
+
+  /**
+   * Set the DPI target of the formulas built by this builder, 0 (default) means the
+   * one of Formula#setDPITarget. Unlike Formula#setDPITarget, it is safe to build
+   * with several DPIs on several threads at the same time.
+   */
+  inline TeXRenderBuilder& setDPITarget(float dpi) {
+    _ppp = dpi > 0 ? dpi / 72.f : 0;
+    return *this;
+  }
+
+  /**
+   * Set if record the atoms the boxes are created from, so the entries of the box
+   * index link to the atoms (see TeXRender#getBoxIndex), default is false.
+   */
+  inline TeXRenderBuilder& setLinkAtoms(bool link) {
+    _linkAtoms = link;
+    return *this;
+  }
+
   TeXRender* build(const sptr<Atom>& f);
 
   TeXRender* build(Formula& f);
 
-  static DefaultTeXFont* createFont(float size, int type);
+  /**
+   * Measure the given formula with the settings of this builder, the result is
+   * the same as the dimensions of the render built by #build, but nothing only
+   * required to draw (the render, the debug boxes, the atom links) is created.
+   * The rows are reduced to their metrics instead of keeping their children (see
+   * Environment#setMetricsOnly), which makes it about 20-25% faster than #build
+   * followed by TeXRender#getWidth for the common inline formulas. The rows are
+   * kept if the breaks are wanted or a width is set, it then takes about the same
+   * time as #build.
+   *
+   * @param breaks if to collect the positions the unbroken formula could be broken
+   * at (see TeXMetrics#breaks), e.g. to break it across the lines of a paragraph
+   */
+  TeXMetrics measure(const sptr<Atom>& f, bool breaks = false);
+
+  TeXMetrics measure(Formula& f, bool breaks = false);
+
+  /** Measure the given formulas, see #measure, the delimiters are built once for all of them */
+  std::vector<TeXMetrics> measureBatch(const std::vector<sptr<Atom>>& formulas, bool breaks = false);
+
+  /**
+   * Lay out the given formula with the settings of this builder once, to render it
+   * at several text sizes and DPIs later, see TeXLayout.
+   */
+  sptr<TeXLayout> layout(const sptr<Atom>& f);
+
+  sptr<TeXLayout> layout(Formula& f);
+
+  /**
+   * Get the font of the given size and type (a combination of TeXFontStyle), see
+   * DefaultTeXFont#get, the pixels per point 0 means the one of Formula#setDPITarget
+   */
+  static sptr<TeXFont> createFont(float size, int type, bool draft = false, float ppp = 0);
+
+  friend class TeXLayout;
+};
+
+/**
+ * A formula laid out once by TeXRenderBuilder#layout, and rendered at any text
+ * size and DPI. The boxes are in units relative to the text size, so a render at
+ * another size shares the boxes and only breaks the lines again if a width is
+ * given, and a render at another DPI scales them. If the layout depends on the
+ * text size (e.g. a length in pt) or the text width (e.g. an array spans the
+ * whole width), the formula is laid out again when they change, so a layout must
+ * not be rendered on several threads at the same time (different layouts can be).
+ */
+class TeXLayout {
+private:
+  sptr<Atom> _formula;
+  TeXRenderBuilder _builder;
+  // the unsplit box
+  sptr<Box> _box;
+  sptr<AtomLinks> _links;
+  // if depends on the text size or the text width, see LayoutDeps
+  bool _sizeDependent = false, _widthDependent = false;
+  bool _exactSize = true;
+  // the text size, the pixels per point and the text width (in box units) laid out with
+  float _textSize = 0, _ppp = 0, _textWidth = 0;
+
+  TeXLayout() = default;
+
+  friend class TeXRenderBuilder;
+
+public:
+  /** If the layout could be rendered at any text size without laying out again */
+  inline bool isSizeIndependent() const { return !_sizeDependent; }
+
+  /**
+   * Set if lay out the formula again to render it at another text size or DPI if
+   * the layout depends on the text size, default is true. The lengths in absolute
+   * units (e.g. the 0.5pt space after the scripts, the shortfall of the delimiters)
+   * depend on the text size, if set to false, they are scaled with the text size
+   * instead, the render differs slightly from the one laid out again but the layout
+   * is always reused.
+   */
+  inline void setExactSize(bool exact) { _exactSize = exact; }
+
+  /**
+   * Render the formula at the given text size.
+   *
+   * @param textSize the text size in pixels
+   * @param width the width (in pixels) to break the formula into lines with, 0
+   * means the width of the builder
+   * @param dpi the DPI target, 0 means the one of the builder (see
+   * TeXRenderBuilder#setDPITarget)
+   */
+  TeXRender* render(float textSize, int width = 0, float dpi = 0);
 };
 
 }  // namespace tex
@@ -1,11 +1,24 @@
+#include "core/char_routing.h"
 #include "core/formula.h"
+#include "utils/sorted_table.h"
 
 using namespace std;
+using namespace tex;
 
-map<int, string> tex::Formula::_symbolFormulaMappings = {
+namespace {
+
+/** Sorted by the char */
+constexpr TableEntry<int, const char*> BUILTIN_FORMULA_MAPPINGS[]{
+    {125, "\\rbrace"},
     {160, "\\ "},
     {161, "!`"},
     {169, "\\copyright"},
+    {172, "\\lnot"},
+    {177, "\\pm"},
+    {183, "\\cdot"},
+    {188, "\\text{\\sfrac14}"},
+    {189, "\\text{\\sfrac12}"},
+    {190, "\\text{\\sfrac34}"},
     {192, "\\`A"},
     {193, "\\'A"},
     {194, "\\^A"},
@@ -22,20 +35,19 @@ map<int, string> tex::Formula::_symbolFormulaMappings = {
     {205, "\\'I"},
     {206, "\\^I"},
     {207, "\\\"I"},
-    // ETH {208, ""},
     {209, "\\~N"},
     {210, "\\`O"},
     {211, "\\'O"},
     {212, "\\^O"},
     {213, "\\~O"},
     {214, "\\\"O"},
+    {215, "\\times"},
     {216, "\\O"},
     {217, "\\`U"},
     {218, "\\'U"},
     {219, "\\^U"},
     {220, "\\\"U"},
     {221, "\\'Y"},
-    // THORN {222, ""},
     {223, "\\ss"},
     {224, "\\`a"},
     {225, "\\'a"},
@@ -67,7 +79,6 @@ map<int, string> tex::Formula::_symbolFormulaMappings = {
     {251, "\\^u"},
     {252, "\\\"u"},
     {253, "\\'y"},
-    // thorn {254, ""},
     {255, "\\\"y"},
     {256, "\\=A"},
     {257, "\\=a"},
@@ -125,7 +136,6 @@ map<int, string> tex::Formula::_symbolFormulaMappings = {
     {309, "\\^\\j"},
     {310, "\\underaccent{,}K"},
     {311, "\\underaccent{,}k"},
-    // kra groenland
     {313, "\\'L"},
     {314, "\\'l"},
     {315, "\\underaccent{,}L"},
@@ -136,7 +146,6 @@ map<int, string> tex::Formula::_symbolFormulaMappings = {
     {320, "l\\cdot"},
     {321, "\\L"},
     {322, "\\l"},
-    // L barre
     {323, "\\'N"},
     {324, "\\'n"},
     {325, "\\underaccent{,}N"},
@@ -144,7 +153,6 @@ map<int, string> tex::Formula::_symbolFormulaMappings = {
     {327, "\\v N"},
     {328, "\\v n"},
     {329, "\\text{'}n"},
-    // Nj
     {332, "\\=O"},
     {333, "\\=o"},
     {334, "\\u O"},
@@ -196,8 +204,17 @@ map<int, string> tex::Formula::_symbolFormulaMappings = {
     {380, "\\.z"},
     {381, "\\v Z"},
     {382, "\\v z"},
-    // f avec demi-barre
-    // greek capitals
+    {730, "\\bmathring"},
+    {768, "\\grave"},
+    {769, "\\acute"},
+    {770, "\\hat"},
+    {771, "\\tilde"},
+    {772, "\\bar"},
+    {774, "\\breve"},
+    {775, "\\dot"},
+    {776, "\\ddot"},
+    {779, "\\doubleacute"},
+    {780, "\\check"},
     {913, "\\Alpha"},
     {914, "\\Beta"},
     {915, "\\Gamma"},
@@ -222,122 +239,249 @@ map<int, string> tex::Formula::_symbolFormulaMappings = {
     {935, "\\Chi"},
     {936, "\\Psi"},
     {937, "\\Omega"},
-    // Unicode to symbols
-    {8742, "\\nshortparallel"},
-    {8651, "\\leftrightharpoons"},
-    {8667, "\\Rrightarrow"},
-    {10956, "\\supsetneqq"},
-    {8805, "\\ge"},
-    {8883, "\\rhd"},
-    {10877, "\\leqslant"},
-    {8650, "\\downdownarrows"},
-    {8819, "\\gtrsim"},
-    {8822, "\\lessgtr"},
-    {10230, "\\longrightarrow"},
-    {8660, "\\Leftrightarrow"},
-    {8592, "\\leftarrow"},
-    {8854, "\\ominus"},
-    {8203, "\\!"},
-    {8855, "\\otimes"},
-    {8968, "\\lceil"},
-    {8706, "\\partial"},
-    {8994, "\\smallfrown"},
-    {8196, "\\,"},
-    {10914, "\\gg"},
-    {10916, "\\mathbin{\\rlap{>}\\!<}"},
-    {10917, "\\mathbin{><}"},
-    {10918, "\\leftslice"},
-    {10919, "\\rightslice"},
+    {1013, "\\epsilon"},
+    {1014, "\\backepsilon"},
     {8194, "\\;"},
+    {8195, "\\quad"},
+    {8196, "\\,"},
     {8197, "\\:"},
+    {8203, "\\!"},
+    {8206, " "},
+    {8207, " "},
+    {8208, "\\textminus"},
+    {8211, "\\textendash"},
+    {8212, "\\textemdash"},
+    {8214, "\\|"},
+    {8216, "`"},
+    {8217, "\\textapos"},
+    {8218, ","},
+    {8220, "``"},
+    {8221, "\\textapos\\textapos"},
+    {8222, ",,"},
+    {8224, "\\dagger"},
+    {8225, "\\ddagger"},
+    {8230, "\\ldots"},
+    {8240, "\\textperthousand"},
+    {8241, "\\textpertenthousand"},
+    {8242, "\\prime"},
+    {8244, "'''"},
+    {8249, "\\guilsinglleft"},
+    {8250, "\\guilsinglright"},
+    {8254, "\\mathpunct{\\={\\ }}"},
+    {8259, "\\hybull"},
+    {8364, "\\euro"},
+    {8407, "\\vec"},
+    {8411, "''"},
+    {8448, "\\sfrac{a}{c}"},
+    {8449, "\\sfrac{a}{s}"},
+    {8450, "\\mathbb{C}"},
+    {8451, "\\sideset{^\\circ}{}\\text{C}"},
+    {8453, "\\sfrac{c}{o}"},
+    {8454, "\\sfrac{c}{u}"},
+    {8455, "\\euler"},
+    {8457, "\\sideset{^\\circ}{}\\text{F}"},
+    {8459, "\\mathscr{H}"},
+    {8460, "\\mathfrak{H}"},
+    {8461, "\\mathbb{H}"},
     {8463, "\\hbar"},
-    {8601, "\\swarrow"},
-    {8809, "\\gneqq"},
-    {8800, "\\neq"},
-    {215, "\\times"},
-    {172, "\\lnot"},
-    {10949, "\\nsubseteqq"},
+    {8464, "\\mathscr{I}"},
+    {8465, "\\Im"},
+    {8466, "\\mathscr{L}"},
+    {8467, "\\ell"},
+    {8469, "\\mathbb{N}"},
+    {8472, "\\wp"},
+    {8473, "\\mathbb{P}"},
+    {8474, "\\mathbb{Q}"},
+    {8475, "\\mathscr{R}"},
+    {8476, "\\Re"},
+    {8477, "\\mathbb{R}"},
+    {8480, "{}^{\\text{TM}}"},
+    {8484, "\\mathbb{Z}"},
+    {8487, "\\mho"},
+    {8488, "\\mathfrak{Z}"},
+    {8491, "\\text{\\AA}"},
+    {8492, "\\mathscr{B}"},
+    {8493, "\\mathfrak{C}"},
+    {8495, "e"},
+    {8496, "\\mathscr{E}"},
+    {8497, "\\mathscr{F}"},
+    {8498, "\\Finv"},
+    {8499, "\\mathscr{M}"},
+    {8500, "\\mathit{o}"},
+    {8501, "\\aleph"},
+    {8502, "\\beth"},
+    {8503, "\\gimel"},
+    {8504, "\\daleth"},
+    {8513, "\\Game"},
+    {8523, "\\parr"},
+    {8531, "\\text{\\sfrac13}"},
+    {8532, "\\text{sfrac23}"},
+    {8533, "\\text{\\sfrac15}"},
+    {8534, "\\text{\\sfrac25}"},
+    {8535, "\\text{\\sfrac35}"},
+    {8536, "\\text{\\sfrac45}"},
+    {8537, "\\text{\\sfrac16}"},
+    {8538, "\\text{\\sfrac56}"},
+    {8539, "\\text{\\sfrac18}"},
+    {8540, "\\text{\\sfrac38}"},
+    {8541, "\\text{\\sfrac58}"},
+    {8542, "\\text{\\sfrac78}"},
+    {8543, "\\text{\\sfrac{1}{\\ }}"},
+    {8544, "\\text{I}"},
+    {8545, "\\text{II}"},
+    {8546, "\\text{III}"},
+    {8547, "\\text{IV}"},
+    {8548, "\\text{V}"},
+    {8549, "\\text{VI}"},
+    {8550, "\\text{VII}"},
+    {8551, "\\text{VIII}"},
+    {8552, "\\text{IX}"},
+    {8553, "\\text{X}"},
+    {8554, "\\text{XI}"},
+    {8555, "\\text{XII}"},
+    {8556, "\\text{L}"},
+    {8557, "\\text{C}"},
+    {8558, "\\text{D}"},
+    {8559, "\\text{M}"},
+    {8560, "\\text{i}"},
+    {8561, "\\text{ii}"},
+    {8562, "\\text{iii}"},
+    {8563, "\\text{iv}"},
+    {8564, "\\text{v}"},
+    {8565, "\\text{vi}"},
+    {8566, "\\text{vii}"},
+    {8567, "\\text{viii}"},
+    {8568, "\\text{ix}"},
+    {8569, "\\text{x}"},
+    {8570, "\\text{xi}"},
+    {8571, "\\text{xii}"},
+    {8572, "\\text{l}"},
+    {8573, "\\text{c}"},
+    {8574, "\\text{d}"},
+    {8575, "\\text{m}"},
+    {8592, "\\leftarrow"},
     {8593, "\\uparrow"},
-    {8910, "\\curlyvee"},
-    {8726, "\\setminus"},
-    {8727, "{}_\\ast"},
-    {8843, "\\supsetneq"},
+    {8594, "\\to"},
+    {8595, "\\downarrow"},
+    {8596, "\\leftrightarrow"},
+    {8597, "\\updownarrow"},
+    {8598, "\\nwarrow"},
+    {8599, "\\nearrow"},
+    {8600, "\\searrow"},
+    {8601, "\\swarrow"},
     {8602, "\\nleftarrow"},
-    {8654, "\\nLeftrightarrow"},
-    {9662, "\\blacktriangledown"},
+    {8603, "\\nrightarrow"},
+    {8605, "\\rightsquigarrow"},
+    {8606, "\\twoheadleftarrow"},
+    {8608, "\\twoheadrightarrow"},
+    {8610, "\\leftarrowtail"},
+    {8611, "\\rightarrowtail"},
+    {8614, "\\mapsto"},
+    {8617, "\\hookleftarrow"},
+    {8618, "\\hookrightarrow"},
+    {8619, "\\looparrowleft"},
+    {8620, "\\looparrowright"},
+    {8621, "\\leftrightsquigarrow"},
+    {8622, "\\nleftrightarrow"},
+    {8624, "\\Lsh"},
+    {8625, "\\Rsh"},
+    {8630, "\\curvearrowleft"},
+    {8631, "\\curvearrowright"},
+    {8636, "\\leftharpoonup"},
+    {8637, "\\leftharpoondown"},
+    {8638, "\\upharpoonright"},
+    {8639, "\\upharpoonleft"},
+    {8640, "\\rightharpoonup"},
+    {8641, "\\rightharpoondown"},
     {8642, "\\downharpoonright"},
-    {10949, "\\subseteqq"},
+    {8643, "\\downharpoonleft"},
+    {8644, "\\rightleftarrows"},
+    {8646, "\\leftrightarrows"},
+    {8647, "\\leftleftarrows"},
+    {8648, "\\upuparrows"},
+    {8649, "\\rightrightarrows"},
+    {8650, "\\downdownarrows"},
+    {8651, "\\leftrightharpoons"},
+    {8652, "\\rightleftharpoons"},
+    {8653, "\\nLeftarrow"},
+    {8654, "\\nLeftrightarrow"},
+    {8655, "\\nRightarrow"},
+    {8656, "\\Leftarrow"},
+    {8657, "\\Uparrow"},
+    {8658, "\\Rightarrow"},
+    {8659, "\\Downarrow"},
+    {8660, "\\Leftrightarrow"},
+    {8661, "\\Updownarrow"},
+    {8666, "\\Lleftarrow"},
+    {8667, "\\Rrightarrow"},
+    {8704, "\\forall"},
+    {8705, "\\complement"},
+    {8706, "\\partial"},
     {8707, "\\exists"},
+    {8708, "\\nexists"},
     {8709, "\\emptyset"},
-    {8921, "\\ggg"},
-    {8764, "\\sim"},
-    {8808, "\\lvertneqq"},
-    {8214, "\\|"},
-    {8744, "\\vee"},
+    {8711, "\\nabla"},
+    {8712, "\\in"},
+    {8713, "\\notin"},
+    {8714, "\\in"},
+    {8717, "\\ni"},
+    {8719, "\\prod"},
+    {8720, "\\coprod"},
+    {8721, "\\sum"},
+    {8722, "\\minus"},
+    {8723, "\\mp"},
+    {8724, "\\dotplus"},
+    {8725, "\\slash"},
+    {8726, "\\setminus"},
+    {8727, "{}_\\ast"},
+    {8728, "\\circ"},
     {8729, "\\bullet"},
-    {10955, "\\subsetneqq"},
-    {9663, "\\triangledown"},
-    {8771, "\\simeq"},
-    {8649, "\\rightrightarrows"},
-    {9661, "\\bigtriangledown"},
-    {8816, "\\nleqslant"},
-    {8625, "\\Rsh"},
-    {8600, "\\searrow"},
-    {9664, "\\blacktriangleleft"},
-    {8805, "\\geq"},
+    {8730, "\\surd"},
+    {8733, "\\varpropto"},
+    {8734, "\\infty"},
+    {8736, "\\angle"},
+    {8737, "\\measuredangle"},
+    {8738, "\\sphericalangle"},
+    {8739, "\\shortmid"},
+    {8740, "\\nmid"},
     {8741, "\\Vert"},
-    {8941, "\\ntrianglerighteq"},
-    {8596, "\\leftrightarrow"},
-    {8965, "\\barwedge"},
-    {8939, "\\ntriangleright"},
-    {8906, "\\rtimes"},
-    {8660, "\\iff"},
-    {8861, "\\circleddash"},
-    {8915, "\\Cup"},
-    {8648, "\\upuparrows"},
-    {8815, "\\ngtr"},
-    {8937, "\\succnsim"},
-    {10868, "\\coloncolonequals"},
-    {10889, "\\lnapprox"},
-    {8919, "\\gtrdot"},
-    {8230, "\\ldots"},
-    {8776, "\\approx"},
-    {10885, "\\lessapprox"},
-    {8911, "\\curlywedge"},
-    {8809, "\\gvertneqq"},
-    {8775, "\\ncong"},
-    {8783, "\\bumpeq"},
-    {10232, "\\Longleftarrow"},
-    {8741, "\\parallel"},
-    {8196, "\\thinspace"},
-    {9002, "\\rangle"},
-    {8898, "\\bigcap"},
-    {9827, "\\clubsuit"},
-    {8835, "\\supset"},
-    {8836, "\\not\\subset"},
-    {8837, "\\not\\supset"},
-    {8856, "\\oslash"},
+    {8742, "\\nshortparallel"},
+    {8743, "\\wedge"},
+    {8744, "\\vee"},
+    {8745, "\\cap"},
+    {8746, "\\cup"},
+    {8747, "\\int"},
+    {8748, "\\iint"},
+    {8749, "\\iiint"},
+    {8750, "\\oint"},
     {8756, "\\therefore"},
+    {8757, "\\because"},
     {8758, "\\ratio"},
     {8759, "\\mathbin{\\ratio\\ratio}"},
-    {10936, "\\succapprox"},
-    {8869, "\\bot"},
-    {8923, "\\gtreqless"},
+    {8760, "\\dotminus"},
+    {8761, "\\minuscolon"},
+    {8762, "\\geoprop"},
+    {8764, "\\sim"},
+    {8765, "\\backsim"},
+    {8768, "\\wr"},
+    {8769, "\\nsim"},
+    {8770, "\\eqsim"},
+    {8771, "\\simeq"},
+    {8772, "\\not\\simeq"},
+    {8773, "\\cong"},
+    {8775, "\\ncong"},
+    {8776, "\\approx"},
+    {8778, "\\approxeq"},
+    {8781, "\\asymp"},
     {8782, "\\Bumpeq"},
-    {8661, "\\Updownarrow"},
-    {1014, "\\backepsilon"},
-    {8746, "\\cup"},
-    {10234, "\\Longleftrightarrow"},
-    {10927, "\\preceq"},
-    {8915, "\\doublecup"},
-    {8214, "\\lVert"},
-    {8839, "\\supseteq"},
-    {8817, "\\ngeqslant"},
-    {8224, "\\dagger"},
-    {10928, "\\nsucceq"},
-    {10815, "\\amalg"},
-    {10891, "\\lesseqqgtr"},
-    {8806, "\\leqq"},
+    {8783, "\\bumpeq"},
+    {8784, "\\doteq"},
+    {8785, "\\doteqdot"},
+    {8786, "\\fallingdotseq"},
+    {8787, "\\risingdotseq"},
+    {8788, "\\colonequals"},
+    {8789, "\\equalscolon"},
+    {8790, "\\eqcirc"},
     {8791, "\\circeq"},
     {8792, "\\smallfrowneq"},
     {8793, "\\stackrel{\\wedge}{=}"},
@@ -347,436 +491,138 @@ map<int, string> tex::Formula::_symbolFormulaMappings = {
     {8797, "\\stackrel{\\scalebox{0.75}{\\mathrm{def}}}{=}"},
     {8798, "\\stackrel{\\scalebox{0.75}{\\mathrm{m}}}{=}"},
     {8799, "\\stackrel{\\scalebox{0.75}{\\mathrm{?}}}{=}"},
-    {8636, "\\leftharpoonup"},
-    {8858, "\\circledcirc"},
-    {8598, "\\nwarrow"},
-    {8934, "\\lnsim"},
-    {8995, "\\smallsmile"},
-    {8857, "\\odot"},
-    {8740, "\\nmid"},
-    {8918, "\\lessdot"},
-    {8242, "\\prime"},
-    {177, "\\pm"},
-    {8850, "\\sqsupseteq"},
-    {8784, "\\doteq"},
-    {8810, "\\ll"},
+    {8800, "\\neq"},
+    {8801, "\\equiv"},
+    {8802, "\\not\\equiv"},
+    {8804, "\\le"},
+    {8805, "\\ge"},
+    {8806, "\\leqq"},
     {8807, "\\geqq"},
-    {9825, "\\heartsuit"},
-    {8638, "\\upharpoonright"},
-    {8646, "\\leftrightarrows"},
-    {8908, "\\rightthreetimes"},
-    {8723, "\\mp"},
-    {10927, "\\npreceq"},
-    {8942, "\\vdots"},
-    {8938, "\\ntriangleleft"},
-    {8733, "\\varpropto"},
-    {8902, "\\star"},
-    {8761, "\\minuscolon"},
-    {8762, "\\geoprop"},
-    {8764, "\\thicksim"},
-    {8882, "\\vartriangleleft"},
-    {9642, "\\blacksquare"},
-    {9646, "\\marker"},
-    {9653, "\\triangle"},
-    {10756, "\\biguplus"},
-    {10938, "\\succnapprox"},
-    {10890, "\\gnapprox"},
-    {8800, "\\ne"},
-    {9633, "\\square"},
-    {8717, "\\ni"},
-    {8944, "\\iddots"},
-    {8945, "\\ddots"},
-    {8948, "\\inplus"},
-    {8876, "\\nvdash"},
-    {8720, "\\coprod"},
-    {8739, "\\shortmid"},
-    {8617, "\\hookleftarrow"},
-    {8655, "\\nRightarrow"},
-    {8639, "\\upharpoonleft"},
-    {8865, "\\boxdot"},
-    {8841, "\\nsupseteq"},
-    {8712, "\\in"},
-    {8713, "\\notin"},
-    {8905, "\\ltimes"},
+    {8808, "\\lvertneqq"},
+    {8809, "\\gneqq"},
+    {8810, "\\ll"},
+    {8812, "\\between"},
+    {8814, "\\nless"},
+    {8815, "\\ngtr"},
+    {8816, "\\nleqslant"},
+    {8817, "\\ngeqslant"},
+    {8818, "\\lesssim"},
+    {8819, "\\gtrsim"},
+    {8822, "\\lessgtr"},
+    {8823, "\\gtrless"},
+    {8826, "\\prec"},
     {8827, "\\succ"},
-    {8722, "\\minus"},
-    {10928, "\\succeq"},
-    {8638, "\\restriction"},
-    {8747, "\\int"},
-    {9837, "\\flat"},
-    {8513, "\\Game"},
-    {8523, "\\parr"},
+    {8828, "\\preccurlyeq"},
     {8829, "\\succcurlyeq"},
-    {9001, "\\langle"},
-    {8901, "\\cdot"},
-    {8852, "\\sqcup"},
-    {8503, "\\gimel"},
-    {8859, "\\circledast"},
-    {10901, "\\eqslantless"},
-    {8804, "\\le"},
-    {8823, "\\gtrless"},
-    {8733, "\\propto"},
-    {9665, "\\triangleleft"},
-    {9652, "\\blacktriangle"},
-    {8465, "\\Im"},
-    {10753, "\\bigoplus"},
-    {10764, "\\iiiint"},
-    {8765, "\\backsim"},
-    {8734, "\\infty"},
+    {8830, "\\precsim"},
+    {8831, "\\succsim"},
+    {8832, "\\nprec"},
+    {8833, "\\nsucc"},
     {8834, "\\subset"},
-    {8914, "\\Cap"},
-    {8900, "\\diamond"},
-    {8878, "\\nVdash"},
-    {8786, "\\fallingdotseq"},
-    {8788, "\\colonequals"},
-    {8789, "\\equalscolon"},
-    {8812, "\\between"},
-    {8595, "\\downarrow"},
-    {8592, "\\gets"},
-    {8927, "\\curlyeqsucc"},
-    {8846, "\\uplus"},
-    {8714, "\\in"},
+    {8835, "\\supset"},
+    {8836, "\\not\\subset"},
+    {8837, "\\not\\supset"},
+    {8838, "\\subseteq"},
+    {8839, "\\supseteq"},
     {8840, "\\nsubseteq"},
-    {8903, "\\divideontimes"},
-    {8808, "\\lneqq"},
-    {8936, "\\precnsim"},
-    {8956, "\\niplus"},
-    {8197, "\\medspace"},
-    {10878, "\\geqslant"},
-    {8781, "\\asymp"},
-    {8966, "\\doublebarwedge"},
+    {8841, "\\nsupseteq"},
+    {8842, "\\subsetneq"},
+    {8843, "\\supsetneq"},
+    {8846, "\\uplus"},
+    {8847, "\\sqsubset"},
+    {8848, "\\sqsupset"},
     {8849, "\\sqsubseteq"},
-    {9136, "\\lmoustache"},
-    {8769, "\\nsim"},
+    {8850, "\\sqsupseteq"},
     {8851, "\\sqcap"},
-    {10950, "\\supseteqq"},
-    {8907, "\\leftthreetimes"},
-    {8741, "\\shortparallel"},
-    {8866, "\\vdash"},
-    {8737, "\\measuredangle"},
-    {8838, "\\subseteq"},
-    {8920, "\\llless"},
-    {8744, "\\lor"},
-    {8656, "\\Leftarrow"},
-    {8472, "\\wp"},
-    {8768, "\\wr"},
-    {10754, "\\bigotimes"},
-    {8807, "\\ngeqq"},
-    {8871, "\\models"},
+    {8852, "\\sqcup"},
+    {8853, "\\oplus"},
+    {8854, "\\ominus"},
+    {8855, "\\otimes"},
+    {8856, "\\oslash"},
+    {8857, "\\odot"},
+    {8858, "\\circledcirc"},
+    {8859, "\\circledast"},
+    {8861, "\\circleddash"},
     {8862, "\\boxplus"},
-    {8611, "\\rightarrowtail"},
     {8863, "\\boxminus"},
-    {8726, "\\smallsetminus"},
-    {10886, "\\gtrapprox"},
-    {8826, "\\prec"},
-    {8643, "\\downharpoonleft"},
-    {10239, "\\leadsto"},
-    {8717, "\\owns"},
-    {10902, "\\eqslantgtr"},
-    {8773, "\\cong"},
-    {8619, "\\looparrowleft"},
-    {8502, "\\beth"},
-    {8748, "\\iint"},
-    {9653, "\\vartriangle"},
-    {8869, "\\perp"},
-    {8653, "\\nLeftarrow"},
-    {10758, "\\bigsqcup"},
-    {8711, "\\nabla"},
-    {8884, "\\trianglelefteq"},
-    {8847, "\\sqsubset"},
-    {8708, "\\nexists"},
-    {9654, "\\blacktriangleright"},
-    {8743, "\\wedge"},
-    {8736, "\\angle"},
-    {8242, "\\'"},
-    {10752, "\\bigodot"},
-    {8195, "\\quad"},
-    {9416, "\\circledS"},
-    {8874, "\\Vvdash"},
-    {8828, "\\preccurlyeq"},
-    {9655, "\\triangleright"},
-    {8778, "\\approxeq"},
-    {8594, "\\to"},
-    {10849, "\\veebar"},
-    {8659, "\\Downarrow"},
-    {8877, "\\nvDash"},
-    {8818, "\\lesssim"},
-    {8830, "\\precsim"},
-    {8750, "\\oint"},
-    {8842, "\\subsetneq"},
-    {8873, "\\Vdash"},
-    {9585, "\\diagup"},
-    {8738, "\\sphericalangle"},
-    {9826, "\\diamondsuit"},
-    {8867, "\\dashv"},
-    {8599, "\\nearrow"},
-    {8603, "\\nrightarrow"},
-    {10892, "\\gtreqqless"},
-    {8904, "\\bowtie"},
-    {8916, "\\pitchfork"},
-    {9838, "\\natural"},
-    {10934, "\\succneqq"},
-    {8843, "\\varsupsetneq"},
-    {8621, "\\leftrightsquigarrow"},
-    {8745, "\\cap"},
-    {9137, "\\rmoustache"},
-    {8743, "\\land"},
-    {8913, "\\Supset"},
-    {8721, "\\sum"},
-    {8888, "\\multimap"},
-    {8971, "\\rfloor"},
-    {8622, "\\nleftrightarrow"},
-    {9674, "\\lozenge"},
-    {8647, "\\leftleftarrows"},
-    {8605, "\\rightsquigarrow"},
     {8864, "\\boxtimes"},
-    {8644, "\\rightleftarrows"},
-    {8940, "\\ntrianglelefteq"},
-    {8749, "\\iiint"},
+    {8865, "\\boxdot"},
+    {8866, "\\vdash"},
+    {8867, "\\dashv"},
     {8868, "\\top"},
-    {8594, "\\rightarrow"},
-    {8476, "\\Re"},
-    {8848, "\\sqsupset"},
-    {8608, "\\twoheadrightarrow"},
-    {9632, "\\blacksquare"},
-    {10956, "\\varsupsetneqq"},
-    {8630, "\\curvearrowleft"},
-    {8504, "\\daleth"},
-    {8194, "\\thickspace"},
-    {8921, "\\gggtr"},
-    {8790, "\\eqcirc"},
-    {10955, "\\varsubsetneqq"},
-    {8739, "\\vert"},
-    {8831, "\\succsim"},
-    {8657, "\\Uparrow"},
-    {8806, "\\nleqq"},
-    {8487, "\\mho"},
-    {8491, "\\text{\\AA}"},
-    {8770, "\\eqsim"},
-    {8620, "\\looparrowright"},
-    {8640, "\\rightharpoonup"},
-    {8801, "\\equiv"},
-    {8802, "\\not\\equiv"},
-    {8610, "\\leftarrowtail"},
-    {8882, "\\lhd"},
-    {9733, "\\bigstar"},
-    {8935, "\\gnsim"},
+    {8869, "\\bot"},
+    {8871, "\\models"},
     {8872, "\\vDash"},
-    {10731, "\\blacklozenge"},
-    {183, "\\cdot"},
-    {8814, "\\nless"},
-    {8225, "\\ddagger"},
-    {8787, "\\risingdotseq"},
-    {8467, "\\ell"},
-    {8785, "\\doteqdot"},
-    {10887, "\\lneq"},
-    {8658, "\\Rightarrow"},
-    {10233, "\\Longrightarrow"},
-    {8631, "\\curvearrowright"},
-    {8618, "\\hookrightarrow"},
-    {8214, "\\rVert"},
-    {10231, "\\longleftrightarrow"},
-    {8926, "\\curlyeqprec"},
-    {10229, "\\longleftarrow"},
-    {8641, "\\rightharpoondown"},
-    {8463, "\\hslash"},
-    {8914, "\\doublecap"},
-    {8719, "\\prod"},
-    {8597, "\\updownarrow"},
-    {8624, "\\Lsh"},
-    {8833, "\\nsucc"},
-    {8725, "\\slash"},
-    {8637, "\\leftharpoondown"},
-    {8804, "\\leq"},
-    {8500, "\\mathit{o}"},
-    {8501, "\\aleph"},
+    {8873, "\\Vdash"},
+    {8874, "\\Vvdash"},
+    {8876, "\\nvdash"},
+    {8877, "\\nvDash"},
+    {8878, "\\nVdash"},
     {8879, "\\nVDash"},
-    {8970, "\\lfloor"},
-    {8728, "\\circ"},
-    {8899, "\\bigcup"},
-    {8740, "\\nshortmid"},
-    {10935, "\\precapprox"},
+    {8882, "\\vartriangleleft"},
+    {8883, "\\rhd"},
+    {8884, "\\trianglelefteq"},
     {8885, "\\trianglerighteq"},
-    {8739, "\\mid"},
-    {8724, "\\dotplus"},
-    {8832, "\\nprec"},
-    {8943, "\\cdots"},
-    {8666, "\\Lleftarrow"},
-    {10933, "\\precneqq"},
-    {8495, "e"},
-    {8498, "\\Finv"},
+    {8888, "\\multimap"},
     {8890, "\\intercal"},
-    {8730, "\\surd"},
+    {8896, "\\bigwedge"},
     {8897, "\\bigvee"},
-    {10888, "\\gneq"},
-    {8704, "\\forall"},
-    {10937, "\\precnapprox"},
-    {9824, "\\spadesuit"},
-    {10236, "\\longmapsto"},
-    {10214, "\\llbracket"},
-    {10215, "\\rrbracket"},
-    {10216, "\\langle"},
-    {10217, "\\rangle"},
-    {9711, "\\bigcirc"},
+    {8898, "\\bigcap"},
+    {8899, "\\bigcup"},
+    {8900, "\\diamond"},
+    {8901, "\\cdot"},
+    {8902, "\\star"},
+    {8903, "\\divideontimes"},
+    {8904, "\\bowtie"},
+    {8905, "\\ltimes"},
+    {8906, "\\rtimes"},
+    {8907, "\\leftthreetimes"},
+    {8908, "\\rightthreetimes"},
     {8909, "\\backsimeq"},
-    {247, "\\div"},
-    {125, "\\rbrace"},
-    {8705, "\\complement"},
-    {8757, "\\because"},
-    {8760, "\\dotminus"},
-    {9651, "\\triangle"},
-    {8606, "\\twoheadleftarrow"},
-    {1013, "\\epsilon"},
-    {8741, "\\Arrowvert"},
-    {9674, "\\Diamond"},
-    {8842, "\\varsubsetneq"},
-    {8739, "\\arrowvert"},
-    {9839, "\\sharp"},
-    {8896, "\\bigwedge"},
-    {8709, "\\varnothing"},
-    {9586, "\\diagdown"},
-    {8614, "\\mapsto"},
-    {8883, "\\vartriangleright"},
-    {8853, "\\oplus"},
-    {8776, "\\thickapprox"},
+    {8910, "\\curlyvee"},
+    {8911, "\\curlywedge"},
+    {8912, "\\Subset"},
+    {8913, "\\Supset"},
+    {8914, "\\Cap"},
+    {8915, "\\Cup"},
+    {8916, "\\pitchfork"},
+    {8918, "\\lessdot"},
+    {8919, "\\gtrdot"},
+    {8920, "\\llless"},
+    {8921, "\\ggg"},
+    {8923, "\\gtreqless"},
+    {8926, "\\curlyeqprec"},
+    {8927, "\\curlyeqsucc"},
+    {8934, "\\lnsim"},
+    {8935, "\\gnsim"},
+    {8936, "\\precnsim"},
+    {8937, "\\succnsim"},
+    {8938, "\\ntriangleleft"},
+    {8939, "\\ntriangleright"},
+    {8940, "\\ntrianglelefteq"},
+    {8941, "\\ntrianglerighteq"},
+    {8942, "\\vdots"},
+    {8943, "\\cdots"},
+    {8944, "\\iddots"},
+    {8945, "\\ddots"},
+    {8948, "\\inplus"},
+    {8956, "\\niplus"},
+    {8965, "\\barwedge"},
+    {8966, "\\doublebarwedge"},
+    {8968, "\\lceil"},
     {8969, "\\rceil"},
-    {8912, "\\Subset"},
-    {8652, "\\rightleftharpoons"},
-    {769, "\\acute"},
-    {768, "\\grave"},
-    {776, "\\ddot"},
-    {779, "\\doubleacute"},
-    {771, "\\tilde"},
-    {730, "\\bmathring"},
-    {772, "\\bar"},
-    {774, "\\breve"},
-    {780, "\\check"},
-    {770, "\\hat"},
-    {8407, "\\vec"},
-    {775, "\\dot"},
-    {770, "\\widehat"},
-    {771, "\\widetilde"},
-    {8450, "\\mathbb{C}"},
-    {8451, "\\sideset{^\\circ}{}\\text{C}"},
-    {8455, "\\euler"},
-    {8457, "\\sideset{^\\circ}{}\\text{F}"},
-    {8461, "\\mathbb{H}"},
-    {8469, "\\mathbb{N}"},
-    {8473, "\\mathbb{P}"},
-    {8474, "\\mathbb{Q}"},
-    {8477, "\\mathbb{R}"},
-    {8484, "\\mathbb{Z}"},
-    {8488, "\\mathfrak{Z}"},
-    {8459, "\\mathscr{H}"},
-    {8460, "\\mathfrak{H}"},
-    {8464, "\\mathscr{I}"},
-    {8466, "\\mathscr{L}"},
-    {8475, "\\mathscr{R}"},
-    {8492, "\\mathscr{B}"},
-    {8493, "\\mathfrak{C}"},
-    {8496, "\\mathscr{E}"},
-    {8497, "\\mathscr{F}"},
-    {8499, "\\mathscr{M}"},
-    {64256, "ff"},
-    {64257, "fi"},
-    {58290, "fj"},
-    {64258, "fl"},
-    {64259, "ffi"},
-    {64260, "ffl"},
-    {10643, "\\mathbin{\\rlap{<}\\;(}"},
-    {10644, "\\mathbin{\\rlap{>}\\,)}"},
-    {10677, "\\minuso"},
-    {10686, "\\varocircle"},
-    {10688, "\\olessthan"},
-    {10689, "\\ogreaterthan"},
-    {10692, "\\boxslash"},
-    {10693, "\\boxbslash"},
-    {10016, "\\maltese"},
-    {10016, "\\checkmark"},
-    {8254, "\\mathpunct{\\={\\ }}"},
-    {8259, "\\hybull"},
-    {8240, "\\textperthousand"},
-    {8241, "\\textpertenthousand"},
-    {8249, "\\guilsinglleft"},
-    {8250, "\\guilsinglright"},
-    {8772, "\\not\\simeq"},
-    {8244, "'''"},
-    {8411, "''"},
-    {8216, "`"},
-    {8220, "``"},
-    {8217, "\\textapos"},
-    {8218, ","},
-    {8221, "\\textapos\\textapos"},
-    {8222, ",,"},
-    {8206, " "},
-    {8207, " "},
-    {8364, "\\euro"},
-    {8208, "\\textminus"},
-    {8211, "\\textendash"},
-    {8212, "\\textemdash"},
-    {8448, "\\sfrac{a}{c}"},
-    {8449, "\\sfrac{a}{s}"},
-    {8453, "\\sfrac{c}{o}"},
-    {8454, "\\sfrac{c}{u}"},
-    {8480, "{}^{\\text{TM}}"},
+    {8970, "\\lfloor"},
+    {8971, "\\rfloor"},
     {8988, "\\ulcorner"},
     {8989, "\\urcorner"},
     {8990, "\\llcorner"},
     {8991, "\\lrcorner"},
-    {8531, "\\text{\\sfrac13}"},
-    {8532, "\\text{sfrac23}"},
-    {8533, "\\text{\\sfrac15}"},
-    {8534, "\\text{\\sfrac25}"},
-    {8535, "\\text{\\sfrac35}"},
-    {8536, "\\text{\\sfrac45}"},
-    {8537, "\\text{\\sfrac16}"},
-    {8538, "\\text{\\sfrac56}"},
-    {189, "\\text{\\sfrac12}"},
-    {188, "\\text{\\sfrac14}"},
-    {190, "\\text{\\sfrac34}"},
-    {8539, "\\text{\\sfrac18}"},
-    {8540, "\\text{\\sfrac38}"},
-    {8541, "\\text{\\sfrac58}"},
-    {8542, "\\text{\\sfrac78}"},
-    {8543, "\\text{\\sfrac{1}{\\ }}"},
-    {8544, "\\text{I}"},
-    {8545, "\\text{II}"},
-    {8546, "\\text{III}"},
-    {8547, "\\text{IV}"},
-    {8548, "\\text{V}"},
-    {8549, "\\text{VI}"},
-    {8550, "\\text{VII}"},
-    {8551, "\\text{VIII}"},
-    {8552, "\\text{IX}"},
-    {8553, "\\text{X}"},
-    {8554, "\\text{XI}"},
-    {8555, "\\text{XII}"},
-    {8556, "\\text{L}"},
-    {8557, "\\text{C}"},
-    {8558, "\\text{D}"},
-    {8559, "\\text{M}"},
-    {8560, "\\text{i}"},
-    {8561, "\\text{ii}"},
-    {8562, "\\text{iii}"},
-    {8563, "\\text{iv}"},
-    {8564, "\\text{v}"},
-    {8565, "\\text{vi}"},
-    {8566, "\\text{vii}"},
-    {8567, "\\text{viii}"},
-    {8568, "\\text{ix}"},
-    {8569, "\\text{x}"},
-    {8570, "\\text{xi}"},
-    {8571, "\\text{xii}"},
-    {8572, "\\text{l}"},
-    {8573, "\\text{c}"},
-    {8574, "\\text{d}"},
-    {8575, "\\text{m}"},
-    {9600, "\\uhblk"},
-    {9601, "\\lhblk"},
-    {9608, "\\block"},
-    {9617, "\\fgcolor{bfbfbf}{\\block}"},
-    {9618, "\\fgcolor{808080}{\\block}"},
-    {9619, "\\fgcolor{404040}{\\block}"},
+    {8994, "\\smallfrown"},
+    {8995, "\\smallsmile"},
+    {9001, "\\langle"},
+    {9002, "\\rangle"},
+    {9136, "\\lmoustache"},
+    {9137, "\\rmoustache"},
     {9312, "\\textcircled{\\texttt 1}"},
     {9313, "\\textcircled{\\texttt 2}"},
     {9314, "\\textcircled{\\texttt 3}"},
@@ -804,7 +650,7 @@ map<int, string> tex::Formula::_symbolFormulaMappings = {
     {9413, "\\textcircled{\\texttt P}"},
     {9414, "\\textcircled{\\texttt Q}"},
     {9415, "\\textcircled{\\texttt R}"},
-    {9416, "\\textcircled{\\texttt S}"},
+    {9416, "\\circledS"},
     {9417, "\\textcircled{\\texttt T}"},
     {9418, "\\textcircled{\\texttt U}"},
     {9419, "\\textcircled{\\texttt V}"},
@@ -838,4 +684,120 @@ map<int, string> tex::Formula::_symbolFormulaMappings = {
     {9447, "\\textcircled{\\texttt x}"},
     {9448, "\\textcircled{\\texttt y}"},
     {9449, "\\textcircled{\\texttt z}"},
+    {9585, "\\diagup"},
+    {9586, "\\diagdown"},
+    {9600, "\\uhblk"},
+    {9601, "\\lhblk"},
+    {9608, "\\block"},
+    {9617, "\\fgcolor{bfbfbf}{\\block}"},
+    {9618, "\\fgcolor{808080}{\\block}"},
+    {9619, "\\fgcolor{404040}{\\block}"},
+    {9632, "\\blacksquare"},
+    {9633, "\\square"},
+    {9642, "\\blacksquare"},
+    {9646, "\\marker"},
+    {9651, "\\triangle"},
+    {9652, "\\blacktriangle"},
+    {9653, "\\triangle"},
+    {9654, "\\blacktriangleright"},
+    {9655, "\\triangleright"},
+    {9661, "\\bigtriangledown"},
+    {9662, "\\blacktriangledown"},
+    {9663, "\\triangledown"},
+    {9664, "\\blacktriangleleft"},
+    {9665, "\\triangleleft"},
+    {9674, "\\lozenge"},
+    {9711, "\\bigcirc"},
+    {9733, "\\bigstar"},
+    {9824, "\\spadesuit"},
+    {9825, "\\heartsuit"},
+    {9826, "\\diamondsuit"},
+    {9827, "\\clubsuit"},
+    {9837, "\\flat"},
+    {9838, "\\natural"},
+    {9839, "\\sharp"},
+    {10016, "\\maltese"},
+    {10214, "\\llbracket"},
+    {10215, "\\rrbracket"},
+    {10216, "\\langle"},
+    {10217, "\\rangle"},
+    {10229, "\\longleftarrow"},
+    {10230, "\\longrightarrow"},
+    {10231, "\\longleftrightarrow"},
+    {10232, "\\Longleftarrow"},
+    {10233, "\\Longrightarrow"},
+    {10234, "\\Longleftrightarrow"},
+    {10236, "\\longmapsto"},
+    {10239, "\\leadsto"},
+    {10643, "\\mathbin{\\rlap{<}\\;(}"},
+    {10644, "\\mathbin{\\rlap{>}\\,)}"},
+    {10677, "\\minuso"},
+    {10686, "\\varocircle"},
+    {10688, "\\olessthan"},
+    {10689, "\\ogreaterthan"},
+    {10692, "\\boxslash"},
+    {10693, "\\boxbslash"},
+    {10731, "\\blacklozenge"},
+    {10752, "\\bigodot"},
+    {10753, "\\bigoplus"},
+    {10754, "\\bigotimes"},
+    {10756, "\\biguplus"},
+    {10758, "\\bigsqcup"},
+    {10764, "\\iiiint"},
+    {10815, "\\amalg"},
+    {10849, "\\veebar"},
+    {10868, "\\coloncolonequals"},
+    {10877, "\\leqslant"},
+    {10878, "\\geqslant"},
+    {10885, "\\lessapprox"},
+    {10886, "\\gtrapprox"},
+    {10887, "\\lneq"},
+    {10888, "\\gneq"},
+    {10889, "\\lnapprox"},
+    {10890, "\\gnapprox"},
+    {10891, "\\lesseqqgtr"},
+    {10892, "\\gtreqqless"},
+    {10901, "\\eqslantless"},
+    {10902, "\\eqslantgtr"},
+    {10914, "\\gg"},
+    {10916, "\\mathbin{\\rlap{>}\\!<}"},
+    {10917, "\\mathbin{><}"},
+    {10918, "\\leftslice"},
+    {10919, "\\rightslice"},
+    {10927, "\\preceq"},
+    {10928, "\\nsucceq"},
+    {10933, "\\precneqq"},
+    {10934, "\\succneqq"},
+    {10935, "\\precapprox"},
+    {10936, "\\succapprox"},
+    {10937, "\\precnapprox"},
+    {10938, "\\succnapprox"},
+    {10949, "\\nsubseteqq"},
+    {10950, "\\supseteqq"},
+    {10955, "\\subsetneqq"},
+    {10956, "\\supsetneqq"},
+    {58290, "fj"},
+    {64256, "ff"},
+    {64257, "fi"},
+    {64258, "fl"},
+    {64259, "ffi"},
+    {64260, "ffl"},
 };
+
+static_assert(isSortedTable(BUILTIN_FORMULA_MAPPINGS), "The formula mappings must be sorted by the char");
+
+}  // namespace
+
+map<int, string> Formula::_symbolFormulaMappings;
+
+const char* Formula::getSymbolFormulaMapping(int c) {
+  auto it = _symbolFormulaMappings.find(c);
+  if (it != _symbolFormulaMappings.end()) return it->second.c_str();
+  const auto* e = findInTable(BUILTIN_FORMULA_MAPPINGS, c);
+  return e == nullptr ? nullptr : e->value;
+}
+
+void Formula::__markFormulaMappings() {
+  for (const auto& e : BUILTIN_FORMULA_MAPPINGS) CharRouting::__mark(e.key, CharRouting::FORMULA);
+  for (const auto& m : _symbolFormulaMappings) CharRouting::__mark(m.first, CharRouting::FORMULA);
+}
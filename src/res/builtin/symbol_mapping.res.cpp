@@ -1,32 +1,37 @@
+#include "core/char_routing.h"
 #include "core/formula.h"
+#include "utils/sorted_table.h"
 
 using namespace std;
 using namespace tex;
 
-map<int, string> Formula::_symbolMappings = {
-    {'+', "plus"},
-    {'*', "ast"},
-    {'(', "lbrack"},
-    {';', "semicolon"},
-    {'{', "lbrace"},
+namespace {
+
+/** Sorted by the char */
+constexpr TableEntry<int, const char*> BUILTIN_SYMBOL_MAPPINGS[]{
     {'!', "faculty"},
+    {'#', "mathsharp"},
+    {'\'', "textapos"},
+    {'(', "lbrack"},
     {')', "rbrack"},
+    {'*', "ast"},
+    {'+', "plus"},
     {',', "comma"},
-    {'?', "question"},
-    {']', "rsqbrack"},
-    {'|', "vert"},
+    {'-', "minus"},
+    {'.', "normaldot"},
+    {'/', "slash"},
     {':', "colon"},
+    {';', "semicolon"},
+    {'<', "lt"},
     {'=', "equals"},
+    {'>', "gt"},
+    {'?', "question"},
     {'[', "lsqbrack"},
-    {'}', "rbrace"},
+    {']', "rsqbrack"},
     {'`', "mathlapos"},
-    {'#', "mathsharp"},
-    {'-', "minus"},
-    {'/', "slash"},
-    {'.', "normaldot"},
-    {'>', "gt"},
-    {'<', "lt"},
-    {'\'', "textapos"},
+    {'{', "lbrace"},
+    {'|', "vert"},
+    {'}', "rbrace"},
     {163, "mathsterling"},
     {165, "yen"},
     {167, "S"},
@@ -36,10 +41,6 @@ map<int, string> Formula::_symbolMappings = {
     {182, "P"},
     {187, "guillemotright"},
     {191, "questiondown"},
-    {981, "phi"},
-    {982, "varpi"},
-    {1008, "varkappa"},
-    {1009, "varrho"},
     {945, "alpha"},
     {946, "beta"},
     {947, "gamma"},
@@ -66,15 +67,20 @@ map<int, string> Formula::_symbolMappings = {
     {968, "psi"},
     {969, "omega"},
     {977, "vartheta"},
+    {981, "phi"},
+    {982, "varpi"},
+    {1008, "varkappa"},
+    {1009, "varrho"},
     {65288, "lbrack"},
     {65289, "rbrack"},
     {65292, "comma"},
 };
 
-map<int, string> Formula::_symbolTextMappings = {
+/** Sorted by the char */
+constexpr TableEntry<int, const char*> BUILTIN_SYMBOL_TEXT_MAPPINGS[]{
     {'-', "textminus"},
-    {'/', "textfractionsolidus"},
     {'.', "textnormaldot"},
+    {'/', "textfractionsolidus"},
     {913, "Α"},
     {914, "Β"},
     {915, "Γ"},
@@ -129,3 +135,32 @@ map<int, string> Formula::_symbolTextMappings = {
     {65289, "rbrack"},
     {65292, "comma"},
 };
+
+static_assert(isSortedTable(BUILTIN_SYMBOL_MAPPINGS), "The symbol mappings must be sorted by the char");
+static_assert(isSortedTable(BUILTIN_SYMBOL_TEXT_MAPPINGS), "The symbol mappings must be sorted by the char");
+
+}  // namespace
+
+map<int, string> Formula::_symbolMappings;
+map<int, string> Formula::_symbolTextMappings;
+
+const char* Formula::getSymbolMapping(int c) {
+  auto it = _symbolMappings.find(c);
+  if (it != _symbolMappings.end()) return it->second.c_str();
+  const auto* e = findInTable(BUILTIN_SYMBOL_MAPPINGS, c);
+  return e == nullptr ? nullptr : e->value;
+}
+
+const char* Formula::getSymbolTextMapping(int c) {
+  auto it = _symbolTextMappings.find(c);
+  if (it != _symbolTextMappings.end()) return it->second.c_str();
+  const auto* e = findInTable(BUILTIN_SYMBOL_TEXT_MAPPINGS, c);
+  return e == nullptr ? nullptr : e->value;
+}
+
+void Formula::__markSymbolMappings() {
+  for (const auto& e : BUILTIN_SYMBOL_MAPPINGS) CharRouting::__mark(e.key, CharRouting::SYMBOL);
+  for (const auto& e : BUILTIN_SYMBOL_TEXT_MAPPINGS) CharRouting::__mark(e.key, CharRouting::TEXT);
+  for (const auto& m : _symbolMappings) CharRouting::__mark(m.first, CharRouting::SYMBOL);
+  for (const auto& m : _symbolTextMappings) CharRouting::__mark(m.first, CharRouting::TEXT);
+}
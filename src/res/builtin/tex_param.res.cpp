@@ -1,4 +1,5 @@
 #include "fonts/fonts.h"
+#include "res/reg/bundles.h"
 
 /**
  * General parameters used in the TeX algorithms, 
@@ -38,14 +39,18 @@ void tex::DefaultTeXFont::__default_general_settings() {
   };
 }
 
-#define cf(c, f) new CharFont(c, __id(f))
+#define cf(c, f) Arena::state().create<CharFont>(c, __id(f))
 
 void tex::DefaultTeXFont::__default_text_style_mapping() {
   tex::DefaultTeXFont::_textStyleMappings = {
       {"mathnormal", {cf(48, cmr10), cf(65, cmmi10), cf(97, cmmi10), cf(0, cmmi10)}},
+#if CLM_BUNDLE_EULER
       {"mathfrak", {cf(48, eufm10), cf(65, eufm10), cf(97, eufm10), nullptr}},
+#endif
       {"mathcal", {nullptr, cf(65, cmsy10), nullptr, nullptr}},
+#if CLM_BUNDLE_AMS
       {"mathbb", {nullptr, cf(65, msbm10), nullptr, nullptr}},
+#endif
       {"mathscr", {nullptr, cf(65, rsfs10), nullptr, nullptr}},
       {"mathds", {nullptr, cf(65, dsrom10), nullptr, nullptr}},
       {"oldstylenums", {cf(48, cmmi10), nullptr, nullptr, nullptr}},
@@ -1,10 +1,12 @@
 #include "atom/atom_basic.h"
+#include "utils/exceptions.h"
+#include "utils/sorted_table.h"
 
 #define sym(type, name) \
-  { #name, sptr < SymbolAtom>(new SymbolAtom(#name, type, false)) }
+  { #name, type, false }
 
 #define del(type, name) \
-  { #name, sptr < SymbolAtom>(new SymbolAtom(#name, type, true)) }
+  { #name, type, true }
 
 #define ord   AtomType::ordinary
 #define rel   AtomType::relation
@@ -18,651 +20,657 @@
 using namespace std;
 using namespace tex;
 
+namespace {
+
+struct BuiltinSymbol {
+  const char* key;
+  AtomType type;
+  bool isDelimiter;
+};
+
 /**
  * BUILTIN SYMBOLS
  * Page 445 in the [The TeXBook]
+ * <p>
+ * Sorted by the name, the atoms are created on the first use.
  */
-map<string, sptr<SymbolAtom>> SymbolAtom::_symbols = {
-    sym(ord, ae),
+constexpr BuiltinSymbol BUILTIN_SYMBOLS[]{
     sym(ord, AE),
-    sym(ord, OE),
-    sym(ord, oe),
-    sym(ord, ss),
-    sym(ord, o),
+    sym(rel, Arrownot),
+    sym(ord, Bbbk),
+    sym(ord, Box),
+    sym(rel, Bumpeq),
+    sym(bin, Cap),
+    sym(bin, Cup),
+    sym(ord, Delta),
+    sym(rel, Diamond),
+    del(rel, Downarrow),
+    sym(ord, Finv),
+    sym(ord, Game),
+    sym(ord, Gamma),
+    sym(ord, Im),
+    sym(ord, Lambda),
+    sym(open, Lbag),
+    sym(rel, Leftarrow),
+    sym(rel, Leftrightarrow),
+    sym(rel, Lleftarrow),
+    sym(rel, Lsh),
+    sym(rel, Mapsfromchar),
+    sym(rel, Mapstochar),
     sym(ord, O),
-    sym(ord, i),
-    sym(ord, j),
-    sym(ord, euler),
-    sym(ord, textapos),
-    sym(ord, mathlapos),
-    sym(ord, mathcedilla),
-    sym(acc, ogonek),
-    sym(ord, polishlcross),
-    sym(ord, lq),
-    sym(ord, rq),
-    sym(ord, textdbend),
-    sym(ord, dbend),
-    sym(rel, shortleftarrow),
-    sym(rel, shortrightarrow),
-    sym(rel, shortuparrow),
-    sym(rel, shortdownarrow),
-    sym(bin, Yup),
+    sym(ord, OE),
+    sym(ord, Omega),
+    sym(ord, P),
+    sym(ord, Phi),
+    sym(ord, Pi),
+    sym(ord, Psi),
+    sym(close, Rbag),
+    sym(ord, Re),
+    del(rel, Relbar),
+    sym(rel, Rightarrow),
+    sym(rel, Rrightarrow),
+    sym(rel, Rsh),
+    sym(ord, S),
+    sym(ord, Sigma),
+    sym(rel, Subset),
+    sym(rel, Supset),
+    sym(ord, Theta),
+    del(rel, Uparrow),
+    del(rel, Updownarrow),
+    sym(ord, Upsilon),
+    sym(rel, Vdash),
+    del(ord, Vert),
+    sym(rel, Vvdash),
+    sym(ord, Xi),
     sym(bin, Ydown),
     sym(bin, Yleft),
     sym(bin, Yright),
-    sym(bin, varcurlyvee),
-    sym(bin, varcurlywedge),
-    sym(bin, minuso),
+    sym(bin, Yup),
+    sym(acc, acute),
+    sym(ord, ae),
+    sym(ord, aleph),
+    sym(ord, alpha),
+    sym(bin, amalg),
+    sym(ord, android),
+    sym(ord, angle),
+    sym(rel, approx),
+    sym(rel, approxeq),
+    sym(rel, arrownot),
+    sym(bin, ast),
+    sym(rel, asymp),
+    sym(rel, backepsilon),
+    sym(ord, backprime),
+    sym(rel, backsim),
+    sym(rel, backsimeq),
+    del(ord, backslash),
+    sym(acc, bar),
     sym(bin, baro),
-    sym(bin, sslash),
+    sym(bin, barwedge),
     sym(bin, bbslash),
-    sym(bin, moo),
-    sym(bin, varotimes),
-    sym(bin, varoast),
-    sym(bin, varobar),
-    sym(bin, varodot),
-    sym(bin, varoslash),
-    sym(bin, varobslash),
-    sym(bin, varocircle),
-    sym(bin, varoplus),
-    sym(bin, varominus),
-    sym(bin, boxast),
-    sym(bin, boxbar),
-    sym(bin, boxdot),
-    sym(bin, boxslash),
-    sym(bin, boxbslash),
-    sym(bin, boxcircle),
-    sym(bin, boxbox),
-    sym(bin, boxempty),
-    sym(ord, lightning),
-    sym(bin, merge),
-    sym(bin, vartimes),
-    sym(bin, fatsemi),
-    sym(rel, sswarrow),
-    sym(rel, ssearrow),
-    sym(rel, curlywedgeuparrow),
-    sym(rel, curlywedgedownarrow),
-    sym(bin, fatslash),
-    sym(bin, fatbslash),
-    sym(bin, lbag),
-    sym(bin, rbag),
-    sym(bin, varbigcirc),
-    sym(rel, leftrightarroweq),
-    sym(rel, curlyveedownarrow),
-    sym(rel, curlyveeuparrow),
-    sym(rel, nnwarrow),
-    sym(rel, nnearrow),
-    sym(bin, leftslice),
-    sym(bin, rightslice),
-    sym(bin, varolessthan),
-    sym(bin, varogreaterthan),
-    sym(bin, varovee),
-    sym(bin, varowedge),
-    sym(bin, talloblong),
-    sym(bin, interleave),
-    sym(bin, obar),
-    sym(bin, obslash),
-    sym(bin, olessthan),
-    sym(bin, ogreaterthan),
-    sym(bin, ovee),
-    sym(bin, owedge),
-    sym(bin, oblong),
-    sym(rel, inplus),
-    sym(rel, niplus),
-    sym(bin, nplus),
-    sym(rel, subsetplus),
-    sym(rel, supsetplus),
-    sym(rel, subsetpluseq),
-    sym(rel, supsetpluseq),
-    sym(open, Lbag),
-    sym(close, Rbag),
-    sym(open, llbracket),
-    sym(close, rrbracket),
-    sym(open, llparenthesis),
-    sym(close, rrparenthesis),
-    sym(open, binampersand),
-    sym(close, bindnasrepma),
-    sym(rel, trianglelefteqslant),
-    sym(rel, trianglerighteqslant),
-    sym(rel, ntrianglelefteqslant),
-    sym(rel, ntrianglerighteqslant),
-    sym(open, llfloor),
-    sym(close, rrfloor),
-    sym(open, llceil),
-    sym(close, rrceil),
-    sym(rel, arrownot),
-    sym(rel, Arrownot),
-    sym(rel, Mapstochar),
-    sym(rel, mapsfromchar),
-    sym(rel, Mapsfromchar),
-    sym(bin, leftrightarrowtriangle),
-    sym(rel, leftarrowtriangle),
-    sym(rel, rightarrowtriangle),
-    sym(op, bigtriangledown),
-    sym(op, bigtriangleup),
+    sym(rel, because),
+    sym(ord, beta),
+    sym(ord, beth),
+    sym(rel, between),
+    sym(op, bigbox),
+    sym(op, bigcap),
+    sym(bin, bigcirc),
+    sym(op, bigcup),
     sym(op, bigcurlyvee),
     sym(op, bigcurlywedge),
-    sym(op, bigsqcap),
-    sym(op, bigbox),
-    sym(op, bigparallel),
     sym(op, biginterleave),
     sym(op, bignplus),
-    sym(open, ulcorner),
-    sym(close, urcorner),
-    sym(open, llcorner),
-    sym(close, lrcorner),
-    sym(ord, maltese),
-    sym(ord, textregistered),
-    sym(ord, lhook),
-    sym(ord, rhook),
-    sym(rel, mapstochar),
-    sym(ord, angle),
-    sym(ord, hbar),
-    sym(rel, sqsubset),
-    sym(rel, sqsupset),
-    sym(ord, mho),
-    sym(ord, square),
-    sym(ord, lozenge),
-    sym(rel, vartriangleright),
-    sym(rel, vartriangleleft),
-    sym(rel, trianglerighteq),
-    sym(rel, trianglelefteq),
-    sym(rel, rightsquigarrow),
-    sym(rel, lhd),
-    sym(rel, unlhd),
-    sym(rel, rhd),
-    sym(rel, unrhd),
-    sym(ord, Box),
-
+    sym(op, bigodot),
+    sym(op, bigoplus),
+    sym(op, bigotimes),
+    sym(op, bigparallel),
+    sym(op, bigsqcap),
+    sym(op, bigsqcup),
+    sym(ord, bigstar),
+    sym(op, bigtriangledown),
+    sym(op, bigtriangleup),
+    sym(op, biguplus),
+    sym(op, bigvee),
+    sym(op, bigwedge),
+    sym(open, binampersand),
+    sym(close, bindnasrepma),
+    sym(ord, blacklozenge),
+    sym(ord, blacksquare),
+    sym(ord, blacktriangle),
+    sym(ord, blacktriangledown),
+    sym(rel, blacktriangleleft),
+    sym(rel, blacktriangleright),
+    sym(ord, bot),
+    sym(bin, boxast),
+    sym(bin, boxbar),
+    sym(bin, boxbox),
+    sym(bin, boxbslash),
+    sym(bin, boxcircle),
     sym(bin, boxdot),
+    sym(bin, boxempty),
+    sym(bin, boxminus),
     sym(bin, boxplus),
+    sym(bin, boxslash),
     sym(bin, boxtimes),
-    sym(ord, square),
-    sym(ord, blacksquare),
+    del(ord, bracevert),
+    sym(acc, breve),
+    sym(bin, bullet),
+    sym(rel, bumpeq),
+    sym(bin, cap),
+    sym(bin, cdot),
+    sym(punct, cdotp),
     sym(bin, centerdot),
-    sym(ord, lozenge),
-    sym(ord, blacklozenge),
-    sym(rel, circlearrowright),
+    sym(acc, check),
+    sym(ord, checkmark),
+    sym(ord, chi),
+    sym(bin, circ),
+    sym(rel, circeq),
     sym(rel, circlearrowleft),
-    sym(rel, leftrightharpoons),
-    sym(rel, rightleftharpoons),
-    sym(bin, boxminus),
-    sym(rel, Vdash),
-    sym(rel, Vvdash),
-    sym(rel, vDash),
-    sym(rel, twoheadrightarrow),
-    sym(rel, twoheadleftarrow),
-    sym(rel, leftleftarrows),
-    sym(rel, rightrightarrows),
-    sym(rel, upuparrows),
+    sym(rel, circlearrowright),
+    sym(ord, circledS),
+    sym(bin, circledast),
+    sym(bin, circledcirc),
+    sym(bin, circleddash),
+    sym(ord, clubsuit),
+    sym(rel, colon),
+    sym(punct, comma),
+    sym(ord, complement),
+    sym(op, coprod),
+    sym(bin, cup),
+    sym(rel, curlyeqprec),
+    sym(rel, curlyeqsucc),
+    sym(bin, curlyvee),
+    sym(rel, curlyveedownarrow),
+    sym(rel, curlyveeuparrow),
+    sym(bin, curlywedge),
+    sym(rel, curlywedgedownarrow),
+    sym(rel, curlywedgeuparrow),
+    sym(rel, curvearrowleft),
+    sym(rel, curvearrowright),
+    sym(ord, dE),
+    sym(ord, dT),
+    sym(ord, dX),
+    sym(bin, dagger),
+    sym(ord, daleth),
+    sym(rel, dashv),
+    sym(ord, dbend),
+    sym(bin, ddagger),
+    sym(acc, ddot),
+    sym(ord, delta),
+    sym(ord, diagdown),
+    sym(ord, diagup),
+    sym(bin, diamond),
+    sym(ord, diamondsuit),
+    sym(ord, digamma),
+    sym(bin, div),
+    sym(bin, divideontimes),
+    sym(acc, dot),
+    sym(rel, doteqdot),
+    sym(bin, dotplus),
+    sym(acc, doubleacute),
+    sym(bin, doublebarwedge),
+    del(rel, downarrow),
     sym(rel, downdownarrows),
-    sym(rel, upharpoonright),
-    sym(rel, downharpoonright),
-    sym(rel, upharpoonleft),
     sym(rel, downharpoonleft),
-    sym(rel, rightarrowtail),
-    sym(rel, leftarrowtail),
-    sym(rel, leftrightarrows),
-    sym(rel, rightleftarrows),
-    sym(rel, Lsh),
-    sym(rel, Rsh),
-    sym(rel, rightsquigarrow),
-    sym(rel, leftrightsquigarrow),
-    sym(rel, looparrowleft),
-    sym(rel, looparrowright),
-    sym(rel, circeq),
-    sym(rel, succsim),
-    sym(rel, gtrsim),
-    sym(rel, gtrapprox),
-    sym(rel, multimap),
-    sym(rel, therefore),
-    sym(rel, because),
-    sym(rel, doteqdot),
-    sym(rel, triangleq),
-    sym(rel, precsim),
-    sym(rel, lesssim),
-    sym(rel, lessapprox),
-    sym(rel, eqslantless),
+    sym(rel, downharpoonright),
+    sym(ord, ell),
+    sym(ord, emptyset),
+    sym(ord, epsilon),
+    sym(rel, eqcirc),
+    sym(rel, eqsim),
     sym(rel, eqslantgtr),
-    sym(rel, curlyeqprec),
-    sym(rel, curlyeqsucc),
-    sym(rel, preccurlyeq),
-    sym(rel, leqq),
-    sym(rel, leqslant),
-    sym(rel, lessgtr),
-    sym(ord, backprime),
-    sym(rel, risingdotseq),
+    sym(rel, eqslantless),
+    sym(rel, equals),
+    sym(rel, equiv),
+    sym(ord, eta),
+    sym(ord, eth),
+    sym(ord, euler),
+    sym(ord, euro),
+    sym(ord, exists),
+    sym(ord, faculty),
     sym(rel, fallingdotseq),
-    sym(rel, succcurlyeq),
+    sym(bin, fatbslash),
+    sym(bin, fatsemi),
+    sym(bin, fatslash),
+    sym(punct, fg),
+    sym(ord, flat),
+    sym(ord, forall),
+    sym(rel, frown),
+    sym(ord, gamma),
+    sym(rel, ge),
+    sym(rel, geq),
     sym(rel, geqq),
     sym(rel, geqslant),
-    sym(rel, gtrless),
-    sym(rel, vartriangleright),
-    sym(rel, vartriangleleft),
-    sym(rel, trianglerighteq),
-    sym(rel, trianglelefteq),
-    sym(ord, bigstar),
-    sym(rel, between),
-    sym(ord, blacktriangledown),
-    sym(rel, blacktriangleright),
-    sym(rel, blacktriangleleft),
-    sym(rel, vartriangle),
-    sym(ord, blacktriangle),
-    sym(ord, triangledown),
-    sym(rel, eqcirc),
-    sym(rel, lesseqgtr),
-    sym(rel, gtreqless),
-    sym(rel, lesseqqgtr),
-    sym(rel, gtreqqless),
-    sym(rel, Rrightarrow),
-    sym(rel, Lleftarrow),
-    sym(bin, veebar),
-    sym(bin, barwedge),
-    sym(bin, doublebarwedge),
-    sym(ord, measuredangle),
-    sym(ord, sphericalangle),
-    sym(rel, varpropto),
-    sym(rel, smallsmile),
-    sym(rel, smallfrown),
-    sym(rel, Subset),
-    sym(rel, Supset),
-    sym(bin, Cup),
-    sym(bin, Cap),
-    sym(bin, curlywedge),
-    sym(bin, curlyvee),
-    sym(bin, leftthreetimes),
-    sym(bin, rightthreetimes),
-    sym(rel, subseteqq),
-    sym(rel, supseteqq),
-    sym(rel, bumpeq),
-    sym(rel, Bumpeq),
-    sym(rel, lll),
+    sym(rel, gets),
+    sym(rel, gg),
     sym(rel, ggg),
-    sym(ord, circledS),
-    sym(rel, pitchfork),
-    sym(bin, dotplus),
-    sym(rel, backsim),
-    sym(rel, backsimeq),
-    sym(ord, complement),
-    sym(bin, intercal),
-    sym(bin, circledcirc),
-    sym(bin, circledast),
-    sym(bin, circleddash),
-    sym(rel, lvertneqq),
-    sym(rel, gvertneqq),
-    sym(rel, nleq),
-    sym(rel, ngeq),
-    sym(rel, nless),
-    sym(rel, ngtr),
-    sym(rel, nprec),
-    sym(rel, nsucc),
-    sym(rel, lneqq),
-    sym(rel, gneqq),
-    sym(rel, nleqslant),
-    sym(rel, ngeqslant),
-    sym(rel, lneq),
+    sym(ord, gimel),
+    sym(rel, gnapprox),
     sym(rel, gneq),
-    sym(rel, npreceq),
-    sym(rel, nsucceq),
-    sym(rel, precnsim),
-    sym(rel, succnsim),
-    sym(rel, lnsim),
+    sym(rel, gneqq),
     sym(rel, gnsim),
-    sym(rel, nleqq),
-    sym(rel, ngeqq),
-    sym(rel, precneqq),
-    sym(rel, succneqq),
-    sym(rel, precnapprox),
-    sym(rel, succnapprox),
-    sym(rel, lnapprox),
-    sym(rel, gnapprox),
-    sym(rel, nsim),
-    sym(rel, ncong),
-    sym(ord, diagup),
-    sym(ord, diagdown),
-    sym(rel, varsubsetneq),
-    sym(rel, varsupsetneq),
-    sym(rel, nsubseteqq),
-    sym(rel, nsupseteqq),
-    sym(rel, subsetneqq),
-    sym(rel, supsetneqq),
-    sym(rel, varsubsetneqq),
-    sym(rel, varsupsetneqq),
-    sym(rel, subsetneq),
-    sym(rel, supsetneq),
-    sym(rel, nsubseteq),
-    sym(rel, nsupseteq),
-    sym(rel, nparallel),
-    sym(rel, nmid),
-    sym(rel, nshortmid),
-    sym(rel, nshortparallel),
-    sym(rel, nvdash),
-    sym(rel, nVdash),
-    sym(rel, nvDash),
-    sym(rel, nVDash),
-    sym(rel, ntrianglerighteq),
-    sym(rel, ntrianglelefteq),
-    sym(rel, ntriangleleft),
-    sym(rel, ntriangleright),
-    sym(rel, nleftarrow),
-    sym(rel, nrightarrow),
-    sym(rel, nLeftarrow),
-    sym(rel, nRightarrow),
-    sym(rel, nLeftrightarrow),
-    sym(rel, nleftrightarrow),
-    sym(bin, divideontimes),
-    sym(ord, varnothing),
-    sym(ord, nexists),
-    sym(ord, Finv),
-    sym(ord, Game),
-    sym(ord, eth),
-    sym(rel, eqsim),
-    sym(ord, beth),
-    sym(ord, gimel),
-    sym(ord, daleth),
-    sym(bin, lessdot),
+    sym(acc, grave),
+    sym(rel, gt),
+    sym(rel, gtrapprox),
     sym(bin, gtrdot),
-    sym(bin, ltimes),
-    sym(bin, rtimes),
-    sym(rel, shortmid),
-    sym(rel, shortparallel),
-    sym(bin, smallsetminus),
-    sym(rel, thicksim),
-    sym(rel, thickapprox),
-    sym(rel, approxeq),
-    sym(rel, succapprox),
-    sym(rel, precapprox),
-    sym(rel, curvearrowleft),
-    sym(rel, curvearrowright),
-    sym(ord, digamma),
-    sym(ord, varkappa),
-    sym(ord, Bbbk),
-    sym(ord, hslash),
-    sym(rel, backepsilon),
-    sym(rel, Diamond),
-    sym(rel, leadsto),
-    // miscellaneous symbols
+    sym(rel, gtreqless),
+    sym(rel, gtreqqless),
+    sym(rel, gtrless),
+    sym(rel, gtrsim),
     sym(punct, guillemotleft),
     sym(punct, guillemotright),
     sym(punct, guilsinglleft),
     sym(punct, guilsinglright),
-    sym(punct, fg),
-    sym(punct, og),
-    sym(ord, textperthousand),
-    sym(ord, textpertenthousand),
-    sym(ord, textminus),
-    sym(ord, textendash),
-    sym(ord, textemdash),
-    sym(ord, S),
-    sym(ord, P),
-    sym(punct, comma),
-    sym(punct, ldotp),
-    sym(punct, cdotp),
-    sym(ord, normaldot),
-    sym(punct, textnormaldot),
-    sym(ord, slash),
-    sym(punct, semicolon),
-    sym(ord, faculty),
-    sym(ord, question),
-    sym(ord, questiondown),
-    sym(ord, mathsharp),
-    sym(ord, textdollar),
-    sym(ord, textpercent),
-    sym(ord, textampersand),
-    sym(ord, textfractionsolidus),
-    sym(ord, matharobase),
-    sym(ord, underscore),
-    sym(ord, checkmark),
-    sym(ord, mathsterling),
-    sym(ord, yen),
-    // math accents
-    sym(acc, acute),
-    sym(acc, grave),
-    sym(acc, ddot),
-    sym(acc, doubleacute),
-    sym(acc, tilde),
-    sym(acc, mathring),
-    sym(acc, mathring),
-    sym(acc, bar),
-    sym(acc, breve),
-    sym(acc, check),
+    sym(rel, gvertneqq),
     sym(acc, hat),
-    sym(acc, vec),
-    sym(acc, dot),
-    sym(acc, widehat),
-    sym(acc, widetilde),
-    sym(acc, tie),
-    // delimiters that can change size
+    sym(ord, hbar),
+    sym(ord, heartsuit),
+    sym(ord, hslash),
+    sym(ord, i),
+    sym(ord, imath),
+    sym(rel, in),
+    sym(ord, infty),
+    sym(rel, inplus),
+    sym(op, int),
+    sym(bin, intercal),
+    sym(bin, interleave),
+    sym(ord, iota),
+    sym(ord, j),
+    sym(ord, jmath),
+    sym(ord, kappa),
+    sym(ord, lacc),
+    sym(ord, lambda),
+    sym(bin, land),
+    del(open, langle),
+    sym(bin, lbag),
     del(open, lbrace),
-    del(close, rbrace),
     del(open, lbrack),
-    del(close, rbrack),
-    del(close, rsqbrack),
-    del(open, lsqbrack),
-    del(open, langle),
-    del(close, rangle),
-    del(open, lfloor),
-    del(close, rfloor),
     del(open, lceil),
-    del(close, rceil),
-    del(rel, uparrow),
-    del(rel, Uparrow),
-    del(rel, downarrow),
-    del(rel, Downarrow),
-    del(rel, updownarrow),
-    del(rel, Updownarrow),
-    del(ord, vert),
-    del(ord, Vert),
-    del(open, slashdel),
-    del(rel, Relbar),
+    sym(punct, ldotp),
+    sym(rel, le),
+    sym(rel, leadsto),
+    sym(rel, leftarrow),
+    sym(rel, leftarrowtail),
+    sym(rel, leftarrowtriangle),
+    sym(rel, leftharpoondown),
+    sym(rel, leftharpoonup),
+    sym(rel, leftleftarrows),
+    sym(rel, leftrightarrow),
+    sym(rel, leftrightarroweq),
+    sym(rel, leftrightarrows),
+    sym(bin, leftrightarrowtriangle),
+    sym(rel, leftrightharpoons),
+    sym(rel, leftrightsquigarrow),
+    sym(bin, leftslice),
+    sym(bin, leftthreetimes),
+    sym(rel, leq),
+    sym(rel, leqq),
+    sym(rel, leqslant),
+    sym(rel, lessapprox),
+    sym(bin, lessdot),
+    sym(rel, lesseqgtr),
+    sym(rel, lesseqqgtr),
+    sym(rel, lessgtr),
+    sym(rel, lesssim),
+    del(open, lfloor),
     del(open, lgroup),
-    del(close, rgroup),
-    del(ord, bracevert),
+    sym(rel, lhd),
+    sym(ord, lhook),
+    sym(ord, lightning),
+    sym(rel, ll),
+    sym(open, llbracket),
+    sym(open, llceil),
+    sym(open, llcorner),
+    sym(open, llfloor),
+    sym(rel, lll),
+    sym(open, llparenthesis),
     del(open, lmoustache),
-    del(close, rmoustache),
-    // lowercase Greek letters
-    sym(ord, alpha),
-    sym(ord, beta),
-    sym(ord, gamma),
-    sym(ord, delta),
-    sym(ord, epsilon),
-    sym(ord, varepsilon),
-    sym(ord, zeta),
-    sym(ord, eta),
-    sym(ord, theta),
-    sym(ord, vartheta),
-    sym(ord, iota),
-    sym(ord, kappa),
-    sym(ord, lambda),
+    sym(rel, lnapprox),
+    sym(rel, lneq),
+    sym(rel, lneqq),
+    sym(ord, lnot),
+    sym(rel, lnsim),
+    sym(rel, looparrowleft),
+    sym(rel, looparrowright),
+    sym(bin, lor),
+    sym(ord, lozenge),
+    sym(ord, lq),
+    sym(close, lrcorner),
+    del(open, lsqbrack),
+    sym(rel, lt),
+    sym(bin, ltimes),
+    sym(rel, lvertneqq),
+    sym(ord, maltese),
+    sym(rel, mapsfromchar),
+    sym(rel, mapstochar),
+    sym(ord, matharobase),
+    sym(ord, mathcedilla),
+    sym(ord, mathlapos),
+    sym(acc, mathring),
+    sym(ord, mathsharp),
+    sym(ord, mathsterling),
+    sym(ord, measuredangle),
+    sym(bin, merge),
+    sym(ord, mho),
+    sym(rel, mid),
+    sym(bin, minus),
+    sym(bin, minuso),
+    sym(bin, moo),
+    sym(bin, mp),
     sym(ord, mu),
-    sym(ord, nu),
-    sym(ord, xi),
-    sym(ord, omicron),
-    sym(ord, pi),
-    sym(ord, varpi),
-    sym(ord, rho),
-    sym(ord, varrho),
-    sym(ord, sigma),
-    sym(ord, varsigma),
-    sym(ord, tau),
-    sym(ord, upsilon),
-    sym(ord, phi),
-    sym(ord, varphi),
-    sym(ord, chi),
-    sym(ord, psi),
-    sym(ord, omega),
-    // uppercase Greek letters
-    sym(ord, Gamma),
-    sym(ord, Delta),
-    sym(ord, Theta),
-    sym(ord, Lambda),
-    sym(ord, Xi),
-    sym(ord, Pi),
-    sym(ord, Sigma),
-    sym(ord, Upsilon),
-    sym(ord, Phi),
-    sym(ord, Psi),
-    sym(ord, Omega),
-    sym(ord, varGamma),
-    sym(ord, varDelta),
-    sym(ord, varTheta),
-    sym(ord, varLambda),
-    sym(ord, varXi),
-    sym(ord, varPi),
-    sym(ord, varSigma),
-    sym(ord, varUpsilon),
-    sym(ord, varPhi),
-    sym(ord, varPsi),
-    sym(ord, varOmega),
-    // miscellaneous symbols of type "ord"
-    sym(ord, aleph),
-    sym(ord, imath),
-    sym(ord, jmath),
-    sym(ord, ell),
-    sym(ord, wp),
-    sym(ord, Re),
-    sym(ord, Im),
-    sym(ord, partial),
-    sym(ord, infty),
-    sym(ord, prime),
-    sym(ord, emptyset),
+    sym(rel, multimap),
+    sym(rel, nLeftarrow),
+    sym(rel, nLeftrightarrow),
+    sym(rel, nRightarrow),
+    sym(rel, nVDash),
+    sym(rel, nVdash),
     sym(ord, nabla),
-    sym(ord, surdsign),
-    sym(ord, top),
-    sym(ord, bot),
-    sym(ord, |),
-    sym(ord, triangle),
-    del(ord, backslash),
-    sym(ord, forall),
-    sym(ord, exists),
-    sym(ord, neg),
-    sym(ord, lnot),
-    sym(ord, flat),
     sym(ord, natural),
-    sym(ord, sharp),
-    sym(ord, clubsuit),
-    sym(ord, diamondsuit),
-    sym(ord, heartsuit),
-    sym(ord, spadesuit),
-    sym(ord, lacc),
-    sym(ord, racc),
-    // "large" operators
-    sym(op, bigcap),
-    sym(op, bigcup),
-    sym(op, bigodot),
-    sym(op, bigoplus),
-    sym(op, bigotimes),
-    sym(op, bigsqcup),
-    sym(op, biguplus),
-    sym(op, bigvee),
-    sym(op, bigwedge),
-    sym(op, coprod),
-    sym(op, int),
+    sym(rel, ncong),
+    sym(rel, nearrow),
+    sym(ord, neg),
+    sym(ord, nexists),
+    sym(rel, ngeq),
+    sym(rel, ngeqq),
+    sym(rel, ngeqslant),
+    sym(rel, ngtr),
+    sym(rel, ni),
+    sym(rel, niplus),
+    sym(rel, nleftarrow),
+    sym(rel, nleftrightarrow),
+    sym(rel, nleq),
+    sym(rel, nleqq),
+    sym(rel, nleqslant),
+    sym(rel, nless),
+    sym(rel, nmid),
+    sym(rel, nnearrow),
+    sym(rel, nnwarrow),
+    sym(ord, normaldot),
+    sym(rel, not),
+    sym(rel, nparallel),
+    sym(bin, nplus),
+    sym(rel, nprec),
+    sym(rel, npreceq),
+    sym(rel, nrightarrow),
+    sym(rel, nshortmid),
+    sym(rel, nshortparallel),
+    sym(rel, nsim),
+    sym(rel, nsubseteq),
+    sym(rel, nsubseteqq),
+    sym(rel, nsucc),
+    sym(rel, nsucceq),
+    sym(rel, nsupseteq),
+    sym(rel, nsupseteqq),
+    sym(rel, ntriangleleft),
+    sym(rel, ntrianglelefteq),
+    sym(rel, ntrianglelefteqslant),
+    sym(rel, ntriangleright),
+    sym(rel, ntrianglerighteq),
+    sym(rel, ntrianglerighteqslant),
+    sym(ord, nu),
+    sym(rel, nvDash),
+    sym(ord, nvarparallel),
+    sym(rel, nvdash),
+    sym(rel, nwarrow),
+    sym(ord, o),
+    sym(bin, obar),
+    sym(bin, oblong),
+    sym(bin, obslash),
+    sym(bin, odot),
+    sym(ord, oe),
+    sym(punct, og),
+    sym(acc, ogonek),
+    sym(bin, ogreaterthan),
     sym(op, oint),
-    sym(op, sum),
-    sym(op, prod),
-    sym(op, smallint),
-    // binary operators
-    sym(bin, minus),
+    sym(bin, olessthan),
+    sym(ord, omega),
+    sym(ord, omicron),
+    sym(bin, ominus),
+    sym(bin, oplus),
+    sym(bin, oslash),
+    sym(bin, otimes),
+    sym(bin, ovee),
+    sym(bin, owedge),
+    sym(rel, owns),
+    sym(rel, parallel),
+    sym(ord, parallelogram),
+    sym(ord, partial),
+    sym(rel, perp),
+    sym(ord, phi),
+    sym(ord, pi),
+    sym(rel, pitchfork),
     sym(bin, plus),
     sym(bin, pm),
-    sym(bin, mp),
+    sym(ord, polishlcross),
+    sym(rel, prec),
+    sym(rel, precapprox),
+    sym(rel, preccurlyeq),
+    sym(rel, preceq),
+    sym(rel, precnapprox),
+    sym(rel, precneqq),
+    sym(rel, precnsim),
+    sym(rel, precsim),
+    sym(ord, prime),
+    sym(op, prod),
+    sym(rel, propto),
+    sym(ord, psi),
+    sym(ord, question),
+    sym(ord, questiondown),
+    sym(ord, racc),
+    del(close, rangle),
+    sym(bin, rbag),
+    del(close, rbrace),
+    del(close, rbrack),
+    del(close, rceil),
+    del(close, rfloor),
+    del(close, rgroup),
+    sym(rel, rhd),
+    sym(ord, rho),
+    sym(ord, rhook),
+    sym(rel, rightarrow),
+    sym(rel, rightarrowtail),
+    sym(rel, rightarrowtriangle),
+    sym(rel, rightharpoondown),
+    sym(rel, rightharpoonup),
+    sym(rel, rightleftarrows),
+    sym(rel, rightleftharpoons),
+    sym(rel, rightrightarrows),
+    sym(bin, rightslice),
+    sym(rel, rightsquigarrow),
+    sym(bin, rightthreetimes),
+    sym(rel, risingdotseq),
+    del(close, rmoustache),
+    sym(ord, rq),
+    sym(close, rrbracket),
+    sym(close, rrceil),
+    sym(close, rrfloor),
+    sym(close, rrparenthesis),
+    del(close, rsqbrack),
+    sym(bin, rtimes),
+    sym(rel, searrow),
+    sym(punct, semicolon),
     sym(bin, setminus),
-    sym(bin, cdot),
-    sym(bin, times),
-    sym(bin, ast),
-    sym(bin, star),
-    sym(bin, diamond),
-    sym(bin, circ),
-    sym(bin, bullet),
-    sym(bin, div),
-    sym(bin, cap),
-    sym(bin, cup),
-    sym(bin, uplus),
+    sym(ord, sharp),
+    sym(rel, shortdownarrow),
+    sym(rel, shortleftarrow),
+    sym(rel, shortmid),
+    sym(rel, shortparallel),
+    sym(rel, shortrightarrow),
+    sym(rel, shortuparrow),
+    sym(ord, sigma),
+    sym(rel, sim),
+    sym(rel, simeq),
+    sym(ord, slash),
+    del(open, slashdel),
+    sym(rel, smallfrown),
+    sym(op, smallint),
+    sym(bin, smallsetminus),
+    sym(rel, smallsmile),
+    sym(rel, smile),
+    sym(ord, spadesuit),
+    sym(ord, sphericalangle),
     sym(bin, sqcap),
     sym(bin, sqcup),
-    sym(bin, triangleleft),
-    sym(bin, triangleright),
-    sym(bin, wr),
-    sym(bin, bigcirc),
-    sym(bin, vee),
-    sym(bin, lor),
-    sym(bin, land),
-    sym(bin, wedge),
-    sym(bin, oplus),
-    sym(bin, ominus),
-    sym(bin, otimes),
-    sym(bin, oslash),
-    sym(bin, odot),
-    sym(bin, dagger),
-    sym(bin, ddagger),
-    sym(bin, amalg),
-    // relations
-    sym(rel, equals),
-    sym(rel, gt),
-    sym(rel, lt),
-    sym(rel, leq),
-    sym(rel, le),
-    sym(rel, prec),
-    sym(rel, preceq),
-    sym(rel, ll),
+    sym(rel, sqsubset),
+    sym(rel, sqsubseteq),
+    sym(rel, sqsupset),
+    sym(rel, sqsupseteq),
+    sym(ord, square),
+    sym(ord, ss),
+    sym(rel, ssearrow),
+    sym(bin, sslash),
+    sym(rel, sswarrow),
+    sym(bin, star),
     sym(rel, subset),
     sym(rel, subseteq),
-    sym(rel, sqsubseteq),
-    sym(rel, in),
-    sym(rel, vdash),
-    sym(rel, smile),
-    sym(rel, frown),
-    sym(rel, geq),
-    sym(rel, ge),
+    sym(rel, subseteqq),
+    sym(rel, subsetneq),
+    sym(rel, subsetneqq),
+    sym(rel, subsetplus),
+    sym(rel, subsetpluseq),
     sym(rel, succ),
+    sym(rel, succapprox),
+    sym(rel, succcurlyeq),
     sym(rel, succeq),
-    sym(rel, gg),
+    sym(rel, succnapprox),
+    sym(rel, succneqq),
+    sym(rel, succnsim),
+    sym(rel, succsim),
+    sym(op, sum),
     sym(rel, supset),
     sym(rel, supseteq),
-    sym(rel, sqsupseteq),
-    sym(rel, ni),
-    sym(rel, owns),
-    sym(rel, dashv),
-    sym(rel, mid),
-    sym(rel, parallel),
-    sym(rel, equiv),
-    sym(rel, sim),
-    sym(rel, simeq),
-    sym(rel, asymp),
-    sym(rel, approx),
-    sym(rel, propto),
-    sym(rel, perp),
-    // special relation symbol with "width=0" (to overlap other relational symbols)
-    sym(rel, not),
-    // arrows = pointing relations
-    sym(rel, colon),
-    sym(rel, nearrow),
-    sym(rel, searrow),
+    sym(rel, supseteqq),
+    sym(rel, supsetneq),
+    sym(rel, supsetneqq),
+    sym(rel, supsetplus),
+    sym(rel, supsetpluseq),
+    sym(ord, surdsign),
     sym(rel, swarrow),
-    sym(rel, nwarrow),
-    sym(rel, leftarrow),
-    sym(rel, gets),
-    sym(rel, Leftarrow),
-    sym(rel, rightarrow),
-    sym(rel, to),
-    sym(rel, Rightarrow),
-    sym(rel, leftrightarrow),
-    sym(rel, Leftrightarrow),
-    sym(rel, leftharpoonup),
-    sym(rel, leftharpoondown),
-    sym(rel, rightharpoonup),
-    sym(rel, rightharpoondown),
-    // specials
-    sym(ord, textmu),
+    sym(bin, talloblong),
+    sym(ord, tau),
+    sym(ord, textampersand),
+    sym(ord, textapos),
+    sym(ord, textdbend),
+    sym(ord, textdollar),
+    sym(ord, textemdash),
+    sym(ord, textendash),
     sym(ord, texteuro),
-    sym(ord, euro),
-    sym(ord, android),
-    sym(ord, dT),
-    sym(ord, dE),
-    sym(ord, dX),
+    sym(ord, textfractionsolidus),
+    sym(ord, textminus),
+    sym(ord, textmu),
+    sym(punct, textnormaldot),
+    sym(ord, textpercent),
+    sym(ord, textpertenthousand),
+    sym(ord, textperthousand),
+    sym(ord, textregistered),
+    sym(rel, therefore),
+    sym(ord, theta),
+    sym(rel, thickapprox),
+    sym(rel, thicksim),
+    sym(acc, tie),
+    sym(acc, tilde),
+    sym(bin, times),
+    sym(rel, to),
+    sym(ord, top),
+    sym(ord, triangle),
+    sym(ord, triangledown),
+    sym(bin, triangleleft),
+    sym(rel, trianglelefteq),
+    sym(rel, trianglelefteqslant),
+    sym(rel, triangleq),
+    sym(bin, triangleright),
+    sym(rel, trianglerighteq),
+    sym(rel, trianglerighteqslant),
+    sym(rel, twoheadleftarrow),
+    sym(rel, twoheadrightarrow),
+    sym(open, ulcorner),
+    sym(ord, underscore),
+    sym(rel, unlhd),
+    sym(rel, unrhd),
+    del(rel, uparrow),
+    del(rel, updownarrow),
+    sym(rel, upharpoonleft),
+    sym(rel, upharpoonright),
+    sym(bin, uplus),
+    sym(ord, upsilon),
+    sym(rel, upuparrows),
+    sym(close, urcorner),
+    sym(rel, vDash),
+    sym(ord, varDelta),
+    sym(ord, varGamma),
+    sym(ord, varLambda),
+    sym(ord, varOmega),
+    sym(ord, varPhi),
+    sym(ord, varPi),
+    sym(ord, varPsi),
+    sym(ord, varSigma),
+    sym(ord, varTheta),
+    sym(ord, varUpsilon),
+    sym(ord, varXi),
+    sym(bin, varbigcirc),
+    sym(bin, varcurlyvee),
+    sym(bin, varcurlywedge),
+    sym(ord, varepsilon),
+    sym(ord, varkappa),
+    sym(ord, varnothing),
+    sym(bin, varoast),
+    sym(bin, varobar),
+    sym(bin, varobslash),
+    sym(bin, varocircle),
+    sym(bin, varodot),
+    sym(bin, varogreaterthan),
+    sym(bin, varolessthan),
+    sym(bin, varominus),
+    sym(bin, varoplus),
+    sym(bin, varoslash),
+    sym(bin, varotimes),
+    sym(bin, varovee),
+    sym(bin, varowedge),
     sym(ord, varparallel),
-    sym(ord, nvarparallel),
     sym(ord, varparalleleq),
-    sym(ord, parallelogram),
+    sym(ord, varphi),
+    sym(ord, varpi),
+    sym(rel, varpropto),
+    sym(ord, varrho),
+    sym(ord, varsigma),
+    sym(rel, varsubsetneq),
+    sym(rel, varsubsetneqq),
+    sym(rel, varsupsetneq),
+    sym(rel, varsupsetneqq),
+    sym(ord, vartheta),
+    sym(bin, vartimes),
+    sym(rel, vartriangle),
+    sym(rel, vartriangleleft),
+    sym(rel, vartriangleright),
+    sym(rel, vdash),
+    sym(acc, vec),
+    sym(bin, vee),
+    sym(bin, veebar),
+    del(ord, vert),
+    sym(bin, wedge),
+    sym(acc, widehat),
+    sym(acc, widetilde),
+    sym(ord, wp),
+    sym(bin, wr),
+    sym(ord, xi),
+    sym(ord, yen),
+    sym(ord, zeta),
+    sym(ord, |),
 };
+
+static_assert(isSortedTable(BUILTIN_SYMBOLS), "The builtin symbols must be sorted by the name");
+
+TableObjects<sptr<SymbolAtom>, std::size(BUILTIN_SYMBOLS)> builtinAtoms;
+
+}  // namespace
+
+map<string, sptr<SymbolAtom>> SymbolAtom::_symbols;
+
+sptr<SymbolAtom> SymbolAtom::get(const string& name) {
+  auto it = _symbols.find(name);
+  if (it != _symbols.end()) return it->second;
+  const auto* s = findInTable(BUILTIN_SYMBOLS, name.c_str());
+  if (s == nullptr) throw ex_symbol_not_found(name);
+  return builtinAtoms.get(BUILTIN_SYMBOLS, s, [](const BuiltinSymbol& e) {
+    return sptrOf<SymbolAtom>(e.key, e.type, e.isDelimiter);
+  });
+}
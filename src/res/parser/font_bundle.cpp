@@ -0,0 +1,305 @@
+#include "res/parser/font_bundle.h"
+
+#include <cstdint>
+#include <cstring>
+
+#include "res/parser/font_parser.h"
+#include "utils/exceptions.h"
+#include "utils/string_utils.h"
+
+using namespace std;
+using namespace tex;
+
+const u32 FontBundle::VERSION = 1;
+const string FontBundle::EXTENSION = ".bundle";
+
+namespace {
+
+const char MAGIC[4] = {'C', 'L', 'M', 'B'};
+const u32 BYTE_ORDER_MARK = 0x01020304;
+// offset of the size of the bundle in the header
+const size_t SIZE_OFFSET = 16;
+// the largest char code, the float codes of the tables are cast to int by IndexedArray
+const float MAX_CODE = 0x10ffff;
+
+class Writer {
+private:
+  vector<u8>& _out;
+  const size_t _start;
+
+public:
+  explicit Writer(vector<u8>& out) : _out(out), _start(out.size()) {}
+
+  void raw(const void* data, size_t n) {
+    const u8* p = (const u8*) data;
+    _out.insert(_out.end(), p, p + n);
+    while ((_out.size() - _start) % 4 != 0) _out.push_back(0);
+  }
+
+  void u(u32 v) { raw(&v, sizeof(v)); }
+
+  void i(i32 v) { raw(&v, sizeof(v)); }
+
+  void f(float v) { raw(&v, sizeof(v)); }
+
+  void str(const string& s) {
+    u((u32) s.size());
+    raw(s.data(), s.size());
+  }
+
+  template <typename T>
+  void table(const __FontTable<T>& t) {
+    u((u32) t.len);
+    raw(t.data, t.len * sizeof(T));
+  }
+
+  void chr(const __NamedCharFont& c) {
+    u((u32) c.ch);
+    str(c.font);
+    str(c.bold);
+  }
+
+  void mappings(const vector<pair<int, string>>& m) {
+    u((u32) m.size());
+    for (const auto& x : m) {
+      i(x.first);
+      str(x.second);
+    }
+  }
+
+  void finish() {
+    const u32 size = (u32) (_out.size() - _start);
+    memcpy(_out.data() + _start + SIZE_OFFSET, &size, sizeof(size));
+  }
+};
+
+class Reader {
+private:
+  const u8* _p;
+  const u8* const _end;
+  const string& _path;
+
+public:
+  Reader(const u8* data, size_t size, const string& path)
+    : _p(data), _end(data + size), _path(path) {}
+
+  [[noreturn]] void fail(const string& why) const {
+    throw ex_res_parse("The font bundle '" + _path + "' " + why);
+  }
+
+  const u8* take(size_t n) {
+    const size_t padded = (n + 3) & ~(size_t) 3;
+    if ((size_t) (_end - _p) < padded) fail("is truncated!");
+    const u8* p = _p;
+    _p += padded;
+    return p;
+  }
+
+  u32 u() {
+    u32 v;
+    memcpy(&v, take(sizeof(v)), sizeof(v));
+    return v;
+  }
+
+  i32 i() {
+    i32 v;
+    memcpy(&v, take(sizeof(v)), sizeof(v));
+    return v;
+  }
+
+  float f() {
+    float v;
+    memcpy(&v, take(sizeof(v)), sizeof(v));
+    return v;
+  }
+
+  string str() {
+    const u32 n = u();
+    return string((const char*) take(n), n);
+  }
+
+  /**
+   * The table of rows of the given width, it points to the data, which is aligned
+   * to 4 bytes since the bundle is
+   */
+  template <typename T>
+  __FontTable<T> table(u32 width) {
+    const u32 n = u();
+    if (n % width != 0 || n > (u32) INT32_MAX) fail("has a table of an invalid size!");
+    return __FontTable<T>((const T*) take((size_t) n * sizeof(T)), (int) n, false);
+  }
+
+  /** Check the first keys of the rows of the given table are char codes */
+  void codes(const __FontTable<float>& t, int width, int keys) const {
+    for (int row = 0; row < t.len; row += width) {
+      for (int k = 0; k < keys; k++) {
+        const float c = t.data[row + k];
+        // false for NaN too
+        if (!(c >= 0 && c <= MAX_CODE)) fail("has an invalid char code!");
+      }
+    }
+  }
+
+  __NamedCharFont chr() {
+    __NamedCharFont c;
+    c.ch = (wchar_t) u();
+    c.font = str();
+    c.bold = str();
+    return c;
+  }
+
+  void mappings(vector<pair<int, string>>& m) {
+    const u32 n = u();
+    for (u32 k = 0; k < n; k++) {
+      const i32 code = i();
+      m.emplace_back(code, str());
+    }
+  }
+};
+
+}  // namespace
+
+void FontBundle::compile(const string& base, const string& file, vector<u8>& out) {
+  __FontDescription desc;
+  DefaultTeXFontParser(base, file).parse(desc);
+  compile(base, desc, out);
+}
+
+void FontBundle::compile(const string& base, const __FontDescription& desc, vector<u8>& out) {
+  Writer w(out);
+  w.raw(MAGIC, sizeof(MAGIC));
+  w.u(VERSION);
+  w.u(BYTE_ORDER_MARK);
+  w.u((u32) sizeof(wchar_t));
+  // the size of the bundle, see Writer#finish
+  w.u(0);
+
+  const string prefix = base + "/";
+  w.u((u32) desc.fonts.size());
+  for (const auto& f : desc.fonts) {
+    w.str(f.id);
+    w.str(startswith(f.file, prefix) ? f.file.substr(prefix.size()) : f.file);
+    w.f(f.xHeight);
+    w.f(f.space);
+    w.f(f.quad);
+    w.i(f.skewChar);
+    w.str(f.bold);
+    w.str(f.roman);
+    w.str(f.ss);
+    w.str(f.tt);
+    w.str(f.it);
+    w.table(f.metrics);
+    w.table(f.extensions);
+    w.table(f.kerns);
+    w.table(f.ligs);
+    w.u((u32) f.largers.size());
+    for (const auto& l : f.largers) {
+      w.u((u32) l.code);
+      w.u((u32) l.larger);
+      w.str(l.font);
+    }
+  }
+
+  w.u((u32) desc.textStyles.size());
+  for (const auto& s : desc.textStyles) {
+    w.str(s.first);
+    for (const auto& c : s.second) w.chr(c);
+  }
+
+  w.u((u32) desc.symbolMappings.size());
+  for (const auto& m : desc.symbolMappings) {
+    w.str(m.first);
+    w.chr(m.second);
+  }
+
+  w.u((u32) desc.symbols.size());
+  for (const auto& s : desc.symbols) {
+    w.str(s.name);
+    w.i((i32) s.type);
+    w.u(s.del ? 1 : 0);
+  }
+
+  w.mappings(desc.charToSymbol);
+  w.mappings(desc.charToFormula);
+  w.mappings(desc.charToText);
+  w.finish();
+}
+
+string FontBundle::pathOf(const string& file) {
+  if (endswith(file, ".xml")) return file.substr(0, file.size() - 4) + EXTENSION;
+  return file + EXTENSION;
+}
+
+FontBundle::FontBundle(const string& path) : _file(path), _path(path) {}
+
+void FontBundle::read(__FontDescription& desc) const {
+  Reader r(_file.data(), _file.size(), _path);
+  if (memcmp(r.take(sizeof(MAGIC)), MAGIC, sizeof(MAGIC)) != 0) r.fail("is not a font bundle!");
+  if (r.u() != VERSION) r.fail("has an unsupported version, recompile it!");
+  if (r.u() != BYTE_ORDER_MARK || r.u() != sizeof(wchar_t)) {
+    r.fail("was compiled on an incompatible machine, recompile it!");
+  }
+  if (r.u() != _file.size()) r.fail("has an invalid size!");
+
+  const string dir = _path.substr(0, _path.find_last_of("/\\") + 1);
+  const u32 fonts = r.u();
+  for (u32 k = 0; k < fonts; k++) {
+    desc.fonts.emplace_back();
+    __FontDesc& f = desc.fonts.back();
+    f.id = r.str();
+    const string file = r.str();
+    const bool absolute = !file.empty() && (file[0] == '/' || (file.size() > 1 && file[1] == ':'));
+    f.file = absolute ? file : dir + file;
+    f.xHeight = r.f();
+    f.space = r.f();
+    f.quad = r.f();
+    f.skewChar = r.i();
+    f.bold = r.str();
+    f.roman = r.str();
+    f.ss = r.str();
+    f.tt = r.str();
+    f.it = r.str();
+    // the row widths of the tables, see FontInfo
+    f.metrics = r.table<float>(5);
+    r.codes(f.metrics, 5, 1);
+    f.extensions = r.table<int>(5);
+    f.kerns = r.table<float>(3);
+    r.codes(f.kerns, 3, 2);
+    f.ligs = r.table<wchar_t>(3);
+    const u32 largers = r.u();
+    for (u32 j = 0; j < largers; j++) {
+      __NamedLarger l;
+      l.code = (wchar_t) r.u();
+      l.larger = (wchar_t) r.u();
+      l.font = r.str();
+      f.largers.push_back(l);
+    }
+  }
+
+  const u32 styles = r.u();
+  for (u32 k = 0; k < styles; k++) {
+    desc.textStyles.emplace_back();
+    auto& s = desc.textStyles.back();
+    s.first = r.str();
+    for (auto& c : s.second) c = r.chr();
+  }
+
+  const u32 mappings = r.u();
+  for (u32 k = 0; k < mappings; k++) {
+    string name = r.str();
+    desc.symbolMappings.emplace_back(move(name), r.chr());
+  }
+
+  const u32 symbols = r.u();
+  for (u32 k = 0; k < symbols; k++) {
+    __SymbolDesc s;
+    s.name = r.str();
+    s.type = (AtomType) r.i();
+    s.del = r.u() != 0;
+    desc.symbols.push_back(s);
+  }
+
+  r.mappings(desc.charToSymbol);
+  r.mappings(desc.charToFormula);
+  r.mappings(desc.charToText);
+}
@@ -0,0 +1,92 @@
+#ifndef FONT_BUNDLE_H_INCLUDED
+#define FONT_BUNDLE_H_INCLUDED
+
+#include <string>
+#include <vector>
+
+#include "fonts/font_desc.h"
+#include "utils/mapped_file.h"
+
+namespace tex {
+
+/**
+ * A TeX font description (e.g. an alphabet) compiled from XML into a binary
+ * bundle, so it could be registered without parsing XML. The bundle is mapped
+ * into memory and the tables of the fonts (metrics, extensions, kerning and
+ * ligatures) are not copied, the fonts point to the mapped data directly, so the
+ * bundle must outlive the fonts registered from it.
+ * <p>
+ * The values are in the byte order of the compiling machine, the tables are
+ * aligned to 4 bytes and laid out as FontInfo expects, a bundle is only loaded
+ * on a machine with the same byte order and the same size of wchar_t. The layout
+ * is:
+ * <pre>
+ * header: "CLMB", u32 version, u32 byte order mark, u32 size of wchar_t, u32 size of the bundle
+ * u32 font count, for each font:
+ *     str id, str file, f32 x height, f32 space, f32 quad, i32 skew char,
+ *     str bold, str roman, str ss, str tt, str it,
+ *     table metrics (f32), table extensions (i32), table kerns (f32), table ligatures (wchar_t),
+ *     u32 larger count, for each: u32 code, u32 larger, str font
+ * u32 text style count, for each: str name, 4 x char
+ * u32 symbol mapping count, for each: str name, char
+ * u32 symbol count, for each: str name, i32 type, u32 is delimiter
+ * 3 x (u32 count, for each: i32 code, str value) for the chars to symbols, to formulas and to text
+ * </pre>
+ * where a str is u32 length and the bytes padded to 4 bytes, a table is u32 count of
+ * elements and the elements padded to 4 bytes, and a char is u32 code, str font,
+ * str bold font. The paths of the font files are relative to the directory of
+ * the bundle.
+ */
+class FontBundle {
+private:
+  static const u32 VERSION;
+
+  MappedFile _file;
+  std::string _path;
+
+public:
+  /** The extension of the bundle files, e.g. language_greek.bundle */
+  static const std::string EXTENSION;
+
+  /**
+   * Compile the TeX font description of the given XML file into a bundle.
+   *
+   * @param base the directory of the files the description includes, the paths of
+   * the font files in the bundle are relative to this directory, so the bundle is
+   * expected to be placed in it
+   * @param file the path of the XML file
+   * @param out the buffer to append the bundle to
+   */
+  static void compile(const std::string& base, const std::string& file, std::vector<u8>& out);
+
+  /**
+   * Compile the given TeX font description (e.g. read from an OpenType font, see
+   * OpenTypeParser) into a bundle.
+   *
+   * @param base the directory the bundle is expected to be placed in, the paths of the
+   * font files in this directory are written relative to it, the others as they are
+   * @param desc the description to compile
+   * @param out the buffer to append the bundle to
+   */
+  static void compile(const std::string& base, const __FontDescription& desc, std::vector<u8>& out);
+
+  /** Get the path of the bundle compiled from the given XML file, see #EXTENSION */
+  static std::string pathOf(const std::string& file);
+
+  /** Map the bundle of the given path, throws ex_file_not_found if the file could not be opened */
+  explicit FontBundle(const std::string& path);
+
+  no_copy_assign(FontBundle);
+
+  /**
+   * Read the description in this bundle, the tables of the fonts point to the
+   * mapped data. Throws ex_res_parse if the bundle is malformed (e.g. a table is
+   * not made of whole rows or a char code is not a number in range) or compiled
+   * on an incompatible machine.
+   */
+  void read(__FontDescription& desc) const;
+};
+
+}  // namespace tex
+
+#endif  // FONT_BUNDLE_H_INCLUDED
@@ -1,4 +1,5 @@
 #include "res/parser/font_parser.h"
+#include "res/parser/formula_parser.h"
 
 #include <numeric>
 
@@ -62,10 +63,10 @@ void DefaultTeXFontParser::parse_lig(const XMLElement* e, wchar_t c, __BasicInfo
 }
 
 void DefaultTeXFontParser::parse_larger(const XMLElement* e, wchar_t c, __BasicInfo& f) {
-  __Larger larger;
+  __NamedLarger larger;
   larger.code = c;
   larger.larger = (wchar_t)getIntAndCheck("code", e);
-  larger.fontId = __id(getAttrValueAndCheckIfNotNull("fontId", e));
+  larger.font = getAttrValueAndCheckIfNotNull("fontId", e);
   f.largers.push_back(larger);
 }
 
@@ -96,7 +97,7 @@ void DefaultTeXFontParser::processCharElement(const XMLElement* e, __BasicInfo&
 }
 
 void DefaultTeXFontParser::parseStyleMappings(
-    map<string, vector<CharFont*>>& res) {
+    vector<pair<string, array<__NamedCharFont, 4>>>& res) {
   const XMLElement* mapping = _root->FirstChildElement("TextStyleMappings");
   // no defined style mappings
   if (mapping == nullptr) return;
@@ -114,7 +115,7 @@ void DefaultTeXFontParser::parseStyleMappings(
 #ifdef HAVE_LOG
     __dbg("MapRange tag name: %s\n", range->Name());
 #endif  // HAVE_LOG
-    vector<CharFont*> charFonts(4);
+    array<__NamedCharFont, 4> charFonts;
     while (range != nullptr) {
       const string fontId = getAttrValueAndCheckIfNotNull("fontId", range);
       const int    ch     = getIntAndCheck("start", range);
@@ -128,34 +129,45 @@ void DefaultTeXFontParser::parseStyleMappings(
             "code",
             "contains an unknown 'range name' '" + code + "'!");
       }
-      CharFont* f = nullptr;
-      if (boldFontId.empty()) {
-        f = new CharFont((wchar_t)ch, __id(fontId));
-      } else {
-        f = new CharFont((wchar_t)ch, __id(fontId), __id(boldFontId));
-      }
-      charFonts[it->second] = f;
-      range                 = range->NextSiblingElement("MapRange");
+      __NamedCharFont& f = charFonts[it->second];
+      f.ch   = (wchar_t)ch;
+      f.font = fontId;
+      f.bold = boldFontId;
+      range  = range->NextSiblingElement("MapRange");
     }
-    res[textStyleName] = charFonts;
-    mapping            = mapping->NextSiblingElement("TextStyleMapping");
+    res.emplace_back(textStyleName, charFonts);
+    mapping = mapping->NextSiblingElement("TextStyleMapping");
   }
 }
 
-void DefaultTeXFontParser::parseExtraPath() {
+string DefaultTeXFontParser::includePath(const string& include) const {
+  if (_base.empty()) return RES_BASE + "/" + FONTS_RES_BASE + "/" + include;
+  return _base + "/" + include;
+}
+
+void DefaultTeXFontParser::parse(__FontDescription& desc) {
+  parseFontDescriptions(desc);
+  parseStyleMappings(desc.textStyles);
+  parseSymbolMappings(desc.symbolMappings);
+  parseExtraPath(desc);
+}
+
+void DefaultTeXFontParser::parseExtraPath(__FontDescription& desc) {
   const XMLElement* syms = _root->FirstChildElement("TeXSymbols");
   if (syms != nullptr) {  // element present
     string include = getAttrValueAndCheckIfNotNull("include", syms);
-    SymbolAtom::addSymbolAtom(_base + "/" + include);
+    TeXSymbolParser(_base + "/" + include).readSymbols(desc.symbols);
   }
   const XMLElement* settings = _root->FirstChildElement("FormulaSettings");
   if (settings != nullptr) {
     string include = getAttrValueAndCheckIfNotNull("include", settings);
-    Formula::addSymbolMappings(_base + "/" + include);
+    TeXFormulaSettingParser parser(_base + "/" + include);
+    parser.parseSymbol(desc.charToSymbol, desc.charToText);
+    parser.parseSymbol2Formula(desc.charToFormula, desc.charToText);
   }
 }
 
-void DefaultTeXFontParser::parseFontDescriptions() {
+void DefaultTeXFontParser::parseFontDescriptions(__FontDescription& desc) {
   const XMLElement* des = _root->FirstChildElement("FontDescriptions");
   if (des == nullptr) return;
 
@@ -166,13 +178,9 @@ void DefaultTeXFontParser::parseFontDescriptions() {
   const XMLElement* met = des->FirstChildElement("Metrics");
   while (met != nullptr) {
     const string include = getAttrValueAndCheckIfNotNull("include", met);
-    string       path    = "";
-    if (_base.empty()) {
-      path = RES_BASE + "/" + FONTS_RES_BASE + "/" + include;
-    } else {
-      path = _base + "/" + include;
-    }
-    parseFontDescriptions(path);
+    const string path    = includePath(include);
+    desc.fonts.emplace_back();
+    parseFont(path, desc.fonts.back());
 
 #ifdef HAVE_LOG
     __dbg("Metrics file path, path:%s\n", path.c_str());
@@ -180,19 +188,9 @@ void DefaultTeXFontParser::parseFontDescriptions() {
 
     met = met->NextSiblingElement("Metrics");
   }
-  parseStyleMappings(_parsedTextStyles);
-  // set various versions
-  for (auto i : FontInfo::__infos()) {
-    auto it = _variousVersion.find(i->getId());
-    if (it == _variousVersion.end()) continue;
-    auto v = it->second;
-    i->setVariousId(v.bold, v.roman, v.ss, v.tt, v.it);
-  }
 }
 
-void DefaultTeXFontParser::parseFontDescriptions(const string& file) {
-  if (file.empty()) return;
-
+void DefaultTeXFontParser::parseFont(const string& file, __FontDesc& f) {
   XMLDocument doc(true, COLLAPSE_WHITESPACE);
   const int   err = doc.LoadFile(file.c_str());
   if (err != XML_SUCCESS) throw ex_xml_parse("Cannot open file " + file + "!");
@@ -205,45 +203,32 @@ void DefaultTeXFontParser::parseFontDescriptions(const string& file) {
 
   // get required string attribute
   const string fontName = getAttrValueAndCheckIfNotNull("name", font);
-  const string fontId   = getAttrValueAndCheckIfNotNull("id", font);
-  if (__id(fontId) < 0) {
-    FontInfo::__predefine_name(fontId);
-  } else {
-    throw ex_font_loaded("Font " + fontId + " is already loaded!");
-  }
-
-  const int __id = __id(fontId);
+  f.id = getAttrValueAndCheckIfNotNull("id", font);
   // get required real attributes
-  const float space   = getFloatAndCheck("space", font);
-  const float xHeight = getFloatAndCheck("xHeight", font);
-  const float quad    = getFloatAndCheck("quad", font);
+  f.space   = getFloatAndCheck("space", font);
+  f.xHeight = getFloatAndCheck("xHeight", font);
+  f.quad    = getFloatAndCheck("quad", font);
   // optional
-  const int skewChar = getOptionalInt("skewChar", font, -1);
-  const int unicode  = getOptionalInt("unicode", font, 0);
+  f.skewChar = getOptionalInt("skewChar", font, -1);
   // get various versions of the font
-  __Versions v;
-  obtainAttr("boldVersion", font, v.bold);
-  obtainAttr("romanVersion", font, v.roman);
-  obtainAttr("ssVersion", font, v.ss);
-  obtainAttr("ttVersion", font, v.tt);
-  obtainAttr("itVersion", font, v.it);
-  _variousVersion[__id] = v;
+  obtainAttr("boldVersion", font, f.bold);
+  obtainAttr("romanVersion", font, f.roman);
+  obtainAttr("ssVersion", font, f.ss);
+  obtainAttr("ttVersion", font, f.tt);
+  obtainAttr("itVersion", font, f.it);
 
   /**
    * a name contains the file path relative to package "fonts",
    * "base/cmex10.xml" as an example, the font file is represents
    * with "base/cemx10.ttf"
    */
-  string path = file.substr(0, file.find_last_of("/") + 1) + fontName;
-  auto   info = FontInfo::__create(__id, path, xHeight, space, quad);
+  f.file = file.substr(0, file.find_last_of("/") + 1) + fontName;
 
-  // attribute set
-  if (skewChar != -1) info->__skewChar((wchar_t)skewChar);
   // process all "Char"-elements
   const XMLElement* e = font->FirstChildElement("Char");
 
 #ifdef HAVE_LOG
-  __dbg("parse Char, tag name: %s <should be Char>\n", e->Name());
+  if (e != nullptr) __dbg("parse Char, tag name: %s <should be Char>\n", e->Name());
 #endif  // HAVE_LOG
 
   __BasicInfo bi;
@@ -252,10 +237,10 @@ void DefaultTeXFontParser::parseFontDescriptions(const string& file) {
     e = e->NextSiblingElement("Char");
   }
   sortBasicInfo(bi);
-  setupFontInfo(bi, *info);
+  setupTables(bi, f);
 }
 
-void DefaultTeXFontParser::setupFontInfo(__BasicInfo& bi, FontInfo& fi) {
+void DefaultTeXFontParser::setupTables(__BasicInfo& bi, __FontDesc& f) {
   float* const metrics = new float[bi.metrics.size() * 5];
   accumulate(begin(bi.metrics), end(bi.metrics), 0, [&metrics](const int i, const __Metrics& m) {
     const size_t r = i * 5;
@@ -276,14 +261,6 @@ void DefaultTeXFontParser::setupFontInfo(__BasicInfo& bi, FontInfo& fi) {
     exts[r + 4]    = e.bot;
     return i + 1;
   });
-  int* const largers = new int[bi.largers.size() * 3];
-  accumulate(begin(bi.largers), end(bi.largers), 0, [&largers](const int i, const __Larger& l) {
-    const size_t r = i * 3;
-    largers[r + 0] = l.code;
-    largers[r + 1] = l.larger;
-    largers[r + 2] = l.fontId;
-    return i + 1;
-  });
   wchar_t* const ligtures = new wchar_t[bi.ligs.size() * 3];
   accumulate(begin(bi.ligs), end(bi.ligs), 0, [&ligtures](const int i, const __Lig& l) {
     const size_t r  = i * 3;
@@ -300,11 +277,11 @@ void DefaultTeXFontParser::setupFontInfo(__BasicInfo& bi, FontInfo& fi) {
     kerns[r + 2]   = k.kern;
     return i + 1;
   });
-  fi.__metrics(metrics, bi.metrics.size() * 5, true);
-  fi.__extensions(exts, bi.extensions.size() * 5, true);
-  fi.__largers(largers, bi.largers.size() * 3, true);
-  fi.__ligtures(ligtures, bi.ligs.size() * 3, true);
-  fi.__kerns(kerns, bi.kerns.size() * 3, true);
+  f.metrics    = __FontTable<float>(metrics, bi.metrics.size() * 5, true);
+  f.extensions = __FontTable<int>(exts, bi.extensions.size() * 5, true);
+  f.kerns      = __FontTable<float>(kerns, bi.kerns.size() * 3, true);
+  f.ligs       = __FontTable<wchar_t>(ligtures, bi.ligs.size() * 3, true);
+  f.largers    = move(bi.largers);
 }
 
 void DefaultTeXFontParser::sortBasicInfo(__BasicInfo& bi) {
@@ -314,7 +291,7 @@ void DefaultTeXFontParser::sortBasicInfo(__BasicInfo& bi) {
   sort(begin(bi.extensions), end(bi.extensions), [](const __Extension& x, const __Extension& y) {
     return x.ch < y.ch;
   });
-  sort(begin(bi.largers), end(bi.largers), [](const __Larger& x, const __Larger& y) {
+  sort(begin(bi.largers), end(bi.largers), [](const __NamedLarger& x, const __NamedLarger& y) {
     return x.code < y.code;
   });
   sort(begin(bi.kerns), end(bi.kerns), [](const __Kern& x, const __Kern& y) {
@@ -326,7 +303,7 @@ void DefaultTeXFontParser::sortBasicInfo(__BasicInfo& bi) {
 }
 
 void DefaultTeXFontParser::parseSymbolMappings(
-    map<string, CharFont*>& res) {
+    vector<pair<string, __NamedCharFont>>& res) {
   const XMLElement* mapping = _root->FirstChildElement("SymbolMappings");
   if (mapping == nullptr) throw ex_xml_parse(RESOURCE_NAME, "SymbolMappings");
 
@@ -339,12 +316,7 @@ void DefaultTeXFontParser::parseSymbolMappings(
   XMLDocument doc(true, COLLAPSE_WHITESPACE);
   while (mapping != nullptr) {
     const string include = getAttrValueAndCheckIfNotNull("include", mapping);
-    string       path    = "";
-    if (_base.empty()) {
-      path = RES_BASE + "/" + FONTS_RES_BASE + "/" + include;
-    } else {
-      path = _base + "/" + include;
-    }
+    const string path    = includePath(include);
 
 #ifdef HAVE_LOG
     __dbg("symbol map path: %s \n", path.c_str());
@@ -360,23 +332,13 @@ void DefaultTeXFontParser::parseSymbolMappings(
 #endif  // HAVE_LOG
 
     while (symbol != nullptr) {
-      const string  name       = getAttrValueAndCheckIfNotNull("name", symbol);
-      const wchar_t ch         = (wchar_t)getIntAndCheck("ch", symbol);
-      const string  fontId     = getAttrValueAndCheckIfNotNull("fontId", symbol);
-      string        boldFontId = "";
-      obtainAttr("boldId", symbol, boldFontId);
-
-      auto it = res.find(name);
-      if (it != res.end()) delete it->second;
-
-      CharFont* f = nullptr;
-      if (boldFontId.empty()) {
-        f = new CharFont(ch, __id(fontId));
-      } else {
-        f = new CharFont(ch, __id(fontId), __id(boldFontId));
-      }
-      res[name] = f;
-      symbol    = symbol->NextSiblingElement("SymbolMapping");
+      __NamedCharFont f;
+      const string name = getAttrValueAndCheckIfNotNull("name", symbol);
+      f.ch   = (wchar_t)getIntAndCheck("ch", symbol);
+      f.font = getAttrValueAndCheckIfNotNull("fontId", symbol);
+      obtainAttr("boldId", symbol, f.bold);
+      res.emplace_back(name, f);
+      symbol = symbol->NextSiblingElement("SymbolMapping");
     }
     mapping = mapping->NextSiblingElement("Mapping");
   }
@@ -408,7 +370,10 @@ string* DefaultTeXFontParser::parseDefaultTextStyleMappins() {
     // get mapped style and check
     const string textStyleName = getAttrValueAndCheckIfNotNull("textStyle", mapping);
 
-    const auto& it = _parsedTextStyles.find(textStyleName);
+    if (_parsedTextStyles.empty()) parseStyleMappings(_parsedTextStyles);
+    const auto it = find_if(
+      _parsedTextStyles.begin(), _parsedTextStyles.end(),
+      [&](const pair<string, array<__NamedCharFont, 4>>& s) { return s.first == textStyleName; });
     if (it == _parsedTextStyles.end()) {
       throw ex_xml_parse(
           RESOURCE_NAME,
@@ -420,7 +385,7 @@ string* DefaultTeXFontParser::parseDefaultTextStyleMappins() {
     const auto& charFonts = it->second;
     // now check if the range is defined within the mapped text style
     int index = codeMapping;
-    if (charFonts[index] == nullptr)
+    if (charFonts[index].font.empty())
       throw ex_xml_parse(
           RESOURCE_NAME + ": the default text style mapping '" +
           textStyleName + "' for the range '" + code +
@@ -432,11 +397,6 @@ string* DefaultTeXFontParser::parseDefaultTextStyleMappins() {
   return res;
 }
 
-map<string, vector<CharFont*>> DefaultTeXFontParser::parseTextStyleMappings() {
-  if (_parsedTextStyles.empty()) parseStyleMappings(_parsedTextStyles);
-  return _parsedTextStyles;
-}
-
 void DefaultTeXFontParser::parseParameters(map<string, float>& res) {
   const XMLElement* parameters = _root->FirstChildElement("Parameters");
   if (parameters == nullptr) throw ex_xml_parse(RESOURCE_NAME, "Parameter");
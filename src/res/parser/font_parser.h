@@ -2,15 +2,12 @@
 #define FONT_PARSER_H_INCLUDED
 
 #include "common.h"
+#include "fonts/font_desc.h"
 #include "fonts/fonts.h"
 #include <tinyxml2.h>
 
 namespace tex {
 
-struct __Versions {
-    std::string bold, roman, ss, tt, it;
-};
-
 struct __Metrics {
   wchar_t ch;
   float   width, height, depth, italic;
@@ -30,15 +27,10 @@ struct __Lig {
   wchar_t left, right, lig;
 };
 
-struct __Larger {
-  wchar_t code, larger;
-  int     fontId;
-};
-
 struct __BasicInfo {
   std::vector<__Metrics>   metrics;
   std::vector<__Extension> extensions;
-  std::vector<__Larger>    largers;
+  std::vector<__NamedLarger> largers;
   std::vector<__Kern>      kerns;
   std::vector<__Lig>       ligs;
 };
@@ -67,8 +59,7 @@ private:
   // the xml-document we used
   tinyxml2::XMLDocument _doc;
 
-  std::map<int, __Versions>           _variousVersion;
-  std::map<std::string, std::vector<CharFont*>> _parsedTextStyles;
+  std::vector<std::pair<std::string, std::array<__NamedCharFont, 4>>> _parsedTextStyles;
   const tinyxml2::XMLElement*              _root;
   std::string                         _base;
 
@@ -77,7 +68,7 @@ private:
   static void parse_lig(const tinyxml2::XMLElement*, wchar_t, __BasicInfo&);
   static void parse_larger(const tinyxml2::XMLElement*, wchar_t, __BasicInfo&);
 
-  void parseStyleMappings(std::map<std::string, std::vector<CharFont*>>& styles);
+  void parseStyleMappings(std::vector<std::pair<std::string, std::array<__NamedCharFont, 4>>>& styles);
 
   static void processCharElement(const tinyxml2::XMLElement* e, __BasicInfo& info);
 
@@ -158,7 +149,17 @@ private:
 
   void sortBasicInfo(__BasicInfo& bi);
 
-  void setupFontInfo(__BasicInfo& bi, FontInfo& fi);
+  void setupTables(__BasicInfo& bi, __FontDesc& font);
+
+  std::string includePath(const std::string& include) const;
+
+  void parseFont(const std::string& file, __FontDesc& font);
+
+  void parseFontDescriptions(__FontDescription& desc);
+
+  void parseExtraPath(__FontDescription& desc);
+
+  void parseSymbolMappings(std::vector<std::pair<std::string, __NamedCharFont>>& res);
 
 public:
   DefaultTeXFontParser() : _doc(true, tinyxml2::COLLAPSE_WHITESPACE) {
@@ -175,21 +176,18 @@ public:
     init(file);
   }
 
-  void parseExtraPath();
-
-  void parseFontDescriptions(const std::string& file);
-
-  void parseFontDescriptions();
-
-  void parseSymbolMappings(std::map<std::string, CharFont*>& res);
+  /**
+   * Parse the description with the files it includes (metrics, mappings, symbols
+   * and formula settings), nothing is registered, see
+   * DefaultTeXFont#addTeXFontDescription.
+   */
+  void parse(__FontDescription& desc);
 
   std::string* parseDefaultTextStyleMappins();
 
   void parseParameters(std::map<std::string, float>& res);
 
   void parseGeneralSettings(std::map<std::string, float>& res);
-
-  std::map<std::string, std::vector<CharFont*>> parseTextStyleMappings();
 };
 
 }  // namespace tex
@@ -33,7 +33,7 @@ TeXSymbolParser::TeXSymbolParser(const std::string& file)
   _root = _doc.RootElement();
 }
 
-void TeXSymbolParser::readSymbols(std::map<std::string, sptr<SymbolAtom>>& res) {
+void TeXSymbolParser::readSymbols(std::vector<tex::__SymbolDesc>& res) {
   const XMLElement* e = _root->FirstChildElement("Symbol");
   while (e != nullptr) {
     const std::string name = getAttr("name", e);
@@ -45,11 +45,17 @@ void TeXSymbolParser::readSymbols(std::map<std::string, sptr<SymbolAtom>>& res)
     if (it == _typeMappings.end()) {
       throw ex_xml_parse(RESOURCE_NAME, "Symbol", "type", "has an unknown value '" + type + "'!");
     }
-    res[name] = sptrOf<SymbolAtom>(name, it->second, isDelimiter);
+    res.push_back({name, it->second, isDelimiter});
     e = e->NextSiblingElement("Symbol");
   }
 }
 
+void TeXSymbolParser::readSymbols(std::map<std::string, sptr<SymbolAtom>>& res) {
+  std::vector<tex::__SymbolDesc> symbols;
+  readSymbols(symbols);
+  for (const auto& s : symbols) res[s.name] = sptrOf<SymbolAtom>(s.name, s.type, s.del);
+}
+
 const std::string TeXFormulaSettingParser::RESOURCE_NAME = "TeXFormulaSettings";
 
 TeXFormulaSettingParser::TeXFormulaSettingParser(const std::string& file)
@@ -73,8 +79,8 @@ int TeXFormulaSettingParser::getUtf(const XMLElement* e, const char* attr) {
 
 void TeXFormulaSettingParser::add2map(
   const XMLElement* r,
-  std::map<int, std::string>& math,
-  std::map<int, std::string>& txt  //
+  std::vector<std::pair<int, std::string>>& math,
+  std::vector<std::pair<int, std::string>>& txt  //
 ) {
   while (r != nullptr) {
     int ch = getUtf(r, "char");
@@ -84,16 +90,16 @@ void TeXFormulaSettingParser::add2map(
     if (symbol == nullptr) {
       throw ex_xml_parse(RESOURCE_NAME, r->Name(), "symbol", "no mapping!");
     }
-    math[ch] = symbol;
-    if (text != nullptr) txt[ch] = text;
+    math.emplace_back(ch, symbol);
+    if (text != nullptr) txt.emplace_back(ch, text);
     r = r->NextSiblingElement("Map");
   }
 }
 
 void TeXFormulaSettingParser::addFormula2map(
   const XMLElement* r,
-  std::map<int, std::string>& math,
-  std::map<int, std::string>& txt  //
+  std::vector<std::pair<int, std::string>>& math,
+  std::vector<std::pair<int, std::string>>& txt  //
 ) {
   while (r != nullptr) {
     int ch = getUtf(r, "char");
@@ -103,14 +109,15 @@ void TeXFormulaSettingParser::addFormula2map(
     if (formula == nullptr) {
       throw ex_xml_parse(RESOURCE_NAME, r->Name(), "formula", "no mapping!");
     }
-    math[ch] = formula;
-    if (text != nullptr) txt[ch] = text;
+    math.emplace_back(ch, formula);
+    if (text != nullptr) txt.emplace_back(ch, text);
     r = r->NextSiblingElement("Map");
   }
 }
 
 void TeXFormulaSettingParser::parseSymbol2Formula(
-  std::map<int, std::string>& mappings, std::map<int, std::string>& txt  //
+  std::vector<std::pair<int, std::string>>& mappings,
+  std::vector<std::pair<int, std::string>>& txt  //
 ) {
   const XMLElement* e = _root->FirstChildElement("CharacterToFormulaMappings");
   if (e != nullptr) {
@@ -120,7 +127,8 @@ void TeXFormulaSettingParser::parseSymbol2Formula(
 }
 
 void TeXFormulaSettingParser::parseSymbol(
-  std::map<int, std::string>& mappings, std::map<int, std::string>& txt  //
+  std::vector<std::pair<int, std::string>>& mappings,
+  std::vector<std::pair<int, std::string>>& txt  //
 ) {
   const XMLElement* e = _root->FirstChildElement("CharacterToSymbolMappings");
   if (e != nullptr) {
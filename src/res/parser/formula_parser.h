@@ -3,6 +3,7 @@
 
 #include "atom/atom_basic.h"
 #include "common.h"
+#include "fonts/font_desc.h"
 #include <tinyxml2.h>
 
 namespace tex {
@@ -27,6 +28,8 @@ public:
 
   TeXSymbolParser(const std::string& file);
 
+  void readSymbols(std::vector<__SymbolDesc>& res);
+
   void readSymbols(std::map<std::string, sptr<SymbolAtom>>& res);
 };
 
@@ -42,13 +45,13 @@ private:
 
   static void add2map(
       const tinyxml2::XMLElement* mapping,
-      std::map<int, std::string>& tableMath,
-      std::map<int, std::string>& tableTxt);
+      std::vector<std::pair<int, std::string>>& tableMath,
+      std::vector<std::pair<int, std::string>>& tableTxt);
 
   static void addFormula2map(
       const tinyxml2::XMLElement* mapping,
-      std::map<int, std::string>& tableMath,
-      std::map<int, std::string>& tableTxt);
+      std::vector<std::pair<int, std::string>>& tableMath,
+      std::vector<std::pair<int, std::string>>& tableTxt);
 
 public:
   static const std::string RESOURCE_NAME;
@@ -58,12 +61,12 @@ public:
   TeXFormulaSettingParser(const std::string& file);
 
   void parseSymbol2Formula(
-      std::map<int, std::string>& mappings,
-      std::map<int, std::string>& textMappings);
+      std::vector<std::pair<int, std::string>>& mappings,
+      std::vector<std::pair<int, std::string>>& textMappings);
 
   void parseSymbol(
-      std::map<int, std::string>& mappings,
-      std::map<int, std::string>& textMappings);
+      std::vector<std::pair<int, std::string>>& mappings,
+      std::vector<std::pair<int, std::string>>& textMappings);
 };
 }  // namespace tex
 
@@ -0,0 +1,826 @@
+#include "res/parser/otf_parser.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <map>
+
+#include "utils/exceptions.h"
+
+using namespace std;
+using namespace tex;
+
+namespace {
+
+/** A big-endian view of some bytes of the font, the reads out of the view throw ex_res_parse */
+class Span {
+private:
+  const u8* _data;
+  size_t _size;
+  const string* _path;
+
+public:
+  Span() : _data(nullptr), _size(0), _path(nullptr) {}
+
+  Span(const u8* data, size_t size, const string& path) : _data(data), _size(size), _path(&path) {}
+
+  [[noreturn]] void fail(const string& why) const {
+    throw ex_res_parse("The font '" + (_path == nullptr ? string() : *_path) + "' " + why);
+  }
+
+  inline size_t size() const { return _size; }
+
+  inline bool empty() const { return _size == 0; }
+
+  Span sub(size_t offset, size_t size) const {
+    if (offset > _size || size > _size - offset) fail("is truncated!");
+    return Span(_data + offset, size, *_path);
+  }
+
+  Span from(size_t offset) const {
+    if (offset > _size) fail("is truncated!");
+    return Span(_data + offset, _size - offset, *_path);
+  }
+
+  u8 u8at(size_t i) const {
+    if (i >= _size) fail("is truncated!");
+    return _data[i];
+  }
+
+  u16 u16at(size_t i) const {
+    if (i + 2 > _size) fail("is truncated!");
+    return (u16) ((_data[i] << 8) | _data[i + 1]);
+  }
+
+  i16 i16at(size_t i) const { return (i16) u16at(i); }
+
+  u32 u32at(size_t i) const {
+    if (i + 4 > _size) fail("is truncated!");
+    return ((u32) _data[i] << 24) | ((u32) _data[i + 1] << 16) | ((u32) _data[i + 2] << 8) | _data[i + 3];
+  }
+
+  /** Read an unsigned integer of the given size (1 ~ 4 bytes) */
+  u32 uat(size_t i, size_t n) const {
+    u32 v = 0;
+    for (size_t k = 0; k < n; k++) v = (v << 8) | u8at(i + k);
+    return v;
+  }
+};
+
+inline u32 tag(const char* t) {
+  return ((u32) t[0] << 24) | ((u32) t[1] << 16) | ((u32) t[2] << 8) | (u32) t[3];
+}
+
+/** The table directory of the font */
+class Tables {
+private:
+  Span _file;
+  size_t _dir;
+  u16 _count;
+
+public:
+  explicit Tables(const Span& file) : _file(file), _dir(0) {
+    u32 version = file.u32at(0);
+    // read the first font of a collection
+    if (version == tag("ttcf")) {
+      if (file.u32at(8) == 0) file.fail("is an empty font collection!");
+      _dir = file.u32at(12);
+      version = file.u32at(_dir);
+    }
+    if (version != 0x00010000 && version != tag("OTTO") && version != tag("true")) {
+      file.fail("is not an OpenType font!");
+    }
+    _count = file.u16at(_dir + 4);
+  }
+
+  /** Find the table of the given tag, return an empty span if not found */
+  Span find(const char* name) const {
+    const u32 t = tag(name);
+    for (u16 i = 0; i < _count; i++) {
+      const size_t r = _dir + 12 + i * 16;
+      if (_file.u32at(r) == t) return _file.sub(_file.u32at(r + 8), _file.u32at(r + 12));
+    }
+    return Span();
+  }
+
+  /** Find the table of the given tag, throw ex_res_parse if not found */
+  Span get(const char* name) const {
+    const Span s = find(name);
+    if (s.empty()) _file.fail("has no table '" + string(name) + "'!");
+    return s;
+  }
+};
+
+/**
+ * Read the Unicode char map (format 4 or 12) into the pairs of (char, glyph), sorted by
+ * the chars, the chars that wchar_t could not hold are skipped.
+ */
+vector<pair<u32, u16>> readCharMap(const Span& cmap) {
+  const u16 count = cmap.u16at(2);
+  Span best;
+  int score = 0;
+  for (u16 i = 0; i < count; i++) {
+    const size_t r = 4 + i * 8;
+    const u16 platform = cmap.u16at(r), encoding = cmap.u16at(r + 2);
+    const Span sub = cmap.from(cmap.u32at(r + 4));
+    const u16 format = sub.u16at(0);
+    const bool unicode = platform == 0 || (platform == 3 && (encoding == 1 || encoding == 10));
+    const int s = !unicode ? 0 : format == 12 ? 2 : format == 4 ? 1 : 0;
+    if (s > score) {
+      score = s;
+      best = sub;
+    }
+  }
+  if (score == 0) cmap.fail("has no Unicode char map!");
+
+  const u32 maxChar = sizeof(wchar_t) == 2 ? 0xffff : 0x10ffff;
+  vector<pair<u32, u16>> chars;
+  if (score == 2) {
+    const u32 groups = best.u32at(12);
+    for (u32 i = 0; i < groups; i++) {
+      const size_t g = 16 + (size_t) i * 12;
+      const u32 first = best.u32at(g), last = min(best.u32at(g + 4), maxChar);
+      const u32 glyph = best.u32at(g + 8);
+      for (u32 c = first; c <= last; c++) {
+        if (glyph + (c - first) > 0xffff) break;
+        if (glyph + (c - first) != 0) chars.emplace_back(c, (u16) (glyph + (c - first)));
+      }
+    }
+  } else {
+    const size_t segs = best.u16at(6) / 2;
+    const size_t ends = 14, starts = ends + segs * 2 + 2;
+    const size_t deltas = starts + segs * 2, ranges = deltas + segs * 2;
+    for (size_t i = 0; i < segs; i++) {
+      const u32 first = best.u16at(starts + i * 2), last = best.u16at(ends + i * 2);
+      const u16 delta = best.u16at(deltas + i * 2);
+      const u16 range = best.u16at(ranges + i * 2);
+      for (u32 c = first; c <= last && c != 0xffff; c++) {
+        u16 glyph;
+        if (range == 0) {
+          glyph = (u16) (c + delta);
+        } else {
+          glyph = best.u16at(ranges + i * 2 + range + (c - first) * 2);
+          if (glyph != 0) glyph = (u16) (glyph + delta);
+        }
+        if (glyph != 0) chars.emplace_back(c, glyph);
+      }
+    }
+  }
+  sort(chars.begin(), chars.end());
+  chars.erase(
+    unique(chars.begin(), chars.end(), [](auto& a, auto& b) { return a.first == b.first; }),
+    chars.end()
+  );
+  return chars;
+}
+
+/** The glyphs of an OpenType coverage table, by the coverage index */
+vector<u16> readCoverage(const Span& cov) {
+  vector<u16> glyphs;
+  const u16 format = cov.u16at(0), count = cov.u16at(2);
+  if (format == 1) {
+    for (u16 i = 0; i < count; i++) glyphs.push_back(cov.u16at(4 + i * 2));
+  } else if (format == 2) {
+    for (u16 i = 0; i < count; i++) {
+      const size_t r = 4 + i * 6;
+      const u16 first = cov.u16at(r), last = cov.u16at(r + 2), index = cov.u16at(r + 4);
+      if (last < first) continue;
+      if (glyphs.size() < (size_t) index + (last - first) + 1) {
+        glyphs.resize((size_t) index + (last - first) + 1, 0);
+      }
+      for (u32 g = first; g <= last; g++) glyphs[index + (g - first)] = (u16) g;
+    }
+  } else {
+    cov.fail("has an unsupported coverage table!");
+  }
+  return glyphs;
+}
+
+/** An INDEX of a CFF table */
+class CffIndex {
+private:
+  Span _cff;
+  size_t _offsets = 0, _data = 0, _end = 0;
+  u32 _count = 0;
+  u8 _offSize = 0;
+
+public:
+  CffIndex() = default;
+
+  CffIndex(const Span& cff, size_t pos) : _cff(cff) {
+    _count = cff.u16at(pos);
+    if (_count == 0) {
+      _end = pos + 2;
+      return;
+    }
+    _offSize = cff.u8at(pos + 2);
+    if (_offSize < 1 || _offSize > 4) cff.fail("has an invalid CFF index!");
+    _offsets = pos + 3;
+    // the offsets start from 1
+    _data = _offsets + (_count + 1) * _offSize - 1;
+    _end = _data + cff.uat(_offsets + _count * _offSize, _offSize);
+  }
+
+  inline u32 count() const { return _count; }
+
+  inline size_t end() const { return _end; }
+
+  Span operator[](u32 i) const {
+    if (i >= _count) _cff.fail("refers to an invalid CFF object!");
+    const u32 a = _cff.uat(_offsets + i * _offSize, _offSize);
+    const u32 b = _cff.uat(_offsets + (i + 1) * _offSize, _offSize);
+    if (b < a) _cff.fail("has an invalid CFF index!");
+    return _cff.sub(_data + a, b - a);
+  }
+};
+
+/** Read a CFF DICT into the operands by the operators, the escaped operators are 1200 + x */
+map<int, vector<double>> readCffDict(const Span& dict) {
+  map<int, vector<double>> ops;
+  vector<double> args;
+  size_t i = 0;
+  while (i < dict.size()) {
+    const u8 b = dict.u8at(i++);
+    if (b <= 21) {
+      const int op = b == 12 ? 1200 + dict.u8at(i++) : b;
+      ops[op] = args;
+      args.clear();
+    } else if (b == 28) {
+      args.push_back(dict.i16at(i));
+      i += 2;
+    } else if (b == 29) {
+      args.push_back((i32) dict.u32at(i));
+      i += 4;
+    } else if (b == 30) {
+      // a real number in nibbles, the operands we need are integers
+      string s;
+      for (bool end = false; !end;) {
+        const u8 n = dict.u8at(i++);
+        for (const int d : {n >> 4, n & 0xf}) {
+          if (d <= 9) s += (char) ('0' + d);
+          else if (d == 0xa) s += '.';
+          else if (d == 0xb) s += 'E';
+          else if (d == 0xc) s += "E-";
+          else if (d == 0xe) s += '-';
+          else if (d == 0xf) end = true;
+          if (end) break;
+        }
+      }
+      args.push_back(atof(s.c_str()));
+    } else if (b >= 32 && b <= 246) {
+      args.push_back((int) b - 139);
+    } else if (b >= 247 && b <= 250) {
+      args.push_back(((int) b - 247) * 256 + dict.u8at(i++) + 108);
+    } else if (b >= 251 && b <= 254) {
+      args.push_back(-((int) b - 251) * 256 - dict.u8at(i++) - 108);
+    } else {
+      dict.fail("has an invalid CFF dict!");
+    }
+  }
+  return ops;
+}
+
+inline int subrBias(u32 count) {
+  return count < 1240 ? 107 : count < 33900 ? 1131 : 32768;
+}
+
+/** The vertical extent of a glyph */
+struct Extent {
+  float yMin = 0, yMax = 0;
+};
+
+/** The CFF outlines, evaluates the Type 2 charstrings to find the extents of the glyphs */
+class CffOutlines {
+private:
+  Span _cff;
+  CffIndex _charStrings, _globalSubrs;
+  // the local subroutines of every font dict, one for the fonts not CID-keyed
+  vector<CffIndex> _localSubrs;
+  // the font dict of every glyph, empty if the font is not CID-keyed
+  vector<u8> _fdSelect;
+
+  CffIndex readPrivate(const map<int, vector<double>>& dict) const {
+    const auto it = dict.find(18);
+    if (it == dict.end() || it->second.size() < 2) return CffIndex();
+    const size_t size = (size_t) it->second[0], offset = (size_t) it->second[1];
+    const auto priv = readCffDict(_cff.sub(offset, size));
+    const auto subrs = priv.find(19);
+    if (subrs == priv.end() || subrs->second.empty()) return CffIndex();
+    return CffIndex(_cff, offset + (size_t) subrs->second[0]);
+  }
+
+public:
+  CffOutlines(const Span& cff, u16 glyphs) : _cff(cff) {
+    const CffIndex names(cff, cff.u8at(2));
+    const CffIndex tops(cff, names.end());
+    const CffIndex strings(cff, tops.end());
+    _globalSubrs = CffIndex(cff, strings.end());
+    if (tops.count() == 0) cff.fail("has no CFF font!");
+    const auto top = readCffDict(tops[0]);
+    const auto type = top.find(1206);
+    if (type != top.end() && !type->second.empty() && type->second[0] != 2) {
+      cff.fail("has unsupported charstrings!");
+    }
+    const auto cs = top.find(17);
+    if (cs == top.end() || cs->second.empty()) cff.fail("has no charstrings!");
+    _charStrings = CffIndex(cff, (size_t) cs->second[0]);
+
+    const auto fdArray = top.find(1236), fdSelect = top.find(1237);
+    if (fdArray == top.end() || fdSelect == top.end()) {
+      _localSubrs.push_back(readPrivate(top));
+      return;
+    }
+    // CID-keyed, the glyphs select the font dicts
+    const CffIndex fds(cff, (size_t) fdArray->second.at(0));
+    for (u32 i = 0; i < fds.count(); i++) _localSubrs.push_back(readPrivate(readCffDict(fds[i])));
+    const size_t p = (size_t) fdSelect->second.at(0);
+    const u8 format = cff.u8at(p);
+    _fdSelect.assign(glyphs, 0);
+    if (format == 0) {
+      for (u16 g = 0; g < glyphs; g++) _fdSelect[g] = cff.u8at(p + 1 + g);
+    } else if (format == 3) {
+      const u16 ranges = cff.u16at(p + 1);
+      for (u16 i = 0; i < ranges; i++) {
+        const size_t r = p + 3 + i * 3;
+        const u16 first = cff.u16at(r), next = cff.u16at(r + 3);
+        const u8 fd = cff.u8at(r + 2);
+        for (u32 g = first; g < next && g < glyphs; g++) _fdSelect[g] = fd;
+      }
+    } else {
+      cff.fail("has an unsupported FDSelect!");
+    }
+  }
+
+  Extent extent(u16 glyph) const;
+
+  friend class CharString;
+};
+
+/** The evaluation of a Type 2 charstring, only the vertical extent of the outline is tracked */
+class CharString {
+private:
+  const CffOutlines& _cff;
+  const CffIndex& _local;
+  const int _localBias, _globalBias;
+
+  double _stack[48];
+  int _n = 0;
+  int _stems = 0;
+  bool _widthRead = false;
+  // the current point, and if a contour is started by a move but not drawn yet
+  double _x = 0, _y = 0;
+  bool _moved = false;
+  bool _empty = true;
+  double _yMin = 0, _yMax = 0;
+
+  [[noreturn]] void fail() const { _cff._cff.fail("has an invalid charstring!"); }
+
+  void add(double y) {
+    if (_empty) {
+      _yMin = _yMax = y;
+      _empty = false;
+    } else {
+      _yMin = min(_yMin, y);
+      _yMax = max(_yMax, y);
+    }
+  }
+
+  void start() {
+    if (_moved) add(_y);
+    _moved = false;
+  }
+
+  void moveTo(double dx, double dy) {
+    _x += dx;
+    _y += dy;
+    _moved = true;
+  }
+
+  void lineTo(double dx, double dy) {
+    start();
+    _x += dx;
+    _y += dy;
+    add(_y);
+  }
+
+  void curveTo(double dx1, double dy1, double dx2, double dy2, double dx3, double dy3) {
+    start();
+    const double y0 = _y, y1 = y0 + dy1, y2 = y1 + dy2, y3 = y2 + dy3;
+    _x += dx1 + dx2 + dx3;
+    _y = y3;
+    add(y3);
+    // the extremes of the curve if the control points are out of the end points
+    if (min(y1, y2) >= min(y0, y3) && max(y1, y2) <= max(y0, y3)) return;
+    const double a = -y0 + 3 * y1 - 3 * y2 + y3, b = 2 * (y0 - 2 * y1 + y2), c = y1 - y0;
+    double ts[2];
+    int n = 0;
+    if (fabs(a) < 1e-9) {
+      if (fabs(b) > 1e-9) ts[n++] = -c / b;
+    } else {
+      const double d = b * b - 4 * a * c;
+      if (d >= 0) {
+        ts[n++] = (-b + sqrt(d)) / (2 * a);
+        ts[n++] = (-b - sqrt(d)) / (2 * a);
+      }
+    }
+    for (int i = 0; i < n; i++) {
+      const double t = ts[i], u = 1 - t;
+      if (t <= 0 || t >= 1) continue;
+      add(u * u * u * y0 + 3 * u * u * t * y1 + 3 * u * t * t * y2 + t * t * t * y3);
+    }
+  }
+
+  /** Drop the width before the first operator that clears the stack if there is */
+  void width(bool has) {
+    if (!_widthRead && has && _n > 0) {
+      for (int i = 1; i < _n; i++) _stack[i - 1] = _stack[i];
+      _n--;
+    }
+    _widthRead = true;
+  }
+
+  /** Run the given charstring, return true if the glyph ends */
+  bool run(const Span& cs, int depth) {
+    if (depth > 10) fail();
+    size_t i = 0;
+    while (i < cs.size()) {
+      const u8 b = cs.u8at(i++);
+      if (b >= 32 || b == 28) {
+        if (_n >= 48) fail();
+        if (b == 28) {
+          _stack[_n++] = cs.i16at(i);
+          i += 2;
+        } else if (b <= 246) {
+          _stack[_n++] = (int) b - 139;
+        } else if (b <= 250) {
+          _stack[_n++] = ((int) b - 247) * 256 + cs.u8at(i++) + 108;
+        } else if (b <= 254) {
+          _stack[_n++] = -((int) b - 251) * 256 - cs.u8at(i++) - 108;
+        } else {
+          _stack[_n++] = (i32) cs.u32at(i) / 65536.0;
+          i += 4;
+        }
+        continue;
+      }
+      const double* s = _stack;
+      int k = 0;
+      switch (b) {
+        case 1:   // hstem
+        case 3:   // vstem
+        case 18:  // hstemhm
+        case 23:  // vstemhm
+          width(_n % 2 == 1);
+          _stems += _n / 2;
+          break;
+        case 19:  // hintmask
+        case 20:  // cntrmask
+          width(_n % 2 == 1);
+          _stems += _n / 2;
+          i += (_stems + 7) / 8;
+          break;
+        case 21:  // rmoveto
+          width(_n > 2);
+          if (_n < 2) fail();
+          moveTo(s[0], s[1]);
+          break;
+        case 22:  // hmoveto
+          width(_n > 1);
+          if (_n < 1) fail();
+          moveTo(s[0], 0);
+          break;
+        case 4:  // vmoveto
+          width(_n > 1);
+          if (_n < 1) fail();
+          moveTo(0, s[0]);
+          break;
+        case 5:  // rlineto
+          for (; k + 2 <= _n; k += 2) lineTo(s[k], s[k + 1]);
+          break;
+        case 6:  // hlineto
+        case 7:  // vlineto
+          for (bool h = b == 6; k < _n; k++, h = !h) h ? lineTo(s[k], 0) : lineTo(0, s[k]);
+          break;
+        case 8:  // rrcurveto
+          for (; k + 6 <= _n; k += 6) curveTo(s[k], s[k + 1], s[k + 2], s[k + 3], s[k + 4], s[k + 5]);
+          break;
+        case 27: {  // hhcurveto
+          double dy1 = _n % 2 == 1 ? s[k++] : 0;
+          for (; k + 4 <= _n; k += 4, dy1 = 0) curveTo(s[k], dy1, s[k + 1], s[k + 2], s[k + 3], 0);
+          break;
+        }
+        case 26: {  // vvcurveto
+          double dx1 = _n % 2 == 1 ? s[k++] : 0;
+          for (; k + 4 <= _n; k += 4, dx1 = 0) curveTo(dx1, s[k], s[k + 1], s[k + 2], 0, s[k + 3]);
+          break;
+        }
+        case 30:    // vhcurveto
+        case 31: {  // hvcurveto
+          for (bool h = b == 31; k + 4 <= _n; h = !h) {
+            const double last = _n - k == 5 ? s[k + 4] : 0;
+            if (h) {
+              curveTo(s[k], 0, s[k + 1], s[k + 2], last, s[k + 3]);
+            } else {
+              curveTo(0, s[k], s[k + 1], s[k + 2], s[k + 3], last);
+            }
+            k += _n - k == 5 ? 5 : 4;
+          }
+          break;
+        }
+        case 24:  // rcurveline
+          for (; k + 6 <= _n - 2; k += 6) curveTo(s[k], s[k + 1], s[k + 2], s[k + 3], s[k + 4], s[k + 5]);
+          if (k + 2 <= _n) lineTo(s[k], s[k + 1]);
+          break;
+        case 25:  // rlinecurve
+          for (; k + 2 <= _n - 6; k += 2) lineTo(s[k], s[k + 1]);
+          if (k + 6 <= _n) curveTo(s[k], s[k + 1], s[k + 2], s[k + 3], s[k + 4], s[k + 5]);
+          break;
+        case 10:    // callsubr
+        case 29: {  // callgsubr
+          if (_n < 1) fail();
+          const bool local = b == 10;
+          const int index = (int) _stack[--_n] + (local ? _localBias : _globalBias);
+          const CffIndex& subrs = local ? _local : _cff._globalSubrs;
+          if (index < 0 || (u32) index >= subrs.count()) fail();
+          if (run(subrs[index], depth + 1)) return true;
+          // the subroutine leaves its operands on the stack
+          continue;
+        }
+        case 11:  // return
+          return false;
+        case 14:  // endchar
+          width(_n == 1 || _n == 5);
+          return true;
+        case 12: {
+          const u8 op = cs.u8at(i++);
+          if (op == 35 && _n >= 12) {  // flex
+            curveTo(s[0], s[1], s[2], s[3], s[4], s[5]);
+            curveTo(s[6], s[7], s[8], s[9], s[10], s[11]);
+          } else if (op == 34 && _n >= 7) {  // hflex
+            curveTo(s[0], 0, s[1], s[2], s[3], 0);
+            curveTo(s[4], 0, s[5], -s[2], s[6], 0);
+          } else if (op == 36 && _n >= 9) {  // hflex1
+            curveTo(s[0], s[1], s[2], s[3], s[4], 0);
+            curveTo(s[5], 0, s[6], s[7], s[8], -(s[1] + s[3] + s[7]));
+          } else if (op == 37 && _n >= 11) {  // flex1
+            const double dx = s[0] + s[2] + s[4] + s[6] + s[8];
+            const double dy = s[1] + s[3] + s[5] + s[7] + s[9];
+            curveTo(s[0], s[1], s[2], s[3], s[4], s[5]);
+            if (fabs(dx) > fabs(dy)) {
+              curveTo(s[6], s[7], s[8], s[9], s[10], -dy);
+            } else {
+              curveTo(s[6], s[7], s[8], s[9], -dx, s[10]);
+            }
+          }
+          // the arithmetic operators are deprecated, they clear the stack as others
+          break;
+        }
+        default:
+          break;
+      }
+      _n = 0;
+    }
+    return false;
+  }
+
+public:
+  CharString(const CffOutlines& cff, const CffIndex& local)
+    : _cff(cff),
+      _local(local),
+      _localBias(subrBias(local.count())),
+      _globalBias(subrBias(cff._globalSubrs.count())) {}
+
+  Extent extent(const Span& cs) {
+    run(cs, 0);
+    Extent e;
+    if (!_empty) {
+      e.yMin = (float) _yMin;
+      e.yMax = (float) _yMax;
+    }
+    return e;
+  }
+};
+
+Extent CffOutlines::extent(u16 glyph) const {
+  const u8 fd = glyph < _fdSelect.size() ? _fdSelect[glyph] : 0;
+  if (fd >= _localSubrs.size()) _cff.fail("refers to an invalid font dict!");
+  return CharString(*this, _localSubrs[fd]).extent(_charStrings[glyph]);
+}
+
+/** The TrueType outlines, the extents are in the headers of the glyphs */
+class GlyfOutlines {
+private:
+  Span _glyf, _loca;
+  bool _long;
+
+public:
+  GlyfOutlines(const Span& glyf, const Span& loca, bool longOffsets)
+    : _glyf(glyf), _loca(loca), _long(longOffsets) {}
+
+  Extent extent(u16 glyph) const {
+    const size_t a = _long ? _loca.u32at(glyph * 4) : _loca.u16at(glyph * 2) * 2u;
+    const size_t b = _long ? _loca.u32at(glyph * 4 + 4) : _loca.u16at(glyph * 2 + 2) * 2u;
+    Extent e;
+    // no outline, e.g. the space
+    if (b <= a) return e;
+    const Span g = _glyf.sub(a, b - a);
+    e.yMin = g.i16at(4);
+    e.yMax = g.i16at(8);
+    return e;
+  }
+};
+
+/** Map the glyph parts of a vertical assembly (bottom to top) to (top, middle, repeat, bottom) */
+bool toExtension(const vector<pair<u16, bool>>& parts, const map<u16, u32>& codes, int ext[4]) {
+  // the parts in letters, B for a piece and E for the extender, the adjacent extenders are merged
+  string pattern;
+  vector<int> pieces;
+  int rep = -1;
+  for (const auto& p : parts) {
+    const auto it = codes.find(p.first);
+    if (it == codes.end()) return false;
+    if (p.second) {
+      if (rep != -1 && rep != (int) it->second) return false;
+      rep = (int) it->second;
+      if (pattern.empty() || pattern.back() != 'E') pattern += 'E';
+    } else {
+      pieces.push_back((int) it->second);
+      pattern += 'B';
+    }
+  }
+  const int NONE = -1;
+  // top, middle, repeat, bottom
+  if (pattern == "E") {
+    ext[0] = NONE, ext[1] = NONE, ext[2] = rep, ext[3] = NONE;
+  } else if (pattern == "BE") {
+    ext[0] = NONE, ext[1] = NONE, ext[2] = rep, ext[3] = pieces[0];
+  } else if (pattern == "EB") {
+    ext[0] = pieces[0], ext[1] = NONE, ext[2] = rep, ext[3] = NONE;
+  } else if (pattern == "BEB") {
+    ext[0] = pieces[1], ext[1] = NONE, ext[2] = rep, ext[3] = pieces[0];
+  } else if (pattern == "EBE") {
+    ext[0] = NONE, ext[1] = pieces[0], ext[2] = rep, ext[3] = NONE;
+  } else if (pattern == "BEBEB") {
+    ext[0] = pieces[2], ext[1] = pieces[1], ext[2] = rep, ext[3] = pieces[0];
+  } else {
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+OpenTypeParser::OpenTypeParser(const string& path) : _file(path), _path(path) {}
+
+string OpenTypeParser::stamp() const {
+  const Tables tables(Span(_file.data(), _file.size(), _path));
+  const Span head = tables.get("head");
+  char buf[32];
+  // the checksum adjustment and the modified time
+  snprintf(buf, sizeof(buf), "%08x%08x%08x", head.u32at(8), head.u32at(28), head.u32at(32));
+  return buf;
+}
+
+void OpenTypeParser::parse(const string& id, __FontDescription& desc) const {
+  const Span file(_file.data(), _file.size(), _path);
+  const Tables tables(file);
+  const Span head = tables.get("head");
+  const float em = head.u16at(18);
+  if (em == 0) file.fail("has an invalid units per em!");
+  const u16 glyphs = tables.get("maxp").u16at(4);
+  const u16 hmetrics = tables.get("hhea").u16at(34);
+  if (hmetrics == 0) file.fail("has no horizontal metrics!");
+  const Span hmtx = tables.get("hmtx");
+  const auto advance = [&](u16 g) { return hmtx.u16at((g < hmetrics ? g : hmetrics - 1) * 4u); };
+
+  // the extents of the glyphs from the outlines
+  const Span glyf = tables.find("glyf"), cffTable = tables.find("CFF ");
+  sptr<GlyfOutlines> glyfs;
+  sptr<CffOutlines> cff;
+  if (!glyf.empty()) {
+    glyfs = sptrOf<GlyfOutlines>(glyf, tables.get("loca"), head.i16at(50) != 0);
+  } else if (!cffTable.empty()) {
+    cff = sptrOf<CffOutlines>(cffTable, glyphs);
+  } else {
+    file.fail("has no supported outlines!");
+  }
+  const auto extent = [&](u16 g) { return glyfs != nullptr ? glyfs->extent(g) : cff->extent(g); };
+
+  const vector<pair<u32, u16>> chars = readCharMap(tables.get("cmap"));
+  // the glyph => the first char maps to it, and all the chars map to it
+  map<u16, u32> codes;
+  map<u16, vector<u32>> allCodes;
+  for (const auto& c : chars) {
+    if (c.second >= glyphs) continue;
+    codes.emplace(c.second, c.first);
+    allCodes[c.second].push_back(c.first);
+  }
+
+  // the math data
+  map<u16, float> italics;
+  // glyph => the variants (from small to large), and the vertical assembly of the largest
+  map<u16, vector<u16>> variants;
+  map<u16, vector<pair<u16, bool>>> assemblies;
+  const Span math = tables.find("MATH");
+  if (!math.empty()) {
+    const Span info = math.from(math.u16at(6));
+    const u16 italicsOffset = info.u16at(0);
+    if (italicsOffset != 0) {
+      const Span it = info.from(italicsOffset);
+      const vector<u16> cov = readCoverage(it.from(it.u16at(0)));
+      const u16 count = it.u16at(2);
+      for (u16 i = 0; i < count && i < cov.size(); i++) italics[cov[i]] = it.i16at(4 + i * 4) / em;
+    }
+    const Span vars = math.from(math.u16at(8));
+    const u16 vertCount = vars.u16at(6), horizCount = vars.u16at(8);
+    const auto readConstructions = [&](u16 covOffset, u16 count, size_t first, bool vertical) {
+      if (covOffset == 0) return;
+      const vector<u16> cov = readCoverage(vars.from(covOffset));
+      for (u16 i = 0; i < count && i < cov.size(); i++) {
+        // the vertical ones win
+        if (variants.find(cov[i]) != variants.end()) continue;
+        const Span con = vars.from(vars.u16at(first + i * 2));
+        auto& v = variants[cov[i]];
+        const u16 n = con.u16at(2);
+        for (u16 j = 0; j < n; j++) v.push_back(con.u16at(4 + j * 4));
+        if (!vertical || con.u16at(0) == 0) continue;
+        const Span assembly = con.from(con.u16at(0));
+        const u16 parts = assembly.u16at(4);
+        auto& a = assemblies[cov[i]];
+        for (u16 j = 0; j < parts; j++) {
+          const size_t p = 6 + j * 10;
+          a.emplace_back(assembly.u16at(p), (assembly.u16at(p + 8) & 1) != 0);
+        }
+      }
+    };
+    readConstructions(vars.u16at(2), vertCount, 10, true);
+    readConstructions(vars.u16at(4), horizCount, 10 + vertCount * 2, false);
+  }
+
+  desc.fonts.emplace_back();
+  __FontDesc& f = desc.fonts.back();
+  f.id = id;
+  f.file = _path;
+  f.quad = 1;
+
+  // rows of (code, width, height, depth, italic), owned by the table before the
+  // glyphs are read since a malformed glyph throws
+  float* metrics = new float[chars.size() * 5];
+  f.metrics = __FontTable<float>(metrics, 0, true);
+  size_t rows = 0;
+  for (const auto& c : chars) {
+    if (c.second >= glyphs) continue;
+    const Extent e = extent(c.second);
+    const auto it = italics.find(c.second);
+    float* r = metrics + rows++ * 5;
+    r[0] = (float) c.first;
+    r[1] = advance(c.second) / em;
+    r[2] = max(0.f, e.yMax / em);
+    r[3] = max(0.f, -e.yMin / em);
+    r[4] = it == italics.end() ? 0.f : it->second;
+    if (c.first == ' ') f.space = r[1];
+  }
+  f.metrics.len = (int) (rows * 5);
+
+  // the x-height is optional in OS/2, and 0 in the fonts converted carelessly
+  const Span os2 = tables.find("OS/2");
+  if (!os2.empty() && os2.u16at(0) >= 2 && os2.size() >= 88 && os2.i16at(86) > 0) {
+    f.xHeight = os2.i16at(86) / em;
+  } else {
+    const auto x = lower_bound(chars.begin(), chars.end(), make_pair((u32) 'x', (u16) 0));
+    if (x != chars.end() && x->first == 'x') f.xHeight = extent(x->second).yMax / em;
+  }
+
+  // the chains of the larger versions stop at the variants not mapped to a char, the
+  // extension is of the largest one in the chain
+  map<u32, u32> largers;
+  map<u32, array<int, 4>> extensions;
+  for (const auto& v : variants) {
+    const auto base = allCodes.find(v.first);
+    if (base == allCodes.end()) continue;
+    vector<u32> last = base->second;
+    for (const u16 g : v.second) {
+      if (g == v.first) continue;
+      const auto code = codes.find(g);
+      if (code == codes.end()) break;
+      for (const u32 c : last) {
+        if (c != code->second) largers.emplace(c, code->second);
+      }
+      last = {code->second};
+    }
+    const auto a = assemblies.find(v.first);
+    array<int, 4> ext;
+    if (a == assemblies.end() || !toExtension(a->second, codes, ext.data())) continue;
+    for (const u32 c : last) extensions.emplace(c, ext);
+  }
+  for (const auto& l : largers) f.largers.push_back({(wchar_t) l.first, (wchar_t) l.second, id});
+  int* exts = new int[extensions.size() * 5];
+  f.extensions = __FontTable<int>(exts, 0, true);
+  rows = 0;
+  for (const auto& e : extensions) {
+    int* r = exts + rows++ * 5;
+    r[0] = (int) e.first;
+    for (int i = 0; i < 4; i++) r[i + 1] = e.second[i];
+  }
+  f.extensions.len = (int) (rows * 5);
+}
@@ -0,0 +1,66 @@
+#ifndef OTF_PARSER_H_INCLUDED
+#define OTF_PARSER_H_INCLUDED
+
+#include <string>
+
+#include "fonts/font_desc.h"
+#include "utils/mapped_file.h"
+
+namespace tex {
+
+/**
+ * Reads an OpenType font (with TrueType or CFF outlines, the first font of a
+ * TrueType collection) into the tables of a TeX font, so a font (e.g. an
+ * OpenType math font) could be registered without converting it ahead of time.
+ * The file is mapped into memory and only the tables below are read:
+ *
+ *      cmap:       the chars of the font, only the chars the font maps could be
+ *                  drawn since the graphics draw chars (see Graphics2D#drawChar)
+ *      hmtx:       the widths of the chars
+ *      glyf, CFF:  the heights and depths of the chars, from the bounding boxes
+ *                  of the outlines
+ *      OS/2:       the x-height
+ *      MATH:       the italic corrections, the variants of the chars as the
+ *                  chains of the larger versions, and the vertical assemblies
+ *                  as the extensions
+ *
+ * The metrics are in em. The variants and the parts of the assemblies that the
+ * font does not map to a char are skipped, a chain of the larger versions stops
+ * at the first one of them, an assembly is kept only if it could be laid out as
+ * an extension (top, middle, repeat and bottom, with one repeated part), and
+ * the overlaps of the connectors are ignored. The kerning, the ligatures and
+ * the math constants are not read.
+ * <p>
+ * Reading a math font of thousands of glyphs takes a few milliseconds, compile
+ * the description into a bundle (see FontBundle) to register the font without
+ * reading it again, DefaultTeXFont#addOpenTypeFont caches the bundles on disk.
+ */
+class OpenTypeParser {
+private:
+  MappedFile _file;
+  const std::string _path;
+
+public:
+  /** Map the font of the given path, throws ex_file_not_found if the file could not be opened */
+  explicit OpenTypeParser(const std::string& path);
+
+  no_copy_assign(OpenTypeParser);
+
+  /**
+   * Get the stamp of the version of the font, from the checksum and the modified
+   * time in its head table, e.g. to name the bundle cached from it. Throws
+   * ex_res_parse if the font is malformed.
+   */
+  std::string stamp() const;
+
+  /**
+   * Read the font as the TeX font of the given id into the given description, the
+   * tables of the font are owned by the description. Throws ex_res_parse if the font
+   * is malformed or has no supported outlines or char map.
+   */
+  void parse(const std::string& id, __FontDescription& desc) const;
+};
+
+}  // namespace tex
+
+#endif  // OTF_PARSER_H_INCLUDED
@@ -1,24 +1,25 @@
 #include "res/reg/builtin_font_reg.h"
+#include "res/reg/bundles.h"
 
 using namespace tex;
 
 DEF_FONT_SET(Builtin)
 
-REG_FONT(msbm10)
+REG_FONT_IN(CLM_BUNDLE_AMS, msbm10)
 REG_FONT(cmex10)
 REG_FONT(cmmi10)
 REG_FONT(cmmib10)
 REG_FONT(moustache)
 REG_FONT(cmmi10_unchanged)
 REG_FONT(cmmib10_unchanged)
-REG_FONT(stmary10)
+REG_FONT_IN(CLM_BUNDLE_STMARYRD, stmary10)
 REG_FONT(cmsy10)
-REG_FONT(msam10)
+REG_FONT_IN(CLM_BUNDLE_AMS, msam10)
 REG_FONT(cmbsy10)
 REG_FONT(dsrom10)
 REG_FONT(rsfs10)
-REG_FONT(eufm10)
-REG_FONT(eufb10)
+REG_FONT_IN(CLM_BUNDLE_EULER, eufm10)
+REG_FONT_IN(CLM_BUNDLE_EULER, eufb10)
 REG_FONT(cmti10)
 REG_FONT(cmti10_unchanged)
 REG_FONT(cmbxti10)
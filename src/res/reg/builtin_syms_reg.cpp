@@ -1,13 +1,14 @@
 #include "res/reg/builtin_syms_reg.h"
+#include "res/reg/bundles.h"
 
 using namespace tex;
 
 DEF_SYMBOLS_SET(Builtin)
 
 REG_SYMBOLS(base)
-REG_SYMBOLS(amssymb)
-REG_SYMBOLS(amsfonts)
-REG_SYMBOLS(stmaryrd)
+REG_SYMBOLS_IN(CLM_BUNDLE_AMS, amssymb)
+REG_SYMBOLS_IN(CLM_BUNDLE_AMS, amsfonts)
+REG_SYMBOLS_IN(CLM_BUNDLE_STMARYRD, stmaryrd)
 REG_SYMBOLS(special)
 
 END_DEF_SYMBOLS_SET
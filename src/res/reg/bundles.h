@@ -0,0 +1,47 @@
+#ifndef BUNDLES_H_INCLUDED
+#define BUNDLES_H_INCLUDED
+
+/**
+ * The optional resource bundles, chosen by the build options (BUNDLE_* in
+ * CMakeLists.txt and meson_options.txt). A bundle is
+ *
+ *      BUNDLE_OFF:  left out of the library, its symbols and text styles are
+ *                   reported as not found
+ *      BUNDLE_LAZY: compiled in and registered on its first use
+ *      BUNDLE_ON:   compiled in and registered by LaTeX#init
+ *
+ * The core math fonts (Computer Modern, moustache, dsrom10, rsfs10) and the base
+ * symbols are always compiled in and registered by LaTeX#init. The alphabets
+ * (Cyrillic and Greek) are always loaded on their first char, LAZY and ON are the
+ * same for them.
+ */
+#define BUNDLE_OFF  0
+#define BUNDLE_LAZY 1
+#define BUNDLE_ON   2
+
+// the AMS fonts (msam10, msbm10) and symbols (amssymb, amsfonts), and \mathbb
+#ifndef CLM_BUNDLE_AMS
+#define CLM_BUNDLE_AMS BUNDLE_ON
+#endif
+
+// the St Mary Road font and symbols (stmary10, stmaryrd)
+#ifndef CLM_BUNDLE_STMARYRD
+#define CLM_BUNDLE_STMARYRD BUNDLE_ON
+#endif
+
+// the Euler Fraktur fonts (eufm10, eufb10), and \mathfrak
+#ifndef CLM_BUNDLE_EULER
+#define CLM_BUNDLE_EULER BUNDLE_ON
+#endif
+
+// the Cyrillic alphabet
+#ifndef CLM_BUNDLE_CYRILLIC
+#define CLM_BUNDLE_CYRILLIC BUNDLE_ON
+#endif
+
+// the Greek alphabet
+#ifndef CLM_BUNDLE_GREEK
+#define CLM_BUNDLE_GREEK BUNDLE_ON
+#endif
+
+#endif
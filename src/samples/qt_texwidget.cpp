@@ -4,6 +4,7 @@
 
 #include <QPrinter>
 #include <QScreen>
+#include <cmath>
 
 using namespace tex;
 
@@ -40,7 +41,7 @@ void TeXWidget::setTextSize(float size)
 
 void TeXWidget::setLaTeX(const std::wstring& latex)
 {
-  if (_render != nullptr) delete _render;
+  TeXRender* old = _render;
 
   _render = LaTeX::parse(
         latex,
@@ -48,7 +49,22 @@ void TeXWidget::setLaTeX(const std::wstring& latex)
         _text_size,
         _text_size / 3.f,
         0xff424242);
-  update();
+  if (old == nullptr
+      || old->getWidth() != _render->getWidth()
+      || old->getHeight() != _render->getHeight()) {
+    // the size changed, let the layout resize the widget and repaint it all
+    delete old;
+    updateGeometry();
+    update();
+    return;
+  }
+  // repaint only the changed parts of the formula, rounded outward to whole pixels
+  for (const auto& r : TeXRender::diff(*old, *_render)) {
+    const int x0 = (int) std::floor(r.x), y0 = (int) std::floor(r.y);
+    const int x1 = (int) std::ceil(r.x + r.w), y1 = (int) std::ceil(r.y + r.h);
+    update(x0 + _padding, y0 + _padding, x1 - x0, y1 - y0);
+  }
+  delete old;
 }
 
 bool TeXWidget::isRenderDisplayed()
@@ -66,6 +82,12 @@ int TeXWidget::getRenderHeight()
   return _render == nullptr ? 0 : _render->getHeight() + _padding * 2;
 }
 
+QSize TeXWidget::sizeHint() const
+{
+  if (_render == nullptr) return QWidget::sizeHint();
+  return QSize(_render->getWidth() + _padding * 2, _render->getHeight() + _padding * 2);
+}
+
 void TeXWidget::paintEvent(QPaintEvent* event)
 {
   if(_render != nullptr) {
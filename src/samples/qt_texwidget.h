@@ -22,6 +22,7 @@ class TeXWidget : public QWidget
   bool isRenderDisplayed();
   int getRenderWidth();
   int getRenderHeight();
+  QSize sizeHint() const override;
   void paintEvent(QPaintEvent* event);
 
   //! save as PDF file with embedded fonts;
@@ -0,0 +1,72 @@
+/**
+ * Benchmark the layout of large arrays (see MatrixAtom): a 100x100 and a 1000x10
+ * array of numbers are parsed and built the given times, and the best and the
+ * median times are printed.
+ *
+ * Usage: LaTeXBenchMatrix [runs] [res]
+ *
+ * The runs are 5 and the resources are in "res" by default.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "core/formula.h"
+#include "latex.h"
+
+using namespace std;
+using namespace tex;
+
+namespace {
+
+/** An array of rows x cols cells, each cell holds its index */
+wstring makeArray(int rows, int cols) {
+  wstring src = L"\\begin{array}{" + wstring(cols, L'c') + L"}";
+  for (int i = 0; i < rows; i++) {
+    for (int j = 0; j < cols; j++) {
+      if (j != 0) src += L"&";
+      src += to_wstring(i * cols + j);
+    }
+    src += L"\\\\";
+  }
+  return src + L"\\end{array}";
+}
+
+void bench(const string& name, const wstring& src, int runs) {
+  typedef chrono::steady_clock clock;
+  vector<double> parses, builds;
+  for (int i = 0; i < runs; i++) {
+    const auto t0 = clock::now();
+    Formula f;
+    f.setLaTeX(src);
+    const auto t1 = clock::now();
+    TeXRender* r = TeXRenderBuilder().setStyle(TexStyle::display).setTextSize(20).build(f);
+    const auto t2 = clock::now();
+    delete r;
+    parses.push_back(chrono::duration<double, milli>(t1 - t0).count());
+    builds.push_back(chrono::duration<double, milli>(t2 - t1).count());
+  }
+  sort(parses.begin(), parses.end());
+  sort(builds.begin(), builds.end());
+  cout << name << ": parse best " << parses.front() << " ms, median " << parses[runs / 2]
+       << " ms; build best " << builds.front() << " ms, median " << builds[runs / 2] << " ms"
+       << endl;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  const int runs = argc > 1 ? max(1, atoi(argv[1])) : 5;
+  LaTeX::init(argc > 2 ? argv[2] : "res");
+  // warm up the fonts and the symbols
+  Formula warm(L"x");
+  delete TeXRenderBuilder().setTextSize(20).build(warm);
+  bench("100x100", makeArray(100, 100), runs);
+  bench("1000x10", makeArray(1000, 10), runs);
+  LaTeX::release();
+  return 0;
+}
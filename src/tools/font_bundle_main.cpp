@@ -0,0 +1,70 @@
+/**
+ * Compile TeX font descriptions (e.g. the alphabets in res/greek and
+ * res/cyrillic) into bundles, which are loaded instead of the XML files if
+ * placed beside them, see FontBundle.
+ *
+ * Usage: LaTeXFontBundle description.xml [output]
+ *        LaTeXFontBundle font.otf [output]
+ *
+ * The output is the description with the extension ".bundle" by default. The
+ * bundle must be compiled on a machine with the same byte order and the same
+ * size of wchar_t as the machine loads it, and recompiled after the XML files
+ * change.
+ * <p>
+ * An OpenType font (.otf, .ttf or .ttc) is read by OpenTypeParser into the TeX
+ * font named by the file without its extension, the bundle is registered by
+ * DefaultTeXFont#addTeXFontBundle and must stay beside the font.
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+#include "res/parser/font_bundle.h"
+#include "res/parser/otf_parser.h"
+#include "utils/string_utils.h"
+
+using namespace std;
+using namespace tex;
+
+int main(int argc, char* argv[]) {
+  if (argc < 2 || argc > 3) {
+    cerr << "Usage: " << argv[0] << " (description.xml | font.otf) [output]" << endl;
+    return 1;
+  }
+  const string file = argv[1];
+  const size_t dot = file.find_last_of('.');
+  string ext = dot == string::npos ? "" : file.substr(dot);
+  tolower(ext);
+  const bool otf = ext == ".otf" || ext == ".ttf" || ext == ".ttc";
+  const string out = argc == 3 ? argv[2]
+                     : otf     ? file.substr(0, dot) + FontBundle::EXTENSION
+                               : FontBundle::pathOf(file);
+  // the files the description includes are relative to it
+  const size_t i = file.find_last_of("/\\");
+  const string base = i == string::npos ? "." : file.substr(0, i);
+
+  vector<u8> bundle;
+  try {
+    if (otf) {
+      const string name = file.substr(i == string::npos ? 0 : i + 1);
+      __FontDescription desc;
+      OpenTypeParser(file).parse(name.substr(0, name.find_last_of('.')), desc);
+      FontBundle::compile(base, desc, bundle);
+    } else {
+      FontBundle::compile(base, file, bundle);
+    }
+  } catch (const exception& e) {
+    cerr << "Failed to compile " << file << ": " << e.what() << endl;
+    return 1;
+  }
+
+  ofstream os(out, ios::binary);
+  os.write((const char*) bundle.data(), bundle.size());
+  if (!os) {
+    cerr << "Failed to write " << out << endl;
+    return 1;
+  }
+  cout << file << " -> " << out << " (" << bundle.size() << " bytes)" << endl;
+  return 0;
+}
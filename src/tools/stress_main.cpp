@@ -0,0 +1,298 @@
+/**
+ * Stress the library from several threads: every thread parses, builds and draws
+ * the formulas in SAMPLES.tex, and draws the renders shared by all the threads
+ * with a clip (see BoxGroup#drawVisible), for the given rounds. The primitives
+ * drawn are counted and compared with the counts of a single thread, any
+ * difference or exception fails the run. Build it with -fsanitize=thread to find
+ * the data races.
+ *
+ * Usage: LaTeXStress [threads] [rounds] [res] [count|backend]
+ *
+ * The threads are 16, the rounds are 4 and the resources are in "res" by default.
+ * The samples that define commands or colors change the global tables, they are
+ * parsed once before the threads start and only drawn by the threads.
+ * <p>
+ * With "backend" the formulas are drawn by the Graphics2D of the platform the
+ * library is built for (cairo, Qt or Skia) into an image per draw instead of
+ * being counted, and the checksums of the pixels are compared, so the fonts and
+ * the text layouts of the platform are used from the threads too.
+ */
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "config.h"
+#include "core/formula.h"
+#include "latex.h"
+#include "samples/samples.h"
+
+#if defined(BUILD_GTK) && !defined(MEM_CHECK)
+#include <cairomm/surface.h>
+
+#include "platform/cairo/graphic_cairo.h"
+#define HAVE_BACKEND
+#elif defined(BUILD_QT) && !defined(MEM_CHECK)
+#include <QGuiApplication>
+#include <QImage>
+#include <QPainter>
+
+#include "platform/qt/graphic_qt.h"
+#define HAVE_BACKEND
+#elif defined(BUILD_SKIA) && !defined(MEM_CHECK)
+#include <core/SkPixmap.h>
+#include <core/SkSurface.h>
+
+#include "platform/skia/graphic_skia.h"
+#define HAVE_BACKEND
+#endif
+
+using namespace std;
+using namespace tex;
+
+namespace {
+
+/** A graphics counts the primitives, nothing is drawn */
+class CountingGraphics2D : public Graphics2D {
+private:
+  color _color = black;
+  Stroke _stroke;
+  const Font* _font = nullptr;
+  float _sx = 1, _sy = 1;
+
+public:
+  u64 primitives = 0;
+
+  void setColor(color c) override { _color = c; }
+
+  color getColor() const override { return _color; }
+
+  void setStroke(const Stroke& s) override { _stroke = s; }
+
+  const Stroke& getStroke() const override { return _stroke; }
+
+  void setStrokeWidth(float w) override { _stroke.lineWidth = w; }
+
+  const Font* getFont() const override { return _font; }
+
+  void setFont(const Font* font) override { _font = font; }
+
+  void translate(float dx, float dy) override {}
+
+  void scale(float sx, float sy) override {
+    _sx *= sx;
+    _sy *= sy;
+  }
+
+  void rotate(float angle) override {}
+
+  void rotate(float angle, float px, float py) override {}
+
+  void reset() override { _sx = _sy = 1; }
+
+  float sx() const override { return _sx; }
+
+  float sy() const override { return _sy; }
+
+  void drawChar(wchar_t c, float x, float y) override { primitives++; }
+
+  void drawText(const wstring& c, float x, float y) override { primitives++; }
+
+  void drawLine(float x1, float y1, float x2, float y2) override { primitives++; }
+
+  void drawRect(float x, float y, float w, float h) override { primitives++; }
+
+  void fillRect(float x, float y, float w, float h) override { primitives++; }
+
+  void drawRoundRect(float x, float y, float w, float h, float rx, float ry) override {
+    primitives++;
+  }
+
+  void fillRoundRect(float x, float y, float w, float h, float rx, float ry) override {
+    primitives++;
+  }
+};
+
+struct Sample {
+  wstring src;
+  // if the sample could be parsed again by the threads
+  bool reparse;
+  sptr<TeXRender> render;
+  // the primitives or the checksums of the pixels drawn by a single thread, as a
+  // whole and clipped
+  u64 whole, clipped;
+};
+
+// if to draw by the Graphics2D of the platform, see #draw
+bool backend = false;
+
+TeXRender* build(Formula& f) {
+  return TeXRenderBuilder()
+    .setStyle(TexStyle::display)
+    .setTextSize(20)
+    .setWidth(UnitType::pixel, 600, Alignment::left)
+    .setIsMaxWidth(true)
+    .setLineSpace(UnitType::point, 4)
+    .build(f);
+}
+
+/** The left half of the render */
+Rect clipOf(const TeXRender& r) {
+  return {0.f, 0.f, r.getWidth() / 2.f, (float) r.getHeight()};
+}
+
+/** The FNV-1a hash of the given pixels */
+u64 checksum(const void* data, size_t size) {
+  const u8* p = (const u8*) data;
+  u64 h = 14695981039346656037ull;
+  for (size_t i = 0; i < size; i++) {
+    h ^= p[i];
+    h *= 1099511628211ull;
+  }
+  return h;
+}
+
+/**
+ * Draw the render into an image by the Graphics2D of the platform, clipped if the
+ * clip is not null, and return the checksum of the pixels
+ */
+u64 drawOnBackend(TeXRender& r, const Rect* clip) {
+#ifdef HAVE_BACKEND
+  const int w = max(1, r.getWidth()), h = max(1, r.getHeight());
+#endif
+#if defined(BUILD_GTK) && !defined(MEM_CHECK)
+  auto surface = Cairo::ImageSurface::create(Cairo::FORMAT_ARGB32, w, h);
+  {
+    Graphics2D_cairo g(Cairo::Context::create(surface));
+    if (clip == nullptr) r.draw(g, 0, 0);
+    else r.draw(g, 0, 0, *clip);
+  }
+  surface->flush();
+  return checksum(surface->get_data(), (size_t) surface->get_stride() * h);
+#elif defined(BUILD_QT) && !defined(MEM_CHECK)
+  QImage image(w, h, QImage::Format_ARGB32_Premultiplied);
+  image.fill(Qt::transparent);
+  {
+    QPainter painter(&image);
+    painter.setRenderHint(QPainter::Antialiasing, true);
+    Graphics2D_qt g(&painter);
+    if (clip == nullptr) r.draw(g, 0, 0);
+    else r.draw(g, 0, 0, *clip);
+  }
+  return checksum(image.constBits(), (size_t) image.sizeInBytes());
+#elif defined(BUILD_SKIA) && !defined(MEM_CHECK)
+  auto surface = SkSurface::MakeRasterN32Premul(w, h);
+  {
+    Graphics2D_skia g(surface->getCanvas());
+    if (clip == nullptr) r.draw(g, 0, 0);
+    else r.draw(g, 0, 0, *clip);
+  }
+  SkPixmap pixels;
+  if (!surface->peekPixels(&pixels)) return 0;
+  return checksum(pixels.addr(), pixels.computeByteSize());
+#else
+  return 0;
+#endif
+}
+
+u64 draw(TeXRender& r) {
+  if (backend) return drawOnBackend(r, nullptr);
+  CountingGraphics2D g;
+  r.draw(g, 0, 0);
+  return g.primitives;
+}
+
+u64 draw(TeXRender& r, const Rect& clip) {
+  if (backend) return drawOnBackend(r, &clip);
+  CountingGraphics2D g;
+  r.draw(g, 0, 0, clip);
+  return g.primitives;
+}
+
+bool defines(const wstring& src) {
+  for (const wchar_t* cmd : {L"\\new", L"\\renew", L"\\define", L"\\Declare"}) {
+    if (src.find(cmd) != wstring::npos) return true;
+  }
+  return false;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  const int threads = argc > 1 ? max(1, atoi(argv[1])) : 16;
+  const int rounds = argc > 2 ? max(1, atoi(argv[2])) : 4;
+  backend = argc > 4 && string(argv[4]) == "backend";
+#ifdef HAVE_BACKEND
+#if defined(BUILD_QT) && !defined(MEM_CHECK)
+  // the fonts of Qt require the application
+  unique_ptr<QGuiApplication> app;
+  if (backend) app = make_unique<QGuiApplication>(argc, argv);
+#endif
+#else
+  if (backend) {
+    cerr << "No Graphics2D of a platform is built, draw by counting" << endl;
+    backend = false;
+  }
+#endif
+  LaTeX::init(argc > 3 ? argv[3] : "res");
+
+  vector<Sample> samples;
+  Samples reader;
+  for (int i = 0; i < reader.count(); i++) {
+    Sample s{reader.next(), false, nullptr, 0, 0};
+    s.reparse = !defines(s.src);
+    try {
+      Formula f(s.src);
+      s.render = sptr<TeXRender>(build(f));
+    } catch (const exception& e) {
+      cerr << "Skip the sample " << i << ": " << e.what() << endl;
+      continue;
+    }
+    s.whole = draw(*s.render);
+    s.clipped = draw(*s.render, clipOf(*s.render));
+    samples.push_back(std::move(s));
+  }
+  cout << samples.size() << " samples, " << threads << " threads, " << rounds << " rounds"
+       << (backend ? ", drawn by the platform" : "") << endl;
+
+  atomic<int> failures(0);
+  const auto run = [&](int id) {
+    const size_t n = samples.size();
+    for (int round = 0; round < rounds; round++) {
+      for (size_t k = 0; k < n; k++) {
+        // the threads start at different samples
+        const size_t i = (k + id * 7) % n;
+        Sample& s = samples[i];
+        try {
+          if (s.reparse) {
+            Formula f(s.src);
+            unique_ptr<TeXRender> r(build(f));
+            if (draw(*r) != s.whole) {
+              cerr << "Thread " << id << ": the sample " << i << " draws differently" << endl;
+              failures++;
+            }
+          }
+          if (draw(*s.render, clipOf(*s.render)) != s.clipped) {
+            cerr << "Thread " << id << ": the shared sample " << i << " draws differently" << endl;
+            failures++;
+          }
+        } catch (const exception& e) {
+          cerr << "Thread " << id << ": the sample " << i << " failed: " << e.what() << endl;
+          failures++;
+        }
+      }
+    }
+  };
+  vector<thread> workers;
+  for (int i = 0; i < threads; i++) workers.emplace_back(run, i);
+  for (auto& w : workers) w.join();
+
+  samples.clear();
+  LaTeX::release();
+  cout << (failures == 0 ? "OK" : to_string(failures) + " failures") << endl;
+  return failures == 0 ? 0 : 1;
+}
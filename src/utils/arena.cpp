@@ -0,0 +1,120 @@
+#include "utils/arena.h"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#define HAVE_MMAP
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+using namespace tex;
+
+static size_t pageSize() {
+#if defined(_WIN32)
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  return info.dwPageSize;
+#elif defined(HAVE_MMAP)
+  const long size = sysconf(_SC_PAGESIZE);
+  return size > 0 ? (size_t) size : 4096;
+#else
+  return 4096;
+#endif
+}
+
+static u8* mapPages(size_t size) {
+#if defined(_WIN32)
+  return (u8*) VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#elif defined(HAVE_MMAP)
+  void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  return p == MAP_FAILED ? nullptr : (u8*) p;
+#else
+  return new (nothrow) u8[size];
+#endif
+}
+
+static void unmapPages(u8* p, size_t size) {
+#if defined(_WIN32)
+  VirtualFree(p, 0, MEM_RELEASE);
+#elif defined(HAVE_MMAP)
+  munmap(p, size);
+#else
+  delete[] p;
+#endif
+}
+
+Arena::Arena(size_t chunkSize) : _chunkSize(chunkSize) {}
+
+void* Arena::alloc(size_t size, size_t align) {
+  if (_sealed) return nullptr;
+  if (!_chunks.empty()) {
+    const Chunk& last = _chunks.back();
+    const size_t start = (_used + align - 1) & ~(align - 1);
+    if (start + size <= last.size) {
+      _used = start + size;
+      _allocated += size;
+      return last.data + start;
+    }
+  }
+  // the chunks start at page boundaries, which meet any alignment of the objects
+  const size_t page = pageSize();
+  const size_t chunk = (max(size, _chunkSize) + page - 1) / page * page;
+  u8* data = mapPages(chunk);
+  if (data == nullptr) throw bad_alloc();
+  _chunks.push_back({data, chunk});
+  _used = size;
+  _allocated += size;
+  return data;
+}
+
+bool Arena::owns(const void* p) const {
+  const u8* x = (const u8*) p;
+  for (const auto& c : _chunks) {
+    if (x >= c.data && x < c.data + c.size) return true;
+  }
+  return false;
+}
+
+void Arena::protect(bool readOnly) {
+  for (const auto& c : _chunks) {
+#if defined(_WIN32)
+    DWORD old;
+    VirtualProtect(c.data, c.size, readOnly ? PAGE_READONLY : PAGE_READWRITE, &old);
+#elif defined(HAVE_MMAP)
+    mprotect(c.data, c.size, readOnly ? PROT_READ : PROT_READ | PROT_WRITE);
+#endif
+  }
+}
+
+void Arena::seal() {
+  if (_sealed) return;
+  protect(true);
+  _sealed = true;
+}
+
+void Arena::unseal() {
+  if (!_sealed) return;
+  protect(false);
+  _sealed = false;
+}
+
+void Arena::clear() {
+  for (const auto& c : _chunks) unmapPages(c.data, c.size);
+  _chunks.clear();
+  _used = _allocated = 0;
+  _sealed = false;
+}
+
+Arena::~Arena() {
+  clear();
+}
+
+Arena& Arena::state() {
+  static Arena* arena = new Arena();
+  return *arena;
+}
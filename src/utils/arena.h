@@ -0,0 +1,144 @@
+#ifndef ARENA_H_INCLUDED
+#define ARENA_H_INCLUDED
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "utils/utils.h"
+
+namespace tex {
+
+/**
+ * A bump allocator that places objects in a few contiguous chunks of pages
+ * instead of many small heap allocations, the objects are never freed one by
+ * one but all at once by #clear.
+ * <p>
+ * It is used to build the immutable state of LaTeX#init (see #state), so the
+ * state is packed into pages that hold nothing else: a process forked after
+ * init shares these pages with its parent as long as it only reads them, while
+ * the heap pages would be copied once anything allocated beside the state is
+ * written. The chunks could be made read-only by #seal (where mprotect or
+ * VirtualProtect is supported), then a write to the state faults instead of
+ * copying a page silently, and the arena allocates from the heap.
+ */
+class Arena {
+private:
+  struct Chunk {
+    u8* data;
+    size_t size;
+  };
+
+  const size_t _chunkSize;
+  std::vector<Chunk> _chunks;
+  // the used bytes of the last chunk
+  size_t _used = 0;
+  // the allocated bytes of all chunks
+  size_t _allocated = 0;
+  bool _sealed = false;
+
+  void protect(bool readOnly);
+
+public:
+  /** Create an arena that maps the chunks in the given size, rounded up to pages */
+  explicit Arena(size_t chunkSize = 64 * 1024);
+
+  no_copy_assign(Arena);
+
+  /**
+   * Allocate the given bytes with the given alignment in this arena, return
+   * nullptr if the arena is sealed.
+   */
+  void* alloc(size_t size, size_t align = alignof(std::max_align_t));
+
+  /** Test if the given pointer points into this arena */
+  bool owns(const void* p) const;
+
+  /** Construct a T in this arena, or on the heap if the arena is sealed, destroy it by #destroy */
+  template <typename T, typename... Args>
+  T* create(Args&&... args) {
+    void* p = alloc(sizeof(T), alignof(T));
+    if (p == nullptr) return new T(std::forward<Args>(args)...);
+    return new (p) T(std::forward<Args>(args)...);
+  }
+
+  /** Destroy an object created by #create */
+  template <typename T>
+  void destroy(T* obj) {
+    if (obj == nullptr) return;
+    if (owns(obj)) {
+      obj->~T();
+    } else {
+      delete obj;
+    }
+  }
+
+  /** Make the chunks read-only, the later allocations go to the heap */
+  void seal();
+
+  /** Make the chunks writable again, e.g. to destroy the objects */
+  void unseal();
+
+  inline bool isSealed() const { return _sealed; }
+
+  /** Get the bytes allocated in this arena */
+  inline size_t size() const { return _allocated; }
+
+  /** Release all the chunks, the objects in this arena must have been destroyed */
+  void clear();
+
+  ~Arena();
+
+  /**
+   * The arena of the immutable state built by LaTeX#init, e.g. the font infos
+   * and the mappings of the chars to the fonts. It is never destroyed, so the
+   * containers of the state could be destroyed at exit.
+   */
+  static Arena& state();
+};
+
+/**
+ * The allocator of the containers of the state built by LaTeX#init, it
+ * allocates in Arena#state and falls back to the heap if the arena is sealed.
+ * The memory in the arena is released by Arena#clear only.
+ */
+template <typename T>
+struct StateAllocator {
+  typedef T value_type;
+
+  StateAllocator() = default;
+
+  template <typename U>
+  StateAllocator(const StateAllocator<U>&) {}
+
+  T* allocate(size_t n) {
+    void* p = Arena::state().alloc(n * sizeof(T), alignof(T));
+    if (p == nullptr) p = ::operator new(n * sizeof(T));
+    return (T*) p;
+  }
+
+  void deallocate(T* p, size_t) {
+    if (!Arena::state().owns(p)) ::operator delete(p);
+  }
+
+  template <typename U>
+  bool operator==(const StateAllocator<U>&) const { return true; }
+
+  template <typename U>
+  bool operator!=(const StateAllocator<U>&) const { return false; }
+};
+
+/** A map of the state built by LaTeX#init, see StateAllocator */
+template <typename K, typename V>
+using StateMap = std::map<K, V, std::less<K>, StateAllocator<std::pair<const K, V>>>;
+
+/** A vector of the state built by LaTeX#init, see StateAllocator */
+template <typename T>
+using StateVector = std::vector<T, StateAllocator<T>>;
+
+}  // namespace tex
+
+#endif  // ARENA_H_INCLUDED
@@ -0,0 +1,73 @@
+#ifndef CODE_POINT_TABLE_H_INCLUDED
+#define CODE_POINT_TABLE_H_INCLUDED
+
+#include <array>
+#include <vector>
+
+#include "utils/utils.h"
+
+namespace tex {
+
+/**
+ * A two-level table maps every code point (0 ~ 0x10FFFF) to a small value in
+ * constant time. The code points are split into pages of 256, the first level
+ * maps a page to its values, and the pages never set share one page of the
+ * default value, so a table of a few scripts takes a few kilobytes only.
+ * <p>
+ * The table is built once and read many times, #set is not meant for the hot
+ * paths, it copies a shared page on the first write.
+ */
+template <typename T>
+class CodePointTable {
+private:
+  static constexpr u32 PAGE_BITS = 8;
+  static constexpr u32 PAGE_SIZE = 1u << PAGE_BITS;
+  static constexpr u32 MAX_CODE_POINT = 0x10ffff;
+  static constexpr u32 PAGES = (MAX_CODE_POINT >> PAGE_BITS) + 1;
+
+  T _default;
+  // the page of every code point page, the page 0 is filled with the default value
+  std::vector<u16> _index;
+  std::vector<std::array<T, PAGE_SIZE>> _pages;
+
+public:
+  explicit CodePointTable(T def = T()) { reset(def); }
+
+  /** Map all the code points to the given value */
+  void reset(T def) {
+    _default = def;
+    _index.assign(PAGES, 0);
+    _pages.assign(1, {});
+    _pages[0].fill(def);
+  }
+
+  /** Get the value of the given code point, the ones out of range map to the default value */
+  inline T get(u32 c) const {
+    if (c > MAX_CODE_POINT) return _default;
+    return _pages[_index[c >> PAGE_BITS]][c & (PAGE_SIZE - 1)];
+  }
+
+  /** Set the value of the given code point, the ones out of range are ignored */
+  void set(u32 c, T value) {
+    if (c > MAX_CODE_POINT) return;
+    u16& page = _index[c >> PAGE_BITS];
+    if (page == 0) {
+      if (value == _default) return;
+      page = (u16) _pages.size();
+      _pages.push_back(_pages[0]);
+    }
+    _pages[page][c & (PAGE_SIZE - 1)] = value;
+  }
+
+  /** Set the value of the code points in the range [first, last] */
+  void set(u32 first, u32 last, T value) {
+    for (u32 c = first; c <= last && c <= MAX_CODE_POINT; c++) set(c, value);
+  }
+
+  /** The count of the pages that hold values other than the default */
+  inline size_t pages() const { return _pages.size() - 1; }
+};
+
+}  // namespace tex
+
+#endif  // CODE_POINT_TABLE_H_INCLUDED
@@ -0,0 +1,141 @@
+#ifndef CONCURRENT_CACHE_H_INCLUDED
+#define CONCURRENT_CACHE_H_INCLUDED
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#if __has_include(<version>)
+#include <version>
+#endif
+
+#include "utils/utils.h"
+
+namespace tex {
+
+// the std::atomic<std::shared_ptr>::load of libstdc++ releases its lock relaxed,
+// so it does not order the read before a following store (ThreadSanitizer reports
+// it), libstdc++ keeps the overloads of std::atomic_load without deprecating them
+#if defined(__cpp_lib_atomic_shared_ptr) && !defined(__GLIBCXX__)
+#define CLM_ATOMIC_SHARED_PTR
+#endif
+
+/**
+ * A shared pointer loaded and stored atomically, by std::atomic<std::shared_ptr>
+ * where the library has it (C++20), or by the overloads of std::atomic_load and
+ * std::atomic_store for std::shared_ptr otherwise, which C++20 deprecates.
+ */
+template <typename T>
+class AtomicSharedPtr {
+private:
+#ifdef CLM_ATOMIC_SHARED_PTR
+  std::atomic<std::shared_ptr<T>> _ptr;
+#else
+  std::shared_ptr<T> _ptr;
+#endif
+
+public:
+  AtomicSharedPtr() = default;
+
+  no_copy_assign(AtomicSharedPtr);
+
+  std::shared_ptr<T> load() const {
+#ifdef CLM_ATOMIC_SHARED_PTR
+    return _ptr.load();
+#else
+    return std::atomic_load(&_ptr);
+#endif
+  }
+
+  void store(std::shared_ptr<T> ptr) {
+#ifdef CLM_ATOMIC_SHARED_PTR
+    _ptr.store(std::move(ptr));
+#else
+    std::atomic_store(&_ptr, std::move(ptr));
+#endif
+  }
+};
+
+/**
+ * A process-global cache that is filled on first use and read far more often
+ * than written, e.g. the fonts loaded by the platforms, which could be looked up
+ * from several rendering threads.
+ * <p>
+ * The readers never wait for a writer: they load an immutable snapshot of the map
+ * atomically. A writer copies the snapshot with the new entry under a mutex and
+ * publishes the copy. The snapshots are shared pointers, so an old snapshot is
+ * released by the last reader still walking it, and only the current one is kept.
+ * The values are allocated once and never moved, so a reference to a value is
+ * valid as long as the cache, and the snapshots copy pointers only, which matters
+ * for values whose copy is not thread-safe (e.g. the RefPtr of cairomm).
+ * <p>
+ * A write copies the whole map, so the cache fits the small and bounded key sets
+ * (e.g. the font files), the callers with unbounded keys must bound them.
+ */
+template <typename K, typename V, typename Less = std::less<K>>
+class ConcurrentCache {
+private:
+  typedef std::map<K, const V*, Less> Map;
+
+  AtomicSharedPtr<const Map> _map;
+  std::mutex _mutex;
+  // the values, never moved, released by #clear and the destructor
+  std::deque<V> _values;
+
+public:
+  ConcurrentCache() = default;
+
+  no_copy_assign(ConcurrentCache);
+
+  /** Find the value of the given key without locking, return nullptr if not cached */
+  const V* find(const K& key) const {
+    const auto map = _map.load();
+    if (map == nullptr) return nullptr;
+    const auto it = map->find(key);
+    return it == map->end() ? nullptr : it->second;
+  }
+
+  /**
+   * Get the value of the given key, or create it by the given function and cache
+   * it if not cached. The function runs outside the lock so two threads could
+   * create the value of the same key at the same time, the value cached first
+   * wins and the other one is dropped. If the function throws, nothing is cached.
+   */
+  template <typename F>
+  const V& getOrCreate(const K& key, F&& create) {
+    const V* value = find(key);
+    if (value != nullptr) return *value;
+    return put(key, create());
+  }
+
+  /** Cache the given value if the key is not cached yet, return the cached value */
+  const V& put(const K& key, V&& value) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    const auto old = _map.load();
+    if (old != nullptr) {
+      const auto it = old->find(key);
+      if (it != old->end()) return *it->second;
+    }
+    _values.push_back(std::move(value));
+    const V* v = &_values.back();
+    auto map = old == nullptr ? std::make_shared<Map>() : std::make_shared<Map>(*old);
+    (*map)[key] = v;
+    _map.store(std::shared_ptr<const Map>(std::move(map)));
+    return *v;
+  }
+
+  /** Drop all the cached values, no thread may use the values meanwhile */
+  void clear() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _map.store(nullptr);
+    _values.clear();
+  }
+
+  ~ConcurrentCache() { clear(); }
+};
+
+}  // namespace tex
+
+#endif  // CONCURRENT_CACHE_H_INCLUDED
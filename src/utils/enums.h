@@ -23,6 +23,27 @@ enum class Alignment : i8 {
   none = -1
 };
 
+/** Strategy to break a formula into lines. */
+enum class BreakMode : i8 {
+  /** Fill each line as much as possible, then break (first-fit). */
+  greedy,
+  /**
+   * Choose the breaks of the whole formula at once so that the sum of the
+   * demerits of all lines is minimal (Knuth-Plass), lines are more even.
+   */
+  optimal
+};
+
+/** How LaTeX#preloadFonts creates the fonts. */
+enum class FontPreload : i8 {
+  /** Create the fonts one by one on a background thread. */
+  background,
+  /** Create the fonts on a pool of background threads, one per hardware thread. */
+  parallel,
+  /** Create the fonts in the calling thread before returning. */
+  blocking
+};
+
 /** Space amount between formulas. */
 enum class SpaceType : i8 {
   thinMuSkip = 1,
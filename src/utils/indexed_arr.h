@@ -1,19 +1,37 @@
 #ifndef INDEXED_ARR_H_INCLUDED
 #define INDEXED_ARR_H_INCLUDED
 
+#include <cstdint>
+#include <vector>
+
 namespace tex {
 
 /**
  * Template to represents 2 dimensions array with N element(s) for each item and
  * sorted by the first M element(s).
+ * <p>
+ * If the first keys are integral codes in a small and dense range (e.g. the character
+ * codes of the builtin fonts, mostly in [0, 255]), a direct index maps every code to
+ * the span of rows that starts with it, so #find(int) and #find(int, int) are O(1)
+ * instead of a binary search over all rows.
  */
 template <typename T, size_t N, size_t M>
 class IndexedArray {
 private:
+  /** The max range of codes that the dense index covers */
+  static constexpr int MAX_DENSE_RANGE = 0x10000;
+  /** Mark of a code that has no rows */
+  static constexpr uint16_t NO_ROW = 0xffff;
+
   const T* _raw;
   size_t   _rows;
   bool     _auto_delete;
 
+  // the first code covered by the dense index
+  int _first;
+  // code - _first => start row of the span, the span ends at the start of the next code
+  std::vector<uint16_t> _index;
+
   int compare(const T a[M], const T b[M]) const {
     for (size_t i = 0; i < M; i++) {
       if (a[i] < b[i]) return -1;
@@ -22,32 +40,71 @@ private:
     return 0;
   }
 
+  inline int code(size_t row) const {
+    return (int) _raw[row * N];
+  }
+
+  void buildIndex() {
+    _index.clear();
+    _first = 0;
+    if (_raw == nullptr || _rows == 0 || _rows >= NO_ROW) return;
+    const int first = code(0), last = code(_rows - 1);
+    // the dense index only works with integral keys sorted in ascending order
+    if (last - first >= MAX_DENSE_RANGE) return;
+    for (size_t i = 0; i < _rows; i++) {
+      if ((T) code(i) != _raw[i * N]) return;
+      if (i > 0 && code(i) < code(i - 1)) return;
+    }
+    _first = first;
+    // one more slot to close the span of the last code
+    _index.resize(last - first + 2, NO_ROW);
+    for (size_t i = _rows; i > 0; i--) {
+      _index[code(i - 1) - first] = (uint16_t) (i - 1);
+    }
+    // codes without rows point to the start of the next span, so the span is empty
+    uint16_t next = (uint16_t) _rows;
+    for (size_t i = _index.size(); i > 0; i--) {
+      if (_index[i - 1] == NO_ROW) {
+        _index[i - 1] = next;
+      } else {
+        next = _index[i - 1];
+      }
+    }
+  }
+
 public:
   IndexedArray(const IndexedArray& arr) = delete;
 
   IndexedArray(IndexedArray&& arr) = delete;
 
-  IndexedArray() : _raw(nullptr), _rows(0), _auto_delete(false) {}
+  IndexedArray() : _raw(nullptr), _rows(0), _auto_delete(false), _first(0) {}
 
   IndexedArray(const T* arr, int len, bool auto_delete = false)
-      : _raw(arr), _rows(len / N), _auto_delete(auto_delete) {}
+      : _raw(arr), _rows(len / N), _auto_delete(auto_delete), _first(0) {
+    buildIndex();
+  }
 
   void operator=(IndexedArray&& o) {
+    if (_auto_delete && _raw != nullptr) delete[] _raw;
     _raw         = o._raw;
     _rows        = o._rows;
     _auto_delete = o._auto_delete;
+    _first       = o._first;
+    _index       = std::move(o._index);
     // reset o
     o._raw         = nullptr;
     o._rows        = 0;
     o._auto_delete = false;
+    o._first       = 0;
+    o._index.clear();
   }
 
   /** Find the item by the given keys, return nullptr if not found */
   template <typename... Ks>
   const T* operator()(const Ks&... keys) const {
-    if (_raw == nullptr) return nullptr;
+    if (_raw == nullptr || _rows == 0) return nullptr;
     const T k[] = {keys...};
-    int     l = 0, h = _rows;
+    int     l = 0, h = (int) _rows - 1;
     while (l <= h) {
       const int  m   = l + ((h - l) >> 1);
       const T*   r   = _raw + (m * N);
@@ -58,6 +115,36 @@ public:
     return nullptr;
   }
 
+  /**
+   * Find the item whose first key is the given code, return nullptr if not found.
+   * Falls back to the binary search if the keys are not dense.
+   */
+  const T* find(int key) const {
+    if (_index.empty()) return (*this)((T) key);
+    const int i = key - _first;
+    if (i < 0 || i + 1 >= (int) _index.size()) return nullptr;
+    const uint16_t r = _index[i];
+    return r == _index[i + 1] ? nullptr : _raw + (r * N);
+  }
+
+  /**
+   * Find the item by the given 2 codes, return nullptr if not found. The rows start with
+   * the first code are scanned linearly, which are few (e.g. kerning pairs of a char).
+   * If the pair is defined more than once, the last definition wins.
+   */
+  const T* find(int first, int second) const {
+    if (_index.empty()) return (*this)((T) first, (T) second);
+    const int i = first - _first;
+    if (i < 0 || i + 1 >= (int) _index.size()) return nullptr;
+    const T k = (T) second;
+    const T* found = nullptr;
+    for (const T* r = _raw + (_index[i] * N), * e = _raw + (_index[i + 1] * N); r < e; r += N) {
+      if (r[1] > k) break;
+      if (r[1] == k) found = r;
+    }
+    return found;
+  }
+
   /** Get the item by the given index, return nullptr if index out of range */
   const T* operator[](const size_t i) const {
     if (_raw == nullptr || i < 0 || i >= _rows) return nullptr;
@@ -76,6 +163,11 @@ public:
     return _rows == 0 || _raw == nullptr;
   }
 
+  /** Test if the lookups are done by the dense index */
+  inline bool isDense() const {
+    return !_index.empty();
+  }
+
   ~IndexedArray() {
     if (_auto_delete && _raw != nullptr) delete[] _raw;
     _raw = nullptr;
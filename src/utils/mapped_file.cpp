@@ -0,0 +1,111 @@
+#include "utils/mapped_file.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+
+#include "utils/exceptions.h"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#define HAVE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+using namespace tex;
+
+static FILE* openFile(const string& path) {
+#ifdef _MSC_VER
+  FILE* fp = nullptr;
+  return fopen_s(&fp, path.c_str(), "rb") == 0 ? fp : nullptr;
+#else
+  return fopen(path.c_str(), "rb");
+#endif
+}
+
+MappedFile::MappedFile(const string& path) {
+#if defined(_WIN32)
+  HANDLE file = CreateFileA(
+    path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr
+  );
+  if (file == INVALID_HANDLE_VALUE) throw ex_file_not_found("Cannot open the file '" + path + "'!");
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size)) {
+    CloseHandle(file);
+    throw ex_file_not_found("Cannot read the file '" + path + "'!");
+  }
+  _size = (size_t) size.QuadPart;
+  if (_size > 0) {
+    _mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (_mapping != nullptr) _data = (const u8*) MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0);
+  }
+  CloseHandle(file);
+  if (_size == 0 || _data != nullptr) return;
+#elif defined(HAVE_MMAP)
+  const int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) throw ex_file_not_found("Cannot open the file '" + path + "'!");
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    throw ex_file_not_found("Cannot read the file '" + path + "'!");
+  }
+  _size = (size_t) st.st_size;
+  if (_size > 0) {
+    void* p = mmap(nullptr, _size, PROT_READ, MAP_SHARED, fd, 0);
+    if (p != MAP_FAILED) _data = (const u8*) p;
+  }
+  // the mapping holds the file
+  close(fd);
+  if (_size == 0 || _data != nullptr) return;
+#endif
+  // fall back to read the whole file
+  FILE* fp = openFile(path);
+  if (fp == nullptr) throw ex_file_not_found("Cannot open the file '" + path + "'!");
+  fseek(fp, 0, SEEK_END);
+  const long len = ftell(fp);
+  fseek(fp, 0, SEEK_SET);
+  _buffer.resize(len < 0 ? 0 : (size_t) len);
+  const size_t n = fread(_buffer.data(), 1, _buffer.size(), fp);
+  fclose(fp);
+  if (n != _buffer.size()) throw ex_file_not_found("Cannot read the file '" + path + "'!");
+  _data = _buffer.data();
+  _size = _buffer.size();
+}
+
+bool MappedFile::exists(const string& path) {
+  FILE* fp = openFile(path);
+  if (fp == nullptr) return false;
+  fclose(fp);
+  return true;
+}
+
+string MappedFile::tempPathOf(const string& path) {
+  static atomic<unsigned> counter(0);
+#if defined(_WIN32)
+  const unsigned long long pid = GetCurrentProcessId();
+#elif defined(HAVE_MMAP)
+  const unsigned long long pid = getpid();
+#else
+  // no process id, the time is unlikely to collide
+  const unsigned long long pid = chrono::steady_clock::now().time_since_epoch().count();
+#endif
+  return path + "." + to_string(pid) + "." + to_string(counter++) + ".tmp";
+}
+
+MappedFile::~MappedFile() {
+  if (!_buffer.empty() || _data == nullptr) return;
+#if defined(_WIN32)
+  UnmapViewOfFile(_data);
+  CloseHandle(_mapping);
+#elif defined(HAVE_MMAP)
+  munmap((void*) _data, _size);
+#endif
+}
@@ -0,0 +1,50 @@
+#ifndef MAPPED_FILE_H_INCLUDED
+#define MAPPED_FILE_H_INCLUDED
+
+#include <string>
+#include <vector>
+
+#include "utils/utils.h"
+
+namespace tex {
+
+/**
+ * A read-only view of the whole content of a file. The file is memory-mapped
+ * where it is supported (POSIX and Windows), so the pages are loaded on demand
+ * and shared between the processes map the same file, otherwise the content is
+ * read into memory.
+ */
+class MappedFile {
+private:
+  const u8* _data = nullptr;
+  size_t _size = 0;
+  // the handle of the mapping on Windows
+  void* _mapping = nullptr;
+  // the content if the file could not be mapped
+  std::vector<u8> _buffer;
+
+public:
+  /** Map the file of the given path, throws ex_file_not_found if the file could not be opened */
+  explicit MappedFile(const std::string& path);
+
+  no_copy_assign(MappedFile);
+
+  inline const u8* data() const { return _data; }
+
+  inline size_t size() const { return _size; }
+
+  /** Test if the file of the given path exists and could be read */
+  static bool exists(const std::string& path);
+
+  /**
+   * Get a path beside the given path to write a temporary file, unique to the
+   * process and to the call, so the writers of the same file never collide
+   */
+  static std::string tempPathOf(const std::string& path);
+
+  ~MappedFile();
+};
+
+}  // namespace tex
+
+#endif  // MAPPED_FILE_H_INCLUDED
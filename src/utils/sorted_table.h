@@ -0,0 +1,104 @@
+#ifndef SORTED_TABLE_H_INCLUDED
+#define SORTED_TABLE_H_INCLUDED
+
+#include <cstddef>
+#include <iterator>
+#include <mutex>
+
+namespace tex {
+
+/**
+ * Helpers for the builtin tables (e.g. the symbols, the macros and the colors),
+ * which are constexpr arrays of literal entries sorted by their keys, so they
+ * are placed in read-only data and need no work at startup, unlike std::map
+ * that is built by a static initializer.
+ * <p>
+ * An entry is a struct with a member <code>key</code>, which is an integer or a
+ * null-terminated string. Strings are ordered by their code units, the same as
+ * std::string and std::wstring compare them.
+ * The order is checked at compile time by #isSortedTable, and the entries are
+ * found by binary search with #findInTable.
+ */
+
+/** An entry maps a key to a value, for the tables without other fields */
+template <typename K, typename V>
+struct TableEntry {
+  K key;
+  V value;
+};
+
+constexpr int compareKey(int a, int b) {
+  return a < b ? -1 : (a > b ? 1 : 0);
+}
+
+constexpr int compareKey(const char* a, const char* b) {
+  while (*a != 0 && *a == *b) {
+    a++;
+    b++;
+  }
+  const auto x = (unsigned char) *a, y = (unsigned char) *b;
+  return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+constexpr int compareKey(const wchar_t* a, const wchar_t* b) {
+  while (*a != 0 && *a == *b) {
+    a++;
+    b++;
+  }
+  return *a < *b ? -1 : (*a > *b ? 1 : 0);
+}
+
+/** Test if the keys of the given entries are strictly ascending, used by static_assert */
+template <typename E, size_t N>
+constexpr bool isSortedTable(const E (&entries)[N]) {
+  for (size_t i = 1; i < N; i++) {
+    if (compareKey(entries[i - 1].key, entries[i].key) >= 0) return false;
+  }
+  return true;
+}
+
+/** Find the entry with the given key in the sorted entries, return nullptr if not found */
+template <typename E, size_t N, typename K>
+const E* findInTable(const E (&entries)[N], const K& key) {
+  size_t lo = 0, hi = N;
+  while (lo < hi) {
+    const size_t mid = lo + (hi - lo) / 2;
+    const int c = compareKey(entries[mid].key, key);
+    if (c == 0) return &entries[mid];
+    if (c < 0) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return nullptr;
+}
+
+/**
+ * The objects created from the entries of a builtin table on their first use (e.g.
+ * the atoms of the builtin symbols). Every entry has its own slot that is filled
+ * once, so the objects are created and shared by several threads without changing
+ * any map. The slots are constant-initialized, nothing is created at startup.
+ */
+template <typename T, size_t N>
+class TableObjects {
+private:
+  std::once_flag _once[N];
+  T _objects[N];
+
+public:
+  /**
+   * Get the object of the given entry of the given entries, create it by the given
+   * function (that takes the entry) if it is the first use
+   */
+  template <typename E, typename F>
+  const T& get(const E (&entries)[N], const E* entry, F&& create) {
+    const size_t i = entry - entries;
+    std::call_once(_once[i], [&]() { _objects[i] = create(*entry); });
+    return _objects[i];
+  }
+};
+
+}  // namespace tex
+
+#endif  // SORTED_TABLE_H_INCLUDED
@@ -18,6 +18,8 @@ using i16 = std::int16_t;
 using u16 = std::uint16_t;
 using i32 = std::int32_t;
 using u32 = std::uint32_t;
+using i64 = std::int64_t;
+using u64 = std::uint64_t;
 using c32 = char32_t;
 
 /** Type alias shared_ptr<T> to sptr<T> */